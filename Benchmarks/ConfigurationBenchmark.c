@@ -0,0 +1,184 @@
+//
+//  ConfigurationBenchmark.c
+//  Woodpeckers Benchmarks
+//
+//  Created by Stephen H. Gerstacker on 2020-12-15.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "Configuration.h"
+#include "Log.h"
+
+
+// MARK: - Constants & Globals
+
+#define DEFAULT_TOTAL_OUTPUTS 10000
+#define DEFAULT_ITERATIONS 20
+#define OUTPUTS_PER_BIRD 4
+
+
+// MARK: - Prototypes
+
+static char * GenerateConfiguration(size_t totalOutputs);
+static char * GenerateTemplatedConfiguration(size_t totalOutputs);
+static bool MeasureParse(const char * NONNULL yaml, size_t iterations, size_t * NONNULL totalAllocations, double * NONNULL parseTime, double * NONNULL destroyTime);
+static double Now(void);
+
+
+// MARK: - Main
+
+int main(int argc, char **argv) {
+    size_t totalOutputs = (argc > 1) ? strtoul(argv[1], NULL, 10) : DEFAULT_TOTAL_OUTPUTS;
+    size_t iterations = (argc > 2) ? strtoul(argv[2], NULL, 10) : DEFAULT_ITERATIONS;
+
+    if (totalOutputs < OUTPUTS_PER_BIRD || iterations == 0) {
+        fprintf(stderr, "Usage: ConfigurationBenchmark [outputs] [iterations]\n");
+        return EXIT_FAILURE;
+    }
+
+    LogEnableConsoleOutput(true);
+    LogEnableSystemOutput(false);
+    LogSetUp(LogLevelWarning);
+
+    char *yaml = GenerateConfiguration(totalOutputs);
+    char *templatedYAML = GenerateTemplatedConfiguration(totalOutputs);
+
+    size_t totalAllocations = 0;
+    double parseTime = 0.0;
+    double destroyTime = 0.0;
+
+    size_t templatedAllocations = 0;
+    double templatedParseTime = 0.0;
+    double templatedDestroyTime = 0.0;
+
+    bool success = MeasureParse(yaml, iterations, &totalAllocations, &parseTime, &destroyTime)
+        && MeasureParse(templatedYAML, iterations, &templatedAllocations, &templatedParseTime, &templatedDestroyTime);
+
+    if (success) {
+        printf("Outputs:       %zu\n", totalOutputs);
+        printf("Birds:         %zu\n", totalOutputs / OUTPUTS_PER_BIRD);
+        printf("Iterations:    %zu\n", iterations);
+        printf("\n");
+        printf("Expanded YAML: %zu bytes\n", strlen(yaml));
+        printf("Allocations:   %zu per configuration\n", totalAllocations);
+        printf("Parse:         %.3f ms\n", parseTime * 1000.0);
+        printf("Destroy:       %.3f ms\n", destroyTime * 1000.0);
+        printf("\n");
+        printf("Template YAML: %zu bytes\n", strlen(templatedYAML));
+        printf("Allocations:   %zu per configuration\n", templatedAllocations);
+        printf("Parse:         %.3f ms\n", templatedParseTime * 1000.0);
+        printf("Destroy:       %.3f ms\n", templatedDestroyTime * 1000.0);
+    }
+
+    free(yaml);
+    free(templatedYAML);
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+// MARK: - Utilities
+
+static char * GenerateConfiguration(size_t totalOutputs) {
+    size_t totalBirds = totalOutputs / OUTPUTS_PER_BIRD;
+
+    char *buffer = NULL;
+    size_t bufferSize = 0;
+    FILE *stream = open_memstream(&buffer, &bufferSize);
+
+    fprintf(stream, "%%YAML 1.1\n---\n\nOutputs:\n");
+
+    for (size_t idx = 0; idx < totalOutputs; idx++) {
+        fprintf(stream, "  - Output %zu:\n    Type: File\n    Path: /sys/class/gpio/gpio%zu/value\n", idx, idx);
+    }
+
+    fprintf(stream, "\nBirds:\n");
+
+    for (size_t idx = 0; idx < totalBirds; idx++) {
+        size_t first = idx * OUTPUTS_PER_BIRD;
+
+        fprintf(stream, "  - Bird %zu:\n", idx);
+        fprintf(stream, "    Static:\n      - Output %zu\n      - Output %zu\n", first, first + 1);
+        fprintf(stream, "    Back:\n      - Output %zu\n", first + 2);
+        fprintf(stream, "    Forward:\n      - Output %zu\n", first + 3);
+    }
+
+    fprintf(stream, "\nShows:\n  - Default:\n    Birds:\n");
+
+    for (size_t idx = 0; idx < totalBirds; idx++) {
+        fprintf(stream, "      - Bird %zu\n", idx);
+    }
+
+    fclose(stream);
+
+    return buffer;
+}
+
+static char * GenerateTemplatedConfiguration(size_t totalOutputs) {
+    size_t totalBirds = totalOutputs / OUTPUTS_PER_BIRD;
+
+    char *buffer = NULL;
+    size_t bufferSize = 0;
+    FILE *stream = open_memstream(&buffer, &bufferSize);
+
+    // The same outputs, birds and show as the expanded configuration, as one template each
+    fprintf(stream, "%%YAML 1.1\n---\n\nOutputs:\n");
+
+    for (size_t offset = 0; offset < OUTPUTS_PER_BIRD; offset++) {
+        fprintf(stream, "  - Output $ %zu:\n    Type: File\n    Range: 0..%zu\n    Path: /sys/class/gpio/gpio$-%zu/value\n", offset, totalBirds - 1, offset);
+    }
+
+    fprintf(stream, "\nBirds:\n");
+    fprintf(stream, "  - Bird $:\n    Range: 0..%zu\n", totalBirds - 1);
+    fprintf(stream, "    Static:\n      - Output $ 0\n      - Output $ 1\n");
+    fprintf(stream, "    Back:\n      - Output $ 2\n");
+    fprintf(stream, "    Forward:\n      - Output $ 3\n");
+
+    fprintf(stream, "\nShows:\n  - Default:\n    Range: 0..%zu\n    Birds:\n      - Bird $\n", totalBirds - 1);
+
+    fclose(stream);
+
+    return buffer;
+}
+
+static bool MeasureParse(const char *yaml, size_t iterations, size_t *totalAllocations, double *parseTime, double *destroyTime) {
+    double totalParseTime = 0.0;
+    double totalDestroyTime = 0.0;
+
+    for (size_t idx = 0; idx < iterations; idx++) {
+        double start = Now();
+        ConfigurationRef configuration = ConfigurationCreateFromString(yaml);
+        double parsed = Now();
+
+        if (configuration == NULL) {
+            fprintf(stderr, "Failed to parse the generated configuration\n");
+            return false;
+        }
+
+        *totalAllocations = ConfigurationGetTotalAllocations(configuration);
+
+        ConfigurationDestroy(configuration);
+        double destroyed = Now();
+
+        totalParseTime += parsed - start;
+        totalDestroyTime += destroyed - parsed;
+    }
+
+    *parseTime = totalParseTime / (double)iterations;
+    *destroyTime = totalDestroyTime / (double)iterations;
+
+    return true;
+}
+
+static double Now() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec + ((double)now.tv_nsec / 1000000000.0);
+}
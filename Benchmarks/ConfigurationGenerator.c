@@ -0,0 +1,58 @@
+//
+//  ConfigurationGenerator.c
+//  Woodpeckers Benchmarks
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include "ConfigurationGenerator.h"
+
+
+// MARK: - Generating
+
+bool ConfigurationGeneratorWrite(FILE *stream, size_t totalOutputs, size_t totalBirds, size_t outputsPerBird) {
+    // A bird can not list the same output twice
+    if (totalOutputs == 0 || outputsPerBird == 0 || outputsPerBird > totalOutputs) {
+        return false;
+    }
+
+    fprintf(stream, "%%YAML 1.1\n---\n\nOutputs:\n");
+
+    for (size_t idx = 0; idx < totalOutputs; idx++) {
+        fprintf(stream, "  - Output %zu:\n    Type: Memory\n", idx);
+    }
+
+    if (totalBirds == 0) {
+        return ferror(stream) == 0;
+    }
+
+    fprintf(stream, "\nBirds:\n");
+
+    for (size_t birdIdx = 0; birdIdx < totalBirds; birdIdx++) {
+        size_t first = birdIdx * outputsPerBird;
+
+        fprintf(stream, "  - Bird %zu:\n", birdIdx);
+        fprintf(stream, "    Back:\n      - Output %zu\n", first % totalOutputs);
+
+        if (outputsPerBird > 1) {
+            fprintf(stream, "    Forward:\n      - Output %zu\n", (first + 1) % totalOutputs);
+        }
+
+        if (outputsPerBird > 2) {
+            fprintf(stream, "    Static:\n");
+
+            for (size_t idx = 2; idx < outputsPerBird; idx++) {
+                fprintf(stream, "      - Output %zu\n", (first + idx) % totalOutputs);
+            }
+        }
+    }
+
+    fprintf(stream, "\nShows:\n  - Default:\n    Birds:\n");
+
+    for (size_t birdIdx = 0; birdIdx < totalBirds; birdIdx++) {
+        fprintf(stream, "      - Bird %zu\n", birdIdx);
+    }
+
+    return ferror(stream) == 0;
+}
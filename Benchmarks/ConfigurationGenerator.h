@@ -0,0 +1,37 @@
+//
+//  ConfigurationGenerator.h
+//  Woodpeckers Benchmarks
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#ifndef CONFIGURATION_GENERATOR_H
+#define CONFIGURATION_GENERATOR_H
+
+#include "Macros.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+BEGIN_DECLS
+
+
+// MARK: - Generating
+
+/**
+ * Write a synthetic configuration of memory outputs, birds and a single show listing every bird.
+ * \param stream The stream to write the YAML to.
+ * \param totalOutputs The number of outputs to generate.
+ * \param totalBirds The number of birds to generate.
+ * \param outputsPerBird The number of outputs each bird drives. The first is its back output, the second its forward output and the rest are static.
+ * \return `true` if the configuration was written, `false` if the arguments can not describe a valid configuration.
+ * \note Birds take outputs in turn, wrapping around when there are more bird outputs than outputs.
+ */
+bool ConfigurationGeneratorWrite(FILE * NONNULL stream, size_t totalOutputs, size_t totalBirds, size_t outputsPerBird);
+
+END_DECLS
+
+#endif /* CONFIGURATION_GENERATOR_H */
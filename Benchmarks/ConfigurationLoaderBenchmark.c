@@ -0,0 +1,185 @@
+//
+//  ConfigurationLoaderBenchmark.c
+//  Woodpeckers Benchmarks
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ConfigurationLoader.h"
+#include "Log.h"
+
+
+// MARK: - Constants & Globals
+
+#define DEFAULT_TOTAL_FILES 16
+#define DEFAULT_OUTPUTS_PER_FILE 4000
+#define DEFAULT_ITERATIONS 10
+#define MAX_THREADS 8
+
+
+// MARK: - Prototypes
+
+static bool GenerateFiles(const char * NONNULL directory, size_t totalFiles, size_t outputsPerFile);
+static void RemoveFiles(const char * NONNULL directory, size_t totalFiles);
+static bool MeasureLoad(const char * NONNULL path, size_t totalThreads, size_t iterations, double * NONNULL loadTime);
+static double Now(void);
+
+
+// MARK: - Main
+
+int main(int argc, char **argv) {
+    size_t totalFiles = (argc > 1) ? strtoul(argv[1], NULL, 10) : DEFAULT_TOTAL_FILES;
+    size_t outputsPerFile = (argc > 2) ? strtoul(argv[2], NULL, 10) : DEFAULT_OUTPUTS_PER_FILE;
+    size_t iterations = (argc > 3) ? strtoul(argv[3], NULL, 10) : DEFAULT_ITERATIONS;
+
+    if (totalFiles == 0 || outputsPerFile == 0 || iterations == 0) {
+        fprintf(stderr, "Usage: ConfigurationLoaderBenchmark [files] [outputs per file] [iterations]\n");
+        return EXIT_FAILURE;
+    }
+
+    // The loader logs every load, which would drown out the results
+    LogEnableConsoleOutput(false);
+    LogEnableSystemOutput(false);
+
+    char directory[] = "/tmp/ConfigurationLoaderBenchmark.XXXXXX";
+
+    if (mkdtemp(directory) == NULL) {
+        perror("Failed to create a temporary directory");
+        return EXIT_FAILURE;
+    }
+
+    char rootPath[PATH_MAX];
+    snprintf(rootPath, sizeof(rootPath), "%s/root.yml", directory);
+
+    bool success = GenerateFiles(directory, totalFiles, outputsPerFile);
+
+    long totalProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+
+    printf("Files:       %zu\n", totalFiles);
+    printf("Outputs:     %zu per file\n", outputsPerFile);
+    printf("Iterations:  %zu\n", iterations);
+    printf("Processors:  %li\n", totalProcessors);
+    printf("\n");
+
+    double serialTime = 0.0;
+
+    // Each iteration uses a new loader, so every file is read and parsed cold
+    for (size_t totalThreads = 1; totalThreads <= MAX_THREADS && success; totalThreads *= 2) {
+        double loadTime = 0.0;
+        success = MeasureLoad(rootPath, totalThreads, iterations, &loadTime);
+
+        if (!success) {
+            break;
+        }
+
+        if (totalThreads == 1) {
+            serialTime = loadTime;
+        }
+
+        printf("%zu thread(s): %.3f ms (%.2fx)\n", totalThreads, loadTime * 1000.0, serialTime / loadTime);
+    }
+
+    RemoveFiles(directory, totalFiles);
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+// MARK: - Utilities
+
+static bool GenerateFiles(const char *directory, size_t totalFiles, size_t outputsPerFile) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/root.yml", directory);
+
+    FILE *root = fopen(path, "w");
+
+    if (root == NULL) {
+        perror("Failed to write the root file");
+        return false;
+    }
+
+    fprintf(root, "%%YAML 1.1\n---\n\nInclude:\n");
+
+    for (size_t fileIdx = 0; fileIdx < totalFiles; fileIdx++) {
+        fprintf(root, "  - outputs-%zu.yml\n", fileIdx);
+
+        snprintf(path, sizeof(path), "%s/outputs-%zu.yml", directory, fileIdx);
+        FILE *stream = fopen(path, "w");
+
+        if (stream == NULL) {
+            perror("Failed to write an included file");
+            fclose(root);
+            return false;
+        }
+
+        fprintf(stream, "%%YAML 1.1\n---\n\nOutputs:\n");
+
+        for (size_t idx = 0; idx < outputsPerFile; idx++) {
+            fprintf(stream, "  - Output %zu-%zu:\n    Type: File\n    Path: /sys/class/gpio/gpio%zu/value\n", fileIdx, idx, idx);
+        }
+
+        fclose(stream);
+    }
+
+    fclose(root);
+
+    return true;
+}
+
+static void RemoveFiles(const char *directory, size_t totalFiles) {
+    char path[PATH_MAX];
+
+    for (size_t fileIdx = 0; fileIdx < totalFiles; fileIdx++) {
+        snprintf(path, sizeof(path), "%s/outputs-%zu.yml", directory, fileIdx);
+        unlink(path);
+    }
+
+    snprintf(path, sizeof(path), "%s/root.yml", directory);
+    unlink(path);
+
+    rmdir(directory);
+}
+
+static bool MeasureLoad(const char *path, size_t totalThreads, size_t iterations, double *loadTime) {
+    double totalTime = 0.0;
+
+    for (size_t idx = 0; idx < iterations; idx++) {
+        ConfigurationLoaderRef loader = ConfigurationLoaderCreate(path);
+        ConfigurationLoaderSetTotalThreads(loader, totalThreads);
+
+        double start = Now();
+        ConfigurationRef configuration = ConfigurationLoaderLoad(loader);
+        double loaded = Now();
+
+        ConfigurationLoaderDestroy(loader);
+
+        if (configuration == NULL) {
+            fprintf(stderr, "Failed to load the generated configuration\n");
+            return false;
+        }
+
+        ConfigurationDestroy(configuration);
+
+        totalTime += loaded - start;
+    }
+
+    *loadTime = totalTime / (double)iterations;
+
+    return true;
+}
+
+static double Now() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec + ((double)now.tv_nsec / 1000000000.0);
+}
@@ -0,0 +1,56 @@
+//
+//  GenerateConfiguration.c
+//  Woodpeckers Benchmarks
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ConfigurationGenerator.h"
+
+
+// MARK: - Constants & Globals
+
+#define DEFAULT_OUTPUTS_PER_BIRD 4
+
+
+// MARK: - Main
+
+int main(int argc, char **argv) {
+    if (argc < 3 || argc > 5) {
+        fprintf(stderr, "Usage: GenerateConfiguration outputs birds [outputs per bird] [path]\n");
+        return EXIT_FAILURE;
+    }
+
+    size_t totalOutputs = strtoul(argv[1], NULL, 10);
+    size_t totalBirds = strtoul(argv[2], NULL, 10);
+    size_t outputsPerBird = (argc > 3) ? strtoul(argv[3], NULL, 10) : DEFAULT_OUTPUTS_PER_BIRD;
+
+    FILE *stream = stdout;
+
+    if (argc > 4) {
+        stream = fopen(argv[4], "w");
+
+        if (stream == NULL) {
+            perror("Failed to open the output file");
+            return EXIT_FAILURE;
+        }
+    }
+
+    bool success = ConfigurationGeneratorWrite(stream, totalOutputs, totalBirds, outputsPerBird);
+
+    if (!success) {
+        fprintf(stderr, "Failed to generate %zu birds of %zu outputs from %zu outputs\n", totalBirds, outputsPerBird, totalOutputs);
+    }
+
+    if (stream != stdout && fclose(stream) != 0) {
+        perror("Failed to close the output file");
+        success = false;
+    }
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,174 @@
+//
+//  LogBenchmark.c
+//  Woodpeckers Benchmarks
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Log.h"
+
+
+// MARK: - Constants & Globals
+
+#define DEFAULT_TOTAL_THREADS 4
+#define DEFAULT_ITERATIONS 100000
+
+#define TAG "Benchmark"
+
+typedef struct _LogRun {
+    size_t iterations;
+    double elapsed;
+} LogRun;
+
+
+// MARK: - Prototypes
+
+static double MeasureLog(size_t totalThreads, size_t iterations, double * NONNULL flushTime);
+static void * LogThreadMain(void * NONNULL context);
+static double Now(void);
+
+
+// MARK: - Main
+
+int main(int argc, char **argv) {
+    size_t totalThreads = (argc > 1) ? strtoul(argv[1], NULL, 10) : DEFAULT_TOTAL_THREADS;
+    size_t iterations = (argc > 2) ? strtoul(argv[2], NULL, 10) : DEFAULT_ITERATIONS;
+
+    if (totalThreads == 0 || iterations == 0) {
+        fprintf(stderr, "Usage: LogBenchmark [threads] [iterations]\n");
+        return EXIT_FAILURE;
+    }
+
+    // Measure the logging, not the terminal
+    FILE *results = fdopen(dup(fileno(stdout)), "w");
+
+    if (results == NULL || freopen("/dev/null", "w", stdout) == NULL) {
+        fprintf(stderr, "Failed to redirect the log output\n");
+        return EXIT_FAILURE;
+    }
+
+    LogEnableConsoleOutput(true);
+    LogEnableSystemOutput(false);
+    LogSetUp(LogLevelInfo);
+
+    fprintf(results, "%zu threads, %zu messages each\n", totalThreads, iterations);
+
+    double flushTime = 0.0;
+    double syncTime = MeasureLog(totalThreads, iterations, &flushTime);
+
+    fprintf(results, "Synchronous:       %8.1f ns per message\n", syncTime * 1e9);
+
+    LogEnableCoarseClock(true);
+    double coarseTime = MeasureLog(totalThreads, iterations, &flushTime);
+    LogEnableCoarseClock(false);
+
+    fprintf(results, "Synchronous, coarse: %6.1f ns per message\n", coarseTime * 1e9);
+
+    LogEnableAsyncOutput(true, LogOverflowPolicyDrop);
+    double dropTime = MeasureLog(totalThreads, iterations, &flushTime);
+    LogEnableAsyncOutput(false, LogOverflowPolicyDrop);
+
+    LogStatistics dropStatistics;
+    LogGetStatistics(&dropStatistics);
+
+    fprintf(results, "Asynchronous, drop: %7.1f ns per message, %.3f s to flush\n", dropTime * 1e9, flushTime);
+    fprintf(results, "    %" PRIu64 " written, %" PRIu64 " dropped\n", dropStatistics.totalWritten, dropStatistics.totalDropped);
+
+    LogEnableAsyncOutput(true, LogOverflowPolicyWait);
+    double waitTime = MeasureLog(totalThreads, iterations, &flushTime);
+    LogEnableAsyncOutput(false, LogOverflowPolicyWait);
+
+    LogStatistics waitStatistics;
+    LogGetStatistics(&waitStatistics);
+
+    fprintf(results, "Asynchronous, wait: %7.1f ns per message, %.3f s to flush\n", waitTime * 1e9, flushTime);
+    fprintf(results, "    %" PRIu64 " written, %" PRIu64 " waits\n", waitStatistics.totalWritten - dropStatistics.totalWritten, waitStatistics.totalWaits);
+
+    // With only a binary log, nothing is formatted
+    LogEnableConsoleOutput(false);
+    LogEnableBinaryOutput("/dev/null");
+
+    LogEnableAsyncOutput(true, LogOverflowPolicyWait);
+    double binaryTime = MeasureLog(totalThreads, iterations, &flushTime);
+    LogEnableAsyncOutput(false, LogOverflowPolicyWait);
+
+    LogEnableBinaryOutput(NULL);
+
+    fprintf(results, "Asynchronous, binary: %5.1f ns per message, %.3f s to flush\n", binaryTime * 1e9, flushTime);
+
+    // Messages the outputs filter out are only copied in to the recorder
+    LogSetUp(LogLevelWarning);
+    LogEnableRecorder(true, LogLevelDebug);
+
+    double recorderTime = MeasureLog(totalThreads, iterations, &flushTime);
+
+    LogEnableRecorder(false, LogLevelDebug);
+    LogSetUp(LogLevelInfo);
+
+    fprintf(results, "Recorder only:       %6.1f ns per message\n", recorderTime * 1e9);
+
+    fclose(results);
+
+    return EXIT_SUCCESS;
+}
+
+
+// MARK: - Measuring
+
+static double MeasureLog(size_t totalThreads, size_t iterations, double *flushTime) {
+    pthread_t threads[totalThreads];
+    LogRun runs[totalThreads];
+
+    for (size_t idx = 0; idx < totalThreads; idx++) {
+        runs[idx].iterations = iterations;
+        runs[idx].elapsed = 0.0;
+
+        pthread_create(&threads[idx], NULL, LogThreadMain, &runs[idx]);
+    }
+
+    double elapsed = 0.0;
+
+    for (size_t idx = 0; idx < totalThreads; idx++) {
+        pthread_join(threads[idx], NULL);
+        elapsed += runs[idx].elapsed;
+    }
+
+    double start = Now();
+    LogFlush();
+    *flushTime = Now() - start;
+
+    return elapsed / (double)(totalThreads * iterations);
+}
+
+static void * LogThreadMain(void *context) {
+    LogRun *run = (LogRun *)context;
+
+    double start = Now();
+
+    for (size_t idx = 0; idx < run->iterations; idx++) {
+        LogI(TAG, "Bird %zu pecked %i times in %.1f ms", idx % 64, (int)(idx % 7), (double)idx / 10.0);
+    }
+
+    run->elapsed = Now() - start;
+
+    return NULL;
+}
+
+
+// MARK: - Utilities
+
+static double Now() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec + ((double)now.tv_nsec / 1000000000.0);
+}
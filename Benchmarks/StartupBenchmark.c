@@ -0,0 +1,288 @@
+//
+//  StartupBenchmark.c
+//  Woodpeckers Benchmarks
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Configuration.h"
+#include "ConfigurationGenerator.h"
+#include "Controller.h"
+#include "Log.h"
+#include "Stage.h"
+
+
+// MARK: - Constants & Globals
+
+#define DEFAULT_MAX_OUTPUTS 100000
+#define DEFAULT_OUTPUTS_PER_BIRD 4
+#define MIN_OUTPUTS 10
+#define SCALE_FACTOR 10
+
+typedef struct _Sample {
+    double time;
+    size_t totalAllocations;
+    long peakSize;
+} Sample;
+
+// NOTE: glibc lets a program replace malloc, so every allocation made while starting up can be counted
+#if defined(__GLIBC__)
+#define HAS_ALLOCATION_COUNT 1
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *pointer, size_t size);
+
+static atomic_size_t TotalAllocations = 0;
+
+void *malloc(size_t size) {
+    atomic_fetch_add_explicit(&TotalAllocations, 1, memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    atomic_fetch_add_explicit(&TotalAllocations, 1, memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, size_t size) {
+    atomic_fetch_add_explicit(&TotalAllocations, 1, memory_order_relaxed);
+    return __libc_realloc(pointer, size);
+}
+#else
+#define HAS_ALLOCATION_COUNT 0
+#endif
+
+
+// MARK: - Prototypes
+
+static bool BuildStage(StageRef NONNULL stage, ConfigurationRef NONNULL configuration);
+static size_t GetTotalAllocations(void);
+static long GetPeakSize(void);
+static int MeasureStartup(const char * NONNULL path, size_t totalOutputs, size_t totalBirds);
+static double Now(void);
+static void PrintSample(size_t totalOutputs, size_t totalBirds, const char * NONNULL name, const Sample * NONNULL sample);
+static void TakeSample(Sample * NONNULL sample, double start, size_t startAllocations);
+
+
+// MARK: - Main
+
+int main(int argc, char **argv) {
+    size_t maxOutputs = (argc > 1) ? strtoul(argv[1], NULL, 10) : DEFAULT_MAX_OUTPUTS;
+    size_t outputsPerBird = (argc > 2) ? strtoul(argv[2], NULL, 10) : DEFAULT_OUTPUTS_PER_BIRD;
+
+    if (maxOutputs < MIN_OUTPUTS || outputsPerBird == 0 || outputsPerBird > MIN_OUTPUTS) {
+        fprintf(stderr, "Usage: StartupBenchmark [max outputs] [outputs per bird]\n");
+        return EXIT_FAILURE;
+    }
+
+    // Set up logs every output it touches, which would drown out the results
+    LogEnableConsoleOutput(false);
+    LogEnableSystemOutput(false);
+
+    printf("%-10s %-10s %-8s %12s %12s %16s\n", "Outputs", "Birds", "Stage", "Time (ms)", "Allocations", "Peak RSS (KiB)");
+
+    bool success = true;
+
+    for (size_t totalOutputs = MIN_OUTPUTS; totalOutputs <= maxOutputs && success; totalOutputs *= SCALE_FACTOR) {
+        size_t totalBirds = totalOutputs / outputsPerBird;
+
+        char path[] = "/tmp/StartupBenchmark.XXXXXX";
+        int fd = mkstemp(path);
+
+        if (fd == -1) {
+            perror("Failed to create a temporary file");
+            return EXIT_FAILURE;
+        }
+
+        FILE *stream = fdopen(fd, "w");
+        success = ConfigurationGeneratorWrite(stream, totalOutputs, totalBirds, outputsPerBird);
+        success = (fclose(stream) == 0) && success;
+
+        if (!success) {
+            fprintf(stderr, "Failed to generate a configuration with %zu outputs\n", totalOutputs);
+            unlink(path);
+            break;
+        }
+
+        fflush(stdout);
+
+        // Each scale point starts in a fresh process, so its peak RSS is its own
+        pid_t pid = fork();
+
+        if (pid == 0) {
+            _exit(MeasureStartup(path, totalOutputs, totalBirds));
+        }
+
+        int status = 0;
+        success = (pid != -1) && (waitpid(pid, &status, 0) == pid) && WIFEXITED(status) && (WEXITSTATUS(status) == EXIT_SUCCESS);
+
+        unlink(path);
+    }
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+// MARK: - Measuring
+
+static int MeasureStartup(const char *path, size_t totalOutputs, size_t totalBirds) {
+    Sample parse;
+    Sample resolve;
+    Sample build;
+    Sample setUp;
+
+    double start = Now();
+    size_t startAllocations = GetTotalAllocations();
+
+    ConfigurationRef configuration = ConfigurationCreateFromFile(path);
+    TakeSample(&parse, start, startAllocations);
+
+    if (configuration == NULL) {
+        fprintf(stderr, "Failed to parse %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    start = Now();
+    startAllocations = GetTotalAllocations();
+
+    bool success = ConfigurationResolve(configuration);
+    TakeSample(&resolve, start, startAllocations);
+
+    if (!success) {
+        fprintf(stderr, "Failed to resolve %s\n", path);
+        ConfigurationDestroy(configuration);
+        return EXIT_FAILURE;
+    }
+
+    start = Now();
+    startAllocations = GetTotalAllocations();
+
+    StageRef stage = StageCreate();
+    success = BuildStage(stage, configuration);
+    TakeSample(&build, start, startAllocations);
+
+    ConfigurationDestroy(configuration);
+
+    if (!success) {
+        fprintf(stderr, "Failed to build the stage for %s\n", path);
+        StageDestroy(stage);
+        return EXIT_FAILURE;
+    }
+
+    start = Now();
+    startAllocations = GetTotalAllocations();
+
+    success = StageSetUp(stage);
+    TakeSample(&setUp, start, startAllocations);
+
+    if (!success) {
+        fprintf(stderr, "Failed to set up the stage for %s\n", path);
+        StageDestroy(stage);
+        return EXIT_FAILURE;
+    }
+
+    PrintSample(totalOutputs, totalBirds, "Parse", &parse);
+    PrintSample(totalOutputs, totalBirds, "Resolve", &resolve);
+    PrintSample(totalOutputs, totalBirds, "Build", &build);
+    PrintSample(totalOutputs, totalBirds, "Set Up", &setUp);
+    fflush(stdout);
+
+    StageTearDown(stage);
+    StageDestroy(stage);
+
+    return EXIT_SUCCESS;
+}
+
+static bool BuildStage(StageRef stage, ConfigurationRef configuration) {
+    OutputTableRef outputTable = StageGetOutputTable(stage);
+    size_t totalOutputs = ConfigurationGetTotalOutputs(configuration);
+
+    // The generator only writes memory outputs, so nothing touches the hardware
+    for (size_t idx = 0; idx < totalOutputs; idx++) {
+        if (!OutputTableAddMemoryOutput(outputTable, ConfigurationGetOutputName(configuration, idx))) {
+            return false;
+        }
+    }
+
+    size_t totalShows = ConfigurationGetTotalShows(configuration);
+
+    for (size_t showIdx = 0; showIdx < totalShows; showIdx++) {
+        ControllerRef controller = StageAddShow(stage, ConfigurationGetShowName(configuration, showIdx));
+
+        if (controller == NULL) {
+            return false;
+        }
+
+        const uint32_t *birds = ConfigurationGetShowBirdIndices(configuration, showIdx);
+        size_t totalBirds = ConfigurationGetShowTotalBirds(configuration, showIdx);
+
+        for (size_t idx = 0; idx < totalBirds; idx++) {
+            uint32_t birdIdx = birds[idx];
+
+            bool success = ControllerAddBird(controller, ConfigurationGetBirdName(configuration, birdIdx),
+                ConfigurationGetBirdStaticIndices(configuration, birdIdx), ConfigurationGetBirdTotalStatics(configuration, birdIdx),
+                ConfigurationGetBirdBackIndices(configuration, birdIdx), ConfigurationGetBirdTotalBacks(configuration, birdIdx),
+                ConfigurationGetBirdForwardIndices(configuration, birdIdx), ConfigurationGetBirdTotalForwards(configuration, birdIdx));
+
+            if (!success) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+// MARK: - Utilities
+
+static size_t GetTotalAllocations() {
+#if HAS_ALLOCATION_COUNT
+    return atomic_load_explicit(&TotalAllocations, memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+static long GetPeakSize() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+static double Now() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec + ((double)now.tv_nsec / 1000000000.0);
+}
+
+static void PrintSample(size_t totalOutputs, size_t totalBirds, const char *name, const Sample *sample) {
+#if HAS_ALLOCATION_COUNT
+    printf("%-10zu %-10zu %-8s %12.3f %12zu %16li\n", totalOutputs, totalBirds, name, sample->time * 1000.0, sample->totalAllocations, sample->peakSize);
+#else
+    printf("%-10zu %-10zu %-8s %12.3f %12s %16li\n", totalOutputs, totalBirds, name, sample->time * 1000.0, "-", sample->peakSize);
+#endif
+}
+
+static void TakeSample(Sample *sample, double start, size_t startAllocations) {
+    sample->time = Now() - start;
+    sample->totalAllocations = GetTotalAllocations() - startAllocations;
+    sample->peakSize = GetPeakSize();
+}
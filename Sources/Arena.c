@@ -0,0 +1,259 @@
+//
+//  Arena.c
+//  Woodpeckers
+//
+//  Created by Stephen H. Gerstacker on 2020-12-15.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include "Arena.h"
+
+#include <string.h>
+
+
+// MARK: - Constants & Globals
+
+#define MINIMUM_BLOCK_SIZE 256
+#define MINIMUM_ARRAY_CAPACITY 8
+#define MINIMUM_STRINGS_CAPACITY 64
+
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+typedef struct _ArenaBlock {
+    struct _ArenaBlock *next;
+} ArenaBlock;
+
+typedef struct _Arena {
+    uint8_t *cursor;
+    uint8_t *end;
+
+    // NOTE: The first block follows the Arena in the same allocation. Later blocks are chained here.
+    ArenaBlock *blocks;
+    size_t blockSize;
+
+    size_t usedSize;
+    size_t totalAllocations;
+
+    // NOTE: Open addressed, kept at most half full
+    const char **strings;
+    size_t stringsCapacity;
+    size_t totalStrings;
+} Arena;
+
+
+// MARK: - Prototypes
+
+static void ArenaAddBlock(ArenaRef NONNULL self, size_t size);
+static uint8_t * NONNULL ArenaBump(ArenaRef NONNULL self, size_t size, bool isAligned);
+static void ArenaResizeStrings(ArenaRef NONNULL self);
+static size_t HashString(const char * NONNULL value, size_t length);
+
+
+// MARK: - Lifecycle Methods
+
+ArenaRef ArenaCreate(size_t capacity) {
+    size_t headerSize = ARENA_ALIGN(sizeof(Arena));
+    size_t blockSize = ARENA_ALIGN(capacity);
+
+    ArenaRef self = (ArenaRef)malloc(headerSize + blockSize);
+    memset(self, 0, sizeof(Arena));
+
+    self->cursor = (uint8_t *)self + headerSize;
+    self->end = self->cursor + blockSize;
+    self->blockSize = blockSize;
+    self->totalAllocations = 1;
+
+    return self;
+}
+
+void ArenaDestroy(ArenaRef self) {
+    ArenaBlock *block = self->blocks;
+
+    while (block != NULL) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+
+    SAFE_DESTROY(self->strings, free);
+
+    free(self);
+}
+
+
+// MARK: - Allocation
+
+void * ArenaAllocate(ArenaRef self, size_t size) {
+    uint8_t *memory = ArenaBump(self, size, true);
+    memset(memory, 0, size);
+
+    return memory;
+}
+
+void * ArenaAppend(ArenaRef self, void *items, size_t itemSize, size_t total, size_t *capacity) {
+    if (items != NULL && total < *capacity) {
+        return items;
+    }
+
+    size_t oldSize = ARENA_ALIGN(itemSize * (*capacity));
+    size_t newCapacity = (*capacity < MINIMUM_ARRAY_CAPACITY) ? MINIMUM_ARRAY_CAPACITY : *capacity * 2;
+    size_t newSize = ARENA_ALIGN(itemSize * newCapacity);
+
+    uint8_t *memory = (uint8_t *)items;
+
+    // Grow in place when the array is the last thing allocated and the block has room
+    if (memory != NULL && memory + oldSize == self->cursor && (size_t)(self->end - memory) >= newSize) {
+        memset(self->cursor, 0, newSize - oldSize);
+        self->cursor = memory + newSize;
+        self->usedSize += newSize - oldSize;
+    } else {
+        memory = (uint8_t *)ArenaAllocate(self, newSize);
+
+        if (items != NULL) {
+            memcpy(memory, items, itemSize * total);
+        }
+    }
+
+    *capacity = newCapacity;
+
+    return memory;
+}
+
+
+// MARK: - Strings
+
+const char * ArenaIntern(ArenaRef self, const char *value, size_t length) {
+    if ((self->totalStrings + 1) * 2 > self->stringsCapacity) {
+        ArenaResizeStrings(self);
+    }
+
+    size_t mask = self->stringsCapacity - 1;
+    size_t slot = HashString(value, length) & mask;
+
+    while (self->strings[slot] != NULL) {
+        const char *existing = self->strings[slot];
+
+        if (strncmp(existing, value, length) == 0 && existing[length] == '\0') {
+            return existing;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+
+    // Strings are packed without alignment
+    char *copy = (char *)ArenaBump(self, length + 1, false);
+    memcpy(copy, value, length);
+    copy[length] = '\0';
+
+    self->strings[slot] = copy;
+    self->totalStrings += 1;
+
+    return copy;
+}
+
+void ArenaReleaseInterning(ArenaRef self) {
+    SAFE_DESTROY(self->strings, free);
+
+    self->stringsCapacity = 0;
+    self->totalStrings = 0;
+}
+
+
+// MARK: - Properties
+
+size_t ArenaGetTotalAllocations(const ArenaRef self) {
+    return self->totalAllocations;
+}
+
+size_t ArenaGetUsedSize(const ArenaRef self) {
+    return self->usedSize;
+}
+
+
+// MARK: - Utilities
+
+static void ArenaAddBlock(ArenaRef self, size_t size) {
+    size_t blockSize = (self->blockSize < MINIMUM_BLOCK_SIZE) ? MINIMUM_BLOCK_SIZE : self->blockSize * 2;
+
+    while (blockSize < size) {
+        blockSize *= 2;
+    }
+
+    size_t headerSize = ARENA_ALIGN(sizeof(ArenaBlock));
+
+    ArenaBlock *block = (ArenaBlock *)malloc(headerSize + blockSize);
+    block->next = self->blocks;
+
+    self->blocks = block;
+    self->blockSize = blockSize;
+    self->cursor = (uint8_t *)block + headerSize;
+    self->end = self->cursor + blockSize;
+    self->totalAllocations += 1;
+}
+
+static uint8_t * ArenaBump(ArenaRef self, size_t size, bool isAligned) {
+    if (isAligned) {
+        size = ARENA_ALIGN(size);
+
+        uintptr_t cursor = (uintptr_t)self->cursor;
+        uintptr_t aligned = ARENA_ALIGN(cursor);
+
+        if (aligned <= (uintptr_t)self->end) {
+            self->usedSize += aligned - cursor;
+            self->cursor = (uint8_t *)aligned;
+        } else {
+            self->cursor = self->end;
+        }
+    }
+
+    if ((size_t)(self->end - self->cursor) < size) {
+        ArenaAddBlock(self, size);
+    }
+
+    uint8_t *memory = self->cursor;
+
+    self->cursor += size;
+    self->usedSize += size;
+
+    return memory;
+}
+
+static void ArenaResizeStrings(ArenaRef self) {
+    size_t capacity = (self->stringsCapacity == 0) ? MINIMUM_STRINGS_CAPACITY : self->stringsCapacity * 2;
+    const char **strings = (const char **)calloc(capacity, sizeof(const char *));
+    size_t mask = capacity - 1;
+
+    for (size_t idx = 0; idx < self->stringsCapacity; idx++) {
+        const char *value = self->strings[idx];
+
+        if (value == NULL) {
+            continue;
+        }
+
+        size_t slot = HashString(value, strlen(value)) & mask;
+
+        while (strings[slot] != NULL) {
+            slot = (slot + 1) & mask;
+        }
+
+        strings[slot] = value;
+    }
+
+    SAFE_DESTROY(self->strings, free);
+
+    self->strings = strings;
+    self->stringsCapacity = capacity;
+    self->totalAllocations += 1;
+}
+
+static size_t HashString(const char *value, size_t length) {
+    uint64_t hash = FNV_OFFSET_BASIS;
+
+    for (size_t idx = 0; idx < length; idx++) {
+        hash ^= (uint8_t)value[idx];
+        hash *= FNV_PRIME;
+    }
+
+    return (size_t)hash;
+}
@@ -0,0 +1,111 @@
+//
+//  Arena.h
+//  Woodpeckers
+//
+//  Created by Stephen H. Gerstacker on 2020-12-15.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "Macros.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+
+BEGIN_DECLS
+
+
+// MARK: - Constants & Globals
+
+/// The alignment of every allocation made from an Arena.
+#define ARENA_ALIGNMENT 8
+
+/// Round a size up to `ARENA_ALIGNMENT`, the space an allocation of that size takes.
+#define ARENA_ALIGN(S) (((S) + (ARENA_ALIGNMENT - 1)) & ~((size_t)ARENA_ALIGNMENT - 1))
+
+/// The Arena object, a bump allocator whose memory is all released at once.
+typedef struct _Arena * ArenaRef;
+
+
+// MARK: - Lifecycle Methods
+
+/**
+ * Create an Arena.
+ * \param capacity The number of bytes available before another block is needed. Each later block is twice the size of the one before it.
+ * \return A new Arena instance.
+ * \note The Arena and its first block are a single allocation, so an Arena that never grows is released with a single free.
+ */
+ArenaRef NONNULL ArenaCreate(size_t capacity);
+
+/**
+ * Destroy an Arena and everything allocated from it.
+ * \param arena The instance to destroy.
+ */
+void ArenaDestroy(ArenaRef NONNULL arena);
+
+
+// MARK: - Allocation
+
+/**
+ * Allocate zeroed memory from an Arena.
+ * \param arena The instance to allocate from.
+ * \param size The number of bytes to allocate.
+ * \return The memory, aligned to `ARENA_ALIGNMENT`.
+ */
+void * NONNULL ArenaAllocate(ArenaRef NONNULL arena, size_t size);
+
+/**
+ * Make room to append one more item to an array allocated from an Arena.
+ * \param arena The instance to allocate from.
+ * \param items The array, or `NULL` if it has not been allocated.
+ * \param itemSize The size of each item.
+ * \param total The number of items in the array.
+ * \param capacity The number of items the array has room for, updated when it grows.
+ * \return The array, which may have moved.
+ * \note The array doubles when it grows. The space it leaves behind is only reclaimed when the Arena is destroyed.
+ */
+void * NONNULL ArenaAppend(ArenaRef NONNULL arena, void * NULLABLE items, size_t itemSize, size_t total, size_t * NONNULL capacity);
+
+
+// MARK: - Strings
+
+/**
+ * Copy a string in to an Arena, returning the existing copy if it has already been interned.
+ * \param arena The instance to allocate from.
+ * \param value The string to intern, which does not need to be terminated.
+ * \param length The length of the string.
+ * \return The interned string, which is terminated.
+ */
+const char * NONNULL ArenaIntern(ArenaRef NONNULL arena, const char * NONNULL value, size_t length);
+
+/**
+ * Release the table used to find interned strings.
+ * \param arena The instance to modify.
+ * \note Interned strings stay valid. Interning again builds a new table, so strings interned before may be copied a second time.
+ */
+void ArenaReleaseInterning(ArenaRef NONNULL arena);
+
+
+// MARK: - Properties
+
+/**
+ * Get the number of heap allocations the Arena has made, including itself.
+ * \param arena The instance to inspect.
+ * \return The total number of allocations.
+ */
+size_t ArenaGetTotalAllocations(const ArenaRef NONNULL arena);
+
+/**
+ * Get the number of bytes allocated from the Arena.
+ * \param arena The instance to inspect.
+ * \return The total number of bytes handed out, including alignment.
+ */
+size_t ArenaGetUsedSize(const ArenaRef NONNULL arena);
+
+END_DECLS
+
+#endif /* ARENA_H */
@@ -8,11 +8,19 @@
 
 #include "Configuration.h"
 
+#include <ctype.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <yaml.h>
 
+#include "Arena.h"
 #include "Log.h"
 
 
@@ -20,28 +28,56 @@
 
 #define TAG "Configuration"
 
+#define STRINGIFY(V) STRINGIFY_TOKEN(V)
+#define STRINGIFY_TOKEN(V) #V
+
 static bool DumpParseEvents = false;
 
+#define SCRATCH_ARENA_SIZE 16384
+
+#define MAX_SPLIT_SECTIONS 64
+
+#define IMAGE_MAGIC 0x4B505057 // "WPPK"
+#define IMAGE_NONE UINT32_MAX
+#define IMAGE_ALIGNMENT 8
+
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+#define POINTER_HASH_MULTIPLIER 0x9E3779B97F4A7C15ULL
+
 typedef struct _ConfigurationBird {
-    char *name;
+    const char *name;
 
-    char **statics;
+    const char **statics;
     size_t totalStatics;
 
-    char **backs;
+    const char **backs;
     size_t totalBacks;
 
-    char **forwards;
+    const char **forwards;
     size_t totalForwards;
+
+    // NOTE: Output indices for each name above, set once resolved
+    const uint32_t *staticIndices;
+    const uint32_t *backIndices;
+    const uint32_t *forwardIndices;
+
+    // NOTE: Only the settings in `overrides` were set by the bird
+    ConfigurationTiming timing;
 } ConfigurationBird;
 
 typedef struct _ConfigurationOutput {
-    char *name;
+    const char *name;
     ConfigurationOutputType type;
+    ConfigurationSafeState safeState;
+
+    uint32_t minOn;
+    uint32_t minOff;
+    uint32_t minDwell;
 
     union {
         struct {
-            char *path;
+            const char *path;
         } file;
 
         struct {
@@ -50,6 +86,46 @@ typedef struct _ConfigurationOutput {
     };
 } ConfigurationOutput;
 
+typedef struct _ConfigurationShow {
+    const char *name;
+
+    const char **birds;
+    size_t totalBirds;
+
+    // NOTE: Bird indices for each name above, set once resolved
+    const uint32_t *birdIndices;
+} ConfigurationShow;
+
+typedef struct _ConfigurationGroup {
+    const char *name;
+
+    const char **birds;
+    size_t totalBirds;
+
+    // NOTE: Only the settings in `overrides` were set by the group
+    ConfigurationTiming timing;
+} ConfigurationGroup;
+
+typedef struct _ConfigurationTrigger {
+    const char *name;
+    ConfigurationTriggerType type;
+    uint32_t source;
+    bool hasSource;
+
+    const char *show;
+    ConfigurationTriggerAction action;
+    const char *bird;
+
+    // NOTE: Set once resolved, or `CONFIGURATION_INDEX_NONE` without a show or bird
+    uint32_t showIndex;
+    uint32_t birdIndex;
+} ConfigurationTrigger;
+
+typedef struct _ConfigurationSource {
+    const char *path;
+    uint64_t hash;
+} ConfigurationSource;
+
 typedef struct _Configuration {
     uint32_t minWait;
     uint32_t maxWait;
@@ -57,13 +133,149 @@ typedef struct _Configuration {
     uint32_t maxPecks;
     uint32_t peckWait;
 
+    const char *watchdogPath;
+    uint32_t watchdogInterval;
+
+    const char *logLevels;
+
+    // NOTE: A bit for each settings key that was parsed, `1 << ScalarKey`, so merging can catch a setting set twice
+    uint32_t parsedSettings;
+
     ConfigurationOutput *outputs;
     size_t totalOutputs;
 
     ConfigurationBird *birds;
     size_t totalBirds;
+
+    ConfigurationShow *shows;
+    size_t totalShows;
+
+    ConfigurationGroup *groups;
+    size_t totalGroups;
+
+    ConfigurationTrigger *triggers;
+    size_t totalTriggers;
+
+    const char **includes;
+    size_t totalIncludes;
+
+    ConfigurationSource *sources;
+    size_t totalSources;
+
+    bool isResolved;
+
+    // NOTE: The timing of each bird, packed in bird order, set once resolved
+    const ConfigurationTiming *timings;
+
+    // NOTE: The Configuration itself and every array and string it owns live in this arena
+    ArenaRef arena;
+    size_t totalAllocations;
+
+    // NOTE: Set when loaded from a compiled image. Strings point in to the mapping instead of the arena.
+    void *image;
+    size_t imageSize;
 } Configuration;
 
+typedef struct _ImageHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t totalSize;
+    uint64_t checksum;
+    uint64_t sourceHash;
+
+    uint32_t minWait;
+    uint32_t maxWait;
+    uint32_t minPecks;
+    uint32_t maxPecks;
+    uint32_t peckWait;
+    uint32_t watchdogInterval;
+    uint32_t watchdogPath;
+    uint32_t logLevels;
+
+    uint32_t stringsOffset;
+    uint32_t stringsSize;
+    uint32_t outputsOffset;
+    uint32_t totalOutputs;
+    uint32_t birdsOffset;
+    uint32_t totalBirds;
+    uint32_t showsOffset;
+    uint32_t totalShows;
+    uint32_t triggersOffset;
+    uint32_t totalTriggers;
+    uint32_t referencesOffset;
+    uint32_t totalReferences;
+    uint32_t sourcesOffset;
+    uint32_t totalSources;
+    uint32_t timingsOffset;
+} ImageHeader;
+
+// NOTE: Strings are offsets in to the string table. References are indices in to the image's arrays.
+typedef struct _ImageOutput {
+    uint32_t name;
+    uint32_t type;
+    uint32_t safeState;
+    uint32_t path;
+    int32_t pin;
+    uint32_t minOn;
+    uint32_t minOff;
+    uint32_t minDwell;
+} ImageOutput;
+
+typedef struct _ImageBird {
+    uint32_t name;
+    uint32_t firstStatic;
+    uint32_t totalStatics;
+    uint32_t firstBack;
+    uint32_t totalBacks;
+    uint32_t firstForward;
+    uint32_t totalForwards;
+} ImageBird;
+
+typedef struct _ImageShow {
+    uint32_t name;
+    uint32_t firstBird;
+    uint32_t totalBirds;
+} ImageShow;
+
+typedef struct _ImageTrigger {
+    uint32_t name;
+    uint32_t type;
+    uint32_t source;
+    uint32_t show;
+    uint32_t action;
+    uint32_t bird;
+    uint32_t showIndex;
+    uint32_t birdIndex;
+} ImageTrigger;
+
+typedef struct _ImageSource {
+    uint32_t path;
+    uint32_t reserved;
+    uint64_t hash;
+} ImageSource;
+
+typedef struct _NameIndex {
+    // NOTE: Open addressed on the name pointers, kept at most half full
+    const char **names;
+    uint32_t *indices;
+    size_t mask;
+} NameIndex;
+
+typedef struct _ImageWriter {
+    char *strings;
+    size_t stringsSize;
+    size_t stringsCapacity;
+
+    // NOTE: Interned strings are numbered in order. Slots hold the number plus one, or 0 when empty.
+    uint32_t *stringOffsets;
+    size_t totalStrings;
+    uint32_t *slots;
+    size_t slotsCapacity;
+
+    uint32_t *references;
+    size_t totalReferences;
+} ImageWriter;
+
 typedef enum _ScalarKey {
     ScalarKeyNone = 0,
     ScalarKeyMinWait,
@@ -71,45 +283,104 @@ typedef enum _ScalarKey {
     ScalarKeyMinPecks,
     ScalarKeyMaxPecks,
     ScalarKeyPeckWait,
+    ScalarKeyWatchdog,
+    ScalarKeyWatchdogInterval,
+    ScalarKeyLogLevels,
     ScalarKeyType,
     ScalarKeyPath,
     ScalarKeyPin,
+    ScalarKeySafeState,
+    ScalarKeyMinOn,
+    ScalarKeyMinOff,
+    ScalarKeyMinDwell,
     ScalarKeyStatic,
     ScalarKeyBack,
     ScalarKeyForward,
+    ScalarKeyBirds,
+    ScalarKeySource,
+    ScalarKeyShow,
+    ScalarKeyAction,
+    ScalarKeyBird,
+    ScalarKeyRange,
+    ScalarKeyPinStep,
 } ScalarKey;
 
 typedef enum _Section {
     SectionNone = 0,
     SectionSettings,
     SectionOutputs,
-    SectionBirds
+    SectionBirds,
+    SectionShows,
+    SectionGroups,
+    SectionTriggers,
+    SectionIncludes,
 } Section;
 
 typedef struct _ParsingContext {
     Section section;
     ScalarKey scalarKey;
 
+    // NOTE: Everything parsed is built here, then compacted in to the Configuration's own arena
+    ArenaRef scratch;
+
+    size_t outputsCapacity;
+    size_t birdsCapacity;
+    size_t showsCapacity;
+    size_t groupsCapacity;
+    size_t triggersCapacity;
+
+    size_t staticsCapacity;
+    size_t backsCapacity;
+    size_t forwardsCapacity;
+    size_t showBirdsCapacity;
+    size_t groupBirdsCapacity;
+    size_t includesCapacity;
+
+    // NOTE: Set by a `Range` key, which turns the current item in to a template
+    bool hasRange;
+    uint32_t rangeFirst;
+    uint32_t rangeLast;
+    int pinStep;
+
     ConfigurationOutput output;
     bool isInOutput;
 
     ConfigurationBird bird;
     bool isInBird;
+
+    ConfigurationShow show;
+    bool isInShow;
+
+    ConfigurationGroup group;
+    bool isInGroup;
+
+    ConfigurationTrigger trigger;
+    bool isInTrigger;
+
+    bool isInIncludes;
 } ParsingContext;
 
 
 // MARK: - Prototypes
 
-static NONNULL ConfigurationRef ConfigurationCreateDefaults(void);
-static bool ConfigurationParse(ConfigurationRef self, yaml_parser_t * NONNULL parser);
-static bool ConfigurationParseFromFile(ConfigurationRef self, const char * NONNULL path);
-static bool ConfigurationParseFromString(ConfigurationRef self, const char * NONNULL value);
+static ConfigurationRef NONNULL ConfigurationCompact(const Configuration * NONNULL source, size_t totalAllocations);
+static void ConfigurationSetDefaults(Configuration * NONNULL self);
+static bool ConfigurationParse(ConfigurationRef self, ArenaRef NONNULL scratch, yaml_parser_t * NONNULL parser);
+static bool ConfigurationParseFromFile(ConfigurationRef self, ArenaRef NONNULL scratch, const char * NONNULL path);
+static bool ConfigurationParseFromString(ConfigurationRef self, ArenaRef NONNULL scratch, const char * NONNULL value);
 
 static bool ConfigurationParseBirds(ConfigurationRef NONNULL self, const yaml_event_t * NONNULL event, ParsingContext * NONNULL context);
 static bool ConfigurationParseBirdsMappingEnd(ConfigurationRef NONNULL self, const yaml_event_t * NONNULL event, ParsingContext * NONNULL context);
 static bool ConfigurationParseBirdsScalar(ConfigurationRef NONNULL self, const yaml_event_t * NONNULL event, ParsingContext * NONNULL context);
 static bool ConfigurationParseBirdsSequenceEnd(ConfigurationRef NONNULL self, const yaml_event_t * NONNULL event, ParsingContext * NONNULL context);
 
+static bool ConfigurationParseGroups(ConfigurationRef NONNULL self, const yaml_event_t * NONNULL event, ParsingContext * NONNULL context);
+static bool ConfigurationParseGroupsMappingEnd(ConfigurationRef NONNULL self, const yaml_event_t * NONNULL event, ParsingContext * NONNULL context);
+static bool ConfigurationParseGroupsScalar(ConfigurationRef NONNULL self, const yaml_event_t * NONNULL event, ParsingContext * NONNULL context);
+static bool ConfigurationParseGroupsSequenceEnd(ConfigurationRef NONNULL self, const yaml_event_t * NONNULL event, ParsingContext * NONNULL context);
+
+static bool ConfigurationParseIncludes(ConfigurationRef NONNULL self, const yaml_event_t * NONNULL event, ParsingContext * NONNULL context);
+
 static bool ConfigurationParseNoSection(ConfigurationRef NONNULL self, const yaml_event_t * NONNULL event, ParsingContext * NONNULL context);
 static bool ConfigurationParseNoSectionScalar(ConfigurationRef NONNULL self, const yaml_event_t * NONNULL event, ParsingContext * NONNULL context);
 
@@ -119,92 +390,427 @@ static bool ConfigurationParseOutputMappingStart(ConfigurationRef NONNULL self,
 static bool ConfigurationParseOutputScalar(ConfigurationRef NONNULL self, const yaml_event_t * NONNULL event, ParsingContext * NONNULL context);
 static bool ConfigurationParseOutputSequenceEnd(ConfigurationRef NONNULL self, const yaml_event_t * NONNULL event, ParsingContext * NONNULL context);
 
+static bool ConfigurationParseShows(ConfigurationRef NONNULL self, const yaml_event_t * NONNULL event, ParsingContext * NONNULL context);
+static bool ConfigurationParseShowsMappingEnd(ConfigurationRef NONNULL self, const yaml_event_t * NONNULL event, ParsingContext * NONNULL context);
+static bool ConfigurationParseShowsScalar(ConfigurationRef NONNULL self, const yaml_event_t * NONNULL event, ParsingContext * NONNULL context);
+static bool ConfigurationParseShowsSequenceEnd(ConfigurationRef NONNULL self, const yaml_event_t * NONNULL event, ParsingContext * NONNULL context);
+
+static bool ConfigurationParseTriggers(ConfigurationRef NONNULL self, const yaml_event_t * NONNULL event, ParsingContext * NONNULL context);
+static bool ConfigurationParseTriggersMappingEnd(ConfigurationRef NONNULL self, const yaml_event_t * NONNULL event, ParsingContext * NONNULL context);
+static bool ConfigurationParseTriggersScalar(ConfigurationRef NONNULL self, const yaml_event_t * NONNULL event, ParsingContext * NONNULL context);
+static bool ConfigurationParseTriggersSequenceEnd(ConfigurationRef NONNULL self, const yaml_event_t * NONNULL event, ParsingContext * NONNULL context);
+
 static bool ConfigurationParseSettings(ConfigurationRef NONNULL self, const yaml_event_t * NONNULL event, ParsingContext * NONNULL context);
 static bool ConfigurationParseSettingsMappingEnd(ConfigurationRef NONNULL self, const yaml_event_t * NONNULL event, ParsingContext * NONNULL context);
 static bool ConfigurationParseSettingsScalar(ConfigurationRef NONNULL self, const yaml_event_t * NONNULL event, ParsingContext * NONNULL context);
 
-static void ConfigurationBirdDestroy(ConfigurationBird * NONNULL bird);
+static void ConfigurationAddBird(ConfigurationRef NONNULL self, ParsingContext * NONNULL context, const ConfigurationBird * NONNULL bird);
+static bool ConfigurationAddGroup(ConfigurationRef NONNULL self, ParsingContext * NONNULL context, const ConfigurationGroup * NONNULL group);
+static void ConfigurationAddOutput(ConfigurationRef NONNULL self, ParsingContext * NONNULL context, const ConfigurationOutput * NONNULL output);
+static bool ConfigurationAddShow(ConfigurationRef NONNULL self, ParsingContext * NONNULL context, const ConfigurationShow * NONNULL show);
+
+static const char * NULLABLE ConfigurationExpandName(ParsingContext * NONNULL context, const char * NULLABLE name, uint32_t index);
+static const char * NONNULL * NULLABLE ConfigurationExpandNames(ParsingContext * NONNULL context, const char * NONNULL * NULLABLE names, size_t * NONNULL total);
+static const char * NONNULL * NULLABLE ConfigurationInstantiateNames(ParsingContext * NONNULL context, const char * NONNULL * NULLABLE names, size_t total, uint32_t index);
+static bool ConfigurationParseTemplateRange(ParsingContext * NONNULL context, const char * NONNULL value);
+static bool ConfigurationParseRangeIndex(const char * NONNULL value, const char * NONNULL * NONNULL end, uint32_t * NONNULL index);
+static void ConfigurationResetTemplate(ParsingContext * NONNULL context);
+
+static bool ConfigurationResolveNames(ArenaRef NONNULL arena, const NameIndex * NONNULL index, const char * NONNULL owner, const char * NONNULL kind, const char * NONNULL * NULLABLE names, size_t total, const uint32_t * NULLABLE * NONNULL indices);
+static bool ConfigurationShowHasBird(const ConfigurationShow * NONNULL show, uint32_t birdIdx);
+static bool ConfigurationResolveTimings(ConfigurationRef NONNULL self, ArenaRef NONNULL scratch, const NameIndex * NONNULL birds);
+
+static void ConfigurationAppendChunk(char * NONNULL * NONNULL * NONNULL chunks, size_t * NONNULL totalChunks, const char * NULLABLE key, size_t keySize, const char * NONNULL body, size_t bodySize);
+static size_t LineIndent(const char * NONNULL line, const char * NONNULL end);
+static const char * NONNULL NextLine(const char * NONNULL line, const char * NONNULL end);
+static Section SectionForLine(const char * NONNULL line, const char * NONNULL end);
+
+static bool ConfigurationMergeSetting(Configuration * NONNULL self, const Configuration * NONNULL fragment, ScalarKey key);
+static const char * NONNULL ConfigurationSettingName(ScalarKey key);
+static void ConfigurationTimingApply(ConfigurationTiming * NONNULL timing, const ConfigurationTiming * NONNULL overrides);
+static ScalarKey ConfigurationTimingKey(const char * NONNULL value);
+static void ConfigurationTimingSet(ConfigurationTiming * NONNULL timing, ScalarKey key, const char * NONNULL value);
+
 static void ConfigurationBirdReset(ConfigurationBird * NONNULL bird);
-static void ConfigurationOutputDestroy(ConfigurationOutput * NONNULL output);
+static void ConfigurationGroupReset(ConfigurationGroup * NONNULL group);
 static void ConfigurationOutputReset(ConfigurationOutput * NONNULL output);
+static void ConfigurationShowReset(ConfigurationShow * NONNULL show);
+static void ConfigurationTriggerReset(ConfigurationTrigger * NONNULL trigger);
+
+static ConfigurationRef NONNULL ConfigurationLoadImage(void * NONNULL image, size_t imageSize);
+static bool ConfigurationValidateImage(const void * NONNULL image, size_t imageSize, uint64_t sourceHash);
+
+static void * NULLABLE CompactArray(ArenaRef NONNULL arena, const void * NULLABLE items, size_t itemSize, size_t total);
+static const char * NULLABLE CompactString(ArenaRef NONNULL arena, const char * NULLABLE value);
+static uint64_t HashBytes(uint64_t hash, const void * NONNULL bytes, size_t size);
+static size_t ImageAlign(size_t size);
+static bool ImageReferencesFit(const uint32_t * NONNULL references, uint32_t first, uint32_t total, uint32_t limit);
+static uint32_t ImageWriterAppendReferences(ImageWriter * NONNULL writer, const uint32_t * NULLABLE references, size_t total);
+static uint32_t ImageWriterFind(const ImageWriter * NONNULL writer, const char * NONNULL value);
+static uint32_t ImageWriterIntern(ImageWriter * NONNULL writer, const char * NULLABLE value);
+static void ImageWriterResize(ImageWriter * NONNULL writer);
+static bool NameIndexBuild(NameIndex * NONNULL index, ArenaRef NONNULL scratch, const char * NONNULL kind, const void * NULLABLE items, size_t itemSize, size_t nameOffset, size_t total);
+static uint32_t NameIndexFind(const NameIndex * NONNULL index, const char * NONNULL name);
 
 
 // MARK: - Lifecycle Methods
 
 ConfigurationRef NULLABLE ConfigurationCreate(void) {
-    ConfigurationRef self = ConfigurationCreateDefaults();
+    Configuration defaults;
+    ConfigurationSetDefaults(&defaults);
+
+    ConfigurationRef self = ConfigurationCompact(&defaults, 0);
 
     return self;
 }
 
-static ConfigurationRef ConfigurationCreateDefaults() {
-    ConfigurationRef self = (ConfigurationRef)calloc(1, sizeof(Configuration));
+static void ConfigurationSetDefaults(Configuration *self) {
+    memset(self, 0, sizeof(Configuration));
 
     self->minWait = 1000;
     self->maxWait = 4000;
     self->minPecks = 1;
     self->maxPecks = 3;
     self->peckWait = 500;
-
-    return self;
+    self->watchdogInterval = 1000;
 }
 
 ConfigurationRef ConfigurationCreateFromFile(const char *path) {
-    ConfigurationRef self = ConfigurationCreateDefaults();
+    ConfigurationRef self = NULL;
 
-    bool success = ConfigurationParseFromFile(self, path);
+    Configuration scratchConfiguration;
+    ConfigurationSetDefaults(&scratchConfiguration);
 
-    if (!success) {
-        SAFE_DESTROY(self, ConfigurationDestroy);
+    ArenaRef scratch = ArenaCreate(SCRATCH_ARENA_SIZE);
+
+    bool success = ConfigurationParseFromFile(&scratchConfiguration, scratch, path);
+
+    if (success) {
+        self = ConfigurationCompact(&scratchConfiguration, ArenaGetTotalAllocations(scratch));
     }
 
+    ArenaDestroy(scratch);
+
     return self;
 }
 
 ConfigurationRef ConfigurationCreateFromString(const char *value) {
-    ConfigurationRef self = ConfigurationCreateDefaults();
+    ConfigurationRef self = NULL;
 
-    bool success = ConfigurationParseFromString(self, value);
+    Configuration scratchConfiguration;
+    ConfigurationSetDefaults(&scratchConfiguration);
 
-    if (!success) {
+    ArenaRef scratch = ArenaCreate(SCRATCH_ARENA_SIZE);
+
+    bool success = ConfigurationParseFromString(&scratchConfiguration, scratch, value);
+
+    if (success) {
+        self = ConfigurationCompact(&scratchConfiguration, ArenaGetTotalAllocations(scratch));
+    }
+
+    ArenaDestroy(scratch);
+
+    return self;
+}
+
+ConfigurationRef ConfigurationCreateMerged(const ConfigurationRef *fragments, size_t totalFragments, const char **paths, const uint64_t *hashes, size_t totalSources) {
+    ConfigurationRef self = NULL;
+
+    Configuration merged;
+    ConfigurationSetDefaults(&merged);
+
+    // Size every array up front, so each is a single allocation
+    size_t totalOutputs = 0;
+    size_t totalBirds = 0;
+    size_t totalShows = 0;
+    size_t totalGroups = 0;
+    size_t totalTriggers = 0;
+
+    for (size_t idx = 0; idx < totalFragments; idx++) {
+        totalOutputs += fragments[idx]->totalOutputs;
+        totalBirds += fragments[idx]->totalBirds;
+        totalShows += fragments[idx]->totalShows;
+        totalGroups += fragments[idx]->totalGroups;
+        totalTriggers += fragments[idx]->totalTriggers;
+    }
+
+    ArenaRef scratch = ArenaCreate(SCRATCH_ARENA_SIZE);
+
+    merged.outputs = (ConfigurationOutput *)ArenaAllocate(scratch, sizeof(ConfigurationOutput) * totalOutputs);
+    merged.birds = (ConfigurationBird *)ArenaAllocate(scratch, sizeof(ConfigurationBird) * totalBirds);
+    merged.shows = (ConfigurationShow *)ArenaAllocate(scratch, sizeof(ConfigurationShow) * totalShows);
+    merged.groups = (ConfigurationGroup *)ArenaAllocate(scratch, sizeof(ConfigurationGroup) * totalGroups);
+    merged.triggers = (ConfigurationTrigger *)ArenaAllocate(scratch, sizeof(ConfigurationTrigger) * totalTriggers);
+    merged.sources = (ConfigurationSource *)ArenaAllocate(scratch, sizeof(ConfigurationSource) * totalSources);
+
+    // The merged arrays point at the fragments' strings, which compacting copies
+    for (size_t idx = 0; idx < totalFragments; idx++) {
+        const Configuration *fragment = fragments[idx];
+
+        for (ScalarKey key = ScalarKeyMinWait; key <= ScalarKeyLogLevels; key++) {
+            if ((fragment->parsedSettings & (1u << key)) != 0 && !ConfigurationMergeSetting(&merged, fragment, key)) {
+                goto create_merged_cleanup;
+            }
+        }
+
+        #define MERGE_ITEMS(ITEMS, TOTAL, TYPE) \
+            if (fragment->TOTAL > 0) { \
+                memcpy(merged.ITEMS + merged.TOTAL, fragment->ITEMS, sizeof(TYPE) * fragment->TOTAL); \
+                merged.TOTAL += fragment->TOTAL; \
+            }
+
+        MERGE_ITEMS(outputs, totalOutputs, ConfigurationOutput);
+        MERGE_ITEMS(birds, totalBirds, ConfigurationBird);
+        MERGE_ITEMS(shows, totalShows, ConfigurationShow);
+        MERGE_ITEMS(groups, totalGroups, ConfigurationGroup);
+        MERGE_ITEMS(triggers, totalTriggers, ConfigurationTrigger);
+
+        #undef MERGE_ITEMS
+    }
+
+    for (size_t idx = 0; idx < totalSources; idx++) {
+        merged.sources[idx].path = paths[idx];
+        merged.sources[idx].hash = hashes[idx];
+    }
+
+    merged.totalSources = totalSources;
+
+    self = ConfigurationCompact(&merged, ArenaGetTotalAllocations(scratch));
+
+    // Compacting interned every name in one arena, so equal names are now equal pointers
+    NameIndex names;
+
+    bool isUnique = NameIndexBuild(&names, scratch, "output", self->outputs, sizeof(ConfigurationOutput), offsetof(ConfigurationOutput, name), self->totalOutputs)
+        && NameIndexBuild(&names, scratch, "bird", self->birds, sizeof(ConfigurationBird), offsetof(ConfigurationBird, name), self->totalBirds)
+        && NameIndexBuild(&names, scratch, "show", self->shows, sizeof(ConfigurationShow), offsetof(ConfigurationShow, name), self->totalShows)
+        && NameIndexBuild(&names, scratch, "group", self->groups, sizeof(ConfigurationGroup), offsetof(ConfigurationGroup, name), self->totalGroups)
+        && NameIndexBuild(&names, scratch, "trigger", self->triggers, sizeof(ConfigurationTrigger), offsetof(ConfigurationTrigger, name), self->totalTriggers);
+
+    if (!isUnique) {
         SAFE_DESTROY(self, ConfigurationDestroy);
     }
 
+create_merged_cleanup:
+
+    ArenaDestroy(scratch);
+
     return self;
 }
 
 void ConfigurationDestroy(ConfigurationRef self) {
-    ConfigurationOutput *tempOutputs = self->outputs;
-    size_t tempTotalOutputs = self->totalOutputs;
+    if (self->image != NULL) {
+        munmap(self->image, self->imageSize);
+    }
+
+    // The Configuration lives in its own arena, so this releases everything
+    ArenaDestroy(self->arena);
+}
+
+static ConfigurationRef ConfigurationCompact(const Configuration *source, size_t totalAllocations) {
+    // Size everything up front so the arena needs a single block
+    size_t size = ARENA_ALIGN(sizeof(Configuration))
+        + ARENA_ALIGN(sizeof(ConfigurationOutput) * source->totalOutputs)
+        + ARENA_ALIGN(sizeof(ConfigurationBird) * source->totalBirds)
+        + ARENA_ALIGN(sizeof(ConfigurationShow) * source->totalShows)
+        + ARENA_ALIGN(sizeof(ConfigurationGroup) * source->totalGroups)
+        + ARENA_ALIGN(sizeof(ConfigurationTrigger) * source->totalTriggers)
+        + ARENA_ALIGN(sizeof(char *) * source->totalIncludes)
+        + ARENA_ALIGN(sizeof(ConfigurationSource) * source->totalSources);
+
+    #define STRING_SIZE(S) (((S) == NULL) ? 0 : strlen(S) + 1)
+
+    size += STRING_SIZE(source->watchdogPath);
+    size += STRING_SIZE(source->logLevels);
+
+    for (size_t idx = 0; idx < source->totalIncludes; idx++) {
+        size += STRING_SIZE(source->includes[idx]);
+    }
+
+    for (size_t idx = 0; idx < source->totalSources; idx++) {
+        size += STRING_SIZE(source->sources[idx].path);
+    }
+
+    for (size_t idx = 0; idx < source->totalOutputs; idx++) {
+        const ConfigurationOutput *output = source->outputs + idx;
+
+        size += STRING_SIZE(output->name);
+
+        if (output->type == ConfigurationOutputTypeFile) {
+            size += STRING_SIZE(output->file.path);
+        }
+    }
+
+    for (size_t idx = 0; idx < source->totalBirds; idx++) {
+        const ConfigurationBird *bird = source->birds + idx;
+
+        size += STRING_SIZE(bird->name);
+        size += ARENA_ALIGN(sizeof(char *) * bird->totalStatics) + ARENA_ALIGN(sizeof(char *) * bird->totalBacks) + ARENA_ALIGN(sizeof(char *) * bird->totalForwards);
+
+        for (size_t nameIdx = 0; nameIdx < bird->totalStatics; nameIdx++) {
+            size += STRING_SIZE(bird->statics[nameIdx]);
+        }
+
+        for (size_t nameIdx = 0; nameIdx < bird->totalBacks; nameIdx++) {
+            size += STRING_SIZE(bird->backs[nameIdx]);
+        }
+
+        for (size_t nameIdx = 0; nameIdx < bird->totalForwards; nameIdx++) {
+            size += STRING_SIZE(bird->forwards[nameIdx]);
+        }
+    }
+
+    for (size_t idx = 0; idx < source->totalShows; idx++) {
+        const ConfigurationShow *show = source->shows + idx;
+
+        size += STRING_SIZE(show->name);
+        size += ARENA_ALIGN(sizeof(char *) * show->totalBirds);
+
+        for (size_t nameIdx = 0; nameIdx < show->totalBirds; nameIdx++) {
+            size += STRING_SIZE(show->birds[nameIdx]);
+        }
+    }
+
+    for (size_t idx = 0; idx < source->totalGroups; idx++) {
+        const ConfigurationGroup *group = source->groups + idx;
+
+        size += STRING_SIZE(group->name);
+        size += ARENA_ALIGN(sizeof(char *) * group->totalBirds);
+
+        for (size_t nameIdx = 0; nameIdx < group->totalBirds; nameIdx++) {
+            size += STRING_SIZE(group->birds[nameIdx]);
+        }
+    }
+
+    for (size_t idx = 0; idx < source->totalTriggers; idx++) {
+        const ConfigurationTrigger *trigger = source->triggers + idx;
+
+        size += STRING_SIZE(trigger->name) + STRING_SIZE(trigger->show) + STRING_SIZE(trigger->bird);
+    }
+
+    #undef STRING_SIZE
+
+    ArenaRef arena = ArenaCreate(size);
+
+    ConfigurationRef self = (ConfigurationRef)ArenaAllocate(arena, sizeof(Configuration));
+    memcpy(self, source, sizeof(Configuration));
+
+    self->arena = arena;
+    self->isResolved = false;
+    self->timings = NULL;
+
+    // Arrays first, so the strings packed after them need no padding
+    self->outputs = (ConfigurationOutput *)CompactArray(arena, source->outputs, sizeof(ConfigurationOutput), source->totalOutputs);
+    self->birds = (ConfigurationBird *)CompactArray(arena, source->birds, sizeof(ConfigurationBird), source->totalBirds);
+    self->shows = (ConfigurationShow *)CompactArray(arena, source->shows, sizeof(ConfigurationShow), source->totalShows);
+    self->groups = (ConfigurationGroup *)CompactArray(arena, source->groups, sizeof(ConfigurationGroup), source->totalGroups);
+    self->triggers = (ConfigurationTrigger *)CompactArray(arena, source->triggers, sizeof(ConfigurationTrigger), source->totalTriggers);
+    self->includes = (const char **)CompactArray(arena, source->includes, sizeof(char *), source->totalIncludes);
+    self->sources = (ConfigurationSource *)CompactArray(arena, source->sources, sizeof(ConfigurationSource), source->totalSources);
+
+    for (size_t idx = 0; idx < self->totalBirds; idx++) {
+        ConfigurationBird *bird = self->birds + idx;
+
+        bird->statics = (const char **)CompactArray(arena, bird->statics, sizeof(char *), bird->totalStatics);
+        bird->backs = (const char **)CompactArray(arena, bird->backs, sizeof(char *), bird->totalBacks);
+        bird->forwards = (const char **)CompactArray(arena, bird->forwards, sizeof(char *), bird->totalForwards);
+
+        bird->staticIndices = NULL;
+        bird->backIndices = NULL;
+        bird->forwardIndices = NULL;
+    }
+
+    for (size_t idx = 0; idx < self->totalShows; idx++) {
+        ConfigurationShow *show = self->shows + idx;
+
+        show->birds = (const char **)CompactArray(arena, show->birds, sizeof(char *), show->totalBirds);
+        show->birdIndices = NULL;
+    }
+
+    for (size_t idx = 0; idx < self->totalGroups; idx++) {
+        ConfigurationGroup *group = self->groups + idx;
+
+        group->birds = (const char **)CompactArray(arena, group->birds, sizeof(char *), group->totalBirds);
+    }
+
+    self->watchdogPath = CompactString(arena, self->watchdogPath);
+    self->logLevels = CompactString(arena, self->logLevels);
+
+    for (size_t idx = 0; idx < self->totalIncludes; idx++) {
+        self->includes[idx] = CompactString(arena, self->includes[idx]);
+    }
+
+    for (size_t idx = 0; idx < self->totalSources; idx++) {
+        self->sources[idx].path = CompactString(arena, self->sources[idx].path);
+    }
+
+    for (size_t idx = 0; idx < self->totalOutputs; idx++) {
+        ConfigurationOutput *output = self->outputs + idx;
+
+        output->name = CompactString(arena, output->name);
+
+        if (output->type == ConfigurationOutputTypeFile) {
+            output->file.path = CompactString(arena, output->file.path);
+        }
+    }
+
+    for (size_t idx = 0; idx < self->totalBirds; idx++) {
+        ConfigurationBird *bird = self->birds + idx;
+
+        bird->name = CompactString(arena, bird->name);
+
+        for (size_t nameIdx = 0; nameIdx < bird->totalStatics; nameIdx++) {
+            bird->statics[nameIdx] = CompactString(arena, bird->statics[nameIdx]);
+        }
+
+        for (size_t nameIdx = 0; nameIdx < bird->totalBacks; nameIdx++) {
+            bird->backs[nameIdx] = CompactString(arena, bird->backs[nameIdx]);
+        }
 
-    self->outputs = NULL;
-    self->totalOutputs = 0;
+        for (size_t nameIdx = 0; nameIdx < bird->totalForwards; nameIdx++) {
+            bird->forwards[nameIdx] = CompactString(arena, bird->forwards[nameIdx]);
+        }
+    }
+
+    for (size_t idx = 0; idx < self->totalShows; idx++) {
+        ConfigurationShow *show = self->shows + idx;
+
+        show->name = CompactString(arena, show->name);
 
-    for (size_t idx = 0; idx < tempTotalOutputs; idx++) {
-        ConfigurationOutputDestroy(&tempOutputs[idx]);
+        for (size_t nameIdx = 0; nameIdx < show->totalBirds; nameIdx++) {
+            show->birds[nameIdx] = CompactString(arena, show->birds[nameIdx]);
+        }
     }
 
-    SAFE_DESTROY(tempOutputs, free);
+    for (size_t idx = 0; idx < self->totalGroups; idx++) {
+        ConfigurationGroup *group = self->groups + idx;
+
+        group->name = CompactString(arena, group->name);
 
-    ConfigurationBird *tempBirds = self->birds;
-    size_t tempTotalBirds = self->totalBirds;
+        for (size_t nameIdx = 0; nameIdx < group->totalBirds; nameIdx++) {
+            group->birds[nameIdx] = CompactString(arena, group->birds[nameIdx]);
+        }
+    }
 
-    self->birds = NULL;
-    self->totalBirds = 0;
+    for (size_t idx = 0; idx < self->totalTriggers; idx++) {
+        ConfigurationTrigger *trigger = self->triggers + idx;
 
-    for (size_t idx = 0; idx < tempTotalBirds; idx++) {
-        ConfigurationBirdDestroy(&tempBirds[idx]);
+        trigger->name = CompactString(arena, trigger->name);
+        trigger->show = CompactString(arena, trigger->show);
+        trigger->bird = CompactString(arena, trigger->bird);
     }
 
-    SAFE_DESTROY(tempBirds, free);
+    // Nothing is interned after compacting, so the lookup table can go
+    ArenaReleaseInterning(arena);
 
-    free(self);
+    self->totalAllocations = totalAllocations + ArenaGetTotalAllocations(arena);
+
+    return self;
 }
 
 
 // MARK: - Parsing
 
-static bool ConfigurationParse(ConfigurationRef self, yaml_parser_t *parser) {
+static bool ConfigurationParse(ConfigurationRef self, ArenaRef scratch, yaml_parser_t *parser) {
     bool isDone = false;
     bool success = false;
 
@@ -213,6 +819,8 @@ static bool ConfigurationParse(ConfigurationRef self, yaml_parser_t *parser) {
     ParsingContext context;
     memset(&context, 0, sizeof(ParsingContext));
 
+    context.scratch = scratch;
+
     while (!isDone) {
         int result = yaml_parser_parse(parser, &event);
 
@@ -272,6 +880,18 @@ static bool ConfigurationParse(ConfigurationRef self, yaml_parser_t *parser) {
             case SectionBirds:
                 isDone = !ConfigurationParseBirds(self, &event, &context);
                 break;
+            case SectionShows:
+                isDone = !ConfigurationParseShows(self, &event, &context);
+                break;
+            case SectionGroups:
+                isDone = !ConfigurationParseGroups(self, &event, &context);
+                break;
+            case SectionTriggers:
+                isDone = !ConfigurationParseTriggers(self, &event, &context);
+                break;
+            case SectionIncludes:
+                isDone = !ConfigurationParseIncludes(self, &event, &context);
+                break;
         }
 
         if (event.type == YAML_STREAM_END_EVENT) {
@@ -282,13 +902,10 @@ static bool ConfigurationParse(ConfigurationRef self, yaml_parser_t *parser) {
         yaml_event_delete(&event);
     }
 
-    ConfigurationOutputDestroy(&context.output);
-    ConfigurationBirdDestroy(&context.bird);
-
     return success;
 }
 
-static bool ConfigurationParseFromFile(ConfigurationRef self, const char *path) {
+static bool ConfigurationParseFromFile(ConfigurationRef self, ArenaRef scratch, const char *path) {
     bool success = false;
 
     FILE *file = fopen(path, "r");
@@ -303,7 +920,7 @@ static bool ConfigurationParseFromFile(ConfigurationRef self, const char *path)
 
     yaml_parser_set_input_file(&parser, file);
 
-    success = ConfigurationParse(self, &parser);
+    success = ConfigurationParse(self, scratch, &parser);
 
 parse_from_file_cleanup:
 
@@ -313,13 +930,13 @@ parse_from_file_cleanup:
     return success;
 }
 
-static bool ConfigurationParseFromString(ConfigurationRef self, const char *value) {
+static bool ConfigurationParseFromString(ConfigurationRef self, ArenaRef scratch, const char *value) {
     yaml_parser_t parser;
     yaml_parser_initialize(&parser);
 
     yaml_parser_set_input_string(&parser, (const unsigned char *)value, strlen(value));
 
-    bool success = ConfigurationParse(self, &parser);
+    bool success = ConfigurationParse(self, scratch, &parser);
 
     yaml_parser_delete(&parser);
 
@@ -357,18 +974,43 @@ static bool ConfigurationParseBirdsMappingEnd(ConfigurationRef self, const yaml_
     }
 
     // Validate the bird
-    if (context->bird.name == NULL) {
+    const ConfigurationBird *bird = &context->bird;
+
+    if (bird->name == NULL) {
         LogE(TAG, "Bird is missing a name");
         return false;
     }
 
-    // Copy the bird in to place
-    self->birds = (ConfigurationBird *)realloc(self->birds, sizeof(ConfigurationBird) * (self->totalBirds + 1));
-    memcpy(self->birds + self->totalBirds, &context->bird, sizeof(ConfigurationBird));
-    self->totalBirds += 1;
+    // Copy the bird, or every bird its template makes, in to place
+    if (!context->hasRange) {
+        ConfigurationAddBird(self, context, bird);
+    } else if (strchr(bird->name, CONFIGURATION_TEMPLATE_PLACEHOLDER) != NULL) {
+        for (uint64_t index = context->rangeFirst; index <= context->rangeLast; index++) {
+            ConfigurationBird instance = *bird;
+
+            instance.name = ConfigurationExpandName(context, bird->name, index);
+            instance.statics = ConfigurationInstantiateNames(context, bird->statics, bird->totalStatics, index);
+            instance.backs = ConfigurationInstantiateNames(context, bird->backs, bird->totalBacks, index);
+            instance.forwards = ConfigurationInstantiateNames(context, bird->forwards, bird->totalForwards, index);
+
+            ConfigurationAddBird(self, context, &instance);
+        }
+    } else {
+        ConfigurationBird expanded = *bird;
+
+        expanded.statics = ConfigurationExpandNames(context, bird->statics, &expanded.totalStatics);
+        expanded.backs = ConfigurationExpandNames(context, bird->backs, &expanded.totalBacks);
+        expanded.forwards = ConfigurationExpandNames(context, bird->forwards, &expanded.totalForwards);
+
+        ConfigurationAddBird(self, context, &expanded);
+    }
 
     // Clean up
     ConfigurationBirdReset(&context->bird);
+    ConfigurationResetTemplate(context);
+    context->staticsCapacity = 0;
+    context->backsCapacity = 0;
+    context->forwardsCapacity = 0;
     context->isInBird = false;
 
     return true;
@@ -381,7 +1023,7 @@ static bool ConfigurationParseBirdsScalar(ConfigurationRef self, const yaml_even
     size_t valueSize = event->data.scalar.length;
 
     if (context->bird.name == NULL) { // If we have no scalar key, we're in the name portion
-        context->bird.name = strndup(value, valueSize);
+        context->bird.name = ArenaIntern(context->scratch, value, valueSize);
         context->isInBird = true;
         success = true;
     } else if (valueSize == 0) { // Empty scalars come after the name
@@ -396,29 +1038,47 @@ static bool ConfigurationParseBirdsScalar(ConfigurationRef self, const yaml_even
         } else if (strcmp(value, "Forward") == 0) {
             context->scalarKey = ScalarKeyForward;
             success = true;
+        } else if (strcmp(value, "Range") == 0) {
+            context->scalarKey = ScalarKeyRange;
+            success = true;
+        } else if ((context->scalarKey = ConfigurationTimingKey(value)) != ScalarKeyNone) {
+            success = true;
         } else {
             LogE(TAG, "Invalid Bird section: %s", value);
         }
     } else {
         switch (context->scalarKey) {
             case ScalarKeyStatic:
-                context->bird.statics = (char **)realloc(context->bird.statics, sizeof(char *) * (context->bird.totalStatics + 1));
-                context->bird.statics[context->bird.totalStatics] = strndup(value, valueSize);
+                context->bird.statics = (const char **)ArenaAppend(context->scratch, context->bird.statics, sizeof(char *), context->bird.totalStatics, &context->staticsCapacity);
+                context->bird.statics[context->bird.totalStatics] = ArenaIntern(context->scratch, value, valueSize);
                 context->bird.totalStatics += 1;
                 success = true;
                 break;
             case ScalarKeyBack:
-                context->bird.backs = (char **)realloc(context->bird.backs, sizeof(char *) * (context->bird.totalBacks + 1));
-                context->bird.backs[context->bird.totalBacks] = strndup(value, valueSize);
+                context->bird.backs = (const char **)ArenaAppend(context->scratch, context->bird.backs, sizeof(char *), context->bird.totalBacks, &context->backsCapacity);
+                context->bird.backs[context->bird.totalBacks] = ArenaIntern(context->scratch, value, valueSize);
                 context->bird.totalBacks += 1;
                 success = true;
                 break;
             case ScalarKeyForward:
-                context->bird.forwards = (char **)realloc(context->bird.forwards, sizeof(char *) * (context->bird.totalForwards + 1));
-                context->bird.forwards[context->bird.totalForwards] = strndup(value, valueSize);
+                context->bird.forwards = (const char **)ArenaAppend(context->scratch, context->bird.forwards, sizeof(char *), context->bird.totalForwards, &context->forwardsCapacity);
+                context->bird.forwards[context->bird.totalForwards] = ArenaIntern(context->scratch, value, valueSize);
                 context->bird.totalForwards += 1;
                 success = true;
                 break;
+            case ScalarKeyRange:
+                success = ConfigurationParseTemplateRange(context, value);
+                context->scalarKey = ScalarKeyNone;
+                break;
+            case ScalarKeyMinWait:
+            case ScalarKeyMaxWait:
+            case ScalarKeyMinPecks:
+            case ScalarKeyMaxPecks:
+            case ScalarKeyPeckWait:
+                ConfigurationTimingSet(&context->bird.timing, context->scalarKey, value);
+                context->scalarKey = ScalarKeyNone;
+                success = true;
+                break;
             default:
                 LogE(TAG, "Invalid scalar key in Bird: %i", context->scalarKey);
                 break;
@@ -431,62 +1091,229 @@ static bool ConfigurationParseBirdsScalar(ConfigurationRef self, const yaml_even
 static bool ConfigurationParseBirdsSequenceEnd(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
     if (context->scalarKey != ScalarKeyNone) { // If we were in a scalar key, break out
         context->scalarKey = ScalarKeyNone;
+    } else if (!context->isInBird) { // Otherwise the list of birds has ended
+        context->section = SectionNone;
     }
 
     return true;
 }
 
-static bool ConfigurationParseNoSection(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
+static bool ConfigurationParseGroups(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
     switch (event->type) {
+        case YAML_MAPPING_END_EVENT:
+            return ConfigurationParseGroupsMappingEnd(self, event, context);
+            break;
         case YAML_SCALAR_EVENT:
-            return ConfigurationParseNoSectionScalar(self, event, context);
+            return ConfigurationParseGroupsScalar(self, event, context);
+            break;
+        case YAML_SEQUENCE_END_EVENT:
+            return ConfigurationParseGroupsSequenceEnd(self, event, context);
             break;
-        case YAML_MAPPING_END_EVENT:
         case YAML_MAPPING_START_EVENT:
-        case YAML_STREAM_END_EVENT:
-        case YAML_STREAM_START_EVENT:
-        case YAML_DOCUMENT_END_EVENT:
-        case YAML_DOCUMENT_START_EVENT:
+        case YAML_SEQUENCE_START_EVENT:
             // NOTE: Nothing to do with these events
             return true;
             break;
         default:
-            LogE(TAG, "Invalid event %i without a section", event->type);
+            LogE(TAG, "Invalid event %i in Group section", event->type);
             return false;
             break;
     }
 }
 
-static bool ConfigurationParseNoSectionScalar(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
-    bool success;
+static bool ConfigurationParseGroupsMappingEnd(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
+    // Ignore if we are not in a group, we're at the end of the section
+    if (!context->isInGroup) {
+        context->section = SectionNone;
+        return true;
+    }
+
+    // Validate the group
+    const ConfigurationGroup *group = &context->group;
+
+    if (group->name == NULL) {
+        LogE(TAG, "Group is missing a name");
+        return false;
+    }
+
+    // Copy the group, or every group its template makes, in to place
+    bool success = true;
+
+    if (!context->hasRange) {
+        success = ConfigurationAddGroup(self, context, group);
+    } else if (strchr(group->name, CONFIGURATION_TEMPLATE_PLACEHOLDER) != NULL) {
+        for (uint64_t index = context->rangeFirst; index <= context->rangeLast && success; index++) {
+            ConfigurationGroup instance = *group;
+
+            instance.name = ConfigurationExpandName(context, group->name, index);
+            instance.birds = ConfigurationInstantiateNames(context, group->birds, group->totalBirds, index);
+
+            success = ConfigurationAddGroup(self, context, &instance);
+        }
+    } else {
+        ConfigurationGroup expanded = *group;
+        expanded.birds = ConfigurationExpandNames(context, group->birds, &expanded.totalBirds);
+
+        success = ConfigurationAddGroup(self, context, &expanded);
+    }
+
+    // Clean up
+    ConfigurationGroupReset(&context->group);
+    ConfigurationResetTemplate(context);
+    context->groupBirdsCapacity = 0;
+    context->isInGroup = false;
+
+    return success;
+}
+
+static bool ConfigurationParseGroupsScalar(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
+    bool success = false;
 
     const char *value = (const char *)event->data.scalar.value;
     size_t valueSize = event->data.scalar.length;
 
-    if (valueSize == 0) {
-        // Empty scalars are possible. Do nothing.
+    if (context->group.name == NULL) { // The first scalar is the name
+        context->group.name = ArenaIntern(context->scratch, value, valueSize);
+        context->isInGroup = true;
         success = true;
-    } else  if (strcmp(value, "Settings") == 0) {
-        context->section = SectionSettings;
+    } else if (valueSize == 0) { // Empty scalars come after the name
         success = true;
-    } else if  (strcmp(value, "Outputs") == 0) {
-        context->section = SectionOutputs;
+    } else if (context->scalarKey == ScalarKeyNone) {
+        if (strcmp(value, "Birds") == 0) {
+            context->scalarKey = ScalarKeyBirds;
+            success = true;
+        } else if (strcmp(value, "Range") == 0) {
+            context->scalarKey = ScalarKeyRange;
+            success = true;
+        } else if ((context->scalarKey = ConfigurationTimingKey(value)) != ScalarKeyNone) {
+            success = true;
+        } else {
+            LogE(TAG, "Invalid Group section: %s", value);
+        }
+    } else if (context->scalarKey == ScalarKeyBirds) {
+        context->group.birds = (const char **)ArenaAppend(context->scratch, context->group.birds, sizeof(char *), context->group.totalBirds, &context->groupBirdsCapacity);
+        context->group.birds[context->group.totalBirds] = ArenaIntern(context->scratch, value, valueSize);
+        context->group.totalBirds += 1;
         success = true;
-    } else if (strcmp(value, "Birds") == 0) {
-        context->section = SectionBirds;
+    } else if (context->scalarKey == ScalarKeyRange) {
+        success = ConfigurationParseTemplateRange(context, value);
+        context->scalarKey = ScalarKeyNone;
+    } else if (context->scalarKey >= ScalarKeyMinWait && context->scalarKey <= ScalarKeyPeckWait) {
+        ConfigurationTimingSet(&context->group.timing, context->scalarKey, value);
+        context->scalarKey = ScalarKeyNone;
         success = true;
     } else {
-        LogE(TAG, "Invalid section name: %s", value);
-        success = false;
+        LogE(TAG, "Invalid scalar key in Group: %i", context->scalarKey);
     }
 
     return success;
 }
 
-static bool ConfigurationParseOutput(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
-    switch (event->type) {
-        case YAML_SCALAR_EVENT:
-            return ConfigurationParseOutputScalar(self, event, context);
+static bool ConfigurationParseGroupsSequenceEnd(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
+    if (context->scalarKey != ScalarKeyNone) { // If we were in a scalar key, break out
+        context->scalarKey = ScalarKeyNone;
+    } else { // Otherwise the list of groups has ended
+        context->section = SectionNone;
+    }
+
+    return true;
+}
+
+static bool ConfigurationParseIncludes(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
+    switch (event->type) {
+        case YAML_SCALAR_EVENT:
+            if (event->data.scalar.length > 0) {
+                self->includes = (const char **)ArenaAppend(context->scratch, self->includes, sizeof(char *), self->totalIncludes, &context->includesCapacity);
+                self->includes[self->totalIncludes] = ArenaIntern(context->scratch, (const char *)event->data.scalar.value, event->data.scalar.length);
+                self->totalIncludes += 1;
+            }
+
+            // A single include is a scalar instead of a list
+            if (!context->isInIncludes) {
+                context->section = SectionNone;
+            }
+
+            return true;
+            break;
+        case YAML_SEQUENCE_START_EVENT:
+            context->isInIncludes = true;
+            return true;
+            break;
+        case YAML_SEQUENCE_END_EVENT:
+            context->isInIncludes = false;
+            context->section = SectionNone;
+            return true;
+            break;
+        default:
+            LogE(TAG, "Invalid event %i in Include section", event->type);
+            return false;
+            break;
+    }
+}
+
+static bool ConfigurationParseNoSection(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
+    switch (event->type) {
+        case YAML_SCALAR_EVENT:
+            return ConfigurationParseNoSectionScalar(self, event, context);
+            break;
+        case YAML_MAPPING_END_EVENT:
+        case YAML_MAPPING_START_EVENT:
+        case YAML_STREAM_END_EVENT:
+        case YAML_STREAM_START_EVENT:
+        case YAML_DOCUMENT_END_EVENT:
+        case YAML_DOCUMENT_START_EVENT:
+            // NOTE: Nothing to do with these events
+            return true;
+            break;
+        default:
+            LogE(TAG, "Invalid event %i without a section", event->type);
+            return false;
+            break;
+    }
+}
+
+static bool ConfigurationParseNoSectionScalar(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
+    bool success;
+
+    const char *value = (const char *)event->data.scalar.value;
+    size_t valueSize = event->data.scalar.length;
+
+    if (valueSize == 0) {
+        // Empty scalars are possible. Do nothing.
+        success = true;
+    } else  if (strcmp(value, "Settings") == 0) {
+        context->section = SectionSettings;
+        success = true;
+    } else if  (strcmp(value, "Outputs") == 0) {
+        context->section = SectionOutputs;
+        success = true;
+    } else if (strcmp(value, "Birds") == 0) {
+        context->section = SectionBirds;
+        success = true;
+    } else if (strcmp(value, "Shows") == 0) {
+        context->section = SectionShows;
+        success = true;
+    } else if (strcmp(value, "Groups") == 0) {
+        context->section = SectionGroups;
+        success = true;
+    } else if (strcmp(value, "Triggers") == 0) {
+        context->section = SectionTriggers;
+        success = true;
+    } else if (strcmp(value, "Include") == 0) {
+        context->section = SectionIncludes;
+        success = true;
+    } else {
+        LogE(TAG, "Invalid section name: %s", value);
+        success = false;
+    }
+
+    return success;
+}
+
+static bool ConfigurationParseOutput(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
+    switch (event->type) {
+        case YAML_SCALAR_EVENT:
+            return ConfigurationParseOutputScalar(self, event, context);
             break;
         case YAML_MAPPING_END_EVENT:
             return ConfigurationParseOutputMappingEnd(self, event, context);
@@ -537,16 +1364,35 @@ static bool ConfigurationParseOutputMappingEnd(ConfigurationRef self, const yaml
         }
     }
 
-    // Add the output to the list
-    self->outputs = (ConfigurationOutput *)realloc(self->outputs, sizeof(ConfigurationOutput) * (self->totalOutputs + 1));
-    memcpy(self->outputs + self->totalOutputs, output, sizeof(ConfigurationOutput));
-    self->totalOutputs += 1;
+    // Add the output, or every output its template makes, to the list
+    bool success = true;
+
+    if (!context->hasRange) {
+        ConfigurationAddOutput(self, context, output);
+    } else if (strchr(output->name, CONFIGURATION_TEMPLATE_PLACEHOLDER) == NULL) {
+        LogE(TAG, "Output \"%s\" has a range, but its name has no %c", output->name, CONFIGURATION_TEMPLATE_PLACEHOLDER);
+        success = false;
+    } else {
+        for (uint64_t index = context->rangeFirst; index <= context->rangeLast; index++) {
+            ConfigurationOutput instance = *output;
+            instance.name = ConfigurationExpandName(context, output->name, index);
+
+            if (output->type == ConfigurationOutputTypeFile) {
+                instance.file.path = ConfigurationExpandName(context, output->file.path, index);
+            } else if (output->type == ConfigurationOutputTypeGPIO) {
+                instance.gpio.pin = output->gpio.pin + ((int)(index - context->rangeFirst) * context->pinStep);
+            }
+
+            ConfigurationAddOutput(self, context, &instance);
+        }
+    }
 
     // Clean up
     ConfigurationOutputReset(output);
+    ConfigurationResetTemplate(context);
     context->isInOutput = false;
 
-    return true;
+    return success;
 }
 
 static bool ConfigurationParseOutputMappingStart(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
@@ -555,6 +1401,7 @@ static bool ConfigurationParseOutputMappingStart(ConfigurationRef self, const ya
 
     // Reset the parsing state
     context->scalarKey = ScalarKeyNone;
+    ConfigurationResetTemplate(context);
 
     // Flag that we are in an output mapping
     context->isInOutput = true;
@@ -569,7 +1416,7 @@ static bool ConfigurationParseOutputScalar(ConfigurationRef self, const yaml_eve
     size_t valueSize = event->data.scalar.length;
 
     if (context->output.name == NULL) { // The first scalar should be the name
-        context->output.name = strndup(value, valueSize);
+        context->output.name = ArenaIntern(context->scratch, value, valueSize);
         success = true;
     } else if (context->scalarKey == ScalarKeyNone && valueSize == 0 ) { // A blank scalar comes after the name
         success = true;
@@ -583,6 +1430,24 @@ static bool ConfigurationParseOutputScalar(ConfigurationRef self, const yaml_eve
         } else if (strcmp(value, "Pin") == 0) {
             context->scalarKey = ScalarKeyPin;
             success = true;
+        } else if (strcmp(value, "SafeState") == 0) {
+            context->scalarKey = ScalarKeySafeState;
+            success = true;
+        } else if (strcmp(value, "MinOn") == 0) {
+            context->scalarKey = ScalarKeyMinOn;
+            success = true;
+        } else if (strcmp(value, "MinOff") == 0) {
+            context->scalarKey = ScalarKeyMinOff;
+            success = true;
+        } else if (strcmp(value, "MinDwell") == 0) {
+            context->scalarKey = ScalarKeyMinDwell;
+            success = true;
+        } else if (strcmp(value, "Range") == 0) {
+            context->scalarKey = ScalarKeyRange;
+            success = true;
+        } else if (strcmp(value, "PinStep") == 0) {
+            context->scalarKey = ScalarKeyPinStep;
+            success = true;
         } else {
             LogE(TAG, "Unhandled output scalar key: %s", value);
         }
@@ -608,13 +1473,47 @@ static bool ConfigurationParseOutputScalar(ConfigurationRef self, const yaml_eve
 
                 break;
             case ScalarKeyPath:
-                context->output.file.path = strndup(value, valueSize);
+                context->output.file.path = ArenaIntern(context->scratch, value, valueSize);
                 success = true;
                 break;
             case ScalarKeyPin:
                 context->output.gpio.pin = strtol(value, NULL, 10);
                 success = true;
                 break;
+            case ScalarKeySafeState:
+                if (strcmp(value, "Off") == 0) {
+                    context->output.safeState = ConfigurationSafeStateOff;
+                    success = true;
+                } else if (strcmp(value, "On") == 0) {
+                    context->output.safeState = ConfigurationSafeStateOn;
+                    success = true;
+                } else if (strcmp(value, "Hold") == 0) {
+                    context->output.safeState = ConfigurationSafeStateHold;
+                    success = true;
+                } else {
+                    LogE(TAG, "Unhandled output safe state: %s", value);
+                }
+
+                break;
+            case ScalarKeyMinOn:
+                context->output.minOn = (uint32_t)strtoul(value, NULL, 10);
+                success = true;
+                break;
+            case ScalarKeyMinOff:
+                context->output.minOff = (uint32_t)strtoul(value, NULL, 10);
+                success = true;
+                break;
+            case ScalarKeyMinDwell:
+                context->output.minDwell = (uint32_t)strtoul(value, NULL, 10);
+                success = true;
+                break;
+            case ScalarKeyRange:
+                success = ConfigurationParseTemplateRange(context, value);
+                break;
+            case ScalarKeyPinStep:
+                context->pinStep = (int)strtol(value, NULL, 10);
+                success = true;
+                break;
             default:
                 LogE(TAG, "Unhandled output scalar key for value %s", value);
                 break;
@@ -632,135 +1531,459 @@ static bool ConfigurationParseOutputSequenceEnd(ConfigurationRef self, const yam
     return true;
 }
 
-static bool ConfigurationParseSettings(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
+static bool ConfigurationParseShows(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
     switch (event->type) {
         case YAML_MAPPING_END_EVENT:
-            return ConfigurationParseSettingsMappingEnd(self, event, context);
+            return ConfigurationParseShowsMappingEnd(self, event, context);
             break;
         case YAML_SCALAR_EVENT:
-            return ConfigurationParseSettingsScalar(self, event, context);
+            return ConfigurationParseShowsScalar(self, event, context);
+            break;
+        case YAML_SEQUENCE_END_EVENT:
+            return ConfigurationParseShowsSequenceEnd(self, event, context);
             break;
         case YAML_MAPPING_START_EVENT:
+        case YAML_SEQUENCE_START_EVENT:
             // NOTE: Nothing to do with these events
             return true;
             break;
         default:
-            LogE(TAG, "Invalid event %i in Settings section", event->type);
+            LogE(TAG, "Invalid event %i in Show section", event->type);
             return false;
             break;
     }
 }
 
-static bool ConfigurationParseSettingsMappingEnd(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
-    // If we ended without a full value, we've failed
-    if (context->scalarKey != ScalarKeyNone) {
-        LogE(TAG, "Failed to find value for a Settings key");
+static bool ConfigurationParseShowsMappingEnd(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
+    // Ignore if we are not in a show, we're at the end of the section
+    if (!context->isInShow) {
+        context->section = SectionNone;
+        return true;
+    }
+
+    // Validate the show
+    const ConfigurationShow *show = &context->show;
+
+    if (show->name == NULL) {
+        LogE(TAG, "Show is missing a name");
         return false;
     }
 
-    // Transition back out of the section
-    context->section = SectionNone;
+    // Copy the show, or every show its template makes, in to place
+    bool success = true;
 
-    return true;
+    if (!context->hasRange) {
+        success = ConfigurationAddShow(self, context, show);
+    } else if (strchr(show->name, CONFIGURATION_TEMPLATE_PLACEHOLDER) != NULL) {
+        for (uint64_t index = context->rangeFirst; index <= context->rangeLast && success; index++) {
+            ConfigurationShow instance = *show;
+
+            instance.name = ConfigurationExpandName(context, show->name, index);
+            instance.birds = ConfigurationInstantiateNames(context, show->birds, show->totalBirds, index);
+
+            success = ConfigurationAddShow(self, context, &instance);
+        }
+    } else {
+        ConfigurationShow expanded = *show;
+        expanded.birds = ConfigurationExpandNames(context, show->birds, &expanded.totalBirds);
+
+        success = ConfigurationAddShow(self, context, &expanded);
+    }
+
+    // Clean up
+    ConfigurationShowReset(&context->show);
+    ConfigurationResetTemplate(context);
+    context->showBirdsCapacity = 0;
+    context->isInShow = false;
+
+    return success;
 }
 
-static bool ConfigurationParseSettingsScalar(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
+static bool ConfigurationParseShowsScalar(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
     bool success = false;
 
     const char *value = (const char *)event->data.scalar.value;
-    // size_t valueSize = event->data.scalar.length;
-
-    if (context->scalarKey == ScalarKeyNone) {
-
+    size_t valueSize = event->data.scalar.length;
 
-        if (strcmp(value, "MinWait") == 0) {
-            context->scalarKey = ScalarKeyMinWait;
-            success = true;
-        } else if (strcmp(value, "MaxWait") == 0) {
-            context->scalarKey = ScalarKeyMaxWait;
-            success = true;
-        } else if (strcmp(value, "MinPecks") == 0) {
-            context->scalarKey = ScalarKeyMinPecks;
-            success = true;
-        } else if (strcmp(value, "MaxPecks") == 0) {
-            context->scalarKey = ScalarKeyMaxPecks;
+    if (context->show.name == NULL) { // The first scalar is the name
+        context->show.name = ArenaIntern(context->scratch, value, valueSize);
+        context->isInShow = true;
+        success = true;
+    } else if (valueSize == 0) { // Empty scalars come after the name
+        success = true;
+    } else if (context->scalarKey == ScalarKeyNone) {
+        if (strcmp(value, "Birds") == 0) {
+            context->scalarKey = ScalarKeyBirds;
             success = true;
-        } else if (strcmp(value, "PeckWait") == 0) {
-            context->scalarKey = ScalarKeyPeckWait;
+        } else if (strcmp(value, "Range") == 0) {
+            context->scalarKey = ScalarKeyRange;
             success = true;
         } else {
-            LogE(TAG, "Unhandled Settings key: %s", value);
-        }
-    } else {
-        switch (context->scalarKey) {
-            case ScalarKeyMinWait:
-                self->minWait = (uint32_t)strtol(value, NULL, 10);
-                success = true;
-                break;
-            case ScalarKeyMaxWait:
-                self->maxWait = (uint32_t)strtol(value, NULL, 10);
-                success = true;
-                break;
-            case ScalarKeyMinPecks:
-                self->minPecks = (uint32_t)strtol(value, NULL, 10);
-                success = true;
-                break;
-            case ScalarKeyMaxPecks:
-                self->maxPecks = (uint32_t)strtol(value, NULL, 10);
-                success = true;
-                break;
-            case ScalarKeyPeckWait:
-                self->peckWait = (uint32_t)strtol(value, NULL, 10);
-                success = true;
-                break;
-            default:
-                LogE(TAG, "Unhandled Settings value");
-                break;
+            LogE(TAG, "Invalid Show section: %s", value);
         }
-
+    } else if (context->scalarKey == ScalarKeyBirds) {
+        context->show.birds = (const char **)ArenaAppend(context->scratch, context->show.birds, sizeof(char *), context->show.totalBirds, &context->showBirdsCapacity);
+        context->show.birds[context->show.totalBirds] = ArenaIntern(context->scratch, value, valueSize);
+        context->show.totalBirds += 1;
+        success = true;
+    } else if (context->scalarKey == ScalarKeyRange) {
+        success = ConfigurationParseTemplateRange(context, value);
         context->scalarKey = ScalarKeyNone;
+    } else {
+        LogE(TAG, "Invalid scalar key in Show: %i", context->scalarKey);
     }
 
     return success;
 }
 
+static bool ConfigurationParseShowsSequenceEnd(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
+    if (context->scalarKey != ScalarKeyNone) { // If we were in a scalar key, break out
+        context->scalarKey = ScalarKeyNone;
+    } else { // Otherwise the list of shows has ended
+        context->section = SectionNone;
+    }
 
-// MARK: - Settings
-
-uint32_t ConfigurationGetMinWait(const ConfigurationRef self) {
-    return self->minWait;
+    return true;
 }
 
-uint32_t ConfigurationGetMaxWait(const ConfigurationRef self) {
-    return self->maxWait;
+static bool ConfigurationParseTriggers(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
+    switch (event->type) {
+        case YAML_MAPPING_END_EVENT:
+            return ConfigurationParseTriggersMappingEnd(self, event, context);
+            break;
+        case YAML_SCALAR_EVENT:
+            return ConfigurationParseTriggersScalar(self, event, context);
+            break;
+        case YAML_SEQUENCE_END_EVENT:
+            return ConfigurationParseTriggersSequenceEnd(self, event, context);
+            break;
+        case YAML_MAPPING_START_EVENT:
+        case YAML_SEQUENCE_START_EVENT:
+            // NOTE: Nothing to do with these events
+            return true;
+            break;
+        default:
+            LogE(TAG, "Invalid event %i in Trigger section", event->type);
+            return false;
+            break;
+    }
 }
 
-uint32_t ConfigurationGetMinPecks(const ConfigurationRef self) {
-    return self->minPecks;
-}
+static bool ConfigurationParseTriggersMappingEnd(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
+    // Ignore if we are not in a trigger, we're at the end of the section
+    if (!context->isInTrigger) {
+        context->section = SectionNone;
+        return true;
+    }
 
-uint32_t ConfigurationGetMaxPecks(const ConfigurationRef self) {
-    return self->maxPecks;
-}
+    // Validate the trigger
+    ConfigurationTrigger *trigger = &context->trigger;
 
-uint32_t ConfigurationGetPeckWait(const ConfigurationRef self) {
-    return self->peckWait;
-}
+    if (trigger->name == NULL) {
+        LogE(TAG, "Trigger is missing a name");
+        return false;
+    } else if (trigger->type == ConfigurationTriggerTypeUnknown) {
+        LogE(TAG, "Trigger \"%s\" is missing a type", trigger->name);
+        return false;
+    } else if (!trigger->hasSource) {
+        LogE(TAG, "Trigger \"%s\" is missing a source", trigger->name);
+        return false;
+    } else if (trigger->bird != NULL && trigger->action != ConfigurationTriggerActionPeck) {
+        LogE(TAG, "Trigger \"%s\" can only name a bird to peck", trigger->name);
+        return false;
+    }
 
+    for (size_t idx = 0; idx < self->totalTriggers; idx++) {
+        if (strcmp(self->triggers[idx].name, trigger->name) == 0) {
+            LogE(TAG, "Duplicate trigger name: %s", trigger->name);
+            return false;
+        }
+    }
 
-// MARK: - Outputs
+    // Copy the trigger in to place
+    self->triggers = (ConfigurationTrigger *)ArenaAppend(context->scratch, self->triggers, sizeof(ConfigurationTrigger), self->totalTriggers, &context->triggersCapacity);
+    memcpy(self->triggers + self->totalTriggers, trigger, sizeof(ConfigurationTrigger));
+    self->totalTriggers += 1;
 
-const char * ConfigurationGetOutputName(const ConfigurationRef self, size_t idx) {
-    if (idx >= self->totalOutputs) {
-        return NULL;
-    }
+    // Clean up
+    ConfigurationTriggerReset(trigger);
+    context->isInTrigger = false;
 
-    return self->outputs[idx].name;
+    return true;
 }
 
-const char * ConfigurationGetOutputPath(const ConfigurationRef self, size_t idx) {
-    if (idx >= self->totalOutputs) {
-        return NULL;
+static bool ConfigurationParseTriggersScalar(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
+    bool success = false;
+
+    const char *value = (const char *)event->data.scalar.value;
+    size_t valueSize = event->data.scalar.length;
+
+    ConfigurationTrigger *trigger = &context->trigger;
+
+    if (trigger->name == NULL) { // The first scalar is the name
+        trigger->name = ArenaIntern(context->scratch, value, valueSize);
+        context->isInTrigger = true;
+        success = true;
+    } else if (context->scalarKey == ScalarKeyNone && valueSize == 0) { // A blank scalar comes after the name
+        success = true;
+    } else if (context->scalarKey == ScalarKeyNone) {
+        if (strcmp(value, "Type") == 0) {
+            context->scalarKey = ScalarKeyType;
+            success = true;
+        } else if (strcmp(value, "Source") == 0) {
+            context->scalarKey = ScalarKeySource;
+            success = true;
+        } else if (strcmp(value, "Show") == 0) {
+            context->scalarKey = ScalarKeyShow;
+            success = true;
+        } else if (strcmp(value, "Action") == 0) {
+            context->scalarKey = ScalarKeyAction;
+            success = true;
+        } else if (strcmp(value, "Bird") == 0) {
+            context->scalarKey = ScalarKeyBird;
+            success = true;
+        } else {
+            LogE(TAG, "Unhandled trigger scalar key: %s", value);
+        }
+    } else {
+        switch (context->scalarKey) {
+            case ScalarKeyType:
+                if (strcmp(value, "Input") == 0) {
+                    trigger->type = ConfigurationTriggerTypeInput;
+                    success = true;
+                } else if (strcmp(value, "Command") == 0) {
+                    trigger->type = ConfigurationTriggerTypeCommand;
+                    success = true;
+                } else if (strcmp(value, "Schedule") == 0) {
+                    trigger->type = ConfigurationTriggerTypeSchedule;
+                    success = true;
+                } else if (strcmp(value, "Cue") == 0) {
+                    trigger->type = ConfigurationTriggerTypeCue;
+                    success = true;
+                } else {
+                    LogE(TAG, "Unhandled trigger type: %s", value);
+                }
+
+                break;
+            case ScalarKeySource:
+                trigger->source = (uint32_t)strtoul(value, NULL, 10);
+                trigger->hasSource = true;
+                success = true;
+                break;
+            case ScalarKeyShow:
+                trigger->show = ArenaIntern(context->scratch, value, valueSize);
+                success = true;
+                break;
+            case ScalarKeyAction:
+                if (strcmp(value, "Peck") == 0) {
+                    trigger->action = ConfigurationTriggerActionPeck;
+                    success = true;
+                } else if (strcmp(value, "Start") == 0) {
+                    trigger->action = ConfigurationTriggerActionStart;
+                    success = true;
+                } else if (strcmp(value, "Stop") == 0) {
+                    trigger->action = ConfigurationTriggerActionStop;
+                    success = true;
+                } else {
+                    LogE(TAG, "Unhandled trigger action: %s", value);
+                }
+
+                break;
+            case ScalarKeyBird:
+                trigger->bird = ArenaIntern(context->scratch, value, valueSize);
+                success = true;
+                break;
+            default:
+                LogE(TAG, "Unhandled trigger scalar key for value %s", value);
+                break;
+        }
+
+        context->scalarKey = ScalarKeyNone;
+    }
+
+    return success;
+}
+
+static bool ConfigurationParseTriggersSequenceEnd(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
+    // End of the sequence ends the section
+    context->section = SectionNone;
+    return true;
+}
+
+static bool ConfigurationParseSettings(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
+    switch (event->type) {
+        case YAML_MAPPING_END_EVENT:
+            return ConfigurationParseSettingsMappingEnd(self, event, context);
+            break;
+        case YAML_SCALAR_EVENT:
+            return ConfigurationParseSettingsScalar(self, event, context);
+            break;
+        case YAML_MAPPING_START_EVENT:
+            // NOTE: Nothing to do with these events
+            return true;
+            break;
+        default:
+            LogE(TAG, "Invalid event %i in Settings section", event->type);
+            return false;
+            break;
+    }
+}
+
+static bool ConfigurationParseSettingsMappingEnd(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
+    // If we ended without a full value, we've failed
+    if (context->scalarKey != ScalarKeyNone) {
+        LogE(TAG, "Failed to find value for a Settings key");
+        return false;
+    }
+
+    // Transition back out of the section
+    context->section = SectionNone;
+
+    return true;
+}
+
+static bool ConfigurationParseSettingsScalar(ConfigurationRef self, const yaml_event_t *event, ParsingContext *context) {
+    bool success = false;
+
+    const char *value = (const char *)event->data.scalar.value;
+    // size_t valueSize = event->data.scalar.length;
+
+    if (context->scalarKey == ScalarKeyNone) {
+
+
+        if (strcmp(value, "MinWait") == 0) {
+            context->scalarKey = ScalarKeyMinWait;
+            success = true;
+        } else if (strcmp(value, "MaxWait") == 0) {
+            context->scalarKey = ScalarKeyMaxWait;
+            success = true;
+        } else if (strcmp(value, "MinPecks") == 0) {
+            context->scalarKey = ScalarKeyMinPecks;
+            success = true;
+        } else if (strcmp(value, "MaxPecks") == 0) {
+            context->scalarKey = ScalarKeyMaxPecks;
+            success = true;
+        } else if (strcmp(value, "PeckWait") == 0) {
+            context->scalarKey = ScalarKeyPeckWait;
+            success = true;
+        } else if (strcmp(value, "Watchdog") == 0) {
+            context->scalarKey = ScalarKeyWatchdog;
+            success = true;
+        } else if (strcmp(value, "WatchdogInterval") == 0) {
+            context->scalarKey = ScalarKeyWatchdogInterval;
+            success = true;
+        } else if (strcmp(value, "LogLevels") == 0) {
+            context->scalarKey = ScalarKeyLogLevels;
+            success = true;
+        } else {
+            LogE(TAG, "Unhandled Settings key: %s", value);
+        }
+    } else {
+        switch (context->scalarKey) {
+            case ScalarKeyMinWait:
+                self->minWait = (uint32_t)strtol(value, NULL, 10);
+                success = true;
+                break;
+            case ScalarKeyMaxWait:
+                self->maxWait = (uint32_t)strtol(value, NULL, 10);
+                success = true;
+                break;
+            case ScalarKeyMinPecks:
+                self->minPecks = (uint32_t)strtol(value, NULL, 10);
+                success = true;
+                break;
+            case ScalarKeyMaxPecks:
+                self->maxPecks = (uint32_t)strtol(value, NULL, 10);
+                success = true;
+                break;
+            case ScalarKeyPeckWait:
+                self->peckWait = (uint32_t)strtol(value, NULL, 10);
+                success = true;
+                break;
+            case ScalarKeyWatchdog:
+                self->watchdogPath = ArenaIntern(context->scratch, value, strlen(value));
+                success = true;
+                break;
+            case ScalarKeyWatchdogInterval:
+                self->watchdogInterval = (uint32_t)strtol(value, NULL, 10);
+
+                if (self->watchdogInterval == 0) {
+                    LogE(TAG, "WatchdogInterval must be greater than 0");
+                } else {
+                    success = true;
+                }
+
+                break;
+            case ScalarKeyLogLevels:
+                if (!LogCheckTagLevels(value)) {
+                    LogE(TAG, "Invalid LogLevels: %s", value);
+                } else {
+                    self->logLevels = ArenaIntern(context->scratch, value, strlen(value));
+                    success = true;
+                }
+
+                break;
+            default:
+                LogE(TAG, "Unhandled Settings value");
+                break;
+        }
+
+        self->parsedSettings |= (1u << context->scalarKey);
+        context->scalarKey = ScalarKeyNone;
+    }
+
+    return success;
+}
+
+
+// MARK: - Settings
+
+uint32_t ConfigurationGetMinWait(const ConfigurationRef self) {
+    return self->minWait;
+}
+
+uint32_t ConfigurationGetMaxWait(const ConfigurationRef self) {
+    return self->maxWait;
+}
+
+uint32_t ConfigurationGetMinPecks(const ConfigurationRef self) {
+    return self->minPecks;
+}
+
+uint32_t ConfigurationGetMaxPecks(const ConfigurationRef self) {
+    return self->maxPecks;
+}
+
+uint32_t ConfigurationGetPeckWait(const ConfigurationRef self) {
+    return self->peckWait;
+}
+
+const char * ConfigurationGetWatchdogPath(const ConfigurationRef self) {
+    return self->watchdogPath;
+}
+
+uint32_t ConfigurationGetWatchdogInterval(const ConfigurationRef self) {
+    return self->watchdogInterval;
+}
+
+const char * ConfigurationGetLogLevels(const ConfigurationRef self) {
+    return self->logLevels;
+}
+
+
+// MARK: - Outputs
+
+const char * ConfigurationGetOutputName(const ConfigurationRef self, size_t idx) {
+    if (idx >= self->totalOutputs) {
+        return NULL;
+    }
+
+    return self->outputs[idx].name;
+}
+
+const char * ConfigurationGetOutputPath(const ConfigurationRef self, size_t idx) {
+    if (idx >= self->totalOutputs) {
+        return NULL;
     }
 
     if (self->outputs[idx].type != ConfigurationOutputTypeFile) {
@@ -782,6 +2005,38 @@ int ConfigurationGetOutputPin(const ConfigurationRef self, size_t idx) {
     return self->outputs[idx].gpio.pin;
 }
 
+uint32_t ConfigurationGetOutputMinDwell(const ConfigurationRef self, size_t idx) {
+    if (idx >= self->totalOutputs) {
+        return 0;
+    }
+
+    return self->outputs[idx].minDwell;
+}
+
+uint32_t ConfigurationGetOutputMinOff(const ConfigurationRef self, size_t idx) {
+    if (idx >= self->totalOutputs) {
+        return 0;
+    }
+
+    return self->outputs[idx].minOff;
+}
+
+uint32_t ConfigurationGetOutputMinOn(const ConfigurationRef self, size_t idx) {
+    if (idx >= self->totalOutputs) {
+        return 0;
+    }
+
+    return self->outputs[idx].minOn;
+}
+
+ConfigurationSafeState ConfigurationGetOutputSafeState(const ConfigurationRef self, size_t idx) {
+    if (idx >= self->totalOutputs) {
+        return ConfigurationSafeStateOff;
+    }
+
+    return self->outputs[idx].safeState;
+}
+
 ConfigurationOutputType ConfigurationGetOutputType(const ConfigurationRef self, size_t idx) {
     if (idx >= self->totalOutputs) {
         return ConfigurationOutputTypeUnknown;
@@ -876,50 +2131,1666 @@ size_t ConfigurationGetTotalBirds(const ConfigurationRef self) {
 }
 
 
-// MARK: - Utilities
+// MARK: - Shows
 
-static void ConfigurationBirdDestroy(ConfigurationBird *bird) {
-    SAFE_DESTROY(bird->name, free);
+const char * ConfigurationGetShowBird(const ConfigurationRef self, size_t showIdx, size_t idx) {
+    if (showIdx >= self->totalShows) {
+        return NULL;
+    }
 
-    for (size_t idx = 0; idx < bird->totalStatics; idx++) {
-        SAFE_DESTROY(bird->statics[idx], free);
+    const ConfigurationShow *show = self->shows + showIdx;
+
+    if (idx >= show->totalBirds) {
+        return NULL;
     }
 
-    SAFE_DESTROY(bird->statics, free);
+    return show->birds[idx];
+}
 
-    for (size_t idx = 0; idx < bird->totalBacks; idx++) {
-        SAFE_DESTROY(bird->backs[idx], free);
+size_t ConfigurationGetShowTotalBirds(const ConfigurationRef self, size_t idx) {
+    if (idx >= self->totalShows) {
+        return 0;
     }
 
-    SAFE_DESTROY(bird->backs, free);
+    return self->shows[idx].totalBirds;
+}
 
-    for (size_t idx = 0; idx < bird->totalForwards; idx++) {
-        SAFE_DESTROY(bird->forwards[idx], free);
+const char * ConfigurationGetShowName(const ConfigurationRef self, size_t idx) {
+    if (idx >= self->totalShows) {
+        return NULL;
     }
 
-    SAFE_DESTROY(bird->forwards, free);
+    return self->shows[idx].name;
 }
 
-static void ConfigurationBirdReset(ConfigurationBird * NONNULL bird) {
-    memset(bird, 0, sizeof(ConfigurationBird));
+size_t ConfigurationGetTotalShows(const ConfigurationRef self) {
+    return self->totalShows;
 }
 
-static void ConfigurationOutputDestroy(ConfigurationOutput *output) {
-    SAFE_DESTROY(output->name, free);
 
-    if (output->type == ConfigurationOutputTypeFile) {
-        SAFE_DESTROY(output->file.path, free);
+// MARK: - Triggers
+
+ConfigurationTriggerAction ConfigurationGetTriggerAction(const ConfigurationRef self, size_t idx) {
+    if (idx >= self->totalTriggers) {
+        return ConfigurationTriggerActionPeck;
     }
 
-    ConfigurationOutputReset(output);
+    return self->triggers[idx].action;
 }
 
-static void ConfigurationOutputReset(ConfigurationOutput *output) {
-    memset(output, 0, sizeof(ConfigurationOutput));
+const char * ConfigurationGetTriggerBird(const ConfigurationRef self, size_t idx) {
+    if (idx >= self->totalTriggers) {
+        return NULL;
+    }
+
+    return self->triggers[idx].bird;
 }
 
+const char * ConfigurationGetTriggerName(const ConfigurationRef self, size_t idx) {
+    if (idx >= self->totalTriggers) {
+        return NULL;
+    }
 
-// MARK: - Debug
+    return self->triggers[idx].name;
+}
+
+const char * ConfigurationGetTriggerShow(const ConfigurationRef self, size_t idx) {
+    if (idx >= self->totalTriggers) {
+        return NULL;
+    }
+
+    return self->triggers[idx].show;
+}
+
+uint32_t ConfigurationGetTriggerSource(const ConfigurationRef self, size_t idx) {
+    if (idx >= self->totalTriggers) {
+        return 0;
+    }
+
+    return self->triggers[idx].source;
+}
+
+ConfigurationTriggerType ConfigurationGetTriggerType(const ConfigurationRef self, size_t idx) {
+    if (idx >= self->totalTriggers) {
+        return ConfigurationTriggerTypeUnknown;
+    }
+
+    return self->triggers[idx].type;
+}
+
+size_t ConfigurationGetTotalTriggers(const ConfigurationRef self) {
+    return self->totalTriggers;
+}
+
+
+// MARK: - Includes & Sources
+
+const char * ConfigurationGetInclude(const ConfigurationRef self, size_t idx) {
+    if (idx >= self->totalIncludes) {
+        return NULL;
+    }
+
+    return self->includes[idx];
+}
+
+size_t ConfigurationGetTotalIncludes(const ConfigurationRef self) {
+    return self->totalIncludes;
+}
+
+uint64_t ConfigurationGetSourceHash(const ConfigurationRef self, size_t idx) {
+    if (idx >= self->totalSources) {
+        return 0;
+    }
+
+    return self->sources[idx].hash;
+}
+
+const char * ConfigurationGetSourcePath(const ConfigurationRef self, size_t idx) {
+    if (idx >= self->totalSources) {
+        return NULL;
+    }
+
+    return self->sources[idx].path;
+}
+
+size_t ConfigurationGetTotalSources(const ConfigurationRef self) {
+    return self->totalSources;
+}
+
+
+// MARK: - Resolution
+
+bool ConfigurationResolve(ConfigurationRef self) {
+    if (self->isResolved) {
+        return true;
+    }
+
+    // Names were interned when the Configuration was compacted, so equal names are equal pointers
+    ArenaRef scratch = ArenaCreate(SCRATCH_ARENA_SIZE);
+    size_t totalAllocations = ArenaGetTotalAllocations(self->arena);
+
+    NameIndex outputs;
+    NameIndex birds;
+    NameIndex shows;
+
+    bool success = NameIndexBuild(&outputs, scratch, "output", self->outputs, sizeof(ConfigurationOutput), offsetof(ConfigurationOutput, name), self->totalOutputs)
+        && NameIndexBuild(&birds, scratch, "bird", self->birds, sizeof(ConfigurationBird), offsetof(ConfigurationBird, name), self->totalBirds)
+        && NameIndexBuild(&shows, scratch, "show", self->shows, sizeof(ConfigurationShow), offsetof(ConfigurationShow, name), self->totalShows);
+
+    for (size_t idx = 0; idx < self->totalBirds && success; idx++) {
+        ConfigurationBird *bird = self->birds + idx;
+
+        success = ConfigurationResolveNames(self->arena, &outputs, bird->name, "output", bird->statics, bird->totalStatics, &bird->staticIndices)
+            && ConfigurationResolveNames(self->arena, &outputs, bird->name, "output", bird->backs, bird->totalBacks, &bird->backIndices)
+            && ConfigurationResolveNames(self->arena, &outputs, bird->name, "output", bird->forwards, bird->totalForwards, &bird->forwardIndices);
+    }
+
+    // A show runs each of its birds once
+    bool *isInShow = (bool *)ArenaAllocate(scratch, sizeof(bool) * (self->totalBirds + 1));
+
+    for (size_t idx = 0; idx < self->totalShows && success; idx++) {
+        ConfigurationShow *show = self->shows + idx;
+
+        success = ConfigurationResolveNames(self->arena, &birds, show->name, "bird", show->birds, show->totalBirds, &show->birdIndices);
+
+        for (size_t birdIdx = 0; birdIdx < show->totalBirds && success; birdIdx++) {
+            uint32_t bird = show->birdIndices[birdIdx];
+
+            if (isInShow[bird]) {
+                LogE(TAG, "\"%s\" lists bird \"%s\" more than once", show->name, show->birds[birdIdx]);
+                success = false;
+            }
+
+            isInShow[bird] = true;
+        }
+
+        for (size_t birdIdx = 0; birdIdx < show->totalBirds && show->birdIndices != NULL; birdIdx++) {
+            isInShow[show->birdIndices[birdIdx]] = false;
+        }
+    }
+
+    success = success && ConfigurationResolveTimings(self, scratch, &birds);
+
+    for (size_t idx = 0; idx < self->totalTriggers && success; idx++) {
+        ConfigurationTrigger *trigger = self->triggers + idx;
+
+        trigger->showIndex = CONFIGURATION_INDEX_NONE;
+        trigger->birdIndex = CONFIGURATION_INDEX_NONE;
+
+        if (trigger->show != NULL) {
+            trigger->showIndex = NameIndexFind(&shows, trigger->show);
+
+            if (trigger->showIndex == CONFIGURATION_INDEX_NONE) {
+                LogE(TAG, "\"%s\" references unknown show \"%s\"", trigger->name, trigger->show);
+                success = false;
+                break;
+            }
+        }
+
+        if (trigger->bird == NULL) {
+            continue;
+        }
+
+        trigger->birdIndex = NameIndexFind(&birds, trigger->bird);
+
+        if (trigger->birdIndex == CONFIGURATION_INDEX_NONE) {
+            LogE(TAG, "\"%s\" references unknown bird \"%s\"", trigger->name, trigger->bird);
+            success = false;
+            break;
+        }
+
+        // Without shows, every bird is in the single default show
+        for (size_t showIdx = 0; showIdx < self->totalShows && success; showIdx++) {
+            if (trigger->showIndex != CONFIGURATION_INDEX_NONE && trigger->showIndex != showIdx) {
+                continue;
+            }
+
+            if (!ConfigurationShowHasBird(self->shows + showIdx, trigger->birdIndex)) {
+                LogE(TAG, "\"%s\" pecks bird \"%s\", which is not in show \"%s\"", trigger->name, trigger->bird, self->shows[showIdx].name);
+                success = false;
+            }
+        }
+    }
+
+    ArenaDestroy(scratch);
+
+    self->isResolved = success;
+    self->totalAllocations += ArenaGetTotalAllocations(self->arena) - totalAllocations;
+
+    return success;
+}
+
+bool ConfigurationIsResolved(const ConfigurationRef self) {
+    return self->isResolved;
+}
+
+const uint32_t * ConfigurationGetBirdBackIndices(const ConfigurationRef self, size_t idx) {
+    if (!self->isResolved || idx >= self->totalBirds) {
+        return NULL;
+    }
+
+    return self->birds[idx].backIndices;
+}
+
+const uint32_t * ConfigurationGetBirdForwardIndices(const ConfigurationRef self, size_t idx) {
+    if (!self->isResolved || idx >= self->totalBirds) {
+        return NULL;
+    }
+
+    return self->birds[idx].forwardIndices;
+}
+
+const uint32_t * ConfigurationGetBirdStaticIndices(const ConfigurationRef self, size_t idx) {
+    if (!self->isResolved || idx >= self->totalBirds) {
+        return NULL;
+    }
+
+    return self->birds[idx].staticIndices;
+}
+
+const ConfigurationTiming * ConfigurationGetBirdTiming(const ConfigurationRef self, size_t idx) {
+    if (!self->isResolved || idx >= self->totalBirds) {
+        return NULL;
+    }
+
+    return self->timings + idx;
+}
+
+const uint32_t * ConfigurationGetShowBirdIndices(const ConfigurationRef self, size_t idx) {
+    if (!self->isResolved || idx >= self->totalShows) {
+        return NULL;
+    }
+
+    return self->shows[idx].birdIndices;
+}
+
+uint32_t ConfigurationGetTriggerBirdIndex(const ConfigurationRef self, size_t idx) {
+    if (!self->isResolved || idx >= self->totalTriggers) {
+        return CONFIGURATION_INDEX_NONE;
+    }
+
+    return self->triggers[idx].birdIndex;
+}
+
+uint32_t ConfigurationGetTriggerShowIndex(const ConfigurationRef self, size_t idx) {
+    if (!self->isResolved || idx >= self->totalTriggers) {
+        return CONFIGURATION_INDEX_NONE;
+    }
+
+    return self->triggers[idx].showIndex;
+}
+
+static bool ConfigurationResolveNames(ArenaRef arena, const NameIndex *index, const char *owner, const char *kind, const char **names, size_t total, const uint32_t **indices) {
+    if (total == 0) {
+        *indices = NULL;
+        return true;
+    }
+
+    uint32_t *resolved = (uint32_t *)ArenaAllocate(arena, sizeof(uint32_t) * total);
+
+    for (size_t idx = 0; idx < total; idx++) {
+        resolved[idx] = NameIndexFind(index, names[idx]);
+
+        if (resolved[idx] == CONFIGURATION_INDEX_NONE) {
+            LogE(TAG, "\"%s\" references unknown %s \"%s\"", owner, kind, names[idx]);
+            return false;
+        }
+    }
+
+    *indices = resolved;
+
+    return true;
+}
+
+static bool ConfigurationResolveTimings(ConfigurationRef self, ArenaRef scratch, const NameIndex *birds) {
+    // Each bird is in at most one group, so a single group index per bird is enough
+    uint32_t *birdGroups = (uint32_t *)ArenaAllocate(scratch, sizeof(uint32_t) * (self->totalBirds + 1));
+    memset(birdGroups, 0xFF, sizeof(uint32_t) * (self->totalBirds + 1));
+
+    for (size_t idx = 0; idx < self->totalGroups; idx++) {
+        const ConfigurationGroup *group = self->groups + idx;
+        const uint32_t *birdIndices = NULL;
+
+        if (!ConfigurationResolveNames(scratch, birds, group->name, "bird", group->birds, group->totalBirds, &birdIndices)) {
+            return false;
+        }
+
+        for (size_t birdIdx = 0; birdIdx < group->totalBirds; birdIdx++) {
+            uint32_t bird = birdIndices[birdIdx];
+
+            if (birdGroups[bird] == idx) {
+                LogE(TAG, "\"%s\" lists bird \"%s\" more than once", group->name, group->birds[birdIdx]);
+                return false;
+            } else if (birdGroups[bird] != CONFIGURATION_INDEX_NONE) {
+                LogE(TAG, "\"%s\" is in group \"%s\" and group \"%s\"", group->birds[birdIdx], self->groups[birdGroups[bird]].name, group->name);
+                return false;
+            }
+
+            birdGroups[bird] = (uint32_t)idx;
+        }
+    }
+
+    // Flatten the inheritance once, so reading a bird's timing is a single array read
+    ConfigurationTiming *timings = (ConfigurationTiming *)ArenaAllocate(self->arena, sizeof(ConfigurationTiming) * (self->totalBirds + 1));
+
+    for (size_t idx = 0; idx < self->totalBirds; idx++) {
+        ConfigurationTiming *timing = timings + idx;
+
+        timing->minWait = self->minWait;
+        timing->maxWait = self->maxWait;
+        timing->minPecks = self->minPecks;
+        timing->maxPecks = self->maxPecks;
+        timing->peckWait = self->peckWait;
+        timing->overrides = 0;
+
+        if (birdGroups[idx] != CONFIGURATION_INDEX_NONE) {
+            ConfigurationTimingApply(timing, &self->groups[birdGroups[idx]].timing);
+        }
+
+        ConfigurationTimingApply(timing, &self->birds[idx].timing);
+    }
+
+    self->timings = timings;
+
+    return true;
+}
+
+static bool ConfigurationShowHasBird(const ConfigurationShow *show, uint32_t birdIdx) {
+    for (size_t idx = 0; idx < show->totalBirds; idx++) {
+        if (show->birdIndices[idx] == birdIdx) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+// MARK: - Templates
+
+static void ConfigurationAddBird(ConfigurationRef self, ParsingContext *context, const ConfigurationBird *bird) {
+    self->birds = (ConfigurationBird *)ArenaAppend(context->scratch, self->birds, sizeof(ConfigurationBird), self->totalBirds, &context->birdsCapacity);
+    memcpy(self->birds + self->totalBirds, bird, sizeof(ConfigurationBird));
+    self->totalBirds += 1;
+}
+
+static void ConfigurationAddOutput(ConfigurationRef self, ParsingContext *context, const ConfigurationOutput *output) {
+    self->outputs = (ConfigurationOutput *)ArenaAppend(context->scratch, self->outputs, sizeof(ConfigurationOutput), self->totalOutputs, &context->outputsCapacity);
+    memcpy(self->outputs + self->totalOutputs, output, sizeof(ConfigurationOutput));
+    self->totalOutputs += 1;
+}
+
+static bool ConfigurationAddGroup(ConfigurationRef self, ParsingContext *context, const ConfigurationGroup *group) {
+    for (size_t idx = 0; idx < self->totalGroups; idx++) {
+        if (strcmp(self->groups[idx].name, group->name) == 0) {
+            LogE(TAG, "Duplicate group name: %s", group->name);
+            return false;
+        }
+    }
+
+    self->groups = (ConfigurationGroup *)ArenaAppend(context->scratch, self->groups, sizeof(ConfigurationGroup), self->totalGroups, &context->groupsCapacity);
+    memcpy(self->groups + self->totalGroups, group, sizeof(ConfigurationGroup));
+    self->totalGroups += 1;
+
+    return true;
+}
+
+static bool ConfigurationAddShow(ConfigurationRef self, ParsingContext *context, const ConfigurationShow *show) {
+    for (size_t idx = 0; idx < self->totalShows; idx++) {
+        if (strcmp(self->shows[idx].name, show->name) == 0) {
+            LogE(TAG, "Duplicate show name: %s", show->name);
+            return false;
+        }
+    }
+
+    self->shows = (ConfigurationShow *)ArenaAppend(context->scratch, self->shows, sizeof(ConfigurationShow), self->totalShows, &context->showsCapacity);
+    memcpy(self->shows + self->totalShows, show, sizeof(ConfigurationShow));
+    self->totalShows += 1;
+
+    return true;
+}
+
+static const char * ConfigurationExpandName(ParsingContext *context, const char *name, uint32_t index) {
+    if (name == NULL || strchr(name, CONFIGURATION_TEMPLATE_PLACEHOLDER) == NULL) {
+        return name;
+    }
+
+    char number[16];
+    size_t numberSize = (size_t)snprintf(number, sizeof(number), "%" PRIu32, index);
+
+    size_t totalPlaceholders = 0;
+
+    for (const char *character = name; *character != '\0'; character++) {
+        if (*character == CONFIGURATION_TEMPLATE_PLACEHOLDER) {
+            totalPlaceholders += 1;
+        }
+    }
+
+    // Build the name on the stack, then intern it, so repeated names share storage
+    size_t nameSize = strlen(name);
+    size_t expandedSize = nameSize - totalPlaceholders + (totalPlaceholders * numberSize);
+    char expanded[expandedSize + 1];
+    char *cursor = expanded;
+
+    for (const char *character = name; *character != '\0'; character++) {
+        if (*character == CONFIGURATION_TEMPLATE_PLACEHOLDER) {
+            memcpy(cursor, number, numberSize);
+            cursor += numberSize;
+        } else {
+            *cursor = *character;
+            cursor += 1;
+        }
+    }
+
+    return ArenaIntern(context->scratch, expanded, expandedSize);
+}
+
+static const char ** ConfigurationExpandNames(ParsingContext *context, const char **names, size_t *total) {
+    size_t totalInstances = (size_t)(context->rangeLast - context->rangeFirst) + 1;
+    size_t totalExpanded = 0;
+
+    for (size_t idx = 0; idx < *total; idx++) {
+        totalExpanded += (strchr(names[idx], CONFIGURATION_TEMPLATE_PLACEHOLDER) != NULL) ? totalInstances : 1;
+    }
+
+    if (totalExpanded == 0) {
+        return names;
+    }
+
+    const char **expanded = (const char **)ArenaAllocate(context->scratch, sizeof(char *) * totalExpanded);
+    size_t expandedIdx = 0;
+
+    for (size_t idx = 0; idx < *total; idx++) {
+        if (strchr(names[idx], CONFIGURATION_TEMPLATE_PLACEHOLDER) == NULL) {
+            expanded[expandedIdx] = names[idx];
+            expandedIdx += 1;
+            continue;
+        }
+
+        for (uint64_t index = context->rangeFirst; index <= context->rangeLast; index++) {
+            expanded[expandedIdx] = ConfigurationExpandName(context, names[idx], index);
+            expandedIdx += 1;
+        }
+    }
+
+    *total = totalExpanded;
+
+    return expanded;
+}
+
+static const char ** ConfigurationInstantiateNames(ParsingContext *context, const char **names, size_t total, uint32_t index) {
+    if (total == 0) {
+        return names;
+    }
+
+    const char **instances = (const char **)ArenaAllocate(context->scratch, sizeof(char *) * total);
+
+    for (size_t idx = 0; idx < total; idx++) {
+        instances[idx] = ConfigurationExpandName(context, names[idx], index);
+    }
+
+    return instances;
+}
+
+static bool ConfigurationParseTemplateRange(ParsingContext *context, const char *value) {
+    const char *error = ConfigurationParseRange(value, &context->rangeFirst, &context->rangeLast);
+
+    if (error != NULL) {
+        LogE(TAG, "Invalid range \"%s\", %s", value, error);
+        return false;
+    }
+
+    context->hasRange = true;
+
+    return true;
+}
+
+static void ConfigurationResetTemplate(ParsingContext *context) {
+    context->hasRange = false;
+    context->rangeFirst = 0;
+    context->rangeLast = 0;
+    context->pinStep = 1;
+}
+
+
+// MARK: - Templates
+
+const char * ConfigurationParseRange(const char *value, uint32_t *first, uint32_t *last) {
+    const char *end = NULL;
+    uint32_t firstIndex = 0;
+    uint32_t lastIndex = 0;
+
+    if (!ConfigurationParseRangeIndex(value, &end, &firstIndex) || strncmp(end, "..", 2) != 0) {
+        return "expected FIRST..LAST";
+    } else if (!ConfigurationParseRangeIndex(end + 2, &end, &lastIndex) || *end != '\0') {
+        return "expected FIRST..LAST";
+    } else if (lastIndex < firstIndex) {
+        return "the last index is before the first";
+    } else if (lastIndex - firstIndex >= CONFIGURATION_MAX_TEMPLATE_INSTANCES) {
+        return "more than " STRINGIFY(CONFIGURATION_MAX_TEMPLATE_INSTANCES) " instances";
+    }
+
+    *first = firstIndex;
+    *last = lastIndex;
+
+    return NULL;
+}
+
+static bool ConfigurationParseRangeIndex(const char *value, const char **end, uint32_t *index) {
+    // NOTE: `strtoul` would skip spaces and accept a sign, wrapping negative numbers around
+    if (!isdigit((unsigned char)value[0])) {
+        return false;
+    }
+
+    char *numberEnd = NULL;
+
+    errno = 0;
+    unsigned long number = strtoul(value, &numberEnd, 10);
+
+    if (errno == ERANGE || number > UINT32_MAX) {
+        return false;
+    }
+
+    *end = numberEnd;
+    *index = (uint32_t)number;
+
+    return true;
+}
+
+
+// MARK: - Splitting
+
+size_t ConfigurationSplitString(const char *value, size_t chunkSize, char ***chunks) {
+    size_t valueSize = strlen(value);
+    const char *end = value + valueSize;
+
+    *chunks = NULL;
+    size_t totalChunks = 0;
+
+    if (valueSize <= chunkSize) {
+        ConfigurationAppendChunk(chunks, &totalChunks, NULL, 0, value, valueSize);
+        return totalChunks;
+    }
+
+    // Find the top-level sections. Anything at the start of a line that is not a known section means the YAML is not one this can split.
+    const char *sectionStarts[MAX_SPLIT_SECTIONS];
+    Section sections[MAX_SPLIT_SECTIONS];
+    size_t totalSections = 0;
+
+    for (const char *line = value; line < end; line = NextLine(line, end)) {
+        char first = *line;
+
+        if (first == ' ' || first == '\t' || first == '\n' || first == '\r' || first == '#') {
+            continue;
+        } else if (first == '-' && totalSections > 0 && strncmp(line, "---", 3) != 0) {
+            continue;
+        } else if (totalSections == 0 && (first == '%' || strncmp(line, "---", 3) == 0)) {
+            continue;
+        }
+
+        Section section = SectionForLine(line, end);
+
+        if (section == SectionNone || totalSections == MAX_SPLIT_SECTIONS) {
+            ConfigurationAppendChunk(chunks, &totalChunks, NULL, 0, value, valueSize);
+            return totalChunks;
+        }
+
+        sectionStarts[totalSections] = line;
+        sections[totalSections] = section;
+        totalSections += 1;
+    }
+
+    // Small sections are gathered in to one chunk. Large lists are cut between their items, each piece under a copy of the list's key.
+    const char *pending = NULL;
+    const char *pendingEnd = NULL;
+
+    for (size_t idx = 0; idx < totalSections; idx++) {
+        const char *sectionStart = sectionStarts[idx];
+        const char *sectionEnd = (idx + 1 < totalSections) ? sectionStarts[idx + 1] : end;
+
+        bool isList = sections[idx] != SectionSettings && sections[idx] != SectionIncludes;
+
+        if (!isList || (size_t)(sectionEnd - sectionStart) <= chunkSize) {
+            if (pending == NULL) {
+                pending = sectionStart;
+            }
+
+            pendingEnd = sectionEnd;
+
+            if ((size_t)(pendingEnd - pending) >= chunkSize) {
+                ConfigurationAppendChunk(chunks, &totalChunks, NULL, 0, pending, (size_t)(pendingEnd - pending));
+                pending = NULL;
+            }
+
+            continue;
+        }
+
+        if (pending != NULL) {
+            ConfigurationAppendChunk(chunks, &totalChunks, NULL, 0, pending, (size_t)(pendingEnd - pending));
+            pending = NULL;
+        }
+
+        const char *key = sectionStart;
+        const char *body = NextLine(sectionStart, sectionEnd);
+        size_t keySize = (size_t)(body - key);
+
+        // Items start at the indent of the first one
+        size_t itemIndent = SIZE_MAX;
+        const char *pieceStart = body;
+
+        for (const char *line = body; line < sectionEnd; line = NextLine(line, sectionEnd)) {
+            size_t indent = LineIndent(line, sectionEnd);
+            const char *content = line + indent;
+
+            bool isItem = content < sectionEnd && *content == '-'
+                && (content + 1 == sectionEnd || content[1] == ' ' || content[1] == '\n' || content[1] == '\r');
+
+            if (!isItem) {
+                continue;
+            } else if (itemIndent == SIZE_MAX) {
+                itemIndent = indent;
+            } else if (indent == itemIndent && (size_t)(line - pieceStart) >= chunkSize) {
+                ConfigurationAppendChunk(chunks, &totalChunks, key, keySize, pieceStart, (size_t)(line - pieceStart));
+                pieceStart = line;
+            }
+        }
+
+        ConfigurationAppendChunk(chunks, &totalChunks, key, keySize, pieceStart, (size_t)(sectionEnd - pieceStart));
+    }
+
+    if (pending != NULL) {
+        ConfigurationAppendChunk(chunks, &totalChunks, NULL, 0, pending, (size_t)(pendingEnd - pending));
+    }
+
+    return totalChunks;
+}
+
+static void ConfigurationAppendChunk(char ***chunks, size_t *totalChunks, const char *key, size_t keySize, const char *body, size_t bodySize) {
+    char *chunk = (char *)malloc(keySize + bodySize + 1);
+
+    if (keySize > 0) {
+        memcpy(chunk, key, keySize);
+    }
+
+    memcpy(chunk + keySize, body, bodySize);
+    chunk[keySize + bodySize] = '\0';
+
+    *chunks = (char **)realloc(*chunks, sizeof(char *) * (*totalChunks + 1));
+    (*chunks)[*totalChunks] = chunk;
+    *totalChunks += 1;
+}
+
+static size_t LineIndent(const char *line, const char *end) {
+    const char *cursor = line;
+
+    while (cursor < end && *cursor == ' ') {
+        cursor += 1;
+    }
+
+    return (size_t)(cursor - line);
+}
+
+static const char * NextLine(const char *line, const char *end) {
+    const char *newline = (const char *)memchr(line, '\n', (size_t)(end - line));
+
+    return (newline == NULL) ? end : newline + 1;
+}
+
+static Section SectionForLine(const char *line, const char *end) {
+    static const struct {
+        const char *name;
+        Section section;
+    } Sections[] = {
+        { "Settings", SectionSettings },
+        { "Outputs", SectionOutputs },
+        { "Birds", SectionBirds },
+        { "Shows", SectionShows },
+        { "Groups", SectionGroups },
+        { "Triggers", SectionTriggers },
+        { "Include", SectionIncludes },
+    };
+
+    for (size_t idx = 0; idx < sizeof(Sections) / sizeof(Sections[0]); idx++) {
+        size_t nameSize = strlen(Sections[idx].name);
+
+        if ((size_t)(end - line) <= nameSize || strncmp(line, Sections[idx].name, nameSize) != 0 || line[nameSize] != ':') {
+            continue;
+        }
+
+        const char *after = line + nameSize + 1;
+
+        if (after == end || *after == ' ' || *after == '\n' || *after == '\r') {
+            return Sections[idx].section;
+        }
+    }
+
+    return SectionNone;
+}
+
+
+// MARK: - Compiled Images
+
+ConfigurationRef ConfigurationCreateFromImage(const char *path, uint64_t sourceHash) {
+    ConfigurationRef self = NULL;
+    void *image = MAP_FAILED;
+    size_t imageSize = 0;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd == -1) {
+        LogErrno(TAG, errno, "Failed to open configuration image %s", path);
+        goto create_from_image_cleanup;
+    }
+
+    struct stat info;
+
+    if (fstat(fd, &info) == -1) {
+        LogErrno(TAG, errno, "Failed to inspect configuration image %s", path);
+        goto create_from_image_cleanup;
+    }
+
+    imageSize = (size_t)info.st_size;
+
+    if (imageSize < sizeof(ImageHeader)) {
+        LogE(TAG, "Configuration image %s is too small", path);
+        goto create_from_image_cleanup;
+    }
+
+    image = mmap(NULL, imageSize, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (image == MAP_FAILED) {
+        LogErrno(TAG, errno, "Failed to map configuration image %s", path);
+        goto create_from_image_cleanup;
+    }
+
+    if (!ConfigurationValidateImage(image, imageSize, sourceHash)) {
+        goto create_from_image_cleanup;
+    }
+
+    // The Configuration owns the mapping from here
+    self = ConfigurationLoadImage(image, imageSize);
+    image = MAP_FAILED;
+
+create_from_image_cleanup:
+
+    if (image != MAP_FAILED) {
+        munmap(image, imageSize);
+    }
+
+    if (fd != -1) {
+        close(fd);
+    }
+
+    return self;
+}
+
+bool ConfigurationWriteImage(const ConfigurationRef self, const char *path, uint64_t sourceHash) {
+    bool success = false;
+
+    uint8_t *image = NULL;
+    char *temporaryPath = NULL;
+    int fd = -1;
+
+    ImageWriter writer;
+    memset(&writer, 0, sizeof(ImageWriter));
+
+    ImageHeader header;
+    memset(&header, 0, sizeof(ImageHeader));
+
+    // The image stores references as indices, so they must already be resolved
+    if (!self->isResolved) {
+        LogE(TAG, "Cannot compile an unresolved configuration");
+        return false;
+    }
+
+    // Build the records
+    size_t outputsSize = sizeof(ImageOutput) * self->totalOutputs;
+    size_t birdsSize = sizeof(ImageBird) * self->totalBirds;
+    size_t showsSize = sizeof(ImageShow) * self->totalShows;
+    size_t triggersSize = sizeof(ImageTrigger) * self->totalTriggers;
+
+    ImageOutput *outputs = (ImageOutput *)calloc(self->totalOutputs + 1, sizeof(ImageOutput));
+    ImageBird *birds = (ImageBird *)calloc(self->totalBirds + 1, sizeof(ImageBird));
+    ImageShow *shows = (ImageShow *)calloc(self->totalShows + 1, sizeof(ImageShow));
+    ImageTrigger *triggers = (ImageTrigger *)calloc(self->totalTriggers + 1, sizeof(ImageTrigger));
+
+    for (size_t idx = 0; idx < self->totalOutputs; idx++) {
+        const ConfigurationOutput *output = self->outputs + idx;
+        ImageOutput *record = outputs + idx;
+
+        record->name = ImageWriterIntern(&writer, output->name);
+        record->type = (uint32_t)output->type;
+        record->safeState = (uint32_t)output->safeState;
+        record->path = ImageWriterIntern(&writer, (output->type == ConfigurationOutputTypeFile) ? output->file.path : NULL);
+        record->pin = (output->type == ConfigurationOutputTypeGPIO) ? output->gpio.pin : -1;
+        record->minOn = output->minOn;
+        record->minOff = output->minOff;
+        record->minDwell = output->minDwell;
+    }
+
+    for (size_t idx = 0; idx < self->totalBirds; idx++) {
+        const ConfigurationBird *bird = self->birds + idx;
+        ImageBird *record = birds + idx;
+
+        record->name = ImageWriterIntern(&writer, bird->name);
+        record->firstStatic = ImageWriterAppendReferences(&writer, bird->staticIndices, bird->totalStatics);
+        record->totalStatics = (uint32_t)bird->totalStatics;
+        record->firstBack = ImageWriterAppendReferences(&writer, bird->backIndices, bird->totalBacks);
+        record->totalBacks = (uint32_t)bird->totalBacks;
+        record->firstForward = ImageWriterAppendReferences(&writer, bird->forwardIndices, bird->totalForwards);
+        record->totalForwards = (uint32_t)bird->totalForwards;
+    }
+
+    for (size_t idx = 0; idx < self->totalShows; idx++) {
+        const ConfigurationShow *show = self->shows + idx;
+        ImageShow *record = shows + idx;
+
+        record->name = ImageWriterIntern(&writer, show->name);
+        record->firstBird = ImageWriterAppendReferences(&writer, show->birdIndices, show->totalBirds);
+        record->totalBirds = (uint32_t)show->totalBirds;
+    }
+
+    for (size_t idx = 0; idx < self->totalTriggers; idx++) {
+        const ConfigurationTrigger *trigger = self->triggers + idx;
+        ImageTrigger *record = triggers + idx;
+
+        record->name = ImageWriterIntern(&writer, trigger->name);
+        record->type = (uint32_t)trigger->type;
+        record->source = trigger->source;
+        record->show = ImageWriterIntern(&writer, trigger->show);
+        record->action = (uint32_t)trigger->action;
+        record->bird = ImageWriterIntern(&writer, trigger->bird);
+        record->showIndex = trigger->showIndex;
+        record->birdIndex = trigger->birdIndex;
+    }
+
+    header.watchdogPath = ImageWriterIntern(&writer, self->watchdogPath);
+    header.logLevels = ImageWriterIntern(&writer, self->logLevels);
+
+    size_t timingsSize = sizeof(ConfigurationTiming) * self->totalBirds;
+    size_t sourcesSize = sizeof(ImageSource) * self->totalSources;
+    ImageSource *sources = (ImageSource *)calloc(self->totalSources + 1, sizeof(ImageSource));
+
+    for (size_t idx = 0; idx < self->totalSources; idx++) {
+        sources[idx].path = ImageWriterIntern(&writer, self->sources[idx].path);
+        sources[idx].hash = self->sources[idx].hash;
+    }
+
+    // Lay out the image
+    size_t offset = ImageAlign(sizeof(ImageHeader));
+
+    header.stringsOffset = (uint32_t)offset;
+    header.stringsSize = (uint32_t)writer.stringsSize;
+    offset = ImageAlign(offset + writer.stringsSize);
+
+    header.outputsOffset = (uint32_t)offset;
+    header.totalOutputs = (uint32_t)self->totalOutputs;
+    offset = ImageAlign(offset + outputsSize);
+
+    header.birdsOffset = (uint32_t)offset;
+    header.totalBirds = (uint32_t)self->totalBirds;
+    offset = ImageAlign(offset + birdsSize);
+
+    header.showsOffset = (uint32_t)offset;
+    header.totalShows = (uint32_t)self->totalShows;
+    offset = ImageAlign(offset + showsSize);
+
+    header.triggersOffset = (uint32_t)offset;
+    header.totalTriggers = (uint32_t)self->totalTriggers;
+    offset = ImageAlign(offset + triggersSize);
+
+    header.referencesOffset = (uint32_t)offset;
+    header.totalReferences = (uint32_t)writer.totalReferences;
+    offset = ImageAlign(offset + (sizeof(uint32_t) * writer.totalReferences));
+
+    header.sourcesOffset = (uint32_t)offset;
+    header.totalSources = (uint32_t)self->totalSources;
+    offset = ImageAlign(offset + sourcesSize);
+
+    header.timingsOffset = (uint32_t)offset;
+    offset = ImageAlign(offset + timingsSize);
+
+    header.magic = IMAGE_MAGIC;
+    header.version = CONFIGURATION_IMAGE_VERSION;
+    header.totalSize = offset;
+    header.sourceHash = sourceHash;
+
+    header.minWait = self->minWait;
+    header.maxWait = self->maxWait;
+    header.minPecks = self->minPecks;
+    header.maxPecks = self->maxPecks;
+    header.peckWait = self->peckWait;
+    header.watchdogInterval = self->watchdogInterval;
+
+    image = (uint8_t *)calloc(1, offset);
+
+    memcpy(image + header.stringsOffset, writer.strings, writer.stringsSize);
+    memcpy(image + header.outputsOffset, outputs, outputsSize);
+    memcpy(image + header.birdsOffset, birds, birdsSize);
+    memcpy(image + header.showsOffset, shows, showsSize);
+    memcpy(image + header.triggersOffset, triggers, triggersSize);
+    memcpy(image + header.referencesOffset, writer.references, sizeof(uint32_t) * writer.totalReferences);
+    memcpy(image + header.sourcesOffset, sources, sourcesSize);
+    memcpy(image + header.timingsOffset, self->timings, timingsSize);
+
+    SAFE_DESTROY(outputs, free);
+    SAFE_DESTROY(birds, free);
+    SAFE_DESTROY(shows, free);
+    SAFE_DESTROY(triggers, free);
+    SAFE_DESTROY(sources, free);
+
+    header.checksum = HashBytes(FNV_OFFSET_BASIS, image + sizeof(ImageHeader), offset - sizeof(ImageHeader));
+    memcpy(image, &header, sizeof(ImageHeader));
+
+    // Write next to the destination, then move in to place so readers never see a partial image
+    size_t temporaryPathSize = strlen(path) + 5;
+    temporaryPath = (char *)malloc(temporaryPathSize);
+    snprintf(temporaryPath, temporaryPathSize, "%s.tmp", path);
+
+    fd = open(temporaryPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (fd == -1) {
+        LogErrno(TAG, errno, "Failed to create configuration image %s", temporaryPath);
+        goto write_image_cleanup;
+    }
+
+    size_t written = 0;
+
+    while (written < offset) {
+        ssize_t result = write(fd, image + written, offset - written);
+
+        if (result == -1 && errno == EINTR) {
+            continue;
+        } else if (result <= 0) {
+            LogErrno(TAG, errno, "Failed to write configuration image %s", temporaryPath);
+            goto write_image_cleanup;
+        }
+
+        written += (size_t)result;
+    }
+
+    close(fd);
+    fd = -1;
+
+    if (rename(temporaryPath, path) == -1) {
+        LogErrno(TAG, errno, "Failed to move configuration image in to place at %s", path);
+        goto write_image_cleanup;
+    }
+
+    LogI(TAG, "Wrote %zu byte configuration image to %s", offset, path);
+
+    success = true;
+
+write_image_cleanup:
+
+    if (fd != -1) {
+        close(fd);
+        unlink(temporaryPath);
+    }
+
+    SAFE_DESTROY(temporaryPath, free);
+    SAFE_DESTROY(image, free);
+    SAFE_DESTROY(writer.strings, free);
+    SAFE_DESTROY(writer.stringOffsets, free);
+    SAFE_DESTROY(writer.slots, free);
+    SAFE_DESTROY(writer.references, free);
+
+    return success;
+}
+
+bool ConfigurationHashFile(const char *path, uint64_t *hash) {
+    FILE *file = fopen(path, "r");
+
+    if (file == NULL) {
+        LogErrno(TAG, errno, "Failed to open %s for hashing", path);
+        return false;
+    }
+
+    uint8_t buffer[16384];
+    uint64_t value = FNV_OFFSET_BASIS;
+    size_t bytesRead = 0;
+
+    while ((bytesRead = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        value = HashBytes(value, buffer, bytesRead);
+    }
+
+    bool success = (ferror(file) == 0);
+
+    if (!success) {
+        LogE(TAG, "Failed to read %s for hashing", path);
+    }
+
+    fclose(file);
+
+    *hash = value;
+
+    return success;
+}
+
+uint64_t ConfigurationHashBytes(const void *bytes, size_t size) {
+    return HashBytes(FNV_OFFSET_BASIS, bytes, size);
+}
+
+static ConfigurationRef ConfigurationLoadImage(void *mapping, size_t mappingSize) {
+    const ImageHeader *header = (const ImageHeader *)mapping;
+    const uint8_t *image = (const uint8_t *)mapping;
+    const char *strings = (const char *)(image + header->stringsOffset);
+    const ImageOutput *outputs = (const ImageOutput *)(image + header->outputsOffset);
+    const ImageBird *birds = (const ImageBird *)(image + header->birdsOffset);
+    const ImageShow *shows = (const ImageShow *)(image + header->showsOffset);
+    const ImageTrigger *triggers = (const ImageTrigger *)(image + header->triggersOffset);
+    const uint32_t *references = (const uint32_t *)(image + header->referencesOffset);
+    const ImageSource *sources = (const ImageSource *)(image + header->sourcesOffset);
+
+    // Every array is carved out of one arena block. Name lists point straight at the string table.
+    size_t size = ARENA_ALIGN(sizeof(Configuration))
+        + ARENA_ALIGN(sizeof(ConfigurationOutput) * header->totalOutputs)
+        + ARENA_ALIGN(sizeof(ConfigurationBird) * header->totalBirds)
+        + ARENA_ALIGN(sizeof(ConfigurationShow) * header->totalShows)
+        + ARENA_ALIGN(sizeof(ConfigurationTrigger) * header->totalTriggers)
+        + ARENA_ALIGN(sizeof(char *) * header->totalReferences)
+        + ARENA_ALIGN(sizeof(ConfigurationSource) * header->totalSources);
+
+    ArenaRef arena = ArenaCreate(size);
+
+    ConfigurationRef self = (ConfigurationRef)ArenaAllocate(arena, sizeof(Configuration));
+    self->arena = arena;
+    self->image = mapping;
+    self->imageSize = mappingSize;
+
+    self->outputs = (ConfigurationOutput *)ArenaAllocate(arena, sizeof(ConfigurationOutput) * header->totalOutputs);
+    self->birds = (ConfigurationBird *)ArenaAllocate(arena, sizeof(ConfigurationBird) * header->totalBirds);
+    self->shows = (ConfigurationShow *)ArenaAllocate(arena, sizeof(ConfigurationShow) * header->totalShows);
+    self->triggers = (ConfigurationTrigger *)ArenaAllocate(arena, sizeof(ConfigurationTrigger) * header->totalTriggers);
+    self->sources = (ConfigurationSource *)ArenaAllocate(arena, sizeof(ConfigurationSource) * header->totalSources);
+
+    const char **names = (const char **)ArenaAllocate(arena, sizeof(char *) * header->totalReferences);
+
+    #define IMAGE_STRING(O) (((O) == IMAGE_NONE) ? NULL : (strings + (O)))
+
+    self->minWait = header->minWait;
+    self->maxWait = header->maxWait;
+    self->minPecks = header->minPecks;
+    self->maxPecks = header->maxPecks;
+    self->peckWait = header->peckWait;
+    self->watchdogInterval = header->watchdogInterval;
+    self->watchdogPath = IMAGE_STRING(header->watchdogPath);
+    self->logLevels = IMAGE_STRING(header->logLevels);
+
+    for (size_t idx = 0; idx < header->totalOutputs; idx++) {
+        ConfigurationOutput *output = self->outputs + idx;
+
+        output->name = IMAGE_STRING(outputs[idx].name);
+        output->type = (ConfigurationOutputType)outputs[idx].type;
+        output->safeState = (ConfigurationSafeState)outputs[idx].safeState;
+        output->minOn = outputs[idx].minOn;
+        output->minOff = outputs[idx].minOff;
+        output->minDwell = outputs[idx].minDwell;
+
+        if (output->type == ConfigurationOutputTypeFile) {
+            output->file.path = IMAGE_STRING(outputs[idx].path);
+        } else if (output->type == ConfigurationOutputTypeGPIO) {
+            output->gpio.pin = outputs[idx].pin;
+        }
+    }
+
+    self->totalOutputs = header->totalOutputs;
+
+    for (size_t idx = 0; idx < header->totalBirds; idx++) {
+        ConfigurationBird *bird = self->birds + idx;
+
+        bird->name = IMAGE_STRING(birds[idx].name);
+
+        bird->statics = names + birds[idx].firstStatic;
+        bird->totalStatics = birds[idx].totalStatics;
+
+        bird->backs = names + birds[idx].firstBack;
+        bird->totalBacks = birds[idx].totalBacks;
+
+        bird->forwards = names + birds[idx].firstForward;
+        bird->totalForwards = birds[idx].totalForwards;
+
+        // The references are already indices, so they are used in place
+        bird->staticIndices = references + birds[idx].firstStatic;
+        bird->backIndices = references + birds[idx].firstBack;
+        bird->forwardIndices = references + birds[idx].firstForward;
+
+        for (size_t refIdx = birds[idx].firstStatic; refIdx < birds[idx].firstStatic + birds[idx].totalStatics; refIdx++) {
+            names[refIdx] = self->outputs[references[refIdx]].name;
+        }
+
+        for (size_t refIdx = birds[idx].firstBack; refIdx < birds[idx].firstBack + birds[idx].totalBacks; refIdx++) {
+            names[refIdx] = self->outputs[references[refIdx]].name;
+        }
+
+        for (size_t refIdx = birds[idx].firstForward; refIdx < birds[idx].firstForward + birds[idx].totalForwards; refIdx++) {
+            names[refIdx] = self->outputs[references[refIdx]].name;
+        }
+    }
+
+    self->totalBirds = header->totalBirds;
+
+    // The timings are stored just as they are resolved, so they are used in place too
+    self->timings = (const ConfigurationTiming *)(image + header->timingsOffset);
+
+    for (size_t idx = 0; idx < header->totalShows; idx++) {
+        ConfigurationShow *show = self->shows + idx;
+
+        show->name = IMAGE_STRING(shows[idx].name);
+        show->birds = names + shows[idx].firstBird;
+        show->birdIndices = references + shows[idx].firstBird;
+        show->totalBirds = shows[idx].totalBirds;
+
+        for (size_t refIdx = shows[idx].firstBird; refIdx < shows[idx].firstBird + shows[idx].totalBirds; refIdx++) {
+            names[refIdx] = self->birds[references[refIdx]].name;
+        }
+    }
+
+    self->totalShows = header->totalShows;
+
+    for (size_t idx = 0; idx < header->totalTriggers; idx++) {
+        ConfigurationTrigger *trigger = self->triggers + idx;
+
+        trigger->name = IMAGE_STRING(triggers[idx].name);
+        trigger->type = (ConfigurationTriggerType)triggers[idx].type;
+        trigger->source = triggers[idx].source;
+        trigger->hasSource = true;
+        trigger->show = IMAGE_STRING(triggers[idx].show);
+        trigger->action = (ConfigurationTriggerAction)triggers[idx].action;
+        trigger->bird = IMAGE_STRING(triggers[idx].bird);
+        trigger->showIndex = triggers[idx].showIndex;
+        trigger->birdIndex = triggers[idx].birdIndex;
+    }
+
+    self->totalTriggers = header->totalTriggers;
+
+    for (size_t idx = 0; idx < header->totalSources; idx++) {
+        self->sources[idx].path = IMAGE_STRING(sources[idx].path);
+        self->sources[idx].hash = sources[idx].hash;
+    }
+
+    self->totalSources = header->totalSources;
+    self->isResolved = true;
+    self->totalAllocations = ArenaGetTotalAllocations(arena);
+
+    #undef IMAGE_STRING
+
+    return self;
+}
+
+static bool ConfigurationValidateImage(const void *image, size_t imageSize, uint64_t sourceHash) {
+    const ImageHeader *header = (const ImageHeader *)image;
+
+    if (header->magic != IMAGE_MAGIC) {
+        LogE(TAG, "Configuration image has an invalid magic number");
+        return false;
+    } else if (header->version != CONFIGURATION_IMAGE_VERSION) {
+        LogI(TAG, "Configuration image version %" PRIu32 " does not match %i", header->version, CONFIGURATION_IMAGE_VERSION);
+        return false;
+    } else if (header->totalSize != imageSize) {
+        LogE(TAG, "Configuration image is truncated");
+        return false;
+    } else if (header->sourceHash != sourceHash) {
+        LogI(TAG, "Configuration image is out of date");
+        return false;
+    }
+
+    uint64_t checksum = HashBytes(FNV_OFFSET_BASIS, (const uint8_t *)image + sizeof(ImageHeader), imageSize - sizeof(ImageHeader));
+
+    if (checksum != header->checksum) {
+        LogE(TAG, "Configuration image checksum does not match");
+        return false;
+    }
+
+    // Every section must be inside the image, and every string and reference inside its table
+    #define SECTION_FITS(O, C, S) ((uint64_t)(O) + ((uint64_t)(C) * (S)) <= imageSize && ((O) % sizeof(uint32_t)) == 0)
+    #define STRING_FITS(O) ((O) == IMAGE_NONE || (O) < header->stringsSize)
+    #define INDEX_FITS(I, T) ((I) == IMAGE_NONE || (I) < (T))
+    #define REFERENCES_FIT(F, C, T) ((uint64_t)(F) + (C) <= header->totalReferences && ImageReferencesFit(references, (F), (C), (T)))
+
+    if (!SECTION_FITS(header->stringsOffset, header->stringsSize, 1)
+        || !SECTION_FITS(header->outputsOffset, header->totalOutputs, sizeof(ImageOutput))
+        || !SECTION_FITS(header->birdsOffset, header->totalBirds, sizeof(ImageBird))
+        || !SECTION_FITS(header->showsOffset, header->totalShows, sizeof(ImageShow))
+        || !SECTION_FITS(header->triggersOffset, header->totalTriggers, sizeof(ImageTrigger))
+        || !SECTION_FITS(header->referencesOffset, header->totalReferences, sizeof(uint32_t))
+        || !SECTION_FITS(header->sourcesOffset, header->totalSources, sizeof(ImageSource))
+        || !SECTION_FITS(header->timingsOffset, header->totalBirds, sizeof(ConfigurationTiming))
+        || (header->sourcesOffset % IMAGE_ALIGNMENT) != 0) {
+        LogE(TAG, "Configuration image has a section out of bounds");
+        return false;
+    }
+
+    const uint8_t *bytes = (const uint8_t *)image;
+    const char *strings = (const char *)(bytes + header->stringsOffset);
+
+    if (header->stringsSize > 0 && strings[header->stringsSize - 1] != '\0') {
+        LogE(TAG, "Configuration image has an unterminated string table");
+        return false;
+    }
+
+    bool isValid = STRING_FITS(header->watchdogPath) && STRING_FITS(header->logLevels);
+
+    const ImageOutput *outputs = (const ImageOutput *)(bytes + header->outputsOffset);
+
+    for (size_t idx = 0; idx < header->totalOutputs && isValid; idx++) {
+        isValid = outputs[idx].name != IMAGE_NONE && STRING_FITS(outputs[idx].name) && STRING_FITS(outputs[idx].path);
+    }
+
+    const uint32_t *references = (const uint32_t *)(bytes + header->referencesOffset);
+    const ImageBird *birds = (const ImageBird *)(bytes + header->birdsOffset);
+
+    for (size_t idx = 0; idx < header->totalBirds && isValid; idx++) {
+        isValid = birds[idx].name != IMAGE_NONE && STRING_FITS(birds[idx].name)
+            && REFERENCES_FIT(birds[idx].firstStatic, birds[idx].totalStatics, header->totalOutputs)
+            && REFERENCES_FIT(birds[idx].firstBack, birds[idx].totalBacks, header->totalOutputs)
+            && REFERENCES_FIT(birds[idx].firstForward, birds[idx].totalForwards, header->totalOutputs);
+    }
+
+    const ImageShow *shows = (const ImageShow *)(bytes + header->showsOffset);
+
+    for (size_t idx = 0; idx < header->totalShows && isValid; idx++) {
+        isValid = shows[idx].name != IMAGE_NONE && STRING_FITS(shows[idx].name)
+            && REFERENCES_FIT(shows[idx].firstBird, shows[idx].totalBirds, header->totalBirds);
+    }
+
+    const ImageTrigger *triggers = (const ImageTrigger *)(bytes + header->triggersOffset);
+
+    for (size_t idx = 0; idx < header->totalTriggers && isValid; idx++) {
+        isValid = triggers[idx].name != IMAGE_NONE && STRING_FITS(triggers[idx].name) && STRING_FITS(triggers[idx].show) && STRING_FITS(triggers[idx].bird)
+            && INDEX_FITS(triggers[idx].showIndex, header->totalShows) && INDEX_FITS(triggers[idx].birdIndex, header->totalBirds);
+    }
+
+    const ImageSource *sources = (const ImageSource *)(bytes + header->sourcesOffset);
+
+    for (size_t idx = 0; idx < header->totalSources && isValid; idx++) {
+        isValid = sources[idx].path != IMAGE_NONE && STRING_FITS(sources[idx].path);
+    }
+
+    #undef SECTION_FITS
+    #undef STRING_FITS
+    #undef INDEX_FITS
+    #undef REFERENCES_FIT
+
+    if (!isValid) {
+        LogE(TAG, "Configuration image has an invalid record");
+        return false;
+    }
+
+    // The image is only current if every file it was merged from is unchanged
+    for (size_t idx = 0; idx < header->totalSources; idx++) {
+        const char *path = strings + sources[idx].path;
+        uint64_t hash = 0;
+
+        if (!ConfigurationHashFile(path, &hash) || hash != sources[idx].hash) {
+            LogI(TAG, "Configuration image is out of date, %s has changed", path);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// MARK: - Utilities
+
+static void * CompactArray(ArenaRef arena, const void *items, size_t itemSize, size_t total) {
+    if (total == 0) {
+        return NULL;
+    }
+
+    void *compacted = ArenaAllocate(arena, itemSize * total);
+    memcpy(compacted, items, itemSize * total);
+
+    return compacted;
+}
+
+static const char * CompactString(ArenaRef arena, const char *value) {
+    if (value == NULL) {
+        return NULL;
+    }
+
+    return ArenaIntern(arena, value, strlen(value));
+}
+
+static bool ImageReferencesFit(const uint32_t *references, uint32_t first, uint32_t total, uint32_t limit) {
+    for (uint32_t idx = first; idx < first + total; idx++) {
+        if (references[idx] >= limit) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static uint64_t HashBytes(uint64_t hash, const void *bytes, size_t size) {
+    const uint8_t *values = (const uint8_t *)bytes;
+
+    for (size_t idx = 0; idx < size; idx++) {
+        hash ^= values[idx];
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+static size_t ImageAlign(size_t size) {
+    return (size + (IMAGE_ALIGNMENT - 1)) & ~((size_t)IMAGE_ALIGNMENT - 1);
+}
+
+static uint32_t ImageWriterAppendReferences(ImageWriter *writer, const uint32_t *references, size_t total) {
+    uint32_t first = (uint32_t)writer->totalReferences;
+
+    if (total == 0) {
+        return first;
+    }
+
+    writer->references = (uint32_t *)realloc(writer->references, sizeof(uint32_t) * (writer->totalReferences + total));
+    memcpy(writer->references + writer->totalReferences, references, sizeof(uint32_t) * total);
+    writer->totalReferences += total;
+
+    return first;
+}
+
+static uint32_t ImageWriterFind(const ImageWriter *writer, const char *value) {
+    if (writer->slotsCapacity == 0) {
+        return IMAGE_NONE;
+    }
+
+    size_t mask = writer->slotsCapacity - 1;
+    size_t slot = (size_t)HashBytes(FNV_OFFSET_BASIS, value, strlen(value)) & mask;
+
+    while (writer->slots[slot] != 0) {
+        uint32_t string = writer->slots[slot] - 1;
+
+        if (strcmp(writer->strings + writer->stringOffsets[string], value) == 0) {
+            return string;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+
+    return IMAGE_NONE;
+}
+
+static uint32_t ImageWriterIntern(ImageWriter *writer, const char *value) {
+    if (value == NULL) {
+        return IMAGE_NONE;
+    }
+
+    uint32_t string = ImageWriterFind(writer, value);
+
+    if (string != IMAGE_NONE) {
+        return writer->stringOffsets[string];
+    }
+
+    // Keep the table at most half full
+    if ((writer->totalStrings + 1) * 2 > writer->slotsCapacity) {
+        ImageWriterResize(writer);
+    }
+
+    size_t valueSize = strlen(value) + 1;
+
+    if (writer->stringsSize + valueSize > writer->stringsCapacity) {
+        writer->stringsCapacity = (writer->stringsCapacity == 0) ? 4096 : writer->stringsCapacity * 2;
+
+        while (writer->stringsSize + valueSize > writer->stringsCapacity) {
+            writer->stringsCapacity *= 2;
+        }
+
+        writer->strings = (char *)realloc(writer->strings, writer->stringsCapacity);
+    }
+
+    uint32_t offset = (uint32_t)writer->stringsSize;
+    memcpy(writer->strings + offset, value, valueSize);
+    writer->stringsSize += valueSize;
+
+    string = (uint32_t)writer->totalStrings;
+    writer->stringOffsets = (uint32_t *)realloc(writer->stringOffsets, sizeof(uint32_t) * (writer->totalStrings + 1));
+    writer->stringOffsets[string] = offset;
+    writer->totalStrings += 1;
+
+    size_t mask = writer->slotsCapacity - 1;
+    size_t slot = (size_t)HashBytes(FNV_OFFSET_BASIS, value, valueSize - 1) & mask;
+
+    while (writer->slots[slot] != 0) {
+        slot = (slot + 1) & mask;
+    }
+
+    writer->slots[slot] = string + 1;
+
+    return offset;
+}
+
+static void ImageWriterResize(ImageWriter *writer) {
+    size_t capacity = (writer->slotsCapacity == 0) ? 64 : writer->slotsCapacity * 2;
+    uint32_t *slots = (uint32_t *)calloc(capacity, sizeof(uint32_t));
+    size_t mask = capacity - 1;
+
+    for (size_t string = 0; string < writer->totalStrings; string++) {
+        const char *value = writer->strings + writer->stringOffsets[string];
+        size_t slot = (size_t)HashBytes(FNV_OFFSET_BASIS, value, strlen(value)) & mask;
+
+        while (slots[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+
+        slots[slot] = (uint32_t)string + 1;
+    }
+
+    SAFE_DESTROY(writer->slots, free);
+
+    writer->slots = slots;
+    writer->slotsCapacity = capacity;
+}
+
+static bool ConfigurationMergeSetting(Configuration *self, const Configuration *fragment, ScalarKey key) {
+    if ((self->parsedSettings & (1u << key)) != 0) {
+        LogE(TAG, "Duplicate setting: %s", ConfigurationSettingName(key));
+        return false;
+    }
+
+    switch (key) {
+        case ScalarKeyMinWait:
+            self->minWait = fragment->minWait;
+            break;
+        case ScalarKeyMaxWait:
+            self->maxWait = fragment->maxWait;
+            break;
+        case ScalarKeyMinPecks:
+            self->minPecks = fragment->minPecks;
+            break;
+        case ScalarKeyMaxPecks:
+            self->maxPecks = fragment->maxPecks;
+            break;
+        case ScalarKeyPeckWait:
+            self->peckWait = fragment->peckWait;
+            break;
+        case ScalarKeyWatchdog:
+            self->watchdogPath = fragment->watchdogPath;
+            break;
+        case ScalarKeyWatchdogInterval:
+            self->watchdogInterval = fragment->watchdogInterval;
+            break;
+        case ScalarKeyLogLevels:
+            self->logLevels = fragment->logLevels;
+            break;
+        default:
+            break;
+    }
+
+    self->parsedSettings |= (1u << key);
+
+    return true;
+}
+
+static bool NameIndexBuild(NameIndex *index, ArenaRef scratch, const char *kind, const void *items, size_t itemSize, size_t nameOffset, size_t total) {
+    size_t capacity = 8;
+
+    while (capacity < total * 2) {
+        capacity *= 2;
+    }
+
+    index->names = (const char **)ArenaAllocate(scratch, sizeof(char *) * capacity);
+    index->indices = (uint32_t *)ArenaAllocate(scratch, sizeof(uint32_t) * capacity);
+    index->mask = capacity - 1;
+
+    for (size_t idx = 0; idx < total; idx++) {
+        const char *name = *(const char **)((const uint8_t *)items + (idx * itemSize) + nameOffset);
+
+        uint64_t hash = (uint64_t)(uintptr_t)name * POINTER_HASH_MULTIPLIER;
+        size_t slot = (size_t)(hash >> 32) & index->mask;
+
+        while (index->names[slot] != NULL) {
+            if (index->names[slot] == name) {
+                LogE(TAG, "Duplicate %s name: %s", kind, name);
+                return false;
+            }
+
+            slot = (slot + 1) & index->mask;
+        }
+
+        index->names[slot] = name;
+        index->indices[slot] = (uint32_t)idx;
+    }
+
+    return true;
+}
+
+static uint32_t NameIndexFind(const NameIndex *index, const char *name) {
+    uint64_t hash = (uint64_t)(uintptr_t)name * POINTER_HASH_MULTIPLIER;
+    size_t slot = (size_t)(hash >> 32) & index->mask;
+
+    while (index->names[slot] != NULL) {
+        if (index->names[slot] == name) {
+            return index->indices[slot];
+        }
+
+        slot = (slot + 1) & index->mask;
+    }
+
+    return CONFIGURATION_INDEX_NONE;
+}
+
+static const char * ConfigurationSettingName(ScalarKey key) {
+    switch (key) {
+        case ScalarKeyMinWait:
+            return "MinWait";
+            break;
+        case ScalarKeyMaxWait:
+            return "MaxWait";
+            break;
+        case ScalarKeyMinPecks:
+            return "MinPecks";
+            break;
+        case ScalarKeyMaxPecks:
+            return "MaxPecks";
+            break;
+        case ScalarKeyPeckWait:
+            return "PeckWait";
+            break;
+        case ScalarKeyWatchdog:
+            return "Watchdog";
+            break;
+        case ScalarKeyWatchdogInterval:
+            return "WatchdogInterval";
+            break;
+        case ScalarKeyLogLevels:
+            return "LogLevels";
+            break;
+        default:
+            break;
+    }
+
+    return "ERROR";
+}
+
+static void ConfigurationTimingApply(ConfigurationTiming *timing, const ConfigurationTiming *overrides) {
+    if ((overrides->overrides & ConfigurationTimingOverrideMinWait) != 0) {
+        timing->minWait = overrides->minWait;
+    }
+
+    if ((overrides->overrides & ConfigurationTimingOverrideMaxWait) != 0) {
+        timing->maxWait = overrides->maxWait;
+    }
+
+    if ((overrides->overrides & ConfigurationTimingOverrideMinPecks) != 0) {
+        timing->minPecks = overrides->minPecks;
+    }
+
+    if ((overrides->overrides & ConfigurationTimingOverrideMaxPecks) != 0) {
+        timing->maxPecks = overrides->maxPecks;
+    }
+
+    if ((overrides->overrides & ConfigurationTimingOverridePeckWait) != 0) {
+        timing->peckWait = overrides->peckWait;
+    }
+
+    timing->overrides |= overrides->overrides;
+}
+
+static ScalarKey ConfigurationTimingKey(const char *value) {
+    for (ScalarKey key = ScalarKeyMinWait; key <= ScalarKeyPeckWait; key++) {
+        if (strcmp(value, ConfigurationSettingName(key)) == 0) {
+            return key;
+        }
+    }
+
+    return ScalarKeyNone;
+}
+
+static void ConfigurationTimingSet(ConfigurationTiming *timing, ScalarKey key, const char *value) {
+    uint32_t number = (uint32_t)strtol(value, NULL, 10);
+
+    switch (key) {
+        case ScalarKeyMinWait:
+            timing->minWait = number;
+            break;
+        case ScalarKeyMaxWait:
+            timing->maxWait = number;
+            break;
+        case ScalarKeyMinPecks:
+            timing->minPecks = number;
+            break;
+        case ScalarKeyMaxPecks:
+            timing->maxPecks = number;
+            break;
+        case ScalarKeyPeckWait:
+            timing->peckWait = number;
+            break;
+        default:
+            return;
+    }
+
+    // NOTE: The override bits are in the same order as the keys
+    timing->overrides |= (1u << (key - ScalarKeyMinWait));
+}
+
+static void ConfigurationBirdReset(ConfigurationBird * NONNULL bird) {
+    memset(bird, 0, sizeof(ConfigurationBird));
+}
+
+static void ConfigurationGroupReset(ConfigurationGroup *group) {
+    memset(group, 0, sizeof(ConfigurationGroup));
+}
+
+static void ConfigurationOutputReset(ConfigurationOutput *output) {
+    memset(output, 0, sizeof(ConfigurationOutput));
+}
+
+static void ConfigurationShowReset(ConfigurationShow *show) {
+    memset(show, 0, sizeof(ConfigurationShow));
+}
+
+static void ConfigurationTriggerReset(ConfigurationTrigger *trigger) {
+    memset(trigger, 0, sizeof(ConfigurationTrigger));
+}
+
+
+// MARK: - Debug
+
+size_t ConfigurationGetTotalAllocations(const ConfigurationRef self) {
+    return self->totalAllocations;
+}
 
 void ConfigurationSetDumpParseEvents(bool dump) {
     DumpParseEvents = dump;
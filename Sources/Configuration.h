@@ -25,6 +25,18 @@ BEGIN_DECLS
 /// The Configuration object
 typedef struct _Configuration * ConfigurationRef;
 
+/// The version of the compiled image format. Images with any other version are ignored.
+#define CONFIGURATION_IMAGE_VERSION 5
+
+/// The resolved index of a reference that names nothing.
+#define CONFIGURATION_INDEX_NONE UINT32_MAX
+
+/// The character in a template's names that is replaced with each index of its range.
+#define CONFIGURATION_TEMPLATE_PLACEHOLDER '$'
+
+/// The most instances a single template can make.
+#define CONFIGURATION_MAX_TEMPLATE_INSTANCES 100000
+
 /// The output type
 typedef enum _ConfigurationOutputType {
     ConfigurationOutputTypeUnknown = 0, ///< The output is unknown
@@ -33,6 +45,48 @@ typedef enum _ConfigurationOutputType {
     ConfigurationOutputTypeGPIO,        ///< The output is GPIO-based
 } ConfigurationOutputType;
 
+/// The state an output is put in when the process stops or crashes
+typedef enum _ConfigurationSafeState {
+    ConfigurationSafeStateOff = 0, ///< The output is turned off
+    ConfigurationSafeStateOn,      ///< The output is turned on
+    ConfigurationSafeStateHold,    ///< The output keeps its current value
+} ConfigurationSafeState;
+
+/// The source of a trigger
+typedef enum _ConfigurationTriggerType {
+    ConfigurationTriggerTypeUnknown = 0, ///< The trigger is unknown
+    ConfigurationTriggerTypeInput,       ///< The trigger comes from an input
+    ConfigurationTriggerTypeCommand,     ///< The trigger comes from a remote command
+    ConfigurationTriggerTypeSchedule,    ///< The trigger comes from a schedule
+    ConfigurationTriggerTypeCue,         ///< The trigger comes from a cue
+} ConfigurationTriggerType;
+
+/// The behavior a trigger causes
+typedef enum _ConfigurationTriggerAction {
+    ConfigurationTriggerActionPeck = 0, ///< A bird pecks
+    ConfigurationTriggerActionStart,    ///< The show starts
+    ConfigurationTriggerActionStop,     ///< The show stops
+} ConfigurationTriggerAction;
+
+/// The timing settings a bird or group may override, as bits
+typedef enum _ConfigurationTimingOverride {
+    ConfigurationTimingOverrideMinWait = 1 << 0,  ///< The minimum wait is overridden
+    ConfigurationTimingOverrideMaxWait = 1 << 1,  ///< The maximum wait is overridden
+    ConfigurationTimingOverrideMinPecks = 1 << 2, ///< The minimum pecks are overridden
+    ConfigurationTimingOverrideMaxPecks = 1 << 3, ///< The maximum pecks are overridden
+    ConfigurationTimingOverridePeckWait = 1 << 4, ///< The peck wait is overridden
+} ConfigurationTimingOverride;
+
+/// The timing of a bird, with its own and its group's settings applied over the global settings
+typedef struct _ConfigurationTiming {
+    uint32_t minWait;   ///< The minimum time, in milliseconds, between peck sequences
+    uint32_t maxWait;   ///< The maximum time, in milliseconds, between peck sequences
+    uint32_t minPecks;  ///< The minimum number of pecks in a sequence
+    uint32_t maxPecks;  ///< The maximum number of pecks in a sequence
+    uint32_t peckWait;  ///< The time, in milliseconds, between peck movements
+    uint32_t overrides; ///< The `ConfigurationTimingOverride` bits set by the bird or its group
+} ConfigurationTiming;
+
 
 // MARK: - Lifecycle Methods
 
@@ -46,6 +100,7 @@ ConfigurationRef NONNULL ConfigurationCreate(void);
  * Create a Configuration with values from a given YAML file.
  * \param path The path to load the settings from.
  * \return A new Configuration instance, or `NULL` if an error occurred.
+ * \note Only this file is parsed. Use a Configuration Loader to follow its includes.
  */
 ConfigurationRef NULLABLE ConfigurationCreateFromFile(const char * NONNULL path);
 
@@ -56,6 +111,18 @@ ConfigurationRef NULLABLE ConfigurationCreateFromFile(const char * NONNULL path)
  */
 ConfigurationRef NULLABLE ConfigurationCreateFromString(const char * NONNULL value);
 
+/**
+ * Create a Configuration by merging parsed fragments in order.
+ * \param fragments The Configurations to merge.
+ * \param totalFragments The number of fragments.
+ * \param paths The path of each file the fragments were parsed from.
+ * \param hashes The hash of the contents of each file.
+ * \param totalSources The number of files.
+ * \return A new Configuration instance, or `NULL` if a setting is set more than once, or an output, bird, show or trigger name is used more than once.
+ * \note Includes are not followed. The paths and hashes become the sources of the new Configuration.
+ */
+ConfigurationRef NULLABLE ConfigurationCreateMerged(const ConfigurationRef NONNULL * NONNULL fragments, size_t totalFragments, const char * NONNULL * NULLABLE paths, const uint64_t * NULLABLE hashes, size_t totalSources);
+
 /**
  * Destroy a Configuration instance.
  * \param configuration The instance to destroy.
@@ -100,6 +167,27 @@ uint32_t ConfigurationGetMaxPecks(const ConfigurationRef NONNULL configuration);
  */
 uint32_t ConfigurationGetPeckWait(const ConfigurationRef NONNULL configuration);
 
+/**
+ * Get the path of the hardware watchdog to pet.
+ * \param configuration The instance to inspect.
+ * \return The path of the watchdog device, or `NULL` if no watchdog is used.
+ */
+const char * NULLABLE ConfigurationGetWatchdogPath(const ConfigurationRef NONNULL configuration);
+
+/**
+ * Get the time between pets of the hardware watchdog.
+ * \param configuration The instance to inspect.
+ * \return The time in milliseconds between pets of the watchdog.
+ */
+uint32_t ConfigurationGetWatchdogInterval(const ConfigurationRef NONNULL configuration);
+
+/**
+ * Get the levels to filter log tags to.
+ * \param configuration The instance to inspect.
+ * \return The levels, as accepted by `LogSetTagLevels`, or `NULL` if the defaults are used.
+ */
+const char * NULLABLE ConfigurationGetLogLevels(const ConfigurationRef NONNULL configuration);
+
 
 // MARK: - Outputs
 
@@ -127,6 +215,38 @@ const char * NULLABLE ConfigurationGetOutputPath(const ConfigurationRef NONNULL
  */
 int ConfigurationGetOutputPin(const ConfigurationRef NONNULL configuration, size_t idx);
 
+/**
+ * Get the minimum time between changes of an output at the given index.
+ * \param configuration The instance to inspect.
+ * \param idx The index of the output.
+ * \return The minimum time in milliseconds between changes, or `0` for no limit.
+ */
+uint32_t ConfigurationGetOutputMinDwell(const ConfigurationRef NONNULL configuration, size_t idx);
+
+/**
+ * Get the minimum time an output at the given index stays off.
+ * \param configuration The instance to inspect.
+ * \param idx The index of the output.
+ * \return The minimum time in milliseconds the output stays off, or `0` for no limit.
+ */
+uint32_t ConfigurationGetOutputMinOff(const ConfigurationRef NONNULL configuration, size_t idx);
+
+/**
+ * Get the minimum time an output at the given index stays on.
+ * \param configuration The instance to inspect.
+ * \param idx The index of the output.
+ * \return The minimum time in milliseconds the output stays on, or `0` for no limit.
+ */
+uint32_t ConfigurationGetOutputMinOn(const ConfigurationRef NONNULL configuration, size_t idx);
+
+/**
+ * Get the safe state of an output at the given index.
+ * \param configuration The instance to inspect.
+ * \param idx The index of the output.
+ * \return The safe state of the output, which is off unless configured otherwise.
+ */
+ConfigurationSafeState ConfigurationGetOutputSafeState(const ConfigurationRef NONNULL configuration, size_t idx);
+
 /**
  * Get the type of an output at the given index.
  * \param configuration The instance to inspect.
@@ -212,8 +332,293 @@ size_t ConfigurationGetBirdTotalStatics(const ConfigurationRef NONNULL configura
 size_t ConfigurationGetTotalBirds(const ConfigurationRef NONNULL configuration);
 
 
+// MARK: - Shows
+
+/**
+ * Get the name of a bird in the show at the given index.
+ * \param configuration The instance to inspect.
+ * \param showIdx The index of the show in the configuration.
+ * \param idx The index of the bird name.
+ * \return The name of the bird, or `NULL` if the bird is invalid.
+ */
+const char * NULLABLE ConfigurationGetShowBird(const ConfigurationRef NONNULL configuration, size_t showIdx, size_t idx);
+
+/**
+ * Get the total number of birds in the show at the given index.
+ * \param configuration The instance to inspect.
+ * \param idx The index of the show in the configuration.
+ * \return The number of birds, or 0 if the show is invalid.
+ */
+size_t ConfigurationGetShowTotalBirds(const ConfigurationRef NONNULL configuration, size_t idx);
+
+/**
+ * Get the name of the show at the given index.
+ * \param configuration The instance to inspect.
+ * \param idx The index of the show.
+ * \return The name of the show, or `NULL` if the show is invalid.
+ */
+const char * NULLABLE ConfigurationGetShowName(const ConfigurationRef NONNULL configuration, size_t idx);
+
+/**
+ * Get the total number of shows in the configuration.
+ * \param configuration The instance to inspect.
+ * \return The number of shows. A configuration without shows runs every bird in a single show.
+ */
+size_t ConfigurationGetTotalShows(const ConfigurationRef NONNULL configuration);
+
+
+// MARK: - Triggers
+
+/**
+ * Get the action of a trigger at the given index.
+ * \param configuration The instance to inspect.
+ * \param idx The index of the trigger.
+ * \return The action of the trigger, which is to peck unless configured otherwise.
+ */
+ConfigurationTriggerAction ConfigurationGetTriggerAction(const ConfigurationRef NONNULL configuration, size_t idx);
+
+/**
+ * Get the name of the bird a trigger pecks at the given index.
+ * \param configuration The instance to inspect.
+ * \param idx The index of the trigger.
+ * \return The name of the bird, or `NULL` if the show picks the bird.
+ */
+const char * NULLABLE ConfigurationGetTriggerBird(const ConfigurationRef NONNULL configuration, size_t idx);
+
+/**
+ * Get the name of a trigger at the given index.
+ * \param configuration The instance to inspect.
+ * \param idx The index of the trigger.
+ * \return The name of the trigger, or `NULL` if the trigger is invalid.
+ */
+const char * NULLABLE ConfigurationGetTriggerName(const ConfigurationRef NONNULL configuration, size_t idx);
+
+/**
+ * Get the name of the show a trigger acts on at the given index.
+ * \param configuration The instance to inspect.
+ * \param idx The index of the trigger.
+ * \return The name of the show, or `NULL` if the trigger acts on every show.
+ */
+const char * NULLABLE ConfigurationGetTriggerShow(const ConfigurationRef NONNULL configuration, size_t idx);
+
+/**
+ * Get the source of a trigger at the given index.
+ * \param configuration The instance to inspect.
+ * \param idx The index of the trigger.
+ * \return The source of the trigger. For schedules, this is the period in milliseconds.
+ */
+uint32_t ConfigurationGetTriggerSource(const ConfigurationRef NONNULL configuration, size_t idx);
+
+/**
+ * Get the type of a trigger at the given index.
+ * \param configuration The instance to inspect.
+ * \param idx The index of the trigger.
+ * \return The type of the trigger.
+ */
+ConfigurationTriggerType ConfigurationGetTriggerType(const ConfigurationRef NONNULL configuration, size_t idx);
+
+/**
+ * Get the total number of triggers in the configuration.
+ * \param configuration The instance to inspect.
+ * \return The total number of triggers.
+ */
+size_t ConfigurationGetTotalTriggers(const ConfigurationRef NONNULL configuration);
+
+
+// MARK: - Includes & Sources
+
+/**
+ * Get the path of an included file at the given index.
+ * \param configuration The instance to inspect.
+ * \param idx The index of the include.
+ * \return The path as written, relative to the including file unless absolute, or `NULL` if the include is invalid.
+ * \note Includes are recorded when parsing, but only followed by a Configuration Loader.
+ */
+const char * NULLABLE ConfigurationGetInclude(const ConfigurationRef NONNULL configuration, size_t idx);
+
+/**
+ * Get the total number of included files in the configuration.
+ * \param configuration The instance to inspect.
+ * \return The total number of includes.
+ */
+size_t ConfigurationGetTotalIncludes(const ConfigurationRef NONNULL configuration);
+
+/**
+ * Get the hash of a source file at the given index.
+ * \param configuration The instance to inspect.
+ * \param idx The index of the source.
+ * \return The hash of the file's contents when it was parsed, or `0` if the source is invalid.
+ */
+uint64_t ConfigurationGetSourceHash(const ConfigurationRef NONNULL configuration, size_t idx);
+
+/**
+ * Get the path of a source file at the given index.
+ * \param configuration The instance to inspect.
+ * \param idx The index of the source.
+ * \return The path of the file, or `NULL` if the source is invalid.
+ */
+const char * NULLABLE ConfigurationGetSourcePath(const ConfigurationRef NONNULL configuration, size_t idx);
+
+/**
+ * Get the total number of files the configuration was merged from.
+ * \param configuration The instance to inspect.
+ * \return The total number of sources, or 0 if the configuration was not merged.
+ */
+size_t ConfigurationGetTotalSources(const ConfigurationRef NONNULL configuration);
+
+
+// MARK: - Resolution
+
+/**
+ * Resolve every name reference to the index of what it names.
+ * \param configuration The instance to resolve.
+ * \return `true` if every reference named something, otherwise `false`.
+ * \note Bird outputs, show birds, group birds and trigger shows and birds are resolved. A trigger bird must be in its show, or in every show when it has none. A bird can be in at most one group. Resolving a resolved Configuration does nothing.
+ * \note Each bird's timing is resolved too. A bird's own settings win over its group's, which win over the global settings.
+ * \note Fragments of a larger configuration name things in other files, so only the merged Configuration is resolved.
+ */
+bool ConfigurationResolve(ConfigurationRef NONNULL configuration);
+
+/**
+ * Get if the name references have been resolved.
+ * \param configuration The instance to inspect.
+ * \return `true` once resolved. Configurations loaded from a compiled image are always resolved.
+ */
+bool ConfigurationIsResolved(const ConfigurationRef NONNULL configuration);
+
+/**
+ * Get the output indices of a bird's back outputs.
+ * \param configuration The instance to inspect.
+ * \param idx The index of the bird.
+ * \return The `ConfigurationGetBirdTotalBacks` output indices, or `NULL` if the bird has none or the Configuration is unresolved.
+ */
+const uint32_t * NULLABLE ConfigurationGetBirdBackIndices(const ConfigurationRef NONNULL configuration, size_t idx);
+
+/**
+ * Get the output indices of a bird's forward outputs.
+ * \param configuration The instance to inspect.
+ * \param idx The index of the bird.
+ * \return The `ConfigurationGetBirdTotalForwards` output indices, or `NULL` if the bird has none or the Configuration is unresolved.
+ */
+const uint32_t * NULLABLE ConfigurationGetBirdForwardIndices(const ConfigurationRef NONNULL configuration, size_t idx);
+
+/**
+ * Get the output indices of a bird's static outputs.
+ * \param configuration The instance to inspect.
+ * \param idx The index of the bird.
+ * \return The `ConfigurationGetBirdTotalStatics` output indices, or `NULL` if the bird has none or the Configuration is unresolved.
+ */
+const uint32_t * NULLABLE ConfigurationGetBirdStaticIndices(const ConfigurationRef NONNULL configuration, size_t idx);
+
+/**
+ * Get the resolved timing of a bird.
+ * \param configuration The instance to inspect.
+ * \param idx The index of the bird.
+ * \return The timing of the bird, or `NULL` if the index is invalid or the Configuration is unresolved.
+ * \note The timings of every bird are packed in one table, so this is a single array read.
+ */
+const ConfigurationTiming * NULLABLE ConfigurationGetBirdTiming(const ConfigurationRef NONNULL configuration, size_t idx);
+
+/**
+ * Get the bird indices of a show's birds.
+ * \param configuration The instance to inspect.
+ * \param idx The index of the show.
+ * \return The `ConfigurationGetShowTotalBirds` bird indices, or `NULL` if the show has none or the Configuration is unresolved.
+ */
+const uint32_t * NULLABLE ConfigurationGetShowBirdIndices(const ConfigurationRef NONNULL configuration, size_t idx);
+
+/**
+ * Get the index of the bird a trigger pecks.
+ * \param configuration The instance to inspect.
+ * \param idx The index of the trigger.
+ * \return The index of the bird, or `CONFIGURATION_INDEX_NONE` if the trigger pecks the next bird or the Configuration is unresolved.
+ */
+uint32_t ConfigurationGetTriggerBirdIndex(const ConfigurationRef NONNULL configuration, size_t idx);
+
+/**
+ * Get the index of the show a trigger acts on.
+ * \param configuration The instance to inspect.
+ * \param idx The index of the trigger.
+ * \return The index of the show, or `CONFIGURATION_INDEX_NONE` if the trigger acts on every show or the Configuration is unresolved.
+ */
+uint32_t ConfigurationGetTriggerShowIndex(const ConfigurationRef NONNULL configuration, size_t idx);
+
+
+// MARK: - Templates
+
+/**
+ * Parse the range of a template.
+ * \param value The range, as `FIRST..LAST`.
+ * \param first The first index of the range on success.
+ * \param last The last index of the range on success.
+ * \return `NULL` if the range is valid, otherwise why it is not, to follow `Invalid range "..."`.
+ * \note Both indices must be unsigned decimal numbers that fit in 32 bits, and the range can make at most `CONFIGURATION_MAX_TEMPLATE_INSTANCES` instances.
+ */
+const char * NULLABLE ConfigurationParseRange(const char * NONNULL value, uint32_t * NONNULL first, uint32_t * NONNULL last);
+
+
+// MARK: - Splitting
+
+/**
+ * Split YAML in to chunks that can be parsed on their own, then merged in order in to the same Configuration.
+ * \param value The YAML to split.
+ * \param chunkSize The size in bytes to aim for. YAML no larger than this is not split.
+ * \param chunks The chunks, each allocated with `malloc`, in an array allocated with `malloc`.
+ * \return The number of chunks, which is at least 1.
+ * \note Top-level sections are split apart, and long lists are split between their items. YAML with anything else at the top level is returned whole, so the parser can report it.
+ */
+size_t ConfigurationSplitString(const char * NONNULL value, size_t chunkSize, char * NONNULL * NULLABLE * NONNULL chunks);
+
+
+// MARK: - Compiled Images
+
+/**
+ * Create a Configuration from a compiled image, mapping it in to memory.
+ * \param path The path to the compiled image.
+ * \param sourceHash The hash of the YAML the image must have been compiled from.
+ * \return A new Configuration instance, or `NULL` if the image is missing, stale or corrupt.
+ * \note Every source recorded in the image is hashed again, so a change to an included file also makes the image stale.
+ * \note Strings returned by the getters point in to the mapping, which lives as long as the Configuration.
+ */
+ConfigurationRef NULLABLE ConfigurationCreateFromImage(const char * NONNULL path, uint64_t sourceHash);
+
+/**
+ * Write a Configuration as a compiled image.
+ * \param configuration The instance to write.
+ * \param path The path to write the image to. It is replaced atomically.
+ * \param sourceHash The hash of the YAML the Configuration was parsed from.
+ * \return `true` if the image was written, otherwise `false` if the Configuration is unresolved or the file could not be written.
+ * \note The image stores resolved indices, so the Configuration must be resolved first. Groups are stored only as the resolved timing of each bird.
+ */
+bool ConfigurationWriteImage(const ConfigurationRef NONNULL configuration, const char * NONNULL path, uint64_t sourceHash);
+
+/**
+ * Hash the contents of a file, to match compiled images with their sources.
+ * \param path The path to the file.
+ * \param hash The hash of the contents on success.
+ * \return `true` if the file was read, otherwise `false`.
+ */
+bool ConfigurationHashFile(const char * NONNULL path, uint64_t * NONNULL hash);
+
+/**
+ * Hash bytes the same way as `ConfigurationHashFile`.
+ * \param bytes The bytes to hash.
+ * \param size The number of bytes.
+ * \return The hash of the bytes.
+ */
+uint64_t ConfigurationHashBytes(const void * NONNULL bytes, size_t size);
+
+
 // MARK: - Debug
 
+/**
+ * Get the number of heap allocations made to build the Configuration.
+ * \param configuration The instance to inspect.
+ * \return The total number of allocations, not counting those made by the YAML parser.
+ * \note The Configuration is kept in a single block, so destroying it is a single free.
+ */
+size_t ConfigurationGetTotalAllocations(const ConfigurationRef NONNULL configuration);
+
 /**
  * Dump the parsing events to log for debugging purposes.
  * \param dump `true` to dump logs, otherwise `false`.
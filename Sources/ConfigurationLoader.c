@@ -0,0 +1,679 @@
+//
+//  ConfigurationLoader.c
+//  Woodpeckers
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include "ConfigurationLoader.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Log.h"
+
+
+// MARK: - Constants & Globals
+
+#define TAG "ConfigurationLoader"
+
+#define MAX_THREADS 8
+
+typedef struct _ConfigurationFragment {
+    char *path;
+
+    // NOTE: A large file is split in to chunks, which are parsed in parallel and merged in order
+    ConfigurationRef *chunks;
+    size_t totalChunks;
+
+    // NOTE: What the file looked like when it was last parsed
+    struct timespec modifiedTime;
+    off_t size;
+    uint64_t hash;
+
+    // NOTE: Indices in to the loader's fragments, found again on every load
+    size_t *includes;
+    size_t totalIncludes;
+
+    bool isFound;
+    bool isVisited;
+    bool isLoading;
+} ConfigurationFragment;
+
+typedef struct _ConfigurationDiagnostic {
+    LogLevel level;
+    const char *tag;
+    char *message;
+} ConfigurationDiagnostic;
+
+typedef struct _ConfigurationJob {
+    char *text;
+    ConfigurationRef configuration;
+
+    // NOTE: What parsing logged, kept to be logged by the calling thread once the workers have finished
+    ConfigurationDiagnostic *diagnostics;
+    size_t totalDiagnostics;
+} ConfigurationJob;
+
+typedef struct _ConfigurationBatch {
+    ConfigurationJob *jobs;
+    size_t totalJobs;
+    atomic_size_t nextJob;
+} ConfigurationBatch;
+
+typedef struct _ConfigurationLoader {
+    char *path;
+    size_t totalThreads;
+
+    // NOTE: Every file seen by the last load, in no particular order
+    ConfigurationFragment *fragments;
+    size_t totalFragments;
+
+    // NOTE: Indices in to `fragments`, in merge order
+    size_t *order;
+    size_t totalOrder;
+
+    size_t totalParsed;
+} ConfigurationLoader;
+
+static _Thread_local ConfigurationJob *WorkerJob = NULL;
+
+
+// MARK: - Prototypes
+
+static bool ConfigurationLoaderFind(ConfigurationLoaderRef NONNULL self, const char * NONNULL path, size_t * NONNULL idx);
+static bool ConfigurationLoaderFindIncludes(ConfigurationLoaderRef NONNULL self, size_t idx, size_t * NONNULL * NONNULL wave, size_t * NONNULL totalWave);
+static bool ConfigurationLoaderOrder(ConfigurationLoaderRef NONNULL self, size_t idx);
+static void ConfigurationLoaderPrune(ConfigurationLoaderRef NONNULL self);
+static bool ConfigurationLoaderRefresh(ConfigurationLoaderRef NONNULL self, const size_t * NONNULL wave, size_t totalWave);
+static void ConfigurationLoaderRun(ConfigurationLoaderRef NONNULL self, ConfigurationJob * NONNULL jobs, size_t totalJobs);
+
+static void ConfigurationFragmentClear(ConfigurationFragment * NONNULL fragment);
+static void * NULLABLE ConfigurationWorker(void * NONNULL context);
+static void ConfigurationWorkerCapture(LogLevel level, const char * NONNULL tag, const char * NONNULL message);
+static char * NULLABLE ReadFile(const char * NONNULL path, size_t * NONNULL size);
+
+
+// MARK: - Lifecycle Methods
+
+ConfigurationLoaderRef ConfigurationLoaderCreate(const char *path) {
+    ConfigurationLoaderRef self = (ConfigurationLoaderRef)calloc(1, sizeof(ConfigurationLoader));
+    self->path = strdup(path);
+
+    long totalProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+    ConfigurationLoaderSetTotalThreads(self, (totalProcessors > 0) ? (size_t)totalProcessors : 1);
+
+    return self;
+}
+
+void ConfigurationLoaderDestroy(ConfigurationLoaderRef self) {
+    for (size_t idx = 0; idx < self->totalFragments; idx++) {
+        ConfigurationFragmentClear(self->fragments + idx);
+    }
+
+    SAFE_DESTROY(self->fragments, free);
+    SAFE_DESTROY(self->order, free);
+    SAFE_DESTROY(self->path, free);
+
+    free(self);
+}
+
+
+// MARK: - Loading
+
+ConfigurationRef ConfigurationLoaderLoad(ConfigurationLoaderRef self) {
+    for (size_t idx = 0; idx < self->totalFragments; idx++) {
+        self->fragments[idx].isFound = false;
+        self->fragments[idx].isVisited = false;
+        self->fragments[idx].isLoading = false;
+    }
+
+    self->totalOrder = 0;
+    self->totalParsed = 0;
+
+    size_t root = 0;
+
+    if (!ConfigurationLoaderFind(self, self->path, &root)) {
+        return NULL;
+    }
+
+    // Find the files a wave at a time, so each wave's files are parsed together
+    size_t *wave = (size_t *)malloc(sizeof(size_t));
+    size_t totalWave = 1;
+
+    wave[0] = root;
+    self->fragments[root].isFound = true;
+
+    bool success = true;
+
+    for (size_t depth = 0; totalWave > 0 && success; depth++) {
+        if (depth > CONFIGURATION_LOADER_MAX_DEPTH) {
+            LogE(TAG, "Includes are nested more than %i deep", CONFIGURATION_LOADER_MAX_DEPTH);
+            success = false;
+            break;
+        }
+
+        success = ConfigurationLoaderRefresh(self, wave, totalWave);
+
+        size_t *nextWave = NULL;
+        size_t totalNextWave = 0;
+
+        for (size_t idx = 0; idx < totalWave && success; idx++) {
+            success = ConfigurationLoaderFindIncludes(self, wave[idx], &nextWave, &totalNextWave);
+        }
+
+        SAFE_DESTROY(wave, free);
+
+        wave = nextWave;
+        totalWave = totalNextWave;
+    }
+
+    SAFE_DESTROY(wave, free);
+
+    // The merge order is each file, then its includes, no matter the order they were parsed in
+    if (!success || !ConfigurationLoaderOrder(self, root)) {
+        return NULL;
+    }
+
+    // Files that are no longer included are dropped, so the cache only holds the current set
+    ConfigurationLoaderPrune(self);
+
+    size_t totalChunks = 0;
+
+    for (size_t idx = 0; idx < self->totalOrder; idx++) {
+        totalChunks += self->fragments[self->order[idx]].totalChunks;
+    }
+
+    ConfigurationRef *chunks = (ConfigurationRef *)malloc(sizeof(ConfigurationRef) * totalChunks);
+    const char *paths[self->totalOrder];
+    uint64_t hashes[self->totalOrder];
+
+    size_t chunkIdx = 0;
+
+    for (size_t idx = 0; idx < self->totalOrder; idx++) {
+        const ConfigurationFragment *fragment = self->fragments + self->order[idx];
+
+        memcpy(chunks + chunkIdx, fragment->chunks, sizeof(ConfigurationRef) * fragment->totalChunks);
+        chunkIdx += fragment->totalChunks;
+
+        paths[idx] = fragment->path;
+        hashes[idx] = fragment->hash;
+    }
+
+    ConfigurationRef configuration = ConfigurationCreateMerged(chunks, totalChunks, paths, hashes, self->totalOrder);
+    free(chunks);
+
+    // Only the whole configuration names everything its references need
+    if (configuration != NULL && !ConfigurationResolve(configuration)) {
+        SAFE_DESTROY(configuration, ConfigurationDestroy);
+    }
+
+    if (configuration != NULL) {
+        LogI(TAG, "Loaded %zu configuration files, %zu parsed", self->totalOrder, self->totalParsed);
+    }
+
+    return configuration;
+}
+
+static bool ConfigurationLoaderFind(ConfigurationLoaderRef self, const char *path, size_t *idx) {
+    char *resolvedPath = realpath(path, NULL);
+
+    if (resolvedPath == NULL) {
+        LogErrno(TAG, errno, "Failed to find configuration file %s", path);
+        return false;
+    }
+
+    for (size_t fragmentIdx = 0; fragmentIdx < self->totalFragments; fragmentIdx++) {
+        if (strcmp(self->fragments[fragmentIdx].path, resolvedPath) == 0) {
+            free(resolvedPath);
+            *idx = fragmentIdx;
+
+            return true;
+        }
+    }
+
+    self->fragments = (ConfigurationFragment *)realloc(self->fragments, sizeof(ConfigurationFragment) * (self->totalFragments + 1));
+
+    ConfigurationFragment *fragment = self->fragments + self->totalFragments;
+    memset(fragment, 0, sizeof(ConfigurationFragment));
+    fragment->path = resolvedPath;
+
+    *idx = self->totalFragments;
+    self->totalFragments += 1;
+
+    return true;
+}
+
+static bool ConfigurationLoaderFindIncludes(ConfigurationLoaderRef self, size_t idx, size_t **wave, size_t *totalWave) {
+    // Includes are relative to the directory of the file that includes them
+    char directory[PATH_MAX];
+    snprintf(directory, sizeof(directory), "%s", self->fragments[idx].path);
+    dirname(directory);
+
+    self->fragments[idx].totalIncludes = 0;
+
+    for (size_t chunkIdx = 0; chunkIdx < self->fragments[idx].totalChunks; chunkIdx++) {
+        ConfigurationRef chunk = self->fragments[idx].chunks[chunkIdx];
+        size_t totalIncludes = ConfigurationGetTotalIncludes(chunk);
+
+        for (size_t includeIdx = 0; includeIdx < totalIncludes; includeIdx++) {
+            const char *include = ConfigurationGetInclude(chunk, includeIdx);
+            size_t found = 0;
+
+            char includePath[PATH_MAX];
+            int includePathSize = snprintf(includePath, sizeof(includePath), "%s/%s", directory, include);
+
+            if (include[0] == '/') {
+                includePathSize = snprintf(includePath, sizeof(includePath), "%s", include);
+            }
+
+            if (includePathSize < 0 || (size_t)includePathSize >= sizeof(includePath)) {
+                LogE(TAG, "The path of %s included by %s is too long", include, self->fragments[idx].path);
+                return false;
+            }
+
+            // Finding a new file may move the fragments
+            if (!ConfigurationLoaderFind(self, includePath, &found)) {
+                return false;
+            }
+
+            ConfigurationFragment *fragment = self->fragments + idx;
+
+            fragment->includes = (size_t *)realloc(fragment->includes, sizeof(size_t) * (fragment->totalIncludes + 1));
+            fragment->includes[fragment->totalIncludes] = found;
+            fragment->totalIncludes += 1;
+
+            if (!self->fragments[found].isFound) {
+                self->fragments[found].isFound = true;
+
+                *wave = (size_t *)realloc(*wave, sizeof(size_t) * (*totalWave + 1));
+                (*wave)[*totalWave] = found;
+                *totalWave += 1;
+            }
+        }
+    }
+
+    return true;
+}
+
+static bool ConfigurationLoaderOrder(ConfigurationLoaderRef self, size_t idx) {
+    ConfigurationFragment *fragment = self->fragments + idx;
+
+    if (fragment->isLoading) {
+        LogE(TAG, "%s includes itself", fragment->path);
+        return false;
+    } else if (fragment->isVisited) {
+        LogE(TAG, "%s is included more than once", fragment->path);
+        return false;
+    }
+
+    fragment->isVisited = true;
+    fragment->isLoading = true;
+
+    self->order = (size_t *)realloc(self->order, sizeof(size_t) * (self->totalOrder + 1));
+    self->order[self->totalOrder] = idx;
+    self->totalOrder += 1;
+
+    for (size_t includeIdx = 0; includeIdx < fragment->totalIncludes; includeIdx++) {
+        if (!ConfigurationLoaderOrder(self, fragment->includes[includeIdx])) {
+            return false;
+        }
+    }
+
+    fragment->isLoading = false;
+
+    return true;
+}
+
+static void ConfigurationLoaderPrune(ConfigurationLoaderRef self) {
+    size_t totalKept = 0;
+    size_t moved[self->totalFragments];
+
+    for (size_t idx = 0; idx < self->totalFragments; idx++) {
+        ConfigurationFragment *fragment = self->fragments + idx;
+
+        if (!fragment->isVisited) {
+            LogI(TAG, "Dropping %s, which is no longer included", fragment->path);
+            ConfigurationFragmentClear(fragment);
+            continue;
+        }
+
+        moved[idx] = totalKept;
+        self->fragments[totalKept] = *fragment;
+        totalKept += 1;
+    }
+
+    self->totalFragments = totalKept;
+
+    for (size_t idx = 0; idx < self->totalOrder; idx++) {
+        self->order[idx] = moved[self->order[idx]];
+    }
+
+    for (size_t idx = 0; idx < self->totalFragments; idx++) {
+        ConfigurationFragment *fragment = self->fragments + idx;
+
+        for (size_t includeIdx = 0; includeIdx < fragment->totalIncludes; includeIdx++) {
+            fragment->includes[includeIdx] = moved[fragment->includes[includeIdx]];
+        }
+    }
+}
+
+static bool ConfigurationLoaderRefresh(ConfigurationLoaderRef self, const size_t *wave, size_t totalWave) {
+    typedef struct _Pending {
+        size_t fragment;
+        struct stat info;
+        uint64_t hash;
+        size_t firstJob;
+        size_t totalJobs;
+    } Pending;
+
+    Pending pendings[totalWave];
+    size_t totalPendings = 0;
+
+    ConfigurationJob *jobs = NULL;
+    size_t totalJobs = 0;
+
+    bool success = true;
+
+    // Reading is quick next to parsing, so only the parsing is spread over the workers
+    for (size_t waveIdx = 0; waveIdx < totalWave && success; waveIdx++) {
+        ConfigurationFragment *fragment = self->fragments + wave[waveIdx];
+        struct stat info;
+
+        if (stat(fragment->path, &info) == -1) {
+            LogErrno(TAG, errno, "Failed to inspect configuration file %s", fragment->path);
+            success = false;
+            break;
+        }
+
+        bool isUnchanged = fragment->totalChunks > 0
+            && info.st_size == fragment->size
+            && STAT_MODIFIED_TIME(info).tv_sec == fragment->modifiedTime.tv_sec
+            && STAT_MODIFIED_TIME(info).tv_nsec == fragment->modifiedTime.tv_nsec;
+
+        if (isUnchanged) {
+            continue;
+        }
+
+        size_t size = 0;
+        char *contents = ReadFile(fragment->path, &size);
+
+        if (contents == NULL) {
+            success = false;
+            break;
+        }
+
+        uint64_t hash = ConfigurationHashBytes(contents, size);
+
+        // Touched, but not changed
+        if (fragment->totalChunks > 0 && hash == fragment->hash) {
+            free(contents);
+
+            fragment->modifiedTime = STAT_MODIFIED_TIME(info);
+            fragment->size = info.st_size;
+
+            continue;
+        }
+
+        char **texts = NULL;
+        size_t totalTexts = ConfigurationSplitString(contents, CONFIGURATION_LOADER_CHUNK_SIZE, &texts);
+        free(contents);
+
+        Pending *pending = pendings + totalPendings;
+        pending->fragment = wave[waveIdx];
+        pending->info = info;
+        pending->hash = hash;
+        pending->firstJob = totalJobs;
+        pending->totalJobs = totalTexts;
+        totalPendings += 1;
+
+        jobs = (ConfigurationJob *)realloc(jobs, sizeof(ConfigurationJob) * (totalJobs + totalTexts));
+
+        for (size_t textIdx = 0; textIdx < totalTexts; textIdx++) {
+            jobs[totalJobs].text = texts[textIdx];
+            jobs[totalJobs].configuration = NULL;
+            jobs[totalJobs].diagnostics = NULL;
+            jobs[totalJobs].totalDiagnostics = 0;
+            totalJobs += 1;
+        }
+
+        free(texts);
+    }
+
+    if (success) {
+        ConfigurationLoaderRun(self, jobs, totalJobs);
+    }
+
+    // Replace each changed file's chunks, but only if every chunk parsed
+    for (size_t pendingIdx = 0; pendingIdx < totalPendings; pendingIdx++) {
+        const Pending *pending = pendings + pendingIdx;
+        ConfigurationFragment *fragment = self->fragments + pending->fragment;
+
+        bool isParsed = success;
+
+        for (size_t jobIdx = pending->firstJob; jobIdx < pending->firstJob + pending->totalJobs; jobIdx++) {
+            isParsed = isParsed && jobs[jobIdx].configuration != NULL;
+        }
+
+        if (!isParsed) {
+            if (success) {
+                LogE(TAG, "Failed to parse configuration file %s", fragment->path);
+            }
+
+            for (size_t jobIdx = pending->firstJob; jobIdx < pending->firstJob + pending->totalJobs; jobIdx++) {
+                SAFE_DESTROY(jobs[jobIdx].configuration, ConfigurationDestroy);
+            }
+
+            success = false;
+            continue;
+        }
+
+        for (size_t chunkIdx = 0; chunkIdx < fragment->totalChunks; chunkIdx++) {
+            ConfigurationDestroy(fragment->chunks[chunkIdx]);
+        }
+
+        fragment->chunks = (ConfigurationRef *)realloc(fragment->chunks, sizeof(ConfigurationRef) * pending->totalJobs);
+        fragment->totalChunks = pending->totalJobs;
+
+        for (size_t chunkIdx = 0; chunkIdx < pending->totalJobs; chunkIdx++) {
+            fragment->chunks[chunkIdx] = jobs[pending->firstJob + chunkIdx].configuration;
+        }
+
+        fragment->modifiedTime = STAT_MODIFIED_TIME(pending->info);
+        fragment->size = pending->info.st_size;
+        fragment->hash = pending->hash;
+
+        self->totalParsed += 1;
+    }
+
+    for (size_t jobIdx = 0; jobIdx < totalJobs; jobIdx++) {
+        free(jobs[jobIdx].text);
+    }
+
+    SAFE_DESTROY(jobs, free);
+
+    return success;
+}
+
+static void ConfigurationLoaderRun(ConfigurationLoaderRef self, ConfigurationJob *jobs, size_t totalJobs) {
+    if (totalJobs == 0) {
+        return;
+    }
+
+    ConfigurationBatch batch;
+    batch.jobs = jobs;
+    batch.totalJobs = totalJobs;
+    atomic_init(&batch.nextJob, 0);
+
+    // The calling thread works too, so it only starts the others
+    size_t totalThreads = (self->totalThreads < totalJobs) ? self->totalThreads : totalJobs;
+    pthread_t threads[totalThreads];
+    size_t totalStarted = 0;
+
+    for (size_t idx = 1; idx < totalThreads; idx++) {
+        int result = pthread_create(threads + totalStarted, NULL, ConfigurationWorker, &batch);
+
+        if (result != 0) {
+            LogErrno(TAG, result, "Failed to start a configuration worker");
+            break;
+        }
+
+        totalStarted += 1;
+    }
+
+    ConfigurationWorker(&batch);
+
+    for (size_t idx = 0; idx < totalStarted; idx++) {
+        pthread_join(threads[idx], NULL);
+    }
+
+    // Only the calling thread logs, in the order of the jobs
+    for (size_t jobIdx = 0; jobIdx < totalJobs; jobIdx++) {
+        ConfigurationJob *job = jobs + jobIdx;
+
+        for (size_t idx = 0; idx < job->totalDiagnostics; idx++) {
+            Log(job->diagnostics[idx].level, job->diagnostics[idx].tag, "%s", job->diagnostics[idx].message);
+            free(job->diagnostics[idx].message);
+        }
+
+        SAFE_DESTROY(job->diagnostics, free);
+        job->totalDiagnostics = 0;
+    }
+}
+
+
+// MARK: - Properties
+
+size_t ConfigurationLoaderGetTotalParsed(const ConfigurationLoaderRef self) {
+    return self->totalParsed;
+}
+
+size_t ConfigurationLoaderGetTotalThreads(const ConfigurationLoaderRef self) {
+    return self->totalThreads;
+}
+
+void ConfigurationLoaderSetTotalThreads(ConfigurationLoaderRef self, size_t totalThreads) {
+    if (totalThreads < 1) {
+        totalThreads = 1;
+    } else if (totalThreads > MAX_THREADS) {
+        totalThreads = MAX_THREADS;
+    }
+
+    self->totalThreads = totalThreads;
+}
+
+
+// MARK: - Utilities
+
+static void ConfigurationFragmentClear(ConfigurationFragment *fragment) {
+    for (size_t idx = 0; idx < fragment->totalChunks; idx++) {
+        ConfigurationDestroy(fragment->chunks[idx]);
+    }
+
+    SAFE_DESTROY(fragment->chunks, free);
+    SAFE_DESTROY(fragment->includes, free);
+    SAFE_DESTROY(fragment->path, free);
+
+    fragment->totalChunks = 0;
+    fragment->totalIncludes = 0;
+}
+
+static void * ConfigurationWorker(void *context) {
+    ConfigurationBatch *batch = (ConfigurationBatch *)context;
+
+    // Each chunk is parsed in to its own arenas, so workers share nothing but the job counter
+    LogCallback previousCapture = LogSetThreadCapture(ConfigurationWorkerCapture);
+
+    while (true) {
+        size_t idx = atomic_fetch_add(&batch->nextJob, 1);
+
+        if (idx >= batch->totalJobs) {
+            break;
+        }
+
+        WorkerJob = batch->jobs + idx;
+        batch->jobs[idx].configuration = ConfigurationCreateFromString(batch->jobs[idx].text);
+    }
+
+    WorkerJob = NULL;
+    LogSetThreadCapture(previousCapture);
+
+    return NULL;
+}
+
+static void ConfigurationWorkerCapture(LogLevel level, const char *tag, const char *message) {
+    ConfigurationJob *job = WorkerJob;
+
+    // NOTE: A diagnostic that cannot be kept is lost, but its job still fails or succeeds on its own
+    char *copy = strdup(message);
+
+    if (copy == NULL) {
+        return;
+    }
+
+    ConfigurationDiagnostic *diagnostics = (ConfigurationDiagnostic *)realloc(job->diagnostics, sizeof(ConfigurationDiagnostic) * (job->totalDiagnostics + 1));
+
+    if (diagnostics == NULL) {
+        free(copy);
+        return;
+    }
+
+    // NOTE: Tags are literals, so only the message is copied
+    diagnostics[job->totalDiagnostics].level = level;
+    diagnostics[job->totalDiagnostics].tag = tag;
+    diagnostics[job->totalDiagnostics].message = copy;
+
+    job->diagnostics = diagnostics;
+    job->totalDiagnostics += 1;
+}
+
+static char * ReadFile(const char *path, size_t *size) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd == -1) {
+        LogErrno(TAG, errno, "Failed to open configuration file %s", path);
+        return NULL;
+    }
+
+    size_t capacity = 4096;
+    size_t total = 0;
+    char *contents = (char *)malloc(capacity);
+
+    while (true) {
+        // Keep room for the terminator
+        if (total + 1 >= capacity) {
+            capacity *= 2;
+            contents = (char *)realloc(contents, capacity);
+        }
+
+        ssize_t result = read(fd, contents + total, capacity - total - 1);
+
+        if (result == -1 && errno == EINTR) {
+            continue;
+        } else if (result == -1) {
+            LogErrno(TAG, errno, "Failed to read configuration file %s", path);
+            SAFE_DESTROY(contents, free);
+            break;
+        } else if (result == 0) {
+            contents[total] = '\0';
+            break;
+        }
+
+        total += (size_t)result;
+    }
+
+    close(fd);
+
+    *size = total;
+
+    return contents;
+}
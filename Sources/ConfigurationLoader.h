@@ -0,0 +1,88 @@
+//
+//  ConfigurationLoader.h
+//  Woodpeckers
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#ifndef CONFIGURATION_LOADER_H
+#define CONFIGURATION_LOADER_H
+
+#include "Macros.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "Configuration.h"
+
+
+BEGIN_DECLS
+
+
+// MARK: - Constants & Globals
+
+/// The Configuration Loader object, which follows includes and caches each file it parses.
+typedef struct _ConfigurationLoader * ConfigurationLoaderRef;
+
+/// The deepest a chain of includes may go.
+#define CONFIGURATION_LOADER_MAX_DEPTH 16
+
+/// The size files are split in to before they are parsed in parallel.
+#define CONFIGURATION_LOADER_CHUNK_SIZE (64 * 1024)
+
+
+// MARK: - Lifecycle Methods
+
+/**
+ * Create a Configuration Loader for a root configuration file.
+ * \param path The path of the root configuration file.
+ * \return A new Configuration Loader instance.
+ */
+ConfigurationLoaderRef NONNULL ConfigurationLoaderCreate(const char * NONNULL path);
+
+/**
+ * Destroy a Configuration Loader and every fragment it has cached.
+ * \param loader The instance to destroy.
+ */
+void ConfigurationLoaderDestroy(ConfigurationLoaderRef NONNULL loader);
+
+
+// MARK: - Loading
+
+/**
+ * Load the root file and every file it includes, then merge them in to a single Configuration.
+ * \param loader The instance to load with.
+ * \return A new, resolved Configuration instance, or `NULL` if a file could not be read or parsed, the files could not be merged, or a name could not be resolved.
+ * \note Files are merged in the order they are reached: each file, then its includes. A file whose modification time and size are unchanged since the last load is not read again, and a file whose contents hash the same is not parsed again.
+ * \note Changed files are found a level of includes at a time. The files at each level, split in to chunks, are parsed across the loader's threads. What parsing logs is logged by the calling thread, in chunk order, once the level is parsed.
+ */
+ConfigurationRef NULLABLE ConfigurationLoaderLoad(ConfigurationLoaderRef NONNULL loader);
+
+
+// MARK: - Properties
+
+/**
+ * Get the number of files parsed by the last load.
+ * \param loader The instance to inspect.
+ * \return The number of files that were new or had changed.
+ */
+size_t ConfigurationLoaderGetTotalParsed(const ConfigurationLoaderRef NONNULL loader);
+
+/**
+ * Get the number of threads used to parse.
+ * \param loader The instance to inspect.
+ * \return The number of threads, including the one calling `ConfigurationLoaderLoad`.
+ */
+size_t ConfigurationLoaderGetTotalThreads(const ConfigurationLoaderRef NONNULL loader);
+
+/**
+ * Set the number of threads used to parse.
+ * \param loader The instance to modify.
+ * \param totalThreads The number of threads, including the one calling `ConfigurationLoaderLoad`. It is clamped between 1 and 8. The default is the number of online processors.
+ */
+void ConfigurationLoaderSetTotalThreads(ConfigurationLoaderRef NONNULL loader, size_t totalThreads);
+
+END_DECLS
+
+#endif /* CONFIGURATION_LOADER_H */
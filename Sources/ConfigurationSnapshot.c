@@ -0,0 +1,468 @@
+//
+//  ConfigurationSnapshot.c
+//  Woodpeckers
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include "ConfigurationSnapshot.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
+#include <yaml.h>
+
+#include "Log.h"
+
+
+// MARK: - Constants & Globals
+
+#define TAG "ConfigurationSnapshot"
+
+#define NUMBER_SIZE 16
+
+typedef struct _ConfigurationSnapshot {
+    ConfigurationRef configuration;
+    ConfigurationSettings settings;
+} ConfigurationSnapshot;
+
+static const char * const OutputTypeNames[] = {
+    [ConfigurationOutputTypeUnknown] = "Unknown",
+    [ConfigurationOutputTypeMemory] = "Memory",
+    [ConfigurationOutputTypeFile] = "File",
+    [ConfigurationOutputTypeGPIO] = "GPIO",
+};
+
+static const char * const SafeStateNames[] = {
+    [ConfigurationSafeStateOff] = "Off",
+    [ConfigurationSafeStateOn] = "On",
+    [ConfigurationSafeStateHold] = "Hold",
+};
+
+static const char * const TriggerTypeNames[] = {
+    [ConfigurationTriggerTypeUnknown] = "Unknown",
+    [ConfigurationTriggerTypeInput] = "Input",
+    [ConfigurationTriggerTypeCommand] = "Command",
+    [ConfigurationTriggerTypeSchedule] = "Schedule",
+    [ConfigurationTriggerTypeCue] = "Cue",
+};
+
+static const char * const TriggerActionNames[] = {
+    [ConfigurationTriggerActionPeck] = "Peck",
+    [ConfigurationTriggerActionStart] = "Start",
+    [ConfigurationTriggerActionStop] = "Stop",
+};
+
+typedef const char * NULLABLE (* NameGetter)(const ConfigurationRef NONNULL configuration, size_t itemIdx, size_t idx);
+
+
+// MARK: - Prototypes
+
+static bool EmitEvent(yaml_emitter_t * NONNULL emitter, yaml_event_t * NONNULL event);
+static bool EmitKey(yaml_emitter_t * NONNULL emitter, const char * NONNULL key, const char * NONNULL value);
+static bool EmitMappingEnd(yaml_emitter_t * NONNULL emitter);
+static bool EmitMappingStart(yaml_emitter_t * NONNULL emitter);
+static bool EmitName(yaml_emitter_t * NONNULL emitter, const char * NONNULL name);
+static bool EmitNames(yaml_emitter_t * NONNULL emitter, const char * NONNULL key, const ConfigurationRef NONNULL configuration, size_t itemIdx, size_t total, NameGetter getter);
+static bool EmitNumber(yaml_emitter_t * NONNULL emitter, const char * NONNULL key, int64_t value);
+static bool EmitScalar(yaml_emitter_t * NONNULL emitter, const char * NONNULL value);
+static bool EmitSequenceEnd(yaml_emitter_t * NONNULL emitter);
+static bool EmitSequenceStart(yaml_emitter_t * NONNULL emitter);
+
+static bool ConfigurationSnapshotEmitBirds(const ConfigurationSnapshotRef NONNULL snapshot, yaml_emitter_t * NONNULL emitter);
+static bool ConfigurationSnapshotEmitOutputs(const ConfigurationSnapshotRef NONNULL snapshot, yaml_emitter_t * NONNULL emitter);
+static bool ConfigurationSnapshotEmitSettings(const ConfigurationSnapshotRef NONNULL snapshot, yaml_emitter_t * NONNULL emitter);
+static bool ConfigurationSnapshotEmitShows(const ConfigurationSnapshotRef NONNULL snapshot, yaml_emitter_t * NONNULL emitter);
+static bool ConfigurationSnapshotEmitTriggers(const ConfigurationSnapshotRef NONNULL snapshot, yaml_emitter_t * NONNULL emitter);
+
+static bool WriteFileAtomically(const char * NONNULL path, const char * NONNULL bytes, size_t size);
+
+
+// MARK: - Lifecycle Methods
+
+ConfigurationSnapshotRef ConfigurationSnapshotCreate(const ConfigurationRef configuration, const ConfigurationSettings *settings) {
+    ConfigurationSnapshotRef self = (ConfigurationSnapshotRef)calloc(1, sizeof(ConfigurationSnapshot));
+
+    self->configuration = configuration;
+
+    if (settings != NULL) {
+        self->settings = *settings;
+    } else {
+        self->settings.minWait = ConfigurationGetMinWait(configuration);
+        self->settings.maxWait = ConfigurationGetMaxWait(configuration);
+        self->settings.minPecks = ConfigurationGetMinPecks(configuration);
+        self->settings.maxPecks = ConfigurationGetMaxPecks(configuration);
+        self->settings.peckWait = ConfigurationGetPeckWait(configuration);
+    }
+
+    return self;
+}
+
+void ConfigurationSnapshotDestroy(ConfigurationSnapshotRef self) {
+    free(self);
+}
+
+
+// MARK: - Writing
+
+bool ConfigurationSnapshotWriteYAML(const ConfigurationSnapshotRef self, FILE *stream) {
+    yaml_emitter_t emitter;
+
+    if (!yaml_emitter_initialize(&emitter)) {
+        LogE(TAG, "Failed to initialize the YAML emitter");
+        return false;
+    }
+
+    yaml_emitter_set_output_file(&emitter, stream);
+    yaml_emitter_set_unicode(&emitter, 1);
+    yaml_emitter_set_width(&emitter, -1);
+
+    yaml_event_t event;
+    bool success = true;
+
+    yaml_stream_start_event_initialize(&event, YAML_UTF8_ENCODING);
+    success = success && EmitEvent(&emitter, &event);
+
+    yaml_document_start_event_initialize(&event, NULL, NULL, NULL, 0);
+    success = success && EmitEvent(&emitter, &event);
+
+    success = success && EmitMappingStart(&emitter);
+    success = success && ConfigurationSnapshotEmitSettings(self, &emitter);
+    success = success && ConfigurationSnapshotEmitOutputs(self, &emitter);
+    success = success && ConfigurationSnapshotEmitBirds(self, &emitter);
+    success = success && ConfigurationSnapshotEmitShows(self, &emitter);
+    success = success && ConfigurationSnapshotEmitTriggers(self, &emitter);
+    success = success && EmitMappingEnd(&emitter);
+
+    yaml_document_end_event_initialize(&event, 1);
+    success = success && EmitEvent(&emitter, &event);
+
+    yaml_stream_end_event_initialize(&event);
+    success = success && EmitEvent(&emitter, &event);
+
+    if (!success) {
+        LogE(TAG, "Failed to write the configuration snapshot: %s", (emitter.problem != NULL) ? emitter.problem : "unknown error");
+    }
+
+    yaml_emitter_delete(&emitter);
+
+    return success;
+}
+
+bool ConfigurationSnapshotWriteFile(const ConfigurationSnapshotRef self, const char *path, ConfigurationSnapshotFormat format) {
+    char *buffer = NULL;
+    size_t bufferSize = 0;
+
+    FILE *stream = open_memstream(&buffer, &bufferSize);
+
+    if (stream == NULL) {
+        LogErrno(TAG, errno, "Failed to open a stream for the configuration snapshot");
+        return false;
+    }
+
+    bool success = ConfigurationSnapshotWriteYAML(self, stream);
+    success = (fclose(stream) == 0) && success;
+
+    if (!success) {
+        SAFE_DESTROY(buffer, free);
+        return false;
+    }
+
+    if (format == ConfigurationSnapshotFormatYAML) {
+        success = WriteFileAtomically(path, buffer, bufferSize);
+    } else {
+        // Compiling from the YAML form checks that it loads, and gives the image a source hash to match
+        ConfigurationRef configuration = ConfigurationCreateFromString(buffer);
+
+        if (configuration == NULL) {
+            LogE(TAG, "Failed to parse the configuration snapshot");
+            success = false;
+        } else {
+            success = ConfigurationResolve(configuration) && ConfigurationWriteImage(configuration, path, ConfigurationHashBytes(buffer, bufferSize));
+            ConfigurationDestroy(configuration);
+        }
+    }
+
+    SAFE_DESTROY(buffer, free);
+
+    return success;
+}
+
+
+// MARK: - Sections
+
+static bool ConfigurationSnapshotEmitSettings(const ConfigurationSnapshotRef self, yaml_emitter_t *emitter) {
+    const ConfigurationSettings *settings = &self->settings;
+    const char *watchdogPath = ConfigurationGetWatchdogPath(self->configuration);
+    const char *logLevels = ConfigurationGetLogLevels(self->configuration);
+
+    bool success = EmitScalar(emitter, "Settings") && EmitMappingStart(emitter);
+
+    success = success && EmitNumber(emitter, "MinWait", settings->minWait);
+    success = success && EmitNumber(emitter, "MaxWait", settings->maxWait);
+    success = success && EmitNumber(emitter, "MinPecks", settings->minPecks);
+    success = success && EmitNumber(emitter, "MaxPecks", settings->maxPecks);
+    success = success && EmitNumber(emitter, "PeckWait", settings->peckWait);
+
+    if (watchdogPath != NULL) {
+        success = success && EmitKey(emitter, "Watchdog", watchdogPath);
+        success = success && EmitNumber(emitter, "WatchdogInterval", ConfigurationGetWatchdogInterval(self->configuration));
+    }
+
+    if (logLevels != NULL) {
+        success = success && EmitKey(emitter, "LogLevels", logLevels);
+    }
+
+    return success && EmitMappingEnd(emitter);
+}
+
+static bool ConfigurationSnapshotEmitOutputs(const ConfigurationSnapshotRef self, yaml_emitter_t *emitter) {
+    ConfigurationRef configuration = self->configuration;
+    size_t totalOutputs = ConfigurationGetTotalOutputs(configuration);
+
+    if (totalOutputs == 0) {
+        return true;
+    }
+
+    bool success = EmitScalar(emitter, "Outputs") && EmitSequenceStart(emitter);
+
+    for (size_t idx = 0; idx < totalOutputs && success; idx++) {
+        ConfigurationOutputType type = ConfigurationGetOutputType(configuration, idx);
+
+        success = EmitMappingStart(emitter) && EmitName(emitter, ConfigurationGetOutputName(configuration, idx));
+        success = success && EmitKey(emitter, "Type", OutputTypeNames[type]);
+
+        if (type == ConfigurationOutputTypeFile) {
+            success = success && EmitKey(emitter, "Path", ConfigurationGetOutputPath(configuration, idx));
+        } else if (type == ConfigurationOutputTypeGPIO) {
+            success = success && EmitNumber(emitter, "Pin", ConfigurationGetOutputPin(configuration, idx));
+        }
+
+        success = success && EmitKey(emitter, "SafeState", SafeStateNames[ConfigurationGetOutputSafeState(configuration, idx)]);
+        success = success && EmitNumber(emitter, "MinOn", ConfigurationGetOutputMinOn(configuration, idx));
+        success = success && EmitNumber(emitter, "MinOff", ConfigurationGetOutputMinOff(configuration, idx));
+        success = success && EmitNumber(emitter, "MinDwell", ConfigurationGetOutputMinDwell(configuration, idx));
+        success = success && EmitMappingEnd(emitter);
+    }
+
+    return success && EmitSequenceEnd(emitter);
+}
+
+static bool ConfigurationSnapshotEmitBirds(const ConfigurationSnapshotRef self, yaml_emitter_t *emitter) {
+    ConfigurationRef configuration = self->configuration;
+    size_t totalBirds = ConfigurationGetTotalBirds(configuration);
+
+    if (totalBirds == 0) {
+        return true;
+    }
+
+    bool success = EmitScalar(emitter, "Birds") && EmitSequenceStart(emitter);
+
+    for (size_t idx = 0; idx < totalBirds && success; idx++) {
+        success = EmitMappingStart(emitter) && EmitName(emitter, ConfigurationGetBirdName(configuration, idx));
+        success = success && EmitNames(emitter, "Static", configuration, idx, ConfigurationGetBirdTotalStatics(configuration, idx), ConfigurationGetBirdStatic);
+        success = success && EmitNames(emitter, "Back", configuration, idx, ConfigurationGetBirdTotalBacks(configuration, idx), ConfigurationGetBirdBack);
+        success = success && EmitNames(emitter, "Forward", configuration, idx, ConfigurationGetBirdTotalForwards(configuration, idx), ConfigurationGetBirdForward);
+
+        // Groups are flattened too, so each bird carries whatever it or its group overrides
+        const ConfigurationTiming *timing = ConfigurationGetBirdTiming(configuration, idx);
+
+        if (timing != NULL && (timing->overrides & ConfigurationTimingOverrideMinWait) != 0) {
+            success = success && EmitNumber(emitter, "MinWait", timing->minWait);
+        }
+
+        if (timing != NULL && (timing->overrides & ConfigurationTimingOverrideMaxWait) != 0) {
+            success = success && EmitNumber(emitter, "MaxWait", timing->maxWait);
+        }
+
+        if (timing != NULL && (timing->overrides & ConfigurationTimingOverrideMinPecks) != 0) {
+            success = success && EmitNumber(emitter, "MinPecks", timing->minPecks);
+        }
+
+        if (timing != NULL && (timing->overrides & ConfigurationTimingOverrideMaxPecks) != 0) {
+            success = success && EmitNumber(emitter, "MaxPecks", timing->maxPecks);
+        }
+
+        if (timing != NULL && (timing->overrides & ConfigurationTimingOverridePeckWait) != 0) {
+            success = success && EmitNumber(emitter, "PeckWait", timing->peckWait);
+        }
+
+        success = success && EmitMappingEnd(emitter);
+    }
+
+    return success && EmitSequenceEnd(emitter);
+}
+
+static bool ConfigurationSnapshotEmitShows(const ConfigurationSnapshotRef self, yaml_emitter_t *emitter) {
+    ConfigurationRef configuration = self->configuration;
+    size_t totalShows = ConfigurationGetTotalShows(configuration);
+
+    if (totalShows == 0) {
+        return true;
+    }
+
+    bool success = EmitScalar(emitter, "Shows") && EmitSequenceStart(emitter);
+
+    for (size_t idx = 0; idx < totalShows && success; idx++) {
+        success = EmitMappingStart(emitter) && EmitName(emitter, ConfigurationGetShowName(configuration, idx));
+        success = success && EmitNames(emitter, "Birds", configuration, idx, ConfigurationGetShowTotalBirds(configuration, idx), ConfigurationGetShowBird);
+        success = success && EmitMappingEnd(emitter);
+    }
+
+    return success && EmitSequenceEnd(emitter);
+}
+
+static bool ConfigurationSnapshotEmitTriggers(const ConfigurationSnapshotRef self, yaml_emitter_t *emitter) {
+    ConfigurationRef configuration = self->configuration;
+    size_t totalTriggers = ConfigurationGetTotalTriggers(configuration);
+
+    if (totalTriggers == 0) {
+        return true;
+    }
+
+    bool success = EmitScalar(emitter, "Triggers") && EmitSequenceStart(emitter);
+
+    for (size_t idx = 0; idx < totalTriggers && success; idx++) {
+        const char *show = ConfigurationGetTriggerShow(configuration, idx);
+        const char *bird = ConfigurationGetTriggerBird(configuration, idx);
+
+        success = EmitMappingStart(emitter) && EmitName(emitter, ConfigurationGetTriggerName(configuration, idx));
+        success = success && EmitKey(emitter, "Type", TriggerTypeNames[ConfigurationGetTriggerType(configuration, idx)]);
+        success = success && EmitNumber(emitter, "Source", ConfigurationGetTriggerSource(configuration, idx));
+        success = success && EmitKey(emitter, "Action", TriggerActionNames[ConfigurationGetTriggerAction(configuration, idx)]);
+
+        if (show != NULL) {
+            success = success && EmitKey(emitter, "Show", show);
+        }
+
+        if (bird != NULL) {
+            success = success && EmitKey(emitter, "Bird", bird);
+        }
+
+        success = success && EmitMappingEnd(emitter);
+    }
+
+    return success && EmitSequenceEnd(emitter);
+}
+
+
+// MARK: - Emitting
+
+static bool EmitEvent(yaml_emitter_t *emitter, yaml_event_t *event) {
+    // NOTE: The emitter takes ownership of the event, even when it fails
+    return yaml_emitter_emit(emitter, event) == 1;
+}
+
+static bool EmitKey(yaml_emitter_t *emitter, const char *key, const char *value) {
+    return EmitScalar(emitter, key) && EmitScalar(emitter, value);
+}
+
+static bool EmitMappingEnd(yaml_emitter_t *emitter) {
+    yaml_event_t event;
+    yaml_mapping_end_event_initialize(&event);
+
+    return EmitEvent(emitter, &event);
+}
+
+static bool EmitMappingStart(yaml_emitter_t *emitter) {
+    yaml_event_t event;
+    yaml_mapping_start_event_initialize(&event, NULL, NULL, 1, YAML_BLOCK_MAPPING_STYLE);
+
+    return EmitEvent(emitter, &event);
+}
+
+static bool EmitName(yaml_emitter_t *emitter, const char *name) {
+    // An item is a mapping whose first key is its name, with an empty value
+    return EmitKey(emitter, name, "");
+}
+
+static bool EmitNames(yaml_emitter_t *emitter, const char *key, const ConfigurationRef configuration, size_t itemIdx, size_t total, NameGetter getter) {
+    if (total == 0) {
+        return true;
+    }
+
+    bool success = EmitScalar(emitter, key) && EmitSequenceStart(emitter);
+
+    for (size_t idx = 0; idx < total && success; idx++) {
+        success = EmitScalar(emitter, getter(configuration, itemIdx, idx));
+    }
+
+    return success && EmitSequenceEnd(emitter);
+}
+
+static bool EmitNumber(yaml_emitter_t *emitter, const char *key, int64_t value) {
+    char buffer[NUMBER_SIZE];
+    snprintf(buffer, sizeof(buffer), "%" PRIi64, value);
+
+    return EmitKey(emitter, key, buffer);
+}
+
+static bool EmitScalar(yaml_emitter_t *emitter, const char *value) {
+    yaml_event_t event;
+    yaml_scalar_event_initialize(&event, NULL, NULL, (yaml_char_t *)value, (int)strlen(value), 1, 1, YAML_ANY_SCALAR_STYLE);
+
+    return EmitEvent(emitter, &event);
+}
+
+static bool EmitSequenceEnd(yaml_emitter_t *emitter) {
+    yaml_event_t event;
+    yaml_sequence_end_event_initialize(&event);
+
+    return EmitEvent(emitter, &event);
+}
+
+static bool EmitSequenceStart(yaml_emitter_t *emitter) {
+    yaml_event_t event;
+    yaml_sequence_start_event_initialize(&event, NULL, NULL, 1, YAML_BLOCK_SEQUENCE_STYLE);
+
+    return EmitEvent(emitter, &event);
+}
+
+
+// MARK: - Utilities
+
+static bool WriteFileAtomically(const char *path, const char *bytes, size_t size) {
+    size_t temporaryPathSize = strlen(path) + 5;
+    char temporaryPath[temporaryPathSize];
+    snprintf(temporaryPath, temporaryPathSize, "%s.tmp", path);
+
+    int fd = open(temporaryPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (fd == -1) {
+        LogErrno(TAG, errno, "Failed to create configuration snapshot %s", temporaryPath);
+        return false;
+    }
+
+    size_t written = 0;
+
+    while (written < size) {
+        ssize_t result = write(fd, bytes + written, size - written);
+
+        if (result == -1 && errno == EINTR) {
+            continue;
+        } else if (result <= 0) {
+            LogErrno(TAG, errno, "Failed to write configuration snapshot %s", temporaryPath);
+            close(fd);
+            unlink(temporaryPath);
+            return false;
+        }
+
+        written += (size_t)result;
+    }
+
+    close(fd);
+
+    // Move in to place so readers never see a partial file
+    if (rename(temporaryPath, path) == -1) {
+        LogErrno(TAG, errno, "Failed to move configuration snapshot in to place at %s", path);
+        unlink(temporaryPath);
+        return false;
+    }
+
+    LogI(TAG, "Wrote %zu byte configuration snapshot to %s", size, path);
+
+    return true;
+}
@@ -0,0 +1,87 @@
+//
+//  ConfigurationSnapshot.h
+//  Woodpeckers
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#ifndef CONFIGURATION_SNAPSHOT_H
+#define CONFIGURATION_SNAPSHOT_H
+
+#include "Macros.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Configuration.h"
+
+
+BEGIN_DECLS
+
+
+// MARK: - Constants & Globals
+
+/// The Configuration Snapshot object, which captures the running model so it can be written out later.
+typedef struct _ConfigurationSnapshot * ConfigurationSnapshotRef;
+
+/// The show settings that may be changed while running
+typedef struct _ConfigurationSettings {
+    uint32_t minWait;  ///< The minimum time, in milliseconds, between peck sequences
+    uint32_t maxWait;  ///< The maximum time, in milliseconds, between peck sequences
+    uint32_t minPecks; ///< The minimum number of pecks in a sequence
+    uint32_t maxPecks; ///< The maximum number of pecks in a sequence
+    uint32_t peckWait; ///< The time, in milliseconds, between peck movements
+} ConfigurationSettings;
+
+/// The format a snapshot is written in
+typedef enum _ConfigurationSnapshotFormat {
+    ConfigurationSnapshotFormatYAML = 0, ///< A single, flattened configuration file
+    ConfigurationSnapshotFormatImage,    ///< A compiled configuration image
+} ConfigurationSnapshotFormat;
+
+
+// MARK: - Lifecycle Methods
+
+/**
+ * Capture a snapshot of a running configuration.
+ * \param configuration The resolved Configuration the running model was built from.
+ * \param settings The settings in use now, or `NULL` to use the Configuration's.
+ * \return A new Configuration Snapshot instance.
+ * \note The Configuration is shared, not copied, so it must not change or be destroyed until the snapshot is. Only the settings, which change while running, are copied. This keeps taking a snapshot cheap enough for the Event Loop.
+ */
+ConfigurationSnapshotRef NONNULL ConfigurationSnapshotCreate(const ConfigurationRef NONNULL configuration, const ConfigurationSettings * NULLABLE settings);
+
+/**
+ * Destroy a Configuration Snapshot. The shared Configuration is left alone.
+ * \param snapshot The instance to destroy.
+ */
+void ConfigurationSnapshotDestroy(ConfigurationSnapshotRef NONNULL snapshot);
+
+
+// MARK: - Writing
+
+/**
+ * Write a snapshot as a single YAML configuration.
+ * \param snapshot The instance to write.
+ * \param stream The stream to write to.
+ * \return `true` if the snapshot was written, otherwise `false`.
+ * \note Includes, templates and groups are flattened, so every output, bird, show and trigger is listed by name, and each bird lists the timing it overrides. Loading the result builds the same model.
+ */
+bool ConfigurationSnapshotWriteYAML(const ConfigurationSnapshotRef NONNULL snapshot, FILE * NONNULL stream);
+
+/**
+ * Write a snapshot to a file.
+ * \param snapshot The instance to write.
+ * \param path The path to write to. It is replaced atomically.
+ * \param format The format to write.
+ * \return `true` if the file was written, otherwise `false`.
+ * \note An image is compiled from the YAML form of the snapshot, and its source hash is the hash of that YAML. Saving the YAML form as `CONFIG` and the image as `CONFIG.bin` lets the image be loaded at start up.
+ */
+bool ConfigurationSnapshotWriteFile(const ConfigurationSnapshotRef NONNULL snapshot, const char * NONNULL path, ConfigurationSnapshotFormat format);
+
+END_DECLS
+
+#endif /* CONFIGURATION_SNAPSHOT_H */
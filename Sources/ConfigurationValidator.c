@@ -0,0 +1,1275 @@
+//
+//  ConfigurationValidator.c
+//  Woodpeckers
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include "ConfigurationValidator.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <libgen.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <yaml.h>
+
+#include "Arena.h"
+#include "Configuration.h"
+#include "ConfigurationLoader.h"
+#include "Log.h"
+
+
+// MARK: - Constants & Globals
+
+#define ARENA_SIZE 16384
+#define MAX_NODES 8
+#define MINIMUM_NAMES_CAPACITY 64
+#define STRING_PATH "<string>"
+
+#define POINTER_HASH_MULTIPLIER 0x9E3779B97F4A7C15ULL
+
+#define TOTAL(A) (sizeof(A) / sizeof((A)[0]))
+
+typedef enum _Kind {
+    KindOutput = 0,
+    KindBird,
+    KindShow,
+    KindGroup,
+    KindTrigger,
+    KindCount,
+} Kind;
+
+static const char * const KindNames[KindCount] = { "output", "bird", "show", "group", "trigger" };
+
+typedef enum _Role {
+    RoleIgnored = 0,
+    RoleRoot,
+    RoleSettings,
+    RoleItems,
+    RoleItem,
+    RoleNames,
+    RoleIncludes,
+} Role;
+
+typedef enum _ValueType {
+    ValueTypeString = 0,
+    ValueTypeNumber,
+    ValueTypePositiveNumber,
+    ValueTypeSignedNumber,
+    ValueTypeChoice,
+    ValueTypeNames,
+    ValueTypeRange,
+    ValueTypeLogLevels,
+} ValueType;
+
+typedef struct _Key {
+    const char *name;
+    ValueType type;
+
+    // NOTE: `NULL` terminated, for choices. For names, the kind they reference.
+    const char * const *choices;
+    Kind kind;
+} Key;
+
+typedef struct _Section {
+    const char *name;
+    Role role;
+    Kind kind;
+
+    const Key *keys;
+    size_t totalKeys;
+} Section;
+
+static const char * const OutputTypes[] = { "Memory", "File", "GPIO", NULL };
+static const char * const SafeStates[] = { "Off", "On", "Hold", NULL };
+static const char * const TriggerTypes[] = { "Input", "Command", "Schedule", "Cue", NULL };
+static const char * const TriggerActions[] = { "Peck", "Start", "Stop", NULL };
+
+static const Key SettingsKeys[] = {
+    { "MinWait", ValueTypeNumber, NULL, KindCount },
+    { "MaxWait", ValueTypeNumber, NULL, KindCount },
+    { "MinPecks", ValueTypeNumber, NULL, KindCount },
+    { "MaxPecks", ValueTypeNumber, NULL, KindCount },
+    { "PeckWait", ValueTypeNumber, NULL, KindCount },
+    { "Watchdog", ValueTypeString, NULL, KindCount },
+    { "WatchdogInterval", ValueTypePositiveNumber, NULL, KindCount },
+    { "LogLevels", ValueTypeLogLevels, NULL, KindCount },
+};
+
+static const Key OutputKeys[] = {
+    { "Type", ValueTypeChoice, OutputTypes, KindCount },
+    { "Path", ValueTypeString, NULL, KindCount },
+    { "Pin", ValueTypeSignedNumber, NULL, KindCount },
+    { "SafeState", ValueTypeChoice, SafeStates, KindCount },
+    { "MinOn", ValueTypeNumber, NULL, KindCount },
+    { "MinOff", ValueTypeNumber, NULL, KindCount },
+    { "MinDwell", ValueTypeNumber, NULL, KindCount },
+    { "Range", ValueTypeRange, NULL, KindCount },
+    { "PinStep", ValueTypeSignedNumber, NULL, KindCount },
+};
+
+static const Key BirdKeys[] = {
+    { "Static", ValueTypeNames, NULL, KindOutput },
+    { "Back", ValueTypeNames, NULL, KindOutput },
+    { "Forward", ValueTypeNames, NULL, KindOutput },
+    { "Range", ValueTypeRange, NULL, KindCount },
+    { "MinWait", ValueTypeNumber, NULL, KindCount },
+    { "MaxWait", ValueTypeNumber, NULL, KindCount },
+    { "MinPecks", ValueTypeNumber, NULL, KindCount },
+    { "MaxPecks", ValueTypeNumber, NULL, KindCount },
+    { "PeckWait", ValueTypeNumber, NULL, KindCount },
+};
+
+static const Key ShowKeys[] = {
+    { "Birds", ValueTypeNames, NULL, KindBird },
+    { "Range", ValueTypeRange, NULL, KindCount },
+};
+
+static const Key GroupKeys[] = {
+    { "Birds", ValueTypeNames, NULL, KindBird },
+    { "Range", ValueTypeRange, NULL, KindCount },
+    { "MinWait", ValueTypeNumber, NULL, KindCount },
+    { "MaxWait", ValueTypeNumber, NULL, KindCount },
+    { "MinPecks", ValueTypeNumber, NULL, KindCount },
+    { "MaxPecks", ValueTypeNumber, NULL, KindCount },
+    { "PeckWait", ValueTypeNumber, NULL, KindCount },
+};
+
+static const Key TriggerKeys[] = {
+    { "Type", ValueTypeChoice, TriggerTypes, KindCount },
+    { "Source", ValueTypeNumber, NULL, KindCount },
+    { "Show", ValueTypeString, NULL, KindCount },
+    { "Action", ValueTypeChoice, TriggerActions, KindCount },
+    { "Bird", ValueTypeString, NULL, KindCount },
+};
+
+static const Section Sections[] = {
+    { "Settings", RoleSettings, KindCount, SettingsKeys, TOTAL(SettingsKeys) },
+    { "Outputs", RoleItems, KindOutput, OutputKeys, TOTAL(OutputKeys) },
+    { "Birds", RoleItems, KindBird, BirdKeys, TOTAL(BirdKeys) },
+    { "Shows", RoleItems, KindShow, ShowKeys, TOTAL(ShowKeys) },
+    { "Groups", RoleItems, KindGroup, GroupKeys, TOTAL(GroupKeys) },
+    { "Triggers", RoleItems, KindTrigger, TriggerKeys, TOTAL(TriggerKeys) },
+    { "Include", RoleIncludes, KindCount, NULL, 0 },
+};
+
+// NOTE: Every item has fewer keys than this, so a bit for each fits
+#define MAX_ITEM_KEYS 16
+
+typedef struct _Mark {
+    const char *path;
+    size_t line;
+    size_t column;
+} Mark;
+
+typedef struct _NameSet {
+    // NOTE: Open addressed on interned name pointers, kept at most half full
+    const char **names;
+    Mark *marks;
+    uint32_t *values;
+    size_t capacity;
+    size_t total;
+} NameSet;
+
+typedef struct _Reference {
+    const char *owner;
+    const char *name;
+    Kind kind;
+    Mark mark;
+} Reference;
+
+typedef struct _ItemBirds {
+    const char *name;
+    size_t firstReference;
+    size_t totalReferences;
+} ItemBirds;
+
+typedef struct _TriggerTarget {
+    const char *owner;
+
+    const char *show;
+    Mark showMark;
+
+    const char *bird;
+    Mark birdMark;
+} TriggerTarget;
+
+typedef struct _ItemName {
+    const Key *key;
+    const char *name;
+    Mark mark;
+} ItemName;
+
+typedef struct _Item {
+    const Section *section;
+
+    const char *name;
+    Mark mark;
+
+    const char *values[MAX_ITEM_KEYS];
+    Mark valueMarks[MAX_ITEM_KEYS];
+    uint32_t parsedKeys;
+
+    bool hasRange;
+    uint32_t rangeFirst;
+    uint32_t rangeLast;
+
+    // NOTE: Kept between items, so the array is only grown by the largest
+    ItemName *names;
+    size_t totalNames;
+    size_t namesCapacity;
+} Item;
+
+typedef struct _Node {
+    Role role;
+    bool isMapping;
+    bool expectsKey;
+
+    // NOTE: What the next value belongs to. With neither, the value was already reported or is an item's name.
+    const Section *section;
+    const Key *key;
+    bool isName;
+    bool skipsValue;
+} Node;
+
+typedef struct _Include {
+    const char *path;
+    Mark mark;
+} Include;
+
+typedef struct _FileContext {
+    const char *path;
+    const char *directory;
+    size_t depth;
+
+    Node nodes[MAX_NODES];
+    size_t totalNodes;
+    size_t ignoredDepth;
+
+    Item item;
+
+    Include *includes;
+    size_t totalIncludes;
+    size_t includesCapacity;
+} FileContext;
+
+typedef struct _VisitedFile {
+    const char *path;
+    bool isLoading;
+} VisitedFile;
+
+typedef struct _ConfigurationValidator {
+    // NOTE: Every name, reference and diagnostic lives here until the next check
+    ArenaRef arena;
+
+    ConfigurationDiagnostic *diagnostics;
+    size_t totalDiagnostics;
+    size_t diagnosticsCapacity;
+
+    NameSet names[KindCount];
+
+    Reference *references;
+    size_t totalReferences;
+    size_t referencesCapacity;
+
+    ItemBirds *shows;
+    size_t totalShows;
+    size_t showsCapacity;
+
+    ItemBirds *groups;
+    size_t totalGroups;
+    size_t groupsCapacity;
+
+    TriggerTarget *triggers;
+    size_t totalTriggers;
+    size_t triggersCapacity;
+
+    VisitedFile *files;
+    size_t totalFiles;
+    size_t filesCapacity;
+
+    // NOTE: A bit for each settings key, so a setting made in two files is caught
+    uint32_t parsedSettings;
+} ConfigurationValidator;
+
+
+// MARK: - Prototypes
+
+static void ConfigurationValidatorReset(ConfigurationValidatorRef NONNULL self);
+static void ConfigurationValidatorCheckPath(ConfigurationValidatorRef NONNULL self, const char * NONNULL path, size_t depth, const Mark * NULLABLE includedAt);
+static void ConfigurationValidatorStream(ConfigurationValidatorRef NONNULL self, yaml_parser_t * NONNULL parser, FileContext * NONNULL context);
+static void ConfigurationValidatorFinish(ConfigurationValidatorRef NONNULL self);
+
+static void ConfigurationValidatorHandleEnd(ConfigurationValidatorRef NONNULL self, FileContext * NONNULL context);
+static void ConfigurationValidatorHandleKey(ConfigurationValidatorRef NONNULL self, FileContext * NONNULL context, Node * NONNULL parent, const char * NONNULL value, size_t valueSize, const Mark * NONNULL mark);
+static void ConfigurationValidatorHandleScalar(ConfigurationValidatorRef NONNULL self, FileContext * NONNULL context, const char * NONNULL value, size_t valueSize, const Mark * NONNULL mark);
+static void ConfigurationValidatorHandleStart(ConfigurationValidatorRef NONNULL self, FileContext * NONNULL context, bool isMapping, const Mark * NONNULL mark);
+static void ConfigurationValidatorEndValue(FileContext * NONNULL context);
+
+static void ConfigurationValidatorAddInclude(ConfigurationValidatorRef NONNULL self, FileContext * NONNULL context, const char * NONNULL value, size_t valueSize, const Mark * NONNULL mark);
+static void ConfigurationValidatorAddItemName(ConfigurationValidatorRef NONNULL self, FileContext * NONNULL context, const Key * NONNULL key, const char * NONNULL value, size_t valueSize, const Mark * NONNULL mark);
+static void ConfigurationValidatorAddReference(ConfigurationValidatorRef NONNULL self, const char * NONNULL owner, const char * NONNULL name, Kind kind, const Mark * NONNULL mark);
+static void ConfigurationValidatorDefine(ConfigurationValidatorRef NONNULL self, Kind kind, const char * NONNULL name, const Mark * NONNULL mark, uint32_t value);
+static void ConfigurationValidatorEndItem(ConfigurationValidatorRef NONNULL self, FileContext * NONNULL context);
+static void ConfigurationValidatorExpandItem(ConfigurationValidatorRef NONNULL self, Item * NONNULL item, const char * NONNULL name, bool hasIndex, uint32_t index);
+static const char * NULLABLE ConfigurationValidatorItemValue(const Item * NONNULL item, const char * NONNULL key, const Mark * NULLABLE * NULLABLE mark);
+static void ConfigurationValidatorValidateValue(ConfigurationValidatorRef NONNULL self, FileContext * NONNULL context, const Key * NONNULL key, const char * NONNULL value, size_t valueSize, const Mark * NONNULL mark);
+
+static void ConfigurationValidatorReport(ConfigurationValidatorRef NONNULL self, const Mark * NONNULL mark, const char * NONNULL format, ...);
+
+static const char * NONNULL ExpandName(ArenaRef NONNULL arena, const char * NONNULL name, uint32_t index);
+static const Key * NULLABLE FindKey(const Key * NONNULL keys, size_t totalKeys, const char * NONNULL name);
+static const Section * NULLABLE FindSection(const char * NONNULL name);
+static bool HasPlaceholder(const char * NONNULL name);
+
+static void NameSetAdd(NameSet * NONNULL set, ArenaRef NONNULL arena, const char * NONNULL name, const Mark * NONNULL mark, uint32_t value);
+static bool NameSetFind(const NameSet * NONNULL set, const char * NONNULL name, size_t * NONNULL slot);
+static void NameSetResize(NameSet * NONNULL set, ArenaRef NONNULL arena);
+
+
+// MARK: - Lifecycle Methods
+
+ConfigurationValidatorRef ConfigurationValidatorCreate() {
+    ConfigurationValidatorRef self = (ConfigurationValidatorRef)calloc(1, sizeof(ConfigurationValidator));
+    self->arena = ArenaCreate(ARENA_SIZE);
+
+    return self;
+}
+
+void ConfigurationValidatorDestroy(ConfigurationValidatorRef self) {
+    SAFE_DESTROY(self->arena, ArenaDestroy);
+
+    free(self);
+}
+
+static void ConfigurationValidatorReset(ConfigurationValidatorRef self) {
+    ArenaDestroy(self->arena);
+
+    memset(self, 0, sizeof(ConfigurationValidator));
+    self->arena = ArenaCreate(ARENA_SIZE);
+}
+
+
+// MARK: - Validation
+
+bool ConfigurationValidatorCheckFile(ConfigurationValidatorRef self, const char *path) {
+    ConfigurationValidatorReset(self);
+
+    ConfigurationValidatorCheckPath(self, path, 0, NULL);
+    ConfigurationValidatorFinish(self);
+
+    return self->totalDiagnostics == 0;
+}
+
+bool ConfigurationValidatorCheckString(ConfigurationValidatorRef self, const char *value) {
+    ConfigurationValidatorReset(self);
+
+    FileContext context;
+    memset(&context, 0, sizeof(FileContext));
+
+    context.path = STRING_PATH;
+    context.directory = ".";
+
+    yaml_parser_t parser;
+    yaml_parser_initialize(&parser);
+    yaml_parser_set_input_string(&parser, (const unsigned char *)value, strlen(value));
+
+    ConfigurationValidatorStream(self, &parser, &context);
+
+    yaml_parser_delete(&parser);
+
+    ConfigurationValidatorFinish(self);
+
+    return self->totalDiagnostics == 0;
+}
+
+static void ConfigurationValidatorCheckPath(ConfigurationValidatorRef self, const char *path, size_t depth, const Mark *includedAt) {
+    Mark fileMark = { ArenaIntern(self->arena, path, strlen(path)), 0, 0 };
+    const Mark *mark = (includedAt != NULL) ? includedAt : &fileMark;
+
+    if (depth > CONFIGURATION_LOADER_MAX_DEPTH) {
+        ConfigurationValidatorReport(self, mark, "Includes are nested more than %i deep", CONFIGURATION_LOADER_MAX_DEPTH);
+        return;
+    }
+
+    char *resolvedPath = realpath(path, NULL);
+
+    if (resolvedPath == NULL) {
+        ConfigurationValidatorReport(self, mark, "Failed to find configuration file %s: %s", path, strerror(errno));
+        return;
+    }
+
+    // Files are found by their resolved path, the same way the loader finds them
+    const char *visitedPath = ArenaIntern(self->arena, resolvedPath, strlen(resolvedPath));
+    free(resolvedPath);
+
+    for (size_t idx = 0; idx < self->totalFiles; idx++) {
+        if (self->files[idx].path != visitedPath) {
+            continue;
+        }
+
+        if (self->files[idx].isLoading) {
+            ConfigurationValidatorReport(self, mark, "%s includes itself", visitedPath);
+        } else {
+            ConfigurationValidatorReport(self, mark, "%s is included more than once", visitedPath);
+        }
+
+        return;
+    }
+
+    size_t fileIdx = self->totalFiles;
+
+    self->files = (VisitedFile *)ArenaAppend(self->arena, self->files, sizeof(VisitedFile), self->totalFiles, &self->filesCapacity);
+    self->files[fileIdx].path = visitedPath;
+    self->files[fileIdx].isLoading = true;
+    self->totalFiles += 1;
+
+    FILE *file = fopen(path, "r");
+
+    if (file == NULL) {
+        ConfigurationValidatorReport(self, mark, "Failed to open configuration file %s: %s", path, strerror(errno));
+        return;
+    }
+
+    // Includes are relative to the directory of the file that includes them
+    char pathCopy[PATH_MAX];
+    snprintf(pathCopy, sizeof(pathCopy), "%s", path);
+    const char *directory = dirname(pathCopy);
+
+    FileContext context;
+    memset(&context, 0, sizeof(FileContext));
+
+    context.path = fileMark.path;
+    context.directory = ArenaIntern(self->arena, directory, strlen(directory));
+    context.depth = depth;
+
+    yaml_parser_t parser;
+    yaml_parser_initialize(&parser);
+    yaml_parser_set_input_file(&parser, file);
+
+    ConfigurationValidatorStream(self, &parser, &context);
+
+    yaml_parser_delete(&parser);
+    fclose(file);
+
+    self->files[fileIdx].isLoading = false;
+}
+
+static void ConfigurationValidatorStream(ConfigurationValidatorRef self, yaml_parser_t *parser, FileContext *context) {
+    bool isDone = false;
+
+    while (!isDone) {
+        yaml_event_t event;
+
+        if (yaml_parser_parse(parser, &event) == 0) {
+            Mark mark = { context->path, parser->problem_mark.line + 1, parser->problem_mark.column + 1 };
+
+            // Nothing after a syntax error can be read
+            if (parser->problem == NULL) {
+                ConfigurationValidatorReport(self, &mark, "Invalid YAML (%i)", parser->error);
+            } else if (parser->context == NULL) {
+                ConfigurationValidatorReport(self, &mark, "Invalid YAML: %s", parser->problem);
+            } else {
+                ConfigurationValidatorReport(self, &mark, "Invalid YAML: %s %s", parser->problem, parser->context);
+            }
+
+            break;
+        }
+
+        Mark mark = { context->path, event.start_mark.line + 1, event.start_mark.column + 1 };
+
+        bool isStart = (event.type == YAML_MAPPING_START_EVENT || event.type == YAML_SEQUENCE_START_EVENT);
+        bool isEnd = (event.type == YAML_MAPPING_END_EVENT || event.type == YAML_SEQUENCE_END_EVENT);
+
+        if (context->ignoredDepth > 0) {
+            // Skip everything in a value that was already reported
+            if (isStart) {
+                context->ignoredDepth += 1;
+            } else if (isEnd) {
+                context->ignoredDepth -= 1;
+
+                if (context->ignoredDepth == 0) {
+                    ConfigurationValidatorEndValue(context);
+                }
+            }
+        } else if (isStart) {
+            ConfigurationValidatorHandleStart(self, context, event.type == YAML_MAPPING_START_EVENT, &mark);
+        } else if (isEnd) {
+            ConfigurationValidatorHandleEnd(self, context);
+        } else if (event.type == YAML_SCALAR_EVENT) {
+            ConfigurationValidatorHandleScalar(self, context, (const char *)event.data.scalar.value, event.data.scalar.length, &mark);
+        } else if (event.type == YAML_ALIAS_EVENT) {
+            ConfigurationValidatorReport(self, &mark, "Aliases are not supported");
+            ConfigurationValidatorEndValue(context);
+        } else if (event.type == YAML_STREAM_END_EVENT) {
+            isDone = true;
+        }
+
+        yaml_event_delete(&event);
+    }
+
+    // Check the includes once this file is done, so only one file is open at a time
+    for (size_t idx = 0; idx < context->totalIncludes; idx++) {
+        const Include *include = context->includes + idx;
+
+        char includePath[PATH_MAX];
+        int includePathSize = snprintf(includePath, sizeof(includePath), "%s/%s", context->directory, include->path);
+
+        if (include->path[0] == '/' || strcmp(context->directory, ".") == 0) {
+            includePathSize = snprintf(includePath, sizeof(includePath), "%s", include->path);
+        }
+
+        if (includePathSize < 0 || (size_t)includePathSize >= sizeof(includePath)) {
+            ConfigurationValidatorReport(self, &include->mark, "The path of %s is too long", include->path);
+            continue;
+        }
+
+        ConfigurationValidatorCheckPath(self, includePath, context->depth + 1, &include->mark);
+    }
+}
+
+static void ConfigurationValidatorFinish(ConfigurationValidatorRef self) {
+    // Every name is known now, so references can be checked in any order
+    for (size_t idx = 0; idx < self->totalReferences; idx++) {
+        const Reference *reference = self->references + idx;
+        size_t slot = 0;
+
+        if (!NameSetFind(&self->names[reference->kind], reference->name, &slot)) {
+            ConfigurationValidatorReport(self, &reference->mark, "\"%s\" references unknown %s \"%s\"", reference->owner, KindNames[reference->kind], reference->name);
+        }
+    }
+
+    // A show can not list a bird twice
+    NameSet seen;
+    memset(&seen, 0, sizeof(NameSet));
+
+    for (size_t showIdx = 0; showIdx < self->totalShows; showIdx++) {
+        const ItemBirds *show = self->shows + showIdx;
+
+        if (seen.total > 0) {
+            memset(seen.names, 0, sizeof(char *) * seen.capacity);
+            seen.total = 0;
+        }
+
+        for (size_t idx = 0; idx < show->totalReferences; idx++) {
+            const Reference *reference = self->references + show->firstReference + idx;
+            size_t slot = 0;
+
+            if (NameSetFind(&seen, reference->name, &slot)) {
+                ConfigurationValidatorReport(self, &reference->mark, "\"%s\" lists bird \"%s\" more than once", reference->owner, reference->name);
+            } else {
+                NameSetAdd(&seen, self->arena, reference->name, &reference->mark, 0);
+            }
+        }
+    }
+
+    // A bird can be in only one group, so its timing has a single source
+    if (seen.total > 0) {
+        memset(seen.names, 0, sizeof(char *) * seen.capacity);
+        seen.total = 0;
+    }
+
+    for (size_t groupIdx = 0; groupIdx < self->totalGroups; groupIdx++) {
+        const ItemBirds *group = self->groups + groupIdx;
+
+        for (size_t idx = 0; idx < group->totalReferences; idx++) {
+            const Reference *reference = self->references + group->firstReference + idx;
+            size_t slot = 0;
+
+            if (!NameSetFind(&seen, reference->name, &slot)) {
+                NameSetAdd(&seen, self->arena, reference->name, &reference->mark, (uint32_t)groupIdx);
+            } else if (seen.values[slot] == groupIdx) {
+                ConfigurationValidatorReport(self, &reference->mark, "\"%s\" lists bird \"%s\" more than once", reference->owner, reference->name);
+            } else {
+                ConfigurationValidatorReport(self, &reference->mark, "\"%s\" is in group \"%s\" and group \"%s\"", reference->name, self->groups[seen.values[slot]].name, reference->owner);
+            }
+        }
+    }
+
+    // A trigger's bird must be in its show, or in every show without one
+    for (size_t triggerIdx = 0; triggerIdx < self->totalTriggers; triggerIdx++) {
+        const TriggerTarget *trigger = self->triggers + triggerIdx;
+        size_t slot = 0;
+
+        bool hasShow = false;
+        uint32_t showIdx = 0;
+
+        if (trigger->show != NULL) {
+            if (!NameSetFind(&self->names[KindShow], trigger->show, &slot)) {
+                ConfigurationValidatorReport(self, &trigger->showMark, "\"%s\" references unknown show \"%s\"", trigger->owner, trigger->show);
+                continue;
+            }
+
+            hasShow = true;
+            showIdx = self->names[KindShow].values[slot];
+        }
+
+        if (trigger->bird == NULL) {
+            continue;
+        }
+
+        if (!NameSetFind(&self->names[KindBird], trigger->bird, &slot)) {
+            ConfigurationValidatorReport(self, &trigger->birdMark, "\"%s\" references unknown bird \"%s\"", trigger->owner, trigger->bird);
+            continue;
+        }
+
+        for (uint32_t idx = 0; idx < self->totalShows; idx++) {
+            if (hasShow && idx != showIdx) {
+                continue;
+            }
+
+            const ItemBirds *show = self->shows + idx;
+            bool isInShow = false;
+
+            for (size_t birdIdx = 0; birdIdx < show->totalReferences && !isInShow; birdIdx++) {
+                isInShow = (self->references[show->firstReference + birdIdx].name == trigger->bird);
+            }
+
+            if (!isInShow) {
+                ConfigurationValidatorReport(self, &trigger->birdMark, "\"%s\" pecks bird \"%s\", which is not in show \"%s\"", trigger->owner, trigger->bird, show->name);
+            }
+        }
+    }
+}
+
+
+// MARK: - Events
+
+static void ConfigurationValidatorHandleStart(ConfigurationValidatorRef self, FileContext *context, bool isMapping, const Mark *mark) {
+    Node *parent = (context->totalNodes > 0) ? context->nodes + context->totalNodes - 1 : NULL;
+    Node node;
+    memset(&node, 0, sizeof(Node));
+
+    node.role = RoleIgnored;
+    node.isMapping = isMapping;
+    node.expectsKey = isMapping;
+
+    if (parent == NULL) {
+        if (isMapping) {
+            node.role = RoleRoot;
+        } else {
+            ConfigurationValidatorReport(self, mark, "The top level must be a mapping of sections");
+        }
+    } else if (parent->isMapping && parent->expectsKey) {
+        ConfigurationValidatorReport(self, mark, "Keys must be single values");
+    } else if (parent->skipsValue) {
+        // Already reported
+    } else if (parent->role == RoleRoot && parent->section != NULL) {
+        const Section *section = parent->section;
+
+        if (section->role == RoleSettings && isMapping) {
+            node.role = RoleSettings;
+        } else if (section->role != RoleSettings && !isMapping) {
+            node.role = section->role;
+        } else {
+            ConfigurationValidatorReport(self, mark, "The %s section must be a %s", section->name, (section->role == RoleSettings) ? "mapping" : "list");
+        }
+    } else if (parent->role == RoleItems) {
+        if (isMapping) {
+            node.role = RoleItem;
+
+            memset(context->item.values, 0, sizeof(context->item.values));
+            context->item.section = parent->section;
+            context->item.name = NULL;
+            context->item.parsedKeys = 0;
+            context->item.hasRange = false;
+            context->item.totalNames = 0;
+        } else {
+            ConfigurationValidatorReport(self, mark, "Each %s must be a mapping", KindNames[parent->section->kind]);
+        }
+    } else if (parent->role == RoleItem && parent->isName) {
+        ConfigurationValidatorReport(self, mark, "The keys of \"%s\" must line up with its name", context->item.name);
+    } else if (parent->role == RoleItem && parent->key != NULL && parent->key->type == ValueTypeNames && !isMapping) {
+        node.role = RoleNames;
+        node.key = parent->key;
+    } else if (parent->key != NULL) {
+        ConfigurationValidatorReport(self, mark, "\"%s\" must be a single value", parent->key->name);
+    } else {
+        ConfigurationValidatorReport(self, mark, "Expected a single value");
+    }
+
+    if (node.role == RoleIgnored) {
+        context->ignoredDepth = 1;
+        return;
+    }
+
+    if (context->totalNodes == MAX_NODES) {
+        ConfigurationValidatorReport(self, mark, "Values are nested too deeply");
+        context->ignoredDepth = 1;
+        return;
+    }
+
+    // The section of the Items is kept, so each item can find it
+    if (node.role == RoleItems) {
+        node.section = parent->section;
+    }
+
+    context->nodes[context->totalNodes] = node;
+    context->totalNodes += 1;
+}
+
+static void ConfigurationValidatorHandleEnd(ConfigurationValidatorRef self, FileContext *context) {
+    if (context->totalNodes == 0) {
+        return;
+    }
+
+    context->totalNodes -= 1;
+
+    if (context->nodes[context->totalNodes].role == RoleItem) {
+        ConfigurationValidatorEndItem(self, context);
+    }
+
+    ConfigurationValidatorEndValue(context);
+}
+
+static void ConfigurationValidatorHandleKey(ConfigurationValidatorRef self, FileContext *context, Node *parent, const char *value, size_t valueSize, const Mark *mark) {
+    parent->expectsKey = false;
+    parent->section = NULL;
+    parent->key = NULL;
+    parent->isName = false;
+    parent->skipsValue = false;
+
+    if (parent->role == RoleRoot) {
+        parent->section = FindSection(value);
+
+        if (parent->section == NULL) {
+            ConfigurationValidatorReport(self, mark, "Unknown section \"%s\"", value);
+            parent->skipsValue = true;
+        }
+    } else if (parent->role == RoleSettings) {
+        parent->key = FindKey(SettingsKeys, TOTAL(SettingsKeys), value);
+
+        if (parent->key == NULL) {
+            ConfigurationValidatorReport(self, mark, "Unknown setting \"%s\"", value);
+            parent->skipsValue = true;
+            return;
+        }
+
+        uint32_t bit = 1u << (uint32_t)(parent->key - SettingsKeys);
+
+        if ((self->parsedSettings & bit) != 0) {
+            ConfigurationValidatorReport(self, mark, "Setting \"%s\" is set more than once", value);
+        }
+
+        self->parsedSettings |= bit;
+    } else if (parent->role == RoleItem) {
+        Item *item = &context->item;
+
+        // The first key is the item's name
+        if (item->name == NULL) {
+            item->name = ArenaIntern(self->arena, value, valueSize);
+            item->mark = *mark;
+            parent->isName = true;
+
+            if (valueSize == 0) {
+                ConfigurationValidatorReport(self, mark, "A %s is missing a name", KindNames[item->section->kind]);
+            }
+
+            return;
+        }
+
+        parent->key = FindKey(item->section->keys, item->section->totalKeys, value);
+
+        if (parent->key == NULL) {
+            ConfigurationValidatorReport(self, mark, "Unknown %s key \"%s\" in \"%s\"", KindNames[item->section->kind], value, item->name);
+            parent->skipsValue = true;
+            return;
+        }
+
+        uint32_t bit = 1u << (uint32_t)(parent->key - item->section->keys);
+
+        if ((item->parsedKeys & bit) != 0) {
+            ConfigurationValidatorReport(self, mark, "\"%s\" has more than one %s", item->name, value);
+        }
+
+        item->parsedKeys |= bit;
+    }
+}
+
+static void ConfigurationValidatorHandleScalar(ConfigurationValidatorRef self, FileContext *context, const char *value, size_t valueSize, const Mark *mark) {
+    Node *parent = (context->totalNodes > 0) ? context->nodes + context->totalNodes - 1 : NULL;
+
+    if (parent == NULL) {
+        // An empty document is allowed
+        if (valueSize > 0) {
+            ConfigurationValidatorReport(self, mark, "The top level must be a mapping of sections");
+        }
+
+        return;
+    } else if (parent->isMapping && parent->expectsKey) {
+        ConfigurationValidatorHandleKey(self, context, parent, value, valueSize, mark);
+        return;
+    }
+
+    if (parent->skipsValue) {
+        // Already reported
+    } else if (parent->role == RoleRoot) {
+        if (parent->section->role == RoleIncludes) {
+            // A single include is a scalar instead of a list
+            if (valueSize > 0) {
+                ConfigurationValidatorAddInclude(self, context, value, valueSize, mark);
+            }
+        } else if (valueSize > 0) {
+            ConfigurationValidatorReport(self, mark, "The %s section must be a %s", parent->section->name, (parent->section->role == RoleSettings) ? "mapping" : "list");
+        }
+    } else if (parent->role == RoleSettings) {
+        ConfigurationValidatorValidateValue(self, context, parent->key, value, valueSize, mark);
+    } else if (parent->role == RoleItem && parent->isName) {
+        if (valueSize > 0) {
+            ConfigurationValidatorReport(self, mark, "Unexpected value \"%s\" after the name \"%s\"", value, context->item.name);
+        }
+    } else if (parent->role == RoleItem) {
+        ConfigurationValidatorValidateValue(self, context, parent->key, value, valueSize, mark);
+    } else if (parent->role == RoleItems) {
+        ConfigurationValidatorReport(self, mark, "Each %s must be a mapping", KindNames[parent->section->kind]);
+    } else if (parent->role == RoleNames) {
+        ConfigurationValidatorAddItemName(self, context, parent->key, value, valueSize, mark);
+    } else if (parent->role == RoleIncludes) {
+        ConfigurationValidatorAddInclude(self, context, value, valueSize, mark);
+    }
+
+    ConfigurationValidatorEndValue(context);
+}
+
+static void ConfigurationValidatorEndValue(FileContext *context) {
+    if (context->totalNodes == 0) {
+        return;
+    }
+
+    Node *parent = context->nodes + context->totalNodes - 1;
+
+    if (parent->isMapping) {
+        parent->expectsKey = true;
+        parent->section = NULL;
+        parent->key = NULL;
+        parent->isName = false;
+        parent->skipsValue = false;
+    }
+}
+
+
+// MARK: - Items
+
+static void ConfigurationValidatorAddInclude(ConfigurationValidatorRef self, FileContext *context, const char *value, size_t valueSize, const Mark *mark) {
+    if (valueSize == 0) {
+        ConfigurationValidatorReport(self, mark, "An include is empty");
+        return;
+    }
+
+    context->includes = (Include *)ArenaAppend(self->arena, context->includes, sizeof(Include), context->totalIncludes, &context->includesCapacity);
+    context->includes[context->totalIncludes].path = ArenaIntern(self->arena, value, valueSize);
+    context->includes[context->totalIncludes].mark = *mark;
+    context->totalIncludes += 1;
+}
+
+static void ConfigurationValidatorAddItemName(ConfigurationValidatorRef self, FileContext *context, const Key *key, const char *value, size_t valueSize, const Mark *mark) {
+    Item *item = &context->item;
+
+    if (valueSize == 0) {
+        ConfigurationValidatorReport(self, mark, "\"%s\" has an empty name in %s", item->name, key->name);
+        return;
+    }
+
+    item->names = (ItemName *)ArenaAppend(self->arena, item->names, sizeof(ItemName), item->totalNames, &item->namesCapacity);
+    item->names[item->totalNames].key = key;
+    item->names[item->totalNames].name = ArenaIntern(self->arena, value, valueSize);
+    item->names[item->totalNames].mark = *mark;
+    item->totalNames += 1;
+}
+
+static void ConfigurationValidatorAddReference(ConfigurationValidatorRef self, const char *owner, const char *name, Kind kind, const Mark *mark) {
+    self->references = (Reference *)ArenaAppend(self->arena, self->references, sizeof(Reference), self->totalReferences, &self->referencesCapacity);
+
+    Reference *reference = self->references + self->totalReferences;
+    reference->owner = owner;
+    reference->name = name;
+    reference->kind = kind;
+    reference->mark = *mark;
+
+    self->totalReferences += 1;
+}
+
+static void ConfigurationValidatorDefine(ConfigurationValidatorRef self, Kind kind, const char *name, const Mark *mark, uint32_t value) {
+    NameSet *set = &self->names[kind];
+    size_t slot = 0;
+
+    if (NameSetFind(set, name, &slot)) {
+        const Mark *first = set->marks + slot;
+        ConfigurationValidatorReport(self, mark, "Duplicate %s name \"%s\", first defined at %s:%zu", KindNames[kind], name, first->path, first->line);
+        return;
+    }
+
+    NameSetAdd(set, self->arena, name, mark, value);
+}
+
+static void ConfigurationValidatorEndItem(ConfigurationValidatorRef self, FileContext *context) {
+    Item *item = &context->item;
+    Kind kind = item->section->kind;
+
+    if (item->name == NULL || item->name[0] == '\0') {
+        return;
+    }
+
+    const Mark *valueMark = NULL;
+
+    if (kind == KindOutput) {
+        const char *type = ConfigurationValidatorItemValue(item, "Type", NULL);
+
+        if (type == NULL) {
+            ConfigurationValidatorReport(self, &item->mark, "Output \"%s\" is missing a type", item->name);
+        } else if (strcmp(type, "File") == 0 && ConfigurationValidatorItemValue(item, "Path", NULL) == NULL) {
+            ConfigurationValidatorReport(self, &item->mark, "File output \"%s\" is missing a path", item->name);
+        } else if (strcmp(type, "GPIO") == 0 && ConfigurationValidatorItemValue(item, "Pin", NULL) == NULL) {
+            ConfigurationValidatorReport(self, &item->mark, "GPIO output \"%s\" is missing a pin", item->name);
+        }
+
+        if (item->hasRange && !HasPlaceholder(item->name)) {
+            ConfigurationValidatorReport(self, &item->mark, "Output \"%s\" has a range, but its name has no %c", item->name, CONFIGURATION_TEMPLATE_PLACEHOLDER);
+            return;
+        }
+    } else if (kind == KindTrigger) {
+        const char *action = ConfigurationValidatorItemValue(item, "Action", NULL);
+
+        if (ConfigurationValidatorItemValue(item, "Type", NULL) == NULL) {
+            ConfigurationValidatorReport(self, &item->mark, "Trigger \"%s\" is missing a type", item->name);
+        }
+
+        if (ConfigurationValidatorItemValue(item, "Source", NULL) == NULL) {
+            ConfigurationValidatorReport(self, &item->mark, "Trigger \"%s\" is missing a source", item->name);
+        }
+
+        TriggerTarget target;
+        memset(&target, 0, sizeof(TriggerTarget));
+
+        target.owner = item->name;
+        target.show = ConfigurationValidatorItemValue(item, "Show", &valueMark);
+        target.showMark = (valueMark != NULL) ? *valueMark : item->mark;
+        target.bird = ConfigurationValidatorItemValue(item, "Bird", &valueMark);
+        target.birdMark = (valueMark != NULL) ? *valueMark : item->mark;
+
+        if (target.bird != NULL && action != NULL && strcmp(action, "Peck") != 0) {
+            ConfigurationValidatorReport(self, &target.birdMark, "Trigger \"%s\" can only name a bird to peck", item->name);
+            target.bird = NULL;
+        }
+
+        self->triggers = (TriggerTarget *)ArenaAppend(self->arena, self->triggers, sizeof(TriggerTarget), self->totalTriggers, &self->triggersCapacity);
+        self->triggers[self->totalTriggers] = target;
+        self->totalTriggers += 1;
+    }
+
+    // Define the item, or every item its template makes. An invalid item is still defined, so what uses it is not reported again.
+    if (item->hasRange && HasPlaceholder(item->name)) {
+        for (uint64_t index = item->rangeFirst; index <= item->rangeLast; index++) {
+            ConfigurationValidatorExpandItem(self, item, ExpandName(self->arena, item->name, index), true, index);
+        }
+    } else {
+        ConfigurationValidatorExpandItem(self, item, item->name, false, 0);
+    }
+}
+
+static void ConfigurationValidatorExpandItem(ConfigurationValidatorRef self, Item *item, const char *name, bool hasIndex, uint32_t index) {
+    Kind kind = item->section->kind;
+    size_t firstReference = self->totalReferences;
+
+    ConfigurationValidatorDefine(self, kind, name, &item->mark, (uint32_t)self->totalShows);
+
+    for (size_t idx = 0; idx < item->totalNames; idx++) {
+        const ItemName *itemName = item->names + idx;
+
+        // An instance names its own index. Without instances, a templated name stands for every index in the range.
+        if (hasIndex) {
+            ConfigurationValidatorAddReference(self, name, ExpandName(self->arena, itemName->name, index), itemName->key->kind, &itemName->mark);
+        } else if (item->hasRange && HasPlaceholder(itemName->name)) {
+            for (uint64_t rangeIdx = item->rangeFirst; rangeIdx <= item->rangeLast; rangeIdx++) {
+                ConfigurationValidatorAddReference(self, name, ExpandName(self->arena, itemName->name, rangeIdx), itemName->key->kind, &itemName->mark);
+            }
+        } else {
+            ConfigurationValidatorAddReference(self, name, itemName->name, itemName->key->kind, &itemName->mark);
+        }
+    }
+
+    if (kind == KindShow) {
+        self->shows = (ItemBirds *)ArenaAppend(self->arena, self->shows, sizeof(ItemBirds), self->totalShows, &self->showsCapacity);
+        self->shows[self->totalShows].name = name;
+        self->shows[self->totalShows].firstReference = firstReference;
+        self->shows[self->totalShows].totalReferences = self->totalReferences - firstReference;
+        self->totalShows += 1;
+    } else if (kind == KindGroup) {
+        self->groups = (ItemBirds *)ArenaAppend(self->arena, self->groups, sizeof(ItemBirds), self->totalGroups, &self->groupsCapacity);
+        self->groups[self->totalGroups].name = name;
+        self->groups[self->totalGroups].firstReference = firstReference;
+        self->groups[self->totalGroups].totalReferences = self->totalReferences - firstReference;
+        self->totalGroups += 1;
+    }
+}
+
+static const char * ConfigurationValidatorItemValue(const Item *item, const char *key, const Mark **mark) {
+    const Key *found = FindKey(item->section->keys, item->section->totalKeys, key);
+    size_t idx = (size_t)(found - item->section->keys);
+
+    if (mark != NULL) {
+        *mark = (item->values[idx] != NULL) ? item->valueMarks + idx : NULL;
+    }
+
+    return item->values[idx];
+}
+
+static void ConfigurationValidatorValidateValue(ConfigurationValidatorRef self, FileContext *context, const Key *key, const char *value, size_t valueSize, const Mark *mark) {
+    Item *item = &context->item;
+    bool isInItem = (context->totalNodes > 0 && context->nodes[context->totalNodes - 1].role == RoleItem);
+    const char *owner = isInItem ? item->name : "Settings";
+
+    char *end = NULL;
+
+    if (valueSize == 0) {
+        ConfigurationValidatorReport(self, mark, "\"%s\" has no value for %s", owner, key->name);
+        return;
+    }
+
+    switch (key->type) {
+        case ValueTypeString:
+            break;
+        case ValueTypeNumber:
+        case ValueTypePositiveNumber: {
+            errno = 0;
+            unsigned long number = strtoul(value, &end, 10);
+
+            if (value[0] == '-' || *end != '\0' || errno != 0 || number > UINT32_MAX) {
+                ConfigurationValidatorReport(self, mark, "Expected a number for %s of \"%s\", found \"%s\"", key->name, owner, value);
+            } else if (key->type == ValueTypePositiveNumber && number == 0) {
+                ConfigurationValidatorReport(self, mark, "%s must be greater than 0", key->name);
+            }
+
+            break;
+        }
+        case ValueTypeSignedNumber: {
+            errno = 0;
+            long number = strtol(value, &end, 10);
+
+            if (*end != '\0' || errno != 0 || number < INT32_MIN || number > INT32_MAX) {
+                ConfigurationValidatorReport(self, mark, "Expected a number for %s of \"%s\", found \"%s\"", key->name, owner, value);
+            }
+
+            break;
+        }
+        case ValueTypeChoice: {
+            bool isValid = false;
+
+            for (const char * const *choice = key->choices; *choice != NULL && !isValid; choice++) {
+                isValid = (strcmp(*choice, value) == 0);
+            }
+
+            if (!isValid) {
+                char choices[64] = "";
+
+                for (const char * const *choice = key->choices; *choice != NULL; choice++) {
+                    strncat(choices, (choice == key->choices) ? "" : ", ", sizeof(choices) - strlen(choices) - 1);
+                    strncat(choices, *choice, sizeof(choices) - strlen(choices) - 1);
+                }
+
+                ConfigurationValidatorReport(self, mark, "Invalid %s \"%s\" for \"%s\", expected one of %s", key->name, value, owner, choices);
+            }
+
+            break;
+        }
+        case ValueTypeLogLevels:
+            if (!LogCheckTagLevels(value)) {
+                ConfigurationValidatorReport(self, mark, "Invalid %s \"%s\", expected TAG=LEVEL items with levels verbose, debug, info, warn or error", key->name, value);
+            }
+
+            break;
+        case ValueTypeNames:
+            // A single name is a scalar instead of a list
+            ConfigurationValidatorAddItemName(self, context, key, value, valueSize, mark);
+            return;
+        case ValueTypeRange: {
+            const char *error = ConfigurationParseRange(value, &item->rangeFirst, &item->rangeLast);
+
+            if (error != NULL) {
+                ConfigurationValidatorReport(self, mark, "Invalid range \"%s\", %s", value, error);
+            } else {
+                item->hasRange = true;
+            }
+
+            return;
+        }
+    }
+
+    // Values are kept for the checks made once the item ends. Invalid ones were reported, so they are not reported again as missing.
+    if (isInItem) {
+        size_t idx = (size_t)(key - item->section->keys);
+
+        item->values[idx] = ArenaIntern(self->arena, value, valueSize);
+        item->valueMarks[idx] = *mark;
+    }
+}
+
+
+// MARK: - Diagnostics
+
+const ConfigurationDiagnostic * ConfigurationValidatorGetDiagnostic(const ConfigurationValidatorRef self, size_t idx) {
+    if (idx >= self->totalDiagnostics) {
+        return NULL;
+    }
+
+    return self->diagnostics + idx;
+}
+
+size_t ConfigurationValidatorGetTotalDiagnostics(const ConfigurationValidatorRef self) {
+    return self->totalDiagnostics;
+}
+
+void ConfigurationValidatorDumpDiagnostics(const ConfigurationValidatorRef self, int fd) {
+    for (size_t idx = 0; idx < self->totalDiagnostics; idx++) {
+        const ConfigurationDiagnostic *diagnostic = self->diagnostics + idx;
+
+        if (diagnostic->line == 0) {
+            dprintf(fd, "%s: %s\n", diagnostic->path, diagnostic->message);
+        } else {
+            dprintf(fd, "%s:%zu:%zu: %s\n", diagnostic->path, diagnostic->line, diagnostic->column, diagnostic->message);
+        }
+    }
+}
+
+static void ConfigurationValidatorReport(ConfigurationValidatorRef self, const Mark *mark, const char *format, ...) {
+    va_list args;
+
+    va_start(args, format);
+    int messageSize = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+
+    char *message = (char *)ArenaAllocate(self->arena, (size_t)messageSize + 1);
+
+    va_start(args, format);
+    vsnprintf(message, (size_t)messageSize + 1, format, args);
+    va_end(args);
+
+    self->diagnostics = (ConfigurationDiagnostic *)ArenaAppend(self->arena, self->diagnostics, sizeof(ConfigurationDiagnostic), self->totalDiagnostics, &self->diagnosticsCapacity);
+
+    ConfigurationDiagnostic *diagnostic = self->diagnostics + self->totalDiagnostics;
+    diagnostic->path = mark->path;
+    diagnostic->line = mark->line;
+    diagnostic->column = mark->column;
+    diagnostic->message = message;
+
+    self->totalDiagnostics += 1;
+}
+
+
+// MARK: - Utilities
+
+static const char * ExpandName(ArenaRef arena, const char *name, uint32_t index) {
+    if (!HasPlaceholder(name)) {
+        return name;
+    }
+
+    char number[16];
+    size_t numberSize = (size_t)snprintf(number, sizeof(number), "%" PRIu32, index);
+
+    size_t totalPlaceholders = 0;
+
+    for (const char *character = name; *character != '\0'; character++) {
+        totalPlaceholders += (*character == CONFIGURATION_TEMPLATE_PLACEHOLDER) ? 1 : 0;
+    }
+
+    size_t expandedSize = strlen(name) - totalPlaceholders + (totalPlaceholders * numberSize);
+    char expanded[expandedSize + 1];
+    char *cursor = expanded;
+
+    for (const char *character = name; *character != '\0'; character++) {
+        if (*character == CONFIGURATION_TEMPLATE_PLACEHOLDER) {
+            memcpy(cursor, number, numberSize);
+            cursor += numberSize;
+        } else {
+            *cursor = *character;
+            cursor += 1;
+        }
+    }
+
+    return ArenaIntern(arena, expanded, expandedSize);
+}
+
+static const Key * FindKey(const Key *keys, size_t totalKeys, const char *name) {
+    for (size_t idx = 0; idx < totalKeys; idx++) {
+        if (strcmp(keys[idx].name, name) == 0) {
+            return keys + idx;
+        }
+    }
+
+    return NULL;
+}
+
+static const Section * FindSection(const char *name) {
+    for (size_t idx = 0; idx < TOTAL(Sections); idx++) {
+        if (strcmp(Sections[idx].name, name) == 0) {
+            return Sections + idx;
+        }
+    }
+
+    return NULL;
+}
+
+static bool HasPlaceholder(const char *name) {
+    return strchr(name, CONFIGURATION_TEMPLATE_PLACEHOLDER) != NULL;
+}
+
+static void NameSetAdd(NameSet *set, ArenaRef arena, const char *name, const Mark *mark, uint32_t value) {
+    if ((set->total + 1) * 2 > set->capacity) {
+        NameSetResize(set, arena);
+    }
+
+    size_t mask = set->capacity - 1;
+    size_t slot = (size_t)(((uint64_t)(uintptr_t)name * POINTER_HASH_MULTIPLIER) >> 32) & mask;
+
+    while (set->names[slot] != NULL) {
+        slot = (slot + 1) & mask;
+    }
+
+    set->names[slot] = name;
+    set->marks[slot] = *mark;
+    set->values[slot] = value;
+    set->total += 1;
+}
+
+static bool NameSetFind(const NameSet *set, const char *name, size_t *slot) {
+    if (set->capacity == 0) {
+        return false;
+    }
+
+    size_t mask = set->capacity - 1;
+    size_t current = (size_t)(((uint64_t)(uintptr_t)name * POINTER_HASH_MULTIPLIER) >> 32) & mask;
+
+    while (set->names[current] != NULL) {
+        if (set->names[current] == name) {
+            *slot = current;
+            return true;
+        }
+
+        current = (current + 1) & mask;
+    }
+
+    return false;
+}
+
+static void NameSetResize(NameSet *set, ArenaRef arena) {
+    NameSet resized;
+    memset(&resized, 0, sizeof(NameSet));
+
+    resized.capacity = (set->capacity == 0) ? MINIMUM_NAMES_CAPACITY : set->capacity * 2;
+    resized.names = (const char **)ArenaAllocate(arena, sizeof(char *) * resized.capacity);
+    resized.marks = (Mark *)ArenaAllocate(arena, sizeof(Mark) * resized.capacity);
+    resized.values = (uint32_t *)ArenaAllocate(arena, sizeof(uint32_t) * resized.capacity);
+
+    for (size_t idx = 0; idx < set->capacity; idx++) {
+        if (set->names[idx] != NULL) {
+            NameSetAdd(&resized, arena, set->names[idx], set->marks + idx, set->values[idx]);
+        }
+    }
+
+    *set = resized;
+}
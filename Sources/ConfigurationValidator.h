@@ -0,0 +1,98 @@
+//
+//  ConfigurationValidator.h
+//  Woodpeckers
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#ifndef CONFIGURATION_VALIDATOR_H
+#define CONFIGURATION_VALIDATOR_H
+
+#include "Macros.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+
+BEGIN_DECLS
+
+
+// MARK: - Constants & Globals
+
+/// The Configuration Validator object, which checks configuration files without loading them.
+typedef struct _ConfigurationValidator * ConfigurationValidatorRef;
+
+/// A problem found in a configuration file
+typedef struct _ConfigurationDiagnostic {
+    const char *path;    ///< The file with the problem
+    size_t line;         ///< The line of the problem, starting at 1
+    size_t column;       ///< The column of the problem, starting at 1
+    const char *message; ///< A description of the problem
+} ConfigurationDiagnostic;
+
+
+// MARK: - Lifecycle Methods
+
+/**
+ * Create a Configuration Validator.
+ * \return A new Configuration Validator instance.
+ */
+ConfigurationValidatorRef NONNULL ConfigurationValidatorCreate(void);
+
+/**
+ * Destroy a Configuration Validator and every diagnostic it has collected.
+ * \param validator The instance to destroy.
+ */
+void ConfigurationValidatorDestroy(ConfigurationValidatorRef NONNULL validator);
+
+
+// MARK: - Validation
+
+/**
+ * Check a configuration file and every file it includes.
+ * \param validator The instance to check with.
+ * \param path The path of the root configuration file.
+ * \return `true` if no problems were found, otherwise `false`.
+ * \note The files are streamed once, keeping only names and references, and every problem is collected instead of stopping at the first. Diagnostics from an earlier check are discarded.
+ * \note A YAML syntax error ends the check of its file, since nothing after it can be read.
+ */
+bool ConfigurationValidatorCheckFile(ConfigurationValidatorRef NONNULL validator, const char * NONNULL path);
+
+/**
+ * Check a configuration in a string.
+ * \param validator The instance to check with.
+ * \param value The YAML to check.
+ * \return `true` if no problems were found, otherwise `false`.
+ * \note Includes are relative to the current directory.
+ */
+bool ConfigurationValidatorCheckString(ConfigurationValidatorRef NONNULL validator, const char * NONNULL value);
+
+
+// MARK: - Diagnostics
+
+/**
+ * Get a diagnostic from the last check.
+ * \param validator The instance to inspect.
+ * \param idx The index of the diagnostic.
+ * \return The diagnostic, or `NULL` if the index is out of bounds. It is valid until the next check.
+ */
+const ConfigurationDiagnostic * NULLABLE ConfigurationValidatorGetDiagnostic(const ConfigurationValidatorRef NONNULL validator, size_t idx);
+
+/**
+ * Get the number of diagnostics from the last check.
+ * \param validator The instance to inspect.
+ * \return The number of problems found.
+ */
+size_t ConfigurationValidatorGetTotalDiagnostics(const ConfigurationValidatorRef NONNULL validator);
+
+/**
+ * Write every diagnostic from the last check, one per line, as `PATH:LINE:COLUMN: MESSAGE`.
+ * \param validator The instance to dump.
+ * \param fd The file descriptor to write to.
+ */
+void ConfigurationValidatorDumpDiagnostics(const ConfigurationValidatorRef NONNULL validator, int fd);
+
+END_DECLS
+
+#endif /* CONFIGURATION_VALIDATOR_H */
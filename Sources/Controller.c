@@ -12,9 +12,9 @@
 #include <string.h>
 #include <time.h>
 
-#include "EventLoop.h"
 #include "Log.h"
-#include "Output.h"
+#include "Signals.h"
+#include "Trace.h"
 
 
 // MARK: - Constants & Globals
@@ -29,48 +29,120 @@
 
 #define STARTUP_WAIT 500
 
+// NOTE: Timer IDs are offsets in to the Controller's timer namespace
 #define INITIAL_TIMER_ID 1
 #define PECKING_TIMER_ID 4
 #define STARTUP_TIMER_ID 2
 #define WAITING_TIMER_ID 3
 
+#define TIMER_ID(C, T) ((EventID)((C)->timerBase + (T)))
+
+#define TRANSITION_HISTORY_SIZE 64
+
+#define INITIAL_BIRD_SLOTS 16
+#define INITIAL_CAPACITY 8
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+// NOTE: An array that fails to grow keeps its contents, and the capacity only moves once every array has grown
+#define GROW_ARRAY(A, C) do { \
+    void *grown = realloc((A), sizeof(*(A)) * (C)); \
+    if (grown == NULL) { \
+        return false; \
+    } \
+    (A) = grown; \
+} while (0)
+
 typedef enum _ControllerState {
     ControllerStateInitial = 0,
     ControllerStateStartup,
     ControllerStateWaiting,
     ControllerStatePecking,
+    ControllerStateCount,
 } ControllerState;
 
+typedef enum _ControllerEvent {
+    ControllerEventStart = 0,
+    ControllerEventStop,
+    ControllerEventStartupComplete,
+    ControllerEventWaitElapsed,
+    ControllerEventPecksComplete,
+    ControllerEventTriggered,
+    ControllerEventCount,
+} ControllerEvent;
+
+typedef void (* ControllerAction)(ControllerRef NONNULL controller);
+
+typedef struct _ControllerStateHandlers {
+    ControllerAction start;
+    ControllerAction stop;
+} ControllerStateHandlers;
+
+typedef struct _ControllerTransition {
+    bool isValid;
+    ControllerState nextState;
+    ControllerAction NULLABLE action;
+} ControllerTransition;
+
+typedef struct _ControllerTransitionRecord {
+    uint64_t timestamp;
+    uint8_t fromState;
+    uint8_t toState;
+    uint8_t event;
+} ControllerTransitionRecord;
+
+typedef struct _ControllerSubscription {
+    ControllerRef controller;
+    ControllerTriggerAction action;
+    bool hasBird;
+    size_t birdIndex;
+} ControllerSubscription;
+
 typedef struct _Bird {
     char *name;
 
-    // NOTE: These arrays do not out the outputs
-    OutputRef *statics;
+    // NOTE: These are indices in to the Output Table
+    size_t *statics;
     size_t totalStatics;
 
-    OutputRef *backs;
+    size_t *backs;
     size_t totalBacks;
 
-    OutputRef *forwards;
+    size_t *forwards;
     size_t totalForwards;
 } Bird;
 
 typedef struct _Controller {
-    uint32_t minWait;
-    uint32_t maxWait;
-    uint32_t minPecks;
-    uint32_t maxPecks;
-    uint32_t peckWait;
+    char *name;
+    EventID timerBase;
+
+    // NOTE: The show's timing. Birds follow it, except for the settings they override.
+    ControllerTiming timing;
 
     EventLoopRef eventLoop;
+    OutputTableRef outputTable;
 
     ControllerState state;
 
-    OutputRef *outputs;
+    // NOTE: The outputs are owned by the Output Table. These are the indices of the outputs used by this show.
+    size_t *outputs;
     size_t totalOutputs;
+    size_t outputCapacity;
+
+    // NOTE: Indexed like the Output Table, marking the outputs in `outputs`
+    bool *isShowOutputs;
+    size_t totalShowOutputFlags;
 
     Bird *birds;
     size_t totalBirds;
+    size_t birdCapacity;
+
+    // NOTE: Open addressed by name hash. Slots hold the bird index plus one, or 0 when empty.
+    size_t *birdSlots;
+    size_t totalBirdSlots;
+
+    // NOTE: Packed and indexed like `birds`, so a bird's timing is a single read
+    ControllerTiming *timings;
 
     size_t startupIndex;
     bool startupValue;
@@ -78,14 +150,24 @@ typedef struct _Controller {
     int32_t pecksRemaining;
     size_t peckingBirdIndex;
     bool peckValue;
+
+    // NOTE: Each subscription is allocated on its own, as the Trigger Bus holds pointers to them
+    ControllerSubscription **subscriptions;
+    size_t totalSubscriptions;
+    size_t subscriptionCapacity;
+
+    ControllerTransitionRecord transitions[TRANSITION_HISTORY_SIZE];
+    uint64_t totalTransitions;
 } Controller;
 
 
 // MARK: - Prototypes
 
-static void ControllerChangeState(ControllerRef NONNULL controller, ControllerState newState);
+static void ControllerHandleEvent(ControllerRef NONNULL controller, ControllerEvent event);
+static void ControllerRecordTransition(ControllerRef NONNULL controller, ControllerState fromState, ControllerState toState, ControllerEvent event);
 
-static void ControllerAppendOutput(ControllerRef NONNULL controller, OutputRef NONNULL output);
+static bool ControllerAppendBirdOutputs(ControllerRef NONNULL controller, const char * NONNULL birdName, const uint32_t * NULLABLE indices, size_t totalIndices, size_t * NONNULL outputs, size_t * NONNULL totalOutputs);
+static bool ControllerAppendOutput(ControllerRef NONNULL controller, size_t output);
 
 static void ControllerStartInitialState(ControllerRef NONNULL controller);
 static void ControllerStartPeckingState(ControllerRef NONNULL controller);
@@ -95,40 +177,83 @@ static void ControllerStopInitialState(ControllerRef NONNULL controller);
 static void ControllerStopPeckingState(ControllerRef NONNULL controller);
 static void ControllerStopStartupState(ControllerRef NONNULL controller);
 static void ControllerStopWaitingState(ControllerRef NONNULL controller);
+static void ControllerActionAdvanceBird(ControllerRef NONNULL controller);
+static void ControllerActionRestBirds(ControllerRef NONNULL controller);
 static void ControllerTimerPeckingFired(EventLoopRef NONNULL eventLoop, EventID id, void * NULLABLE context);
 static void ControllerTimerStartupFired(EventLoopRef NONNULL eventLoop, EventID id, void * NULLABLE context);
 static void ControllerTimerWaitingFired(EventLoopRef NONNULL eventLoop, EventID id, void * NULLABLE context);
+static void ControllerTriggerFired(const Trigger * NONNULL trigger, void * NULLABLE context);
 
-static void ControllerDidAcceptClient(EventLoopRef NONNULL eventLoop, EventID serverID, EventID peerID, struct sockaddr * NONNULL address, void * NULLABLE context);
-static void ControllerDidReceiveData(EventLoopRef NONNULL eventLoop, EventID serverID, EventID peerID, const uint8_t *data, size_t dataSize, void * NULLABLE context);
-static bool ControllerShouldAcceptClient(EventLoopRef NONNULL eventLoop, EventID id, struct sockaddr * NONNULL address, void * NULLABLE context);
+static const char * NULLABLE ControllerGetPeckingBirdName(const ControllerRef NONNULL controller);
+static const ControllerTiming * NONNULL ControllerGetPeckingTiming(const ControllerRef NONNULL controller);
+static uint32_t ControllerRandom(uint32_t minimum, uint32_t maximum);
+static void ControllerSetTiming(ControllerRef NONNULL controller, ControllerTimingOverride setting, uint32_t value);
+static void ControllerTimingSetValue(ControllerTiming * NONNULL timing, ControllerTimingOverride setting, uint32_t value);
 
 static bool ControllerBirdExists(ControllerRef NONNULL controller, const char * NONNULL name);
-static OutputRef NULLABLE ControllerFindOutput(ControllerRef NONNULL controller, const char * NONNULL name);
-static bool ControllerOutputExists(ControllerRef NONNULL controller, const char * NONNULL name);
+static bool ControllerGrowBirds(ControllerRef NONNULL controller);
+static bool ControllerGrowBirdSlots(ControllerRef NONNULL controller);
+static bool ControllerGrowOutputs(ControllerRef NONNULL controller);
+static bool ControllerGrowSubscriptions(ControllerRef NONNULL controller);
+static size_t ControllerHashName(const char * NONNULL name);
+static bool ControllerHasOutput(ControllerRef NONNULL controller, size_t output);
+static void ControllerInsertBirdName(ControllerRef NONNULL controller, size_t birdIdx);
+static const char * ControllerEventToString(ControllerEvent event);
 static const char * ControllerStateToString(ControllerState state);
 
 
+// MARK: - State Machine
+
+static const ControllerStateHandlers StateHandlers[ControllerStateCount] = {
+    [ControllerStateInitial] = { ControllerStartInitialState, ControllerStopInitialState },
+    [ControllerStateStartup] = { ControllerStartStartupState, ControllerStopStartupState },
+    [ControllerStateWaiting] = { ControllerStartWaitingState, ControllerStopWaitingState },
+    [ControllerStatePecking] = { ControllerStartPeckingState, ControllerStopPeckingState },
+};
+
+// NOTE: Unlisted state and event pairs are invalid and ignored
+static const ControllerTransition Transitions[ControllerStateCount][ControllerEventCount] = {
+    [ControllerStateInitial] = {
+        [ControllerEventStart]           = { true, ControllerStateStartup, NULL },
+        [ControllerEventStop]            = { true, ControllerStateInitial, NULL },
+    },
+    [ControllerStateStartup] = {
+        [ControllerEventStop]            = { true, ControllerStateInitial, NULL },
+        [ControllerEventStartupComplete] = { true, ControllerStateWaiting, ControllerActionRestBirds },
+    },
+    [ControllerStateWaiting] = {
+        [ControllerEventStop]            = { true, ControllerStateInitial, NULL },
+        [ControllerEventWaitElapsed]     = { true, ControllerStatePecking, NULL },
+        [ControllerEventTriggered]       = { true, ControllerStatePecking, NULL },
+    },
+    [ControllerStatePecking] = {
+        [ControllerEventStop]            = { true, ControllerStateInitial, NULL },
+        [ControllerEventPecksComplete]   = { true, ControllerStateWaiting, ControllerActionAdvanceBird },
+    },
+};
+
+
 // MARK: - Lifecycle Methods
 
-ControllerRef ControllerCreate() {
+ControllerRef ControllerCreate(const char *name, EventLoopRef eventLoop, OutputTableRef outputs, EventID timerNamespace) {
     ControllerRef self = (ControllerRef)calloc(1, sizeof(Controller));
 
-    self->minWait = DEFAULT_MIN_WAIT;
-    self->maxWait = DEFAULT_MAX_WAIT;
-    self->minPecks = DEFAULT_MIN_PECKS;
-    self->maxPecks = DEFAULT_MAX_PECKS;
-    self->peckWait = DEFAULT_PECK_WAIT;
+    self->name = strdup(name);
+    self->timerBase = (EventID)(timerNamespace * CONTROLLER_TIMER_NAMESPACE_SIZE);
+
+    self->timing.minWait = DEFAULT_MIN_WAIT;
+    self->timing.maxWait = DEFAULT_MAX_WAIT;
+    self->timing.minPecks = DEFAULT_MIN_PECKS;
+    self->timing.maxPecks = DEFAULT_MAX_PECKS;
+    self->timing.peckWait = DEFAULT_PECK_WAIT;
 
-    self->eventLoop = EventLoopCreate();
-    EventLoopSetCallbackContext(self->eventLoop, self);
+    self->eventLoop = eventLoop;
+    self->outputTable = outputs;
 
     return self;
 }
 
 void ControllerDestroy(ControllerRef self) {
-    SAFE_DESTROY(self->eventLoop, EventLoopDestroy);
-
     for (size_t idx = 0; idx < self->totalBirds; idx++) {
         SAFE_DESTROY(self->birds[idx].statics, free);
         SAFE_DESTROY(self->birds[idx].backs, free);
@@ -137,12 +262,17 @@ void ControllerDestroy(ControllerRef self) {
     }
 
     SAFE_DESTROY(self->birds, free);
+    SAFE_DESTROY(self->birdSlots, free);
+    SAFE_DESTROY(self->timings, free);
+    SAFE_DESTROY(self->outputs, free);
+    SAFE_DESTROY(self->isShowOutputs, free);
 
-    for (size_t idx = 0; idx < self->totalOutputs; idx++) {
-        SAFE_DESTROY(self->outputs[idx], OutputDestroy);
+    for (size_t idx = 0; idx < self->totalSubscriptions; idx++) {
+        SAFE_DESTROY(self->subscriptions[idx], free);
     }
 
-    SAFE_DESTROY(self->outputs, free);
+    SAFE_DESTROY(self->subscriptions, free);
+    SAFE_DESTROY(self->name, free);
 
     free(self);
 }
@@ -150,211 +280,279 @@ void ControllerDestroy(ControllerRef self) {
 
 // MARK: - Running
 
-static void ControllerChangeState(ControllerRef self, ControllerState newState) {
-    LogI(TAG, "Changing state from %s to %s", ControllerStateToString(self->state), ControllerStateToString(newState));
+static void ControllerHandleEvent(ControllerRef self, ControllerEvent event) {
+    ControllerState currentState = self->state;
+    const ControllerTransition *transition = &Transitions[currentState][event];
 
-    switch (self->state) {
-        case ControllerStateInitial:
-            ControllerStopInitialState(self);
-            break;
-        case ControllerStatePecking:
-            ControllerStopPeckingState(self);
-            break;
-        case ControllerStateStartup:
-            ControllerStopStartupState(self);
-            break;
-        case ControllerStateWaiting:
-            ControllerStopWaitingState(self);
-            break;
+    if (!transition->isValid) {
+        LogW(TAG, "%s ignoring event %s in state %s", self->name, ControllerEventToString(event), ControllerStateToString(currentState));
+        return;
     }
 
-    switch (newState) {
-        case ControllerStateInitial:
-            ControllerStartInitialState(self);
-            break;
-        case ControllerStatePecking:
-            ControllerStartPeckingState(self);
-            break;
-        case ControllerStateStartup:
-            ControllerStartStartupState(self);
-            break;
-        case ControllerStateWaiting:
-            ControllerStartWaitingState(self);
-            break;
+    // Everything logged while handling the event names the show and the bird it moves
+    const char *previousShow = LogSetField(LogFieldShow, self->name);
+    const char *previousBird = LogSetField(LogFieldBird, ControllerGetPeckingBirdName(self));
+
+    TraceBeginString(TAG, ControllerEventToString(event), "show", self->name);
+
+    StateHandlers[currentState].stop(self);
+
+    if (transition->action != NULL) {
+        transition->action(self);
     }
 
-    self->state = newState;
-}
+    LogSetField(LogFieldBird, ControllerGetPeckingBirdName(self));
+
+    StateHandlers[transition->nextState].start(self);
 
-void ControllerRun(ControllerRef self) {
-    ControllerChangeState(self, ControllerStateStartup);
+    self->state = transition->nextState;
 
-    EventLoopRun(self->eventLoop);
+    ControllerRecordTransition(self, currentState, transition->nextState, event);
+
+    TraceInstantString(TAG, ControllerStateToString(transition->nextState), "show", self->name);
+    TraceEnd(TAG, ControllerEventToString(event));
+
+    LogSetField(LogFieldShow, previousShow);
+    LogSetField(LogFieldBird, previousBird);
 }
 
-bool ControllerSetUp(ControllerRef self) {
-    srand(time(NULL));
+static void ControllerRecordTransition(ControllerRef self, ControllerState fromState, ControllerState toState, ControllerEvent event) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
 
-    for (size_t idx = 0; idx < self->totalOutputs; idx++) {
-        OutputRef output = self->outputs[idx];
+    ControllerTransitionRecord *record = self->transitions + (self->totalTransitions % TRANSITION_HISTORY_SIZE);
+    record->timestamp = ((uint64_t)now.tv_sec * 1000000ULL) + ((uint64_t)now.tv_nsec / 1000ULL);
+    record->fromState = (uint8_t)fromState;
+    record->toState = (uint8_t)toState;
+    record->event = (uint8_t)event;
 
-        LogI(TAG, "Setting up output %s", OutputGetName(output));
+    self->totalTransitions += 1;
+}
 
-        bool result = OutputSetUp(output);
+void ControllerStart(ControllerRef self) {
+    ControllerHandleEvent(self, ControllerEventStart);
+}
+
+void ControllerStop(ControllerRef self) {
+    ControllerHandleEvent(self, ControllerEventStop);
+}
 
-        if (!result) {
-            return false;
-        }
-    }
 
-    EventLoopServerDescriptor descriptor;
-    memset(&descriptor, 0, sizeof(descriptor));
+// MARK: - Properties
 
-    descriptor.id = 42;
-    descriptor.port = 5353;
-    descriptor.shouldAccept = ControllerShouldAcceptClient;
-    descriptor.didAccept = ControllerDidAcceptClient;
-    descriptor.didReceiveData = ControllerDidReceiveData;
+const char * ControllerGetName(const ControllerRef self) {
+    return self->name;
+}
 
-    EventLoopAddServer(self->eventLoop, &descriptor);
+uint32_t ControllerGetMinWait(const ControllerRef self) {
+    return self->timing.minWait;
+}
 
-    return true;
+uint32_t ControllerGetMaxWait(const ControllerRef self) {
+    return self->timing.maxWait;
 }
 
-void ControllerTearDown(ControllerRef self) {
-    for (size_t idx = 0; idx < self->totalOutputs; idx++) {
-        OutputRef output = self->outputs[idx];
+uint32_t ControllerGetMinPecks(const ControllerRef self) {
+    return self->timing.minPecks;
+}
 
-        LogI(TAG, "Tearing down output %s", OutputGetName(output));
+uint32_t ControllerGetMaxPecks(const ControllerRef self) {
+    return self->timing.maxPecks;
+}
 
-        OutputTearDown(output);
-    }
+uint32_t ControllerGetPeckWait(const ControllerRef self) {
+    return self->timing.peckWait;
 }
 
 
 // MARK: - Properties Setup
 
 void ControllerSetMinWait(ControllerRef self, uint32_t value) {
-    self->minWait = value;
+    ControllerSetTiming(self, ControllerTimingOverrideMinWait, value);
 }
 
 void ControllerSetMaxWait(ControllerRef self, uint32_t value) {
-    self->maxWait = value;
+    ControllerSetTiming(self, ControllerTimingOverrideMaxWait, value);
 }
 
 void ControllerSetMinPecks(ControllerRef self, uint32_t value) {
-    self->minPecks = value;
+    ControllerSetTiming(self, ControllerTimingOverrideMinPecks, value);
 }
 
 void ControllerSetMaxPecks(ControllerRef self, uint32_t value) {
-    self->maxPecks = value;
+    ControllerSetTiming(self, ControllerTimingOverrideMaxPecks, value);
 }
 
 void ControllerSetPeckWait(ControllerRef self, uint32_t value) {
-    self->peckWait = value;
+    ControllerSetTiming(self, ControllerTimingOverridePeckWait, value);
 }
 
+static void ControllerSetTiming(ControllerRef self, ControllerTimingOverride setting, uint32_t value) {
+    ControllerTimingSetValue(&self->timing, setting, value);
 
-// MARK: - Outputs Setup
+    for (size_t idx = 0; idx < self->totalBirds; idx++) {
+        if ((self->timings[idx].overrides & setting) == 0) {
+            ControllerTimingSetValue(self->timings + idx, setting, value);
+        }
+    }
+}
+
+
+// MARK: - Birds Setup
 
-bool ControllerAddFileOutput(ControllerRef self, const char *name, const char *path) {
-    if (ControllerOutputExists(self, name)) {
-        LogE(TAG, "Cannot add file output \"%s\" as another output has that name", name);
+bool ControllerAddBird(ControllerRef self, const char *name, const uint32_t *statics, size_t totalStatics, const uint32_t *backs, size_t totalBacks, const uint32_t *forwards, size_t totalForwards) {
+    if (ControllerBirdExists(self, name)) {
+        LogE(TAG, "Cannot add Bird \"%s\" as another bird has that name", name);
         return false;
     }
 
-    OutputRef output = OutputCreateFile(name, path);
-    ControllerAppendOutput(self, output);
+    if ((self->totalBirds + 1) * 2 > self->totalBirdSlots && !ControllerGrowBirdSlots(self)) {
+        LogE(TAG, "Failed to allocate the name index for Bird \"%s\"", name);
+        return false;
+    }
 
-    return true;
-}
+    // The arrays double as they fill, so building a large stage stays linear
+    if (self->totalBirds == self->birdCapacity && !ControllerGrowBirds(self)) {
+        LogE(TAG, "Failed to allocate space for Bird \"%s\"", name);
+        return false;
+    }
+
+    Bird *bird = self->birds + self->totalBirds;
+    self->timings[self->totalBirds] = self->timing;
+    self->totalBirds += 1;
+
+    memset(bird, 0, sizeof(Bird));
+
+    bird->name = strdup(name);
+    ControllerInsertBirdName(self, self->totalBirds - 1);
+
+    bird->statics = (size_t *)calloc(totalStatics, sizeof(size_t));
+    bird->backs = (size_t *)calloc(totalBacks, sizeof(size_t));
+    bird->forwards = (size_t *)calloc(totalForwards, sizeof(size_t));
 
-bool ControllerAddGPIOOutput(ControllerRef self, const char *name, int pin) {
-    if (ControllerOutputExists(self, name)) {
-        LogE(TAG, "Cannot add GPIO output \"%s\" as another output has that name", name);
+    if (!ControllerAppendBirdOutputs(self, name, statics, totalStatics, bird->statics, &bird->totalStatics)) {
         return false;
     }
 
-    OutputRef output = OutputCreateGPIO(name, pin);
-    ControllerAppendOutput(self, output);
+    if (!ControllerAppendBirdOutputs(self, name, backs, totalBacks, bird->backs, &bird->totalBacks)) {
+        return false;
+    }
+
+    if (!ControllerAppendBirdOutputs(self, name, forwards, totalForwards, bird->forwards, &bird->totalForwards)) {
+        return false;
+    }
 
     return true;
 }
 
-bool ControllerAddMemoryOutput(ControllerRef self, const char *name) {
-    if (ControllerOutputExists(self, name)) {
-        LogE(TAG, "Cannot add Memory output \"%s\" as another output has that name", name);
+bool ControllerSetBirdTiming(ControllerRef self, size_t birdIdx, const ControllerTiming *timing) {
+    if (birdIdx >= self->totalBirds) {
+        LogE(TAG, "Cannot set the timing of unknown bird %zu in %s", birdIdx, self->name);
         return false;
     }
 
-    OutputRef output = OutputCreateMemory(name);
-    ControllerAppendOutput(self, output);
+    // Settings the bird does not override follow the show
+    ControllerTiming *birdTiming = self->timings + birdIdx;
+    uint32_t overrides = timing->overrides;
+
+    birdTiming->minWait = ((overrides & ControllerTimingOverrideMinWait) != 0) ? timing->minWait : self->timing.minWait;
+    birdTiming->maxWait = ((overrides & ControllerTimingOverrideMaxWait) != 0) ? timing->maxWait : self->timing.maxWait;
+    birdTiming->minPecks = ((overrides & ControllerTimingOverrideMinPecks) != 0) ? timing->minPecks : self->timing.minPecks;
+    birdTiming->maxPecks = ((overrides & ControllerTimingOverrideMaxPecks) != 0) ? timing->maxPecks : self->timing.maxPecks;
+    birdTiming->peckWait = ((overrides & ControllerTimingOverridePeckWait) != 0) ? timing->peckWait : self->timing.peckWait;
+    birdTiming->overrides = overrides;
 
     return true;
 }
 
-static void ControllerAppendOutput(ControllerRef self, OutputRef output) {
-    self->outputs = (OutputRef *)realloc(self->outputs, sizeof(OutputRef) * (self->totalOutputs + 1));
-    self->outputs[self->totalOutputs] = output;
-    self->totalOutputs += 1;
+const ControllerTiming * ControllerGetBirdTiming(const ControllerRef self, size_t birdIdx) {
+    if (birdIdx >= self->totalBirds) {
+        return NULL;
+    }
+
+    return self->timings + birdIdx;
 }
 
+static bool ControllerAppendBirdOutputs(ControllerRef self, const char *birdName, const uint32_t *indices, size_t totalIndices, size_t *outputs, size_t *totalOutputs) {
+    size_t totalTableOutputs = OutputTableGetTotalOutputs(self->outputTable);
 
-// MARK: - Birds Setup
+    // Outputs may be added to the table between birds, so the flags grow to match
+    if (self->totalShowOutputFlags < totalTableOutputs) {
+        bool *isShowOutputs = (bool *)realloc(self->isShowOutputs, sizeof(bool) * totalTableOutputs);
 
-bool ControllerAddBird(ControllerRef self, const char *name, const char **statics, size_t totalStatics, const char **backs, size_t totalBacks, const char **forwards, size_t totalForwards) {
-    if (ControllerBirdExists(self, name)) {
-        LogE(TAG, "Cannot add Bird \"%s\" as another bird has that name", name);
-        return false;
-    }
+        if (isShowOutputs == NULL) {
+            LogE(TAG, "Failed to allocate the outputs of bird \"%s\"", birdName);
+            return false;
+        }
 
-    self->birds = (Bird *)realloc(self->birds, sizeof(Bird) * (self->totalBirds + 1));
-    Bird *bird = self->birds + self->totalBirds;
-    self->totalBirds += 1;
+        memset(isShowOutputs + self->totalShowOutputFlags, 0, sizeof(bool) * (totalTableOutputs - self->totalShowOutputFlags));
 
-    memset(bird, 0, sizeof(Bird));
+        self->isShowOutputs = isShowOutputs;
+        self->totalShowOutputFlags = totalTableOutputs;
+    }
 
-    bird->name = strdup(name);
-    bird->statics = (OutputRef *)calloc(totalStatics, sizeof(OutputRef));
-    bird->backs = (OutputRef *)calloc(totalBacks, sizeof(OutputRef));
-    bird->forwards = (OutputRef *)calloc(totalForwards, sizeof(OutputRef));
+    for (size_t idx = 0; idx < totalIndices; idx++) {
+        size_t output = indices[idx];
 
-    for (size_t idx = 0; idx < totalStatics; idx++) {
-        OutputRef output = ControllerFindOutput(self, statics[idx]);
+        if (output >= totalTableOutputs) {
+            LogE(TAG, "Cannot add output %zu to bird \"%s\" because it does not exist", output, birdName);
+            return false;
+        }
+
+        outputs[*totalOutputs] = output;
+        *totalOutputs += 1;
 
-        if (output == NULL) {
-            LogE(TAG, "Cannot add output \"%s\" to bird \"%s\" because it does not exist", statics[idx], name);
+        if (!ControllerHasOutput(self, output) && !ControllerAppendOutput(self, output)) {
+            LogE(TAG, "Failed to allocate the outputs of bird \"%s\"", birdName);
             return false;
         }
+    }
 
-        bird->statics[bird->totalStatics] = output;
-        bird->totalStatics += 1;
+    return true;
+}
+
+static bool ControllerAppendOutput(ControllerRef self, size_t output) {
+    if (self->totalOutputs == self->outputCapacity && !ControllerGrowOutputs(self)) {
+        return false;
     }
 
-    for (size_t idx = 0; idx < totalBacks; idx++) {
-        OutputRef output = ControllerFindOutput(self, backs[idx]);
+    self->outputs[self->totalOutputs] = output;
+    self->totalOutputs += 1;
 
-        if (output == NULL) {
-            LogE(TAG, "Cannot add output \"%s\" to bird \"%s\" because it does not exist", backs[idx], name);
-            return false;
-        }
+    self->isShowOutputs[output] = true;
+
+    return true;
+}
 
-        bird->backs[bird->totalBacks] = output;
-        bird->totalBacks += 1;
+
+// MARK: - Triggers Setup
+
+bool ControllerSubscribe(ControllerRef self, TriggerBusRef bus, TriggerType type, uint32_t source, ControllerTriggerAction action, size_t birdIdx) {
+    if (birdIdx != CONTROLLER_NEXT_BIRD && birdIdx >= self->totalBirds) {
+        LogE(TAG, "Cannot subscribe %s to a trigger for unknown bird %zu", self->name, birdIdx);
+        return false;
     }
 
-    for (size_t idx = 0; idx < totalForwards; idx++) {
-        OutputRef output = ControllerFindOutput(self, forwards[idx]);
+    // NOTE: Grown first, so a subscription the Trigger Bus holds always has a place to be freed from
+    if (self->totalSubscriptions == self->subscriptionCapacity && !ControllerGrowSubscriptions(self)) {
+        LogE(TAG, "Failed to allocate space for a subscription of %s", self->name);
+        return false;
+    }
 
-        if (output == NULL) {
-            LogE(TAG, "Cannot add output \"%s\" to bird \"%s\" because it does not exist", forwards[idx], name);
-            return false;
-        }
+    ControllerSubscription *subscription = (ControllerSubscription *)calloc(1, sizeof(ControllerSubscription));
+    subscription->controller = self;
+    subscription->action = action;
+    subscription->hasBird = (birdIdx != CONTROLLER_NEXT_BIRD);
+    subscription->birdIndex = birdIdx;
 
-        bird->forwards[bird->totalForwards] = output;
-        bird->totalForwards += 1;
+    if (!TriggerBusSubscribe(bus, type, source, ControllerTriggerFired, subscription)) {
+        free(subscription);
+        return false;
     }
 
+    self->subscriptions[self->totalSubscriptions] = subscription;
+    self->totalSubscriptions += 1;
+
     return true;
 }
 
@@ -362,35 +560,36 @@ bool ControllerAddBird(ControllerRef self, const char *name, const char **static
 // MARK: - Running Methods
 
 static void ControllerStartInitialState(ControllerRef self) {
-    // Turn off all outputs
+    // Move all of the show's outputs to their safe states, which turns them off unless configured otherwise
     for (size_t idx = 0; idx < self->totalOutputs; idx++) {
-        OutputRef output = self->outputs[idx];
-        OutputSetValue(output, false);
+        OutputTableSetSafeValue(self->outputTable, self->outputs[idx]);
     }
 }
 
 static void ControllerStartPeckingState(ControllerRef self) {
-    int range = self->maxPecks - self->minPecks;
-    self->pecksRemaining = (rand() % range) + self->minPecks;
+    const ControllerTiming *timing = ControllerGetPeckingTiming(self);
+
+    self->pecksRemaining = (int32_t)ControllerRandom(timing->minPecks, timing->maxPecks);
     self->peckValue = false;
 
-    EventLoopAddTimer(self->eventLoop, PECKING_TIMER_ID, self->peckWait, ControllerTimerPeckingFired);
+    EventLoopAddTimerWithContext(self->eventLoop, TIMER_ID(self, PECKING_TIMER_ID), timing->peckWait, ControllerTimerPeckingFired, self);
 }
 
 static void ControllerStartStartupState(ControllerRef self) {
     self->startupIndex = 0;
     self->startupValue = false;
 
-    EventLoopAddTimer(self->eventLoop, STARTUP_TIMER_ID, STARTUP_WAIT, ControllerTimerStartupFired);
+    EventLoopAddTimerWithContext(self->eventLoop, TIMER_ID(self, STARTUP_TIMER_ID), STARTUP_WAIT, ControllerTimerStartupFired, self);
 }
 
 static void ControllerStartWaitingState(ControllerRef self) {
-    uint32_t range = self->maxWait - self->minWait;
-    uint32_t waitTime = (rand() % range) + self->minWait;
+    // The wait belongs to the bird that pecks next
+    const ControllerTiming *timing = ControllerGetPeckingTiming(self);
+    uint32_t waitTime = ControllerRandom(timing->minWait, timing->maxWait);
 
-    LogI(TAG, "Waiting for %" PRIu32 " milliseconds", waitTime);
+    LogI(TAG, "%s waiting for %" PRIu32 " milliseconds", self->name, waitTime);
 
-    EventLoopAddTimer(self->eventLoop, WAITING_TIMER_ID, waitTime, ControllerTimerWaitingFired);
+    EventLoopAddTimerWithContext(self->eventLoop, TIMER_ID(self, WAITING_TIMER_ID), waitTime, ControllerTimerWaitingFired, self);
 }
 
 static void ControllerStopInitialState(ControllerRef self) {
@@ -398,15 +597,15 @@ static void ControllerStopInitialState(ControllerRef self) {
 }
 
 static void ControllerStopPeckingState(ControllerRef self) {
-    EventLoopRemoveTimer(self->eventLoop, PECKING_TIMER_ID);
+    EventLoopRemoveTimer(self->eventLoop, TIMER_ID(self, PECKING_TIMER_ID));
 }
 
 static void ControllerStopStartupState(ControllerRef self) {
-    EventLoopRemoveTimer(self->eventLoop, STARTUP_TIMER_ID);
+    EventLoopRemoveTimer(self->eventLoop, TIMER_ID(self, STARTUP_TIMER_ID));
 }
 
 static void ControllerStopWaitingState(ControllerRef self) {
-    EventLoopRemoveTimer(self->eventLoop, WAITING_TIMER_ID);
+    EventLoopRemoveTimer(self->eventLoop, TIMER_ID(self, WAITING_TIMER_ID));
 }
 
 static void ControllerTimerPeckingFired(EventLoopRef eventLoop, EventID id, void *context) {
@@ -417,13 +616,11 @@ static void ControllerTimerPeckingFired(EventLoopRef eventLoop, EventID id, void
     Bird *bird = self->birds + self->peckingBirdIndex;
 
     for (size_t idx = 0; idx < bird->totalBacks; idx++) {
-        OutputRef output = bird->backs[idx];
-        OutputSetValue(output, !self->peckValue);
+        OutputTableSetValue(self->outputTable, bird->backs[idx], !self->peckValue);
     }
 
     for (size_t idx = 0; idx < bird->totalForwards; idx++) {
-        OutputRef output = bird->forwards[idx];
-        OutputSetValue(output, self->peckValue);
+        OutputTableSetValue(self->outputTable, bird->forwards[idx], self->peckValue);
     }
 
     if (!self->peckValue) {
@@ -431,8 +628,7 @@ static void ControllerTimerPeckingFired(EventLoopRef eventLoop, EventID id, void
     }
 
     if (self->pecksRemaining <= 0) {
-        self->peckingBirdIndex = (self->peckingBirdIndex + 1) % self->totalBirds;
-        ControllerChangeState(self, ControllerStateWaiting);
+        ControllerHandleEvent(self, ControllerEventPecksComplete);
     }
 }
 
@@ -441,102 +637,275 @@ static void ControllerTimerStartupFired(EventLoopRef eventLoop, EventID id, void
 
     self->startupValue = !self->startupValue;
 
-    OutputRef output = self->outputs[self->startupIndex];
-    OutputSetValue(output, self->startupValue);
+    OutputTableSetValue(self->outputTable, self->outputs[self->startupIndex], self->startupValue);
 
     if (!self->startupValue) {
         self->startupIndex += 1;
     }
 
     if (self->startupIndex >= self->totalOutputs) {
-        for (size_t birdIdx = 0; birdIdx < self->totalBirds; birdIdx++) {
-            Bird *bird = self->birds + birdIdx;
+        ControllerHandleEvent(self, ControllerEventStartupComplete);
+    }
+}
+
+static void ControllerTimerWaitingFired(EventLoopRef eventLoop, EventID id, void *context) {
+    ControllerRef self = (ControllerRef)context;
+    
+    ControllerHandleEvent(self, ControllerEventWaitElapsed);
+}
 
-            for (size_t outputIdx = 0; outputIdx < bird->totalStatics; outputIdx++) {
-                output = bird->statics[outputIdx];
-                OutputSetValue(output, true);
+static void ControllerTriggerFired(const Trigger *trigger, void *context) {
+    ControllerSubscription *subscription = (ControllerSubscription *)context;
+    ControllerRef self = subscription->controller;
+
+    LogD(TAG, "%s received %s trigger from %" PRIu32, self->name, TriggerTypeToString(trigger->type), trigger->source);
+
+    switch (subscription->action) {
+        case ControllerTriggerActionPeck:
+            // NOTE: Pecks already in progress are not interrupted
+            if (self->state != ControllerStateWaiting) {
+                LogD(TAG, "%s is busy and ignored the trigger", self->name);
+                break;
             }
 
-            for (size_t outputIdx = 0; outputIdx < bird->totalBacks; outputIdx++) {
-                output = bird->backs[outputIdx];
-                OutputSetValue(output, true);
+            if (subscription->hasBird) {
+                self->peckingBirdIndex = subscription->birdIndex;
             }
 
-            for (size_t outputIdx = 0; outputIdx < bird->totalForwards; outputIdx++) {
-                output = bird->forwards[outputIdx];
-                OutputSetValue(output, false);
+            ControllerHandleEvent(self, ControllerEventTriggered);
+            break;
+        case ControllerTriggerActionStart:
+            if (self->state == ControllerStateInitial) {
+                ControllerHandleEvent(self, ControllerEventStart);
             }
+
+            break;
+        case ControllerTriggerActionStop:
+            ControllerHandleEvent(self, ControllerEventStop);
+            break;
+    }
+}
+
+static void ControllerActionAdvanceBird(ControllerRef self) {
+    self->peckingBirdIndex = (self->peckingBirdIndex + 1) % self->totalBirds;
+}
+
+static void ControllerActionRestBirds(ControllerRef self) {
+    for (size_t birdIdx = 0; birdIdx < self->totalBirds; birdIdx++) {
+        Bird *bird = self->birds + birdIdx;
+
+        for (size_t outputIdx = 0; outputIdx < bird->totalStatics; outputIdx++) {
+            OutputTableSetValue(self->outputTable, bird->statics[outputIdx], true);
+        }
+
+        for (size_t outputIdx = 0; outputIdx < bird->totalBacks; outputIdx++) {
+            OutputTableSetValue(self->outputTable, bird->backs[outputIdx], true);
         }
 
-        ControllerChangeState(self, ControllerStateWaiting);
+        for (size_t outputIdx = 0; outputIdx < bird->totalForwards; outputIdx++) {
+            OutputTableSetValue(self->outputTable, bird->forwards[outputIdx], false);
+        }
     }
 }
 
-static void ControllerTimerWaitingFired(EventLoopRef eventLoop, EventID id, void *context) {
-    ControllerRef self = (ControllerRef)context;
-    
-    ControllerChangeState(self, ControllerStatePecking);
+
+// MARK: - Diagnostics
+
+void ControllerDumpTransitions(const ControllerRef self, int fd) {
+    uint64_t total = self->totalTransitions;
+    uint64_t first = (total > TRANSITION_HISTORY_SIZE) ? (total - TRANSITION_HISTORY_SIZE) : 0;
+
+    SignalsWriteString(fd, "Show ");
+    SignalsWriteString(fd, self->name);
+    SignalsWriteString(fd, ": ");
+    SignalsWriteUnsigned(fd, total, 0);
+    SignalsWriteString(fd, " transitions, currently ");
+    SignalsWriteString(fd, ControllerStateToString(self->state));
+    SignalsWriteString(fd, "\n");
+
+    for (uint64_t idx = first; idx < total; idx++) {
+        const ControllerTransitionRecord *record = self->transitions + (idx % TRANSITION_HISTORY_SIZE);
+
+        SignalsWriteString(fd, "  ");
+        SignalsWriteUnsigned(fd, record->timestamp / 1000000ULL, 0);
+        SignalsWriteString(fd, ".");
+        SignalsWriteUnsigned(fd, record->timestamp % 1000000ULL, 6);
+        SignalsWriteString(fd, " ");
+        SignalsWriteString(fd, ControllerStateToString((ControllerState)record->fromState));
+        SignalsWriteString(fd, " -> ");
+        SignalsWriteString(fd, ControllerStateToString((ControllerState)record->toState));
+        SignalsWriteString(fd, " (");
+        SignalsWriteString(fd, ControllerEventToString((ControllerEvent)record->event));
+        SignalsWriteString(fd, ")\n");
+    }
+}
+
+
+// MARK: - Utilities
+
+static const char * ControllerGetPeckingBirdName(const ControllerRef self) {
+    if (self->peckingBirdIndex >= self->totalBirds) {
+        return NULL;
+    }
+
+    return self->birds[self->peckingBirdIndex].name;
+}
+
+static const ControllerTiming * ControllerGetPeckingTiming(const ControllerRef self) {
+    if (self->peckingBirdIndex >= self->totalBirds) {
+        return &self->timing;
+    }
+
+    return self->timings + self->peckingBirdIndex;
 }
 
+static uint32_t ControllerRandom(uint32_t minimum, uint32_t maximum) {
+    // A bird may set both ends of a range to the same value
+    if (maximum <= minimum) {
+        return minimum;
+    }
 
-// MARK: - Remote Server
+    return ((uint32_t)rand() % (maximum - minimum)) + minimum;
+}
 
-static void ControllerDidAcceptClient(EventLoopRef eventLoop, EventID serverID, EventID peerID, struct sockaddr *address, void *context) {
-    LogI(TAG, "New client connection %" PRIu16 " on %" PRIu16, peerID, serverID);
+static void ControllerTimingSetValue(ControllerTiming *timing, ControllerTimingOverride setting, uint32_t value) {
+    switch (setting) {
+        case ControllerTimingOverrideMinWait:
+            timing->minWait = value;
+            break;
+        case ControllerTimingOverrideMaxWait:
+            timing->maxWait = value;
+            break;
+        case ControllerTimingOverrideMinPecks:
+            timing->minPecks = value;
+            break;
+        case ControllerTimingOverrideMaxPecks:
+            timing->maxPecks = value;
+            break;
+        case ControllerTimingOverridePeckWait:
+            timing->peckWait = value;
+            break;
+    }
 }
 
-static void ControllerDidReceiveData(EventLoopRef eventLoop, EventID serverID, EventID peerID, const uint8_t *data, size_t dataSize, void * NULLABLE context) {
-    LogI(TAG, "Client %" PRIu16 "/%" PRIu16 " received %zu bytes", serverID, peerID, dataSize);
+static bool ControllerBirdExists(ControllerRef self, const char *name) {
+    if (self->totalBirdSlots == 0) {
+        return false;
+    }
+
+    size_t mask = self->totalBirdSlots - 1;
+
+    for (size_t slot = ControllerHashName(name) & mask; self->birdSlots[slot] != 0; slot = (slot + 1) & mask) {
+        if (strcmp(self->birds[self->birdSlots[slot] - 1].name, name) == 0) {
+            return true;
+        }
+    }
+
+    return false;
 }
 
-static bool ControllerShouldAcceptClient(EventLoopRef eventLoop, EventID id, struct sockaddr *address, void *context) {
+static bool ControllerGrowBirds(ControllerRef self) {
+    size_t capacity = (self->birdCapacity == 0) ? INITIAL_CAPACITY : self->birdCapacity * 2;
+
+    GROW_ARRAY(self->birds, capacity);
+    GROW_ARRAY(self->timings, capacity);
+
+    self->birdCapacity = capacity;
+
     return true;
 }
 
+static bool ControllerGrowBirdSlots(ControllerRef self) {
+    size_t totalBirdSlots = (self->totalBirdSlots == 0) ? INITIAL_BIRD_SLOTS : self->totalBirdSlots * 2;
+    size_t *birdSlots = (size_t *)calloc(totalBirdSlots, sizeof(size_t));
 
-// MARK: - Utilities
+    if (birdSlots == NULL) {
+        return false;
+    }
 
-static bool ControllerBirdExists(ControllerRef self, const char *name) {
-    bool exists = false;
+    SAFE_DESTROY(self->birdSlots, free);
+
+    self->birdSlots = birdSlots;
+    self->totalBirdSlots = totalBirdSlots;
 
     for (size_t idx = 0; idx < self->totalBirds; idx++) {
-        if (strcmp(self->birds[idx].name, name) == 0) {
-            exists = true;
-            break;
-        }
+        ControllerInsertBirdName(self, idx);
     }
 
-    return exists;
+    return true;
 }
 
-static OutputRef ControllerFindOutput(ControllerRef self, const char *name) {
-    OutputRef output = NULL;
+static bool ControllerGrowOutputs(ControllerRef self) {
+    size_t capacity = (self->outputCapacity == 0) ? INITIAL_CAPACITY : self->outputCapacity * 2;
 
-    for (size_t idx = 0; idx < self->totalOutputs; idx++) {
-        const char *outputName = OutputGetName(self->outputs[idx]);
+    GROW_ARRAY(self->outputs, capacity);
 
-        if (strcmp(outputName, name) == 0) {
-            output = self->outputs[idx];
-            break;
-        }
+    self->outputCapacity = capacity;
+
+    return true;
+}
+
+static bool ControllerGrowSubscriptions(ControllerRef self) {
+    size_t capacity = (self->subscriptionCapacity == 0) ? INITIAL_CAPACITY : self->subscriptionCapacity * 2;
+
+    GROW_ARRAY(self->subscriptions, capacity);
+
+    self->subscriptionCapacity = capacity;
+
+    return true;
+}
+
+static size_t ControllerHashName(const char *name) {
+    uint64_t hash = FNV_OFFSET_BASIS;
+
+    for (const char *current = name; *current != '\0'; current++) {
+        hash ^= (uint8_t)*current;
+        hash *= FNV_PRIME;
     }
 
-    return output;
+    return (size_t)hash;
+}
+
+static bool ControllerHasOutput(ControllerRef self, size_t output) {
+    return (output < self->totalShowOutputFlags) && self->isShowOutputs[output];
 }
 
-static bool ControllerOutputExists(ControllerRef self, const char *name) {
-    bool exists = false;
+static void ControllerInsertBirdName(ControllerRef self, size_t birdIdx) {
+    size_t mask = self->totalBirdSlots - 1;
+    size_t slot = ControllerHashName(self->birds[birdIdx].name) & mask;
 
-    for (size_t idx = 0; idx < self->totalOutputs; idx++) {
-        const char *outputName = OutputGetName(self->outputs[idx]);
+    while (self->birdSlots[slot] != 0) {
+        slot = (slot + 1) & mask;
+    }
 
-        if (strcmp(outputName, name) == 0) {
-            exists = true;
+    self->birdSlots[slot] = birdIdx + 1;
+}
+
+static const char * ControllerEventToString(ControllerEvent event) {
+    switch (event) {
+        case ControllerEventStart:
+            return "Start";
+            break;
+        case ControllerEventStop:
+            return "Stop";
+            break;
+        case ControllerEventStartupComplete:
+            return "StartupComplete";
+            break;
+        case ControllerEventWaitElapsed:
+            return "WaitElapsed";
+            break;
+        case ControllerEventPecksComplete:
+            return "PecksComplete";
+            break;
+        case ControllerEventTriggered:
+            return "Triggered";
+            break;
+        case ControllerEventCount:
             break;
-        }
     }
 
-    return exists;
+    return "ERROR";
 }
 
 static const char * ControllerStateToString(ControllerState state) {
@@ -553,6 +922,8 @@ static const char * ControllerStateToString(ControllerState state) {
         case ControllerStatePecking:
             return "Pecking";
             break;
+        case ControllerStateCount:
+            break;
     }
 
     return "ERROR";
@@ -16,23 +16,63 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#include "EventLoop.h"
+#include "OutputTable.h"
+#include "TriggerBus.h"
+
 
 BEGIN_DECLS
 
 
 // MARK: - Constants & Globals
 
-/// The Controller object
+/// The Controller object, which runs a single show.
 typedef struct _Controller * ControllerRef;
 
+/// The number of timer IDs reserved for each Controller's timer namespace.
+#define CONTROLLER_TIMER_NAMESPACE_SIZE 16
+
+/// The bird index of a trigger that pecks the next bird.
+#define CONTROLLER_NEXT_BIRD SIZE_MAX
+
+/// The behavior a trigger causes in a show
+typedef enum _ControllerTriggerAction {
+    ControllerTriggerActionPeck = 0, ///< A bird pecks, if the show is waiting
+    ControllerTriggerActionStart,    ///< The show starts, if it is stopped
+    ControllerTriggerActionStop,     ///< The show stops
+} ControllerTriggerAction;
+
+/// The timing settings a bird may override, as bits
+typedef enum _ControllerTimingOverride {
+    ControllerTimingOverrideMinWait = 1 << 0,  ///< The bird sets its own minimum wait
+    ControllerTimingOverrideMaxWait = 1 << 1,  ///< The bird sets its own maximum wait
+    ControllerTimingOverrideMinPecks = 1 << 2, ///< The bird sets its own minimum pecks
+    ControllerTimingOverrideMaxPecks = 1 << 3, ///< The bird sets its own maximum pecks
+    ControllerTimingOverridePeckWait = 1 << 4, ///< The bird sets its own peck wait
+} ControllerTimingOverride;
+
+/// The timing of a bird
+typedef struct _ControllerTiming {
+    uint32_t minWait;   ///< The minimum time, in milliseconds, to wait before the bird pecks
+    uint32_t maxWait;   ///< The maximum time, in milliseconds, to wait before the bird pecks
+    uint32_t minPecks;  ///< The minimum number of pecks in a sequence
+    uint32_t maxPecks;  ///< The maximum number of pecks in a sequence
+    uint32_t peckWait;  ///< The time, in milliseconds, between peck movements
+    uint32_t overrides; ///< The `ControllerTimingOverride` bits the bird sets itself
+} ControllerTiming;
+
 
 // MARK: - Lifecycle Methods
 
 /**
  * Create a Controller instance.
+ * \param name The name of the show the Controller runs.
+ * \param eventLoop The shared Event Loop to schedule timers on.
+ * \param outputs The shared Output Table that birds reference outputs from.
+ * \param timerNamespace The namespace for the Controller's timer IDs. Each Controller sharing an Event Loop needs a unique namespace.
  * \return The the new instance.
  */
-ControllerRef NONNULL ControllerCreate(void);
+ControllerRef NONNULL ControllerCreate(const char * NONNULL name, EventLoopRef NONNULL eventLoop, OutputTableRef NONNULL outputs, EventID timerNamespace);
 
 /**
  * Destroy an instance of a Controller.
@@ -44,23 +84,62 @@ void ControllerDestroy(ControllerRef NONNULL controller);
 // MARK: - Running
 
 /**
- * Run the given configuration.
- * \param controller The instance to run.
- * \note This will block until the run is complete.
+ * Start running the show.
+ * \param controller The instance to start.
+ * \note The show runs as the shared Event Loop is run.
+ */
+void ControllerStart(ControllerRef NONNULL controller);
+
+/**
+ * Stop running the show, moving all of its outputs to their safe states.
+ * \param controller The instance to stop.
+ */
+void ControllerStop(ControllerRef NONNULL controller);
+
+
+// MARK: - Properties
+
+/**
+ * Get the name of the show the Controller runs.
+ * \param controller The instance to inspect.
+ * \return The name of the show.
+ */
+const char * NONNULL ControllerGetName(const ControllerRef NONNULL controller);
+
+/**
+ * Get the minimum wait time between peck sequences.
+ * \param controller The instance to inspect.
+ * \return The minimum time in milliseconds to wait between peck sequences.
+ */
+uint32_t ControllerGetMinWait(const ControllerRef NONNULL controller);
+
+/**
+ * Get the maximum wait time between peck sequences.
+ * \param controller The instance to inspect.
+ * \return The maximum time in milliseconds to wait between peck sequences.
+ */
+uint32_t ControllerGetMaxWait(const ControllerRef NONNULL controller);
+
+/**
+ * Get the minimum number of pecks to perform in a sequence.
+ * \param controller The instance to inspect.
+ * \return The minimum number of pecks to perform in a sequence.
  */
-void ControllerRun(ControllerRef NONNULL controller);
+uint32_t ControllerGetMinPecks(const ControllerRef NONNULL controller);
 
 /**
- * Perform any set up tasks for the Controller before running.
- * \param controller The instance to set up.
+ * Get the maximum number of pecks to perform in a sequence.
+ * \param controller The instance to inspect.
+ * \return The maximum number of pecks to perform in a sequence.
  */
-bool ControllerSetUp(ControllerRef NONNULL controller);
+uint32_t ControllerGetMaxPecks(const ControllerRef NONNULL controller);
 
 /**
- * Perform any tear down tasks for the Controller after runnings.
- * \param controller The instance to tear down.
+ * Get the time between peck movements.
+ * \param controller The instance to inspect.
+ * \return The time in milliseconds between peck movements.
  */
-void ControllerTearDown(ControllerRef NONNULL controller);
+uint32_t ControllerGetPeckWait(const ControllerRef NONNULL controller);
 
 
 // MARK: - Properties Setup
@@ -69,6 +148,7 @@ void ControllerTearDown(ControllerRef NONNULL controller);
  * Set the minimum wait time between peck sequences.
  * \param controller The instance to modify.
  * \param value The minimum time in milliseconds to wait between peck sequences.
+ * \note This and the other timing setters change every bird that does not override the setting.
  */
 void ControllerSetMinWait(ControllerRef NONNULL controller, uint32_t value);
 
@@ -101,38 +181,67 @@ void ControllerSetMaxPecks(ControllerRef NONNULL controller, uint32_t value);
 void ControllerSetPeckWait(ControllerRef NONNULL controller, uint32_t value);
 
 
-// MARK: - Outputs Setup
+// MARK: - Diagnostics
 
 /**
- * Add a file-based Output to the Controller.
- * \param controller The instance to modify.
- * \param name The name of the Output.
- * \param path The path to the file to output to.
- * \return `true` if the output was added successfully, otherwise `false`.
+ * Write the most recent state transitions of the show to a file descriptor.
+ * \param controller The instance to inspect.
+ * \param fd The file descriptor to write to.
+ * \note This is async-signal-safe, so it may be called when the process is crashing.
  */
-bool ControllerAddFileOutput(ControllerRef NONNULL controller, const char * NONNULL name, const char * NONNULL path);
+void ControllerDumpTransitions(const ControllerRef NONNULL controller, int fd);
+
+
+// MARK: - Birds Setup
 
 /**
- * Add a GPIO-based Output to the Controller.
+ * Add a bird to the show.
  * \param controller The instance to modify.
- * \param name The name of the Output.
- * \param pin The GPIO pin to output to.
- * \return `true` if the output was added successfully, otherwise `false`.
+ * \param name The name of the bird, used only for diagnostics.
+ * \param statics The indices of the outputs that are always on.
+ * \param totalStatics The number of static output indices.
+ * \param backs The indices of the outputs for the back position.
+ * \param totalBacks The number of back output indices.
+ * \param forwards The indices of the outputs for the forward position.
+ * \param totalForwards The number of forward output indices.
+ * \return `true` if the bird was added successfully, otherwise `false`.
+ * \note Output indices are in to the shared Output Table. Birds are numbered in the order they are added.
  */
-bool ControllerAddGPIOOutput(ControllerRef NONNULL controller, const char * NONNULL name, int pin);
+bool ControllerAddBird(ControllerRef NONNULL controller, const char * NONNULL name, const uint32_t * NULLABLE statics, size_t totalStatics, const uint32_t * NULLABLE backs, size_t totalBacks, const uint32_t * NULLABLE forwards, size_t totalForwards);
 
 /**
- * Add a memory-based Output to the Controller.
+ * Override the timing of a bird.
  * \param controller The instance to modify.
- * \param name The name of the Output.
- * \return `true` if the output was added successfully, otherwise `false`.
+ * \param birdIdx The index of the bird in the show.
+ * \param timing The timing of the bird. Only the settings in its `overrides` are used. The rest follow the show.
+ * \return `true` if the timing was set, otherwise `false`.
+ * \note The wait before a sequence and the sequence itself use the timing of the bird that pecks.
  */
-bool ControllerAddMemoryOutput(ControllerRef NONNULL controller, const char * NONNULL name);
+bool ControllerSetBirdTiming(ControllerRef NONNULL controller, size_t birdIdx, const ControllerTiming * NONNULL timing);
 
+/**
+ * Get the timing of a bird.
+ * \param controller The instance to inspect.
+ * \param birdIdx The index of the bird in the show.
+ * \return The timing of the bird, or `NULL` if the index is invalid.
+ */
+const ControllerTiming * NULLABLE ControllerGetBirdTiming(const ControllerRef NONNULL controller, size_t birdIdx);
 
-// MARK: - Birds Setup
 
-bool ControllerAddBird(ControllerRef NONNULL controller, const char * NONNULL name, const char * NONNULL * NONNULL statics, size_t totalStatics, const char * NONNULL * NONNULL backs, size_t totalBacks, const char * NONNULL * NONNULL forwards, size_t totalForwards);
+// MARK: - Triggers Setup
+
+/**
+ * Subscribe the show to a trigger.
+ * \param controller The instance to modify.
+ * \param bus The Trigger Bus to subscribe on.
+ * \param type The type of trigger.
+ * \param source The source of the trigger, or `TRIGGER_SOURCE_ANY` for every source.
+ * \param action The behavior the trigger causes.
+ * \param birdIdx The index of the bird to peck in this show, or `CONTROLLER_NEXT_BIRD` to peck the next bird.
+ * \return `true` if the subscription was added, otherwise `false`.
+ * \note Birds must be added before they can be pecked by a trigger.
+ */
+bool ControllerSubscribe(ControllerRef NONNULL controller, TriggerBusRef NONNULL bus, TriggerType type, uint32_t source, ControllerTriggerAction action, size_t birdIdx);
 
 END_DECLS
 
@@ -24,6 +24,7 @@
 #include <sys/types.h>
 
 #include "Log.h"
+#include "Trace.h"
 
 #if TARGET_PLATFORM_APPLE
 #include <sys/event.h>
@@ -79,6 +80,8 @@ typedef struct _Event {
 
         struct {
             EventLoopTimerFiredCallback timerFired;
+            void *context;
+            bool hasContext;
         } timer;
 
         struct {
@@ -119,6 +122,9 @@ typedef struct _EventLoop {
     size_t deactivatedEventsCount;
     size_t deactivatedEventsSize;
 
+    // NOTE: Kept so stopping from a signal handler does not search the user events
+    EventRef stopEvent;
+
     void *callbackContext;
 } EventLoop;
 
@@ -136,6 +142,9 @@ static void EventLoopHandleServerPeerWriteEvent(EventLoopRef NONNULL eventLoop,
 static void EventLoopHandleTimerEvent(EventLoopRef NONNULL eventLoop, Event * NONNULL event);
 static void EventLoopHandleUserEvent(EventLoopRef NONNULL eventLoop, Event * NONNULL event);
 
+// Timers
+static void EventLoopAddTimerInternal(EventLoopRef NONNULL eventLoop, EventID id, uint32_t timeout, EventLoopTimerFiredCallback NULLABLE callback, void * NULLABLE context, bool hasContext);
+
 // Callbacks
 static void EventLoopHandleStopUserEvent(EventLoopRef NONNULL eventLoop, EventID id, void * NULLABLE context);
 
@@ -206,6 +215,7 @@ EventLoopRef EventLoopCreate() {
 
     // Add the stop event
     EventLoopAddUserEvent(self, INTERNAL_EVENT_ID, EventLoopHandleStopUserEvent);
+    self->stopEvent = EventLoopFindExistingEvent(self, INTERNAL_EVENT_ID, EventTypeUser);
 
     return self;
 }
@@ -315,11 +325,18 @@ void EventLoopRunOnce(EventLoopRef self, int64_t timeout) {
 
     int eventsAvailable = kevent(self->kqueueFD, NULL, 0, events, EVENTS_TO_PROCESS, timeoutPointer);
 
+    // A signal interrupts the wait, and a stop request it makes is handled on the next iteration
     if (eventsAvailable == -1) {
-        LogErrno(TAG, errno, "Failed to get the next events");
+        if (errno != EINTR) {
+            LogErrno(TAG, errno, "Failed to get the next events");
+        }
+
         return;
     }
 
+    // The wait is left out, so each span is the work done for the events
+    TraceBeginValue(TAG, "Iteration", "events", eventsAvailable);
+
     for (int idx = 0; idx < eventsAvailable; idx++) {
         struct kevent *kqueueEvent = events + idx;
         Event *event = (Event *)kqueueEvent->udata;
@@ -364,6 +381,8 @@ void EventLoopRunOnce(EventLoopRef self, int64_t timeout) {
     }
 
     EventLoopDeactivateEvents(self);
+
+    TraceEnd(TAG, "Iteration");
 }
 #elif TARGET_PLATFORM_LINUX
 #warning Implement epoll run once
@@ -372,7 +391,15 @@ void EventLoopRunOnce(EventLoopRef self, int64_t timeout) {
 #endif
 
 void EventLoopStop(EventLoopRef self) {
+#if TARGET_PLATFORM_APPLE
+    // NOTE: This may be called from a signal handler, so the stop event is triggered without searching or logging
+    struct kevent userEvent;
+    EV_SET(&userEvent, INTERNAL_EVENT_ID, EVFILT_USER, 0, NOTE_TRIGGER, 0, self->stopEvent);
+
+    kevent(self->kqueueFD, &userEvent, 1, NULL, 0, NULL);
+#else
     EventLoopTriggerUserEvent(self, INTERNAL_EVENT_ID);
+#endif
 }
 
 
@@ -696,7 +723,9 @@ static void EventLoopHandleServerEvent(EventLoopRef self, Event *event) {
     }
 
     if (event->server.didAccept != NULL) {
+        TraceBeginValue(TAG, "Accept", "id", peerEvent->id);
         event->server.didAccept(self, event->id, peerEvent->id, (struct sockaddr *)&remoteAddress, self->callbackContext);
+        TraceEnd(TAG, "Accept");
     }
 
     self->nextID = nextID + 1;
@@ -734,7 +763,9 @@ static void EventLoopHandleServerPeerDisconnect(EventLoopRef self, Event *event)
     }
 
     if (event->serverPeer.peerDidDisconnect != NULL) {
+        TraceBeginValue(TAG, "Disconnect", "id", event->id);
         event->serverPeer.peerDidDisconnect(self, event->serverPeer.serverID, event->id, self->callbackContext);
+        TraceEnd(TAG, "Disconnect");
     }
 
     EventLoopDeactivateEvent(self, event);
@@ -750,14 +781,17 @@ static void EventLoopHandleServerPeerReadEvent(EventLoopRef self, Event *event)
     // Read the data
     ssize_t bytesRead = read(event->serverPeer.fd, event->serverPeer.receiveBuffer, event->serverPeer.receiveBufferSize);
 
+    // A misbehaving client can fail every read, so the failures are limited
     if (bytesRead == -1) {
-        LogErrno(TAG, errno, "Failed to read from server peer %" PRIu16 " from %" PRIu16, event->id, event->serverPeer.serverID);
+        LogLimitedErrno(TAG, errno, "Failed to read from server peer %" PRIu16 " from %" PRIu16, event->id, event->serverPeer.serverID);
     } else if (bytesRead > 0) {
         if (event->serverPeer.didReceiveData != NULL) {
+            TraceBeginValue(TAG, "Receive", "id", event->id);
             event->serverPeer.didReceiveData(self, event->serverPeer.serverID, event->id, event->serverPeer.receiveBuffer, (size_t)bytesRead, self->callbackContext);
+            TraceEnd(TAG, "Receive");
         }
     } else {
-        LogW(TAG, "Read zero bytes from server peer %" PRIu16 "from %" PRIu16, event->id, event->serverPeer.serverID);
+        LogLimitedW(TAG, "Read zero bytes from server peer %" PRIu16 "from %" PRIu16, event->id, event->serverPeer.serverID);
     }
 }
 
@@ -820,6 +854,14 @@ void EventLoopRemoveServer(EventLoopRef self, EventID id) {
 // MARK: - Timers
 
 void EventLoopAddTimer(EventLoopRef self, EventID id, uint32_t timeout, EventLoopTimerFiredCallback callback) {
+    EventLoopAddTimerInternal(self, id, timeout, callback, NULL, false);
+}
+
+void EventLoopAddTimerWithContext(EventLoopRef self, EventID id, uint32_t timeout, EventLoopTimerFiredCallback callback, void *context) {
+    EventLoopAddTimerInternal(self, id, timeout, callback, context, true);
+}
+
+static void EventLoopAddTimerInternal(EventLoopRef self, EventID id, uint32_t timeout, EventLoopTimerFiredCallback callback, void *context, bool hasContext) {
     EventRef event = NULL;
 
     // Do nothing if the timer exists
@@ -834,6 +876,8 @@ void EventLoopAddTimer(EventLoopRef self, EventID id, uint32_t timeout, EventLoo
     event->id = id;
     event->isActive = true;
     event->timer.timerFired = callback;
+    event->timer.context = context;
+    event->timer.hasContext = hasContext;
 
     // Add the event to kqueue
     struct kevent timerEvent;
@@ -882,7 +926,11 @@ static void EventLoopHandleTimerEvent(EventLoopRef self, Event *event) {
 
     // Call the callback
     if (event->timer.timerFired != NULL) {
-        event->timer.timerFired(self, event->id, self->callbackContext);
+        void *context = event->timer.hasContext ? event->timer.context : self->callbackContext;
+
+        TraceBeginValue(TAG, "Timer", "id", event->id);
+        event->timer.timerFired(self, event->id, context);
+        TraceEnd(TAG, "Timer");
     }
 }
 
@@ -995,7 +1043,9 @@ static void EventLoopHandleUserEvent(EventLoopRef self, Event *event) {
 
     // Call the callback
     if (event->user.userEventFired != NULL) {
+        TraceBeginValue(TAG, "User", "id", event->id);
         event->user.userEventFired(self, event->id, self->callbackContext);
+        TraceEnd(TAG, "User");
     }
 
     // Clear the trigger
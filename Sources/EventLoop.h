@@ -123,6 +123,7 @@ void EventLoopRunOnce(EventLoopRef NONNULL eventLoop, int64_t timeout);
 /**
  * Stop the Event Loop from processing any more events.
  * \param eventLoop The Event Loop to stop.
+ * \note This is async-signal-safe, so a signal handler may stop the Event Loop.
  */
 void EventLoopStop(EventLoopRef NONNULL eventLoop);
 
@@ -140,6 +141,18 @@ void EventLoopStop(EventLoopRef NONNULL eventLoop);
  */
 void EventLoopAddTimer(EventLoopRef NONNULL eventLoop, EventID id, uint32_t timeout, EventLoopTimerFiredCallback NULLABLE callback);
 
+/**
+ * Add a timer with the given ID and its own callback context to the Event Loop.
+ * \param eventLoop The Event Loop to modify.
+ * \param id The ID of the timer.
+ * \param timeout The timeout in milliseconds for the timer.
+ * \param callback The callback to call when the timer has fired.
+ * \param context The opaque context passed to `callback` in place of the Event Loop's callback context.
+ * \note The `id` value of `UINT16_MAX` is reserved.
+ * \note Duplicate `id` values will be ignored.
+ */
+void EventLoopAddTimerWithContext(EventLoopRef NONNULL eventLoop, EventID id, uint32_t timeout, EventLoopTimerFiredCallback NULLABLE callback, void * NULLABLE context);
+
 /**
  * Does the Event Loop have a timer with the given ID?
  * \param eventLoop The Event Loop to inspect.
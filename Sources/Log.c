@@ -11,57 +11,566 @@
 #include "Log.h"
 
 #include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Arena.h"
+#include "LogFile.h"
 
 #if TARGET_PLATFORM_APPLE
 #include <os/log.h>
 #elif TARGET_PLATFORM_LINUX
-#include <time.h>
-// TODO: syslog header here
+#include <syslog.h>
+
+#include "LogJournal.h"
 #endif
 
 
 // MARK: - Constants & Globals
 
-static bool ConsoleOutputEnabled = true;
-static bool CallbackOutputEnabled = false;
-static bool SystemOutputEnabled = false;
+#define MESSAGE_SIZE 1024
+#define LINE_SIZE (MESSAGE_SIZE + 128)
+#define LINE_TAG_WIDTH 14
+#define TIME_PREFIX_SIZE 32
+
+// NOTE: A record is built on the stack before it is copied to a ring, so this is also the largest record.
+#define RECORD_SIZE 2048
+
+// NOTE: Each thread's ring holds this many bytes of records. It must be a power of two.
+#define RING_SIZE 65536
+#define RING_ALIGNMENT 8
+#define RING_ALIGN(S) (((S) + (RING_ALIGNMENT - 1)) & ~((size_t)RING_ALIGNMENT - 1))
+
+#define BATCH_SIZE 16384
+#define WRITER_INTERVAL_MS 10
+#define FILE_SYNC_INTERVAL_MS 1000
+#define WAIT_INTERVAL_NS 50000
+
+// NOTE: A record that fills the end of the ring, so the next record starts at the beginning
+#define RECORD_LEVEL_WRAP UINT16_MAX
+
+#define FORMAT_MAX_ARGUMENTS 16
+#define FORMAT_SPEC_SIZE 32
+
+// NOTE: The length written for a `NULL` string argument
+#define STRING_NULL UINT16_MAX
+
+// NOTE: Tags are never removed, so the table only needs room for every tag in use. It must be a power of two.
+#define TAG_TABLE_SIZE 256
+#define TAG_LEVEL_DEFAULT -1
+
+#define BINARY_MAGIC "WPLG"
+#define BINARY_VERSION 1
+#define BINARY_HEADER_SIZE (sizeof(uint8_t) + sizeof(BINARY_MAGIC) - 2 + sizeof(uint16_t))
+#define BINARY_MESSAGE_SIZE (sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint8_t) + sizeof(int64_t) + sizeof(uint32_t) + sizeof(uint8_t) + UINT8_MAX + sizeof(uint16_t) + RECORD_SIZE)
+#define DECODE_ARENA_SIZE 16384
+
+// NOTE: Formats are numbered per call site, so a log naming more is damaged, not large
+#define DECODE_MAX_FORMATS 65536
+
+// NOTE: The recorder level when nothing is recorded
+#define RECORDER_LEVEL_DISABLED (LogLevelError + 1)
+
+// NOTE: Larger than any binary entry
+#define DUMP_BUFFER_SIZE 8192
+
+// NOTE: The outputs are only changed by publishing a new copy, so messages read them without a lock
+typedef struct _LogSinks {
+    bool isConsoleEnabled;
+    bool isSystemEnabled;
+
+    // NOTE: `NULL` when callback output is disabled
+    LogCallback callback;
+
+    // NOTE: `NULL` when file output is disabled
+    LogFileRef file;
+
+#if TARGET_PLATFORM_LINUX
+    LogJournalRef journal;
+    bool isSyslogOpen;
+#endif
+} LogSinks;
+
+typedef struct _LogReader {
+    // NOTE: The sinks generation the thread started reading in, or 0 when it is not reading
+    atomic_uint_fast64_t generation;
+
+    // NOTE: A reader is never freed. When its thread exits, the next new thread takes it over.
+    atomic_bool isOwned;
+    struct _LogReader *next;
+} LogReader;
+
+// NOTE: Sinks replaced from a callback, kept until no message started before the replacement is still reading them
+typedef struct _LogRetiredSinks {
+    // NOTE: `NULL` when the replaced sinks were the defaults
+    LogSinks *sinks;
+
+    // NOTE: The handles the replacement stopped using, `NULL` when it kept them
+    LogFileRef file;
+#if TARGET_PLATFORM_LINUX
+    LogJournalRef journal;
+    bool isSyslogClosed;
+#endif
+
+    uint64_t generation;
+    struct _LogRetiredSinks *next;
+} LogRetiredSinks;
+
+static LogSinks DefaultSinks = { .isConsoleEnabled = true };
+static _Atomic(LogSinks *) Sinks = &DefaultSinks;
+static atomic_uint_fast64_t SinksGeneration = 1;
+static pthread_mutex_t SinksMutex = PTHREAD_MUTEX_INITIALIZER;
+
+// NOTE: Changed with `SinksMutex` held, the pointer is atomic so messages can check it without the lock
+static _Atomic(LogRetiredSinks *) RetiredSinks = NULL;
+
+static _Atomic(LogReader *) Readers = NULL;
+static _Thread_local LogReader *ThreadReader = NULL;
+static _Thread_local int ThreadReadDepth = 0;
+
+static pthread_once_t ReaderKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t ReaderKey;
+
+static atomic_bool CoarseClockEnabled = false;
+
+#if TARGET_PLATFORM_LINUX
+static char *JournalPath = NULL;
+#endif
+
+static atomic_int GlobalLogLevel = LogLevelInfo;
+
+typedef enum _LogArgument {
+    LogArgumentInt = 0,
+    LogArgumentLong,
+    LogArgumentLongLong,
+    LogArgumentSize,
+    LogArgumentPtrDiff,
+    LogArgumentIntMax,
+    LogArgumentDouble,
+    LogArgumentPointer,
+    LogArgumentString,
+
+    // NOTE: Set on integer arguments with an unsigned conversion, so they are widened correctly
+    LogArgumentUnsigned = 0x80,
+} LogArgument;
+
+typedef struct _LogFormat {
+    // NOTE: Identifiers start at 1 and are only unique to a process
+    uint32_t identifier;
+
+    // NOTE: The binary output generation this format was last defined in
+    uint32_t generation;
+
+    // NOTE: The recorder dump this format was last defined in
+    uint32_t dumpGeneration;
+
+    const char *format;
+
+    // NOTE: Formats that can't be recorded as arguments are formatted when logged
+    bool isDeferred;
+    uint8_t totalArguments;
+    uint8_t arguments[FORMAT_MAX_ARGUMENTS];
+} LogFormat;
+
+typedef struct _LogRecord {
+    uint32_t size;
+    uint16_t level;
+    uint16_t tagSize;
+    uint32_t dataSize;
+
+    // NOTE: The format the data holds the arguments of, or `NULL` if the data is the message
+    const LogFormat *format;
+
+    // NOTE: The logging thread's fields. Their values outlive the asynchronous writer.
+    const char *fields[LogFieldCount];
+
+    struct timeval time;
+
+    // NOTE: The tag, `NULL` terminated, then the data
+    char data[];
+} LogRecord;
+
+typedef union _LogRecordBuffer {
+    LogRecord record;
+    uint64_t storage[RECORD_SIZE / sizeof(uint64_t)];
+} LogRecordBuffer;
+
+typedef struct _LogRing {
+    // NOTE: Free running byte counts. Only the owning thread moves `head` and only the writer moves `tail`.
+    atomic_size_t head;
+    atomic_size_t tail;
+
+    atomic_uint_fast64_t totalDropped;
+    atomic_uint_fast64_t totalWaits;
+    uint64_t reportedDropped;
+
+    // NOTE: A ring is never freed. When its thread exits, the next new thread takes it over.
+    atomic_bool isOwned;
+    struct _LogRing *next;
+
+    uint8_t buffer[RING_SIZE];
+} LogRing;
+
+typedef struct _LogRecorder {
+    // NOTE: Free running byte counts, only moved by the owning thread. `tail` moves before the records behind it are overwritten.
+    atomic_size_t head;
+    atomic_size_t tail;
+
+    // NOTE: Where a dump has read to, and where it stops
+    size_t dumpPosition;
+    size_t dumpEnd;
+
+    // NOTE: A recorder is never freed. When its thread exits, the next new thread takes it over, and its records with it.
+    atomic_bool isOwned;
+    struct _LogRecorder *next;
+
+    uint8_t buffer[LOG_RECORDER_SIZE];
+} LogRecorder;
+
+typedef struct _LogDump {
+    int fd;
+    bool isFailed;
+
+    size_t used;
+    uint8_t buffer[DUMP_BUFFER_SIZE];
+} LogDump;
+
+typedef struct _LogTag {
+    _Atomic(const char *) name;
+
+    // NOTE: The tag's own level, or `TAG_LEVEL_DEFAULT` to follow the global level
+    atomic_int level;
+} LogTag;
+
+typedef struct _LogTimeCache {
+    bool isValid;
+    time_t second;
+
+    // NOTE: The local date and time up to the microseconds, such as `2020-12-16 08:30:00.`
+    char prefix[TIME_PREFIX_SIZE];
+    size_t prefixSize;
+} LogTimeCache;
+
+typedef enum _LogEntry {
+    LogEntryHeader = 'W',
+    LogEntryFormat = 'F',
+    LogEntryMessage = 'M',
+} LogEntry;
+
+static atomic_bool AsyncOutputEnabled = false;
+static atomic_int OverflowPolicy = LogOverflowPolicyDrop;
+
+static _Atomic(LogRing *) Rings = NULL;
+static _Thread_local LogRing *ThreadRing = NULL;
+static _Thread_local bool IsLoggingOnThread = false;
 
-static LogCallback Callback  = NULL;
+// NOTE: Each thread that formats lines keeps its own, so nothing is locked to format the time
+static _Thread_local LogTimeCache TimeCache;
+static _Thread_local const char *ThreadFields[LogFieldCount];
+static _Thread_local LogCallback ThreadCapture = NULL;
 
-static LogLevel GlobalLogLevel = LogLevelInfo;
+static pthread_once_t RingKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t RingKey;
+
+static pthread_t WriterThread;
+static pthread_mutex_t WriterMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t WriterCondition = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t FlushCondition = PTHREAD_COND_INITIALIZER;
+static bool IsWriterRunning = false;
+static uint64_t FlushesRequested = 0;
+static uint64_t FlushesCompleted = 0;
+
+static atomic_uint_fast64_t TotalWritten = 0;
+
+static atomic_uint_fast32_t NextFormatIdentifier = 1;
+
+static LogTag Tags[TAG_TABLE_SIZE];
+static pthread_mutex_t TagsMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static atomic_bool BinaryOutputEnabled = false;
+static pthread_mutex_t BinaryMutex = PTHREAD_MUTEX_INITIALIZER;
+static FILE *BinaryFile = NULL;
+static uint32_t BinaryGeneration = 0;
+
+static atomic_int RecorderLevel = RECORDER_LEVEL_DISABLED;
+static _Atomic(LogRecorder *) Recorders = NULL;
+static _Thread_local LogRecorder *ThreadRecorder = NULL;
+
+static pthread_once_t RecorderKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t RecorderKey;
+
+// NOTE: A dump may run in a signal handler, so dumps are kept apart with a flag rather than a lock
+static atomic_flag IsDumping = ATOMIC_FLAG_INIT;
+static uint32_t DumpGeneration = 0;
+
+
+// MARK: - Prototypes
+
+static char LogLevelToChar(LogLevel level);
+static void LogDeliver(const LogSinks * NONNULL sinks, const LogRecord * NONNULL record, const char * NONNULL message, bool isBatched);
+static size_t LogAppend(char * NONNULL buffer, size_t limit, size_t used, const char * NONNULL value, size_t valueSize);
+static size_t LogFormatLine(char * NONNULL buffer, size_t bufferSize, LogLevel level, const char * NONNULL tag, const char * NONNULL message, const struct timeval * NONNULL time);
+static void LogProcessRecord(const LogSinks * NONNULL sinks, const LogRecord * NONNULL record, char * NULLABLE batch, size_t * NULLABLE batchSize);
+
+static bool LogParseFormat(const char * NONNULL format, LogFormat * NONNULL result);
+static const LogFormat * NONNULL LogRegisterFormat(LogSite * NONNULL site, const char * NONNULL format);
+static size_t LogEncodeArguments(const LogFormat * NONNULL format, va_list args, uint8_t * NONNULL buffer, size_t bufferSize);
+static bool LogRenderMessage(const LogFormat * NONNULL format, const uint8_t * NONNULL data, size_t dataSize, char * NONNULL buffer, size_t bufferSize);
+static void LogCapture(LogLevel level, const char * NONNULL tag, const char * NONNULL format, va_list args);
+static void LogSubmitMessage(LogLevel level, const char * NONNULL tag, const char * NONNULL format, va_list args, bool isOutput);
+static size_t LogStartRecord(LogRecordBuffer * NONNULL buffer, LogLevel level, const char * NONNULL tag);
+static void LogSubmitRecord(LogRecord * NONNULL record, bool isOutput);
+
+static LogRing * NULLABLE LogClaimRing(void);
+static void LogCreateRingKey(void);
+static bool LogEnqueue(const LogRecord * NONNULL record);
+static void LogReleaseRing(void * NULLABLE ring);
+
+static void LogDrainRings(char * NONNULL batch, size_t * NONNULL batchSize);
+static void LogWriteBatch(const char * NONNULL batch, size_t * NONNULL batchSize);
+static void LogSyncFile(void);
+static void * LogWriterMain(void * NULLABLE context);
+
+static const LogSinks * NONNULL LogAcquireSinks(void);
+static void LogReleaseSinks(void);
+static LogSinks * NONNULL LogCopySinks(void);
+static void LogPublishSinks(LogSinks * NONNULL sinks);
+static void LogDestroyRetiredSinks(LogRetiredSinks * NONNULL retired);
+static bool LogIsGenerationRead(uint64_t generation);
+static void LogReleaseRetiredSinks(void);
+static LogReader * NONNULL LogClaimReader(void);
+static void LogCreateReaderKey(void);
+static void LogReleaseReader(void * NULLABLE reader);
+
+static LogTag * NULLABLE LogFindTag(const char * NONNULL name, bool isCreating);
+static bool LogIsTagEnabled(const LogTag * NULLABLE tag, LogLevel level);
+static bool LogParseLevel(const char * NONNULL value, size_t valueSize, LogLevel * NONNULL level);
+static bool LogParseTagLevels(const char * NONNULL levels, bool isApplying);
+
+static LogRecorder * NULLABLE LogClaimRecorder(void);
+static void LogCreateRecorderKey(void);
+static void LogReleaseRecorder(void * NULLABLE recorder);
+static void LogRecorderWrite(const LogRecord * NONNULL record);
+static bool LogRecorderPeek(LogRecorder * NONNULL recorder, struct timeval * NONNULL time);
+static void LogDumpAppend(LogDump * NONNULL dump, const void * NONNULL data, size_t dataSize);
+static void LogDumpFlush(LogDump * NONNULL dump);
+
+static size_t LogEncode(uint8_t * NONNULL buffer, size_t used, const void * NONNULL value, size_t valueSize);
+static size_t LogEncodeBinaryHeader(uint8_t * NONNULL buffer);
+static size_t LogEncodeBinaryFormat(const LogFormat * NONNULL format, uint8_t * NONNULL buffer);
+static size_t LogEncodeBinaryMessage(const LogRecord * NONNULL record, uint8_t * NONNULL buffer);
+static void LogWriteBinaryHeader(FILE * NONNULL file);
+static void LogWriteBinaryRecord(const LogRecord * NONNULL record);
 
 
 // MARK: - Initialization
 
 void LogEnableCallbackOutput(bool enabled, LogCallback NULLABLE callback) {
-    CallbackOutputEnabled = enabled;
+    pthread_mutex_lock(&SinksMutex);
+
+    LogSinks *sinks = LogCopySinks();
+    sinks->callback = enabled ? callback : NULL;
+
+    LogPublishSinks(sinks);
+
+    pthread_mutex_unlock(&SinksMutex);
+}
+
+void LogEnableCoarseClock(bool enabled) {
+    atomic_store(&CoarseClockEnabled, enabled);
+}
+
+void LogEnableConsoleOutput(bool enabled) {
+    pthread_mutex_lock(&SinksMutex);
+
+    LogSinks *sinks = LogCopySinks();
+    sinks->isConsoleEnabled = enabled;
+
+    LogPublishSinks(sinks);
+
+    pthread_mutex_unlock(&SinksMutex);
+}
+
+void LogEnableSystemOutput(bool enabled) {
+    pthread_mutex_lock(&SinksMutex);
+
+    LogSinks *sinks = LogCopySinks();
+    sinks->isSystemEnabled = enabled;
+
+#if TARGET_PLATFORM_LINUX
+    // Entries go to journald when it is running, and to syslog when it is not. The previous journal is closed once it is published.
+    if (enabled && sinks->journal == NULL && !sinks->isSyslogOpen) {
+        sinks->journal = LogJournalCreate((JournalPath != NULL) ? JournalPath : LOG_JOURNAL_DEFAULT_PATH);
+
+        if (sinks->journal == NULL) {
+            openlog(PROJECT_NAME, LOG_PID | LOG_NDELAY, LOG_DAEMON);
+            sinks->isSyslogOpen = true;
+        }
+    } else if (!enabled) {
+        sinks->journal = NULL;
+        sinks->isSyslogOpen = false;
+    }
+#endif
+
+    LogPublishSinks(sinks);
+
+    pthread_mutex_unlock(&SinksMutex);
+}
+
+void LogSetJournalPath(const char *path) {
+#if TARGET_PLATFORM_LINUX
+    pthread_mutex_lock(&SinksMutex);
+
+    SAFE_DESTROY(JournalPath, free);
+
+    if (path != NULL) {
+        JournalPath = strdup(path);
+    }
+
+    pthread_mutex_unlock(&SinksMutex);
+#endif
+}
+
+bool LogEnableFileOutput(const char *path, size_t totalSegments, size_t segmentSize) {
+    LogFileRef file = NULL;
+
+    if (path != NULL) {
+        file = LogFileCreate(path, totalSegments, segmentSize);
+
+        if (file == NULL) {
+            LogErrno("Log", errno, "Failed to open log file %s", path);
+            return false;
+        }
+    }
+
+    // The previous file is closed once no message is writing to it
+    pthread_mutex_lock(&SinksMutex);
+
+    LogSinks *sinks = LogCopySinks();
+    sinks->file = file;
+
+    LogPublishSinks(sinks);
+
+    pthread_mutex_unlock(&SinksMutex);
+
+    return true;
+}
+
+bool LogEnableAsyncOutput(bool enabled, LogOverflowPolicy policy) {
+    atomic_store(&OverflowPolicy, (int)policy);
+
+    pthread_mutex_lock(&WriterMutex);
+
+    if (enabled == IsWriterRunning) {
+        pthread_mutex_unlock(&WriterMutex);
+        return true;
+    }
 
     if (enabled) {
-        Callback = callback;
+        pthread_once(&RingKeyOnce, LogCreateRingKey);
+
+        int result = pthread_create(&WriterThread, NULL, LogWriterMain, NULL);
+
+        if (result != 0) {
+            pthread_mutex_unlock(&WriterMutex);
+            LogErrno("Log", result, "Failed to start the log writer");
+            return false;
+        }
+
+        IsWriterRunning = true;
+        atomic_store(&AsyncOutputEnabled, true);
+
+        pthread_mutex_unlock(&WriterMutex);
     } else {
-        Callback = NULL;
+        // New messages are written directly, then the writer finishes what was buffered
+        atomic_store(&AsyncOutputEnabled, false);
+        IsWriterRunning = false;
+
+        pthread_cond_signal(&WriterCondition);
+        pthread_mutex_unlock(&WriterMutex);
+
+        pthread_join(WriterThread, NULL);
     }
+
+    return true;
 }
 
-void LogEnableConsoleOutput(bool enabled) {
-    ConsoleOutputEnabled = enabled;
+bool LogEnableBinaryOutput(const char *path) {
+    FILE *file = NULL;
+
+    if (path != NULL) {
+        file = fopen(path, "ab");
+
+        if (file == NULL) {
+            LogErrno("Log", errno, "Failed to open binary log %s", path);
+            return false;
+        }
+
+        // A log may be appended to by several runs, so each starts with its own header
+        LogWriteBinaryHeader(file);
+    }
+
+    pthread_mutex_lock(&BinaryMutex);
+
+    if (BinaryFile != NULL) {
+        fclose(BinaryFile);
+    }
+
+    BinaryFile = file;
+    BinaryGeneration += 1;
+    atomic_store(&BinaryOutputEnabled, file != NULL);
+
+    pthread_mutex_unlock(&BinaryMutex);
+
+    return true;
 }
 
-void LogEnableSystemOutput(bool enabled) {
-    SystemOutputEnabled = enabled;
+void LogEnableRecorder(bool enabled, LogLevel level) {
+    atomic_store(&RecorderLevel, enabled ? (int)level : RECORDER_LEVEL_DISABLED);
 }
 
-void LogSetUp(LogLevel level) {
-    GlobalLogLevel = level;
+void LogFlush(void) {
+    pthread_mutex_lock(&WriterMutex);
+
+    if (IsWriterRunning) {
+        FlushesRequested += 1;
+        uint64_t flush = FlushesRequested;
+
+        pthread_cond_signal(&WriterCondition);
+
+        while (IsWriterRunning && FlushesCompleted < flush) {
+            pthread_cond_wait(&FlushCondition, &WriterMutex);
+        }
+    }
+
+    pthread_mutex_unlock(&WriterMutex);
 }
 
+void LogGetStatistics(LogStatistics *statistics) {
+    memset(statistics, 0, sizeof(LogStatistics));
 
-// MARK: - Prototypes
+    statistics->totalWritten = atomic_load(&TotalWritten);
 
-static char LogLevelToChar(LogLevel level);
+    for (LogRing *ring = atomic_load(&Rings); ring != NULL; ring = ring->next) {
+        statistics->totalDropped += atomic_load_explicit(&ring->totalDropped, memory_order_relaxed);
+        statistics->totalWaits += atomic_load_explicit(&ring->totalWaits, memory_order_relaxed);
+    }
+}
+
+void LogSetUp(LogLevel level) {
+    atomic_store(&GlobalLogLevel, (int)level);
+}
 
 
 // MARK: - Logging
@@ -75,52 +584,138 @@ void Log(LogLevel level, const char *tag, const char *format, ...) {
     va_end(args);
 }
 
-void LogVA(LogLevel level, const char *tag, const char *format, va_list args) {
-    char messageBuffer[1024];
-    vsnprintf(messageBuffer, sizeof(messageBuffer), format, args);
+void LogAt(LogSite *site, LogLevel level, const char *tag, const char *format, ...) {
+    if (ThreadCapture != NULL) {
+        va_list args;
+        va_start(args, format);
+
+        LogCapture(level, tag, format, args);
 
-    char levelChar = LogLevelToChar(level);
+        va_end(args);
+        return;
+    }
 
-    struct timeval now;
-    gettimeofday(&now, NULL);
+    // A message may only be let through for the recorder, in which case the outputs skip it
+    bool isRecorded = (int)level >= atomic_load_explicit(&RecorderLevel, memory_order_relaxed);
+    bool isOutput = !isRecorded || LogIsTagEnabled((const LogTag *)atomic_load_explicit((_Atomic(void *) *)&site->tag, memory_order_acquire), level);
 
-    time_t nowTime = now.tv_sec;
-    struct tm *nowLocal = localtime(&nowTime);
+    // Without a reader for the arguments, formatting now is cheapest
+    if (!isRecorded && !atomic_load_explicit(&AsyncOutputEnabled, memory_order_relaxed) && !atomic_load_explicit(&BinaryOutputEnabled, memory_order_relaxed)) {
+        va_list args;
+        va_start(args, format);
 
-    char timeBuffer[64];
-    strftime(timeBuffer, sizeof(timeBuffer), "%Y-%m-%d %H:%M:%S", nowLocal);
+        LogSubmitMessage(level, tag, format, args, true);
 
-    if (CallbackOutputEnabled && Callback != NULL) {
-        Callback(level, tag, messageBuffer);
+        va_end(args);
+        return;
     }
 
-    if (ConsoleOutputEnabled) {
-        printf("%s.%06ld %c %-14s %s\n", timeBuffer, (long)now.tv_usec, levelChar, tag, messageBuffer);
+    const LogFormat *logFormat = (const LogFormat *)atomic_load_explicit((_Atomic(void *) *)&site->format, memory_order_acquire);
+
+    if (logFormat == NULL) {
+        logFormat = LogRegisterFormat(site, format);
     }
 
-    if (SystemOutputEnabled) {
-#if TARGET_PLATFORM_APPLE
-        os_log_type_t logType;
+    va_list args;
+    va_start(args, format);
 
-        switch (level) {
-            case LogLevelDebug:
-            case LogLevelVerbose:
-                logType = OS_LOG_TYPE_DEBUG;
-                break;
-            case LogLevelError:
-            case LogLevelWarning:
-                logType = OS_LOG_TYPE_ERROR;
-                break;
-            case LogLevelInfo:
-                logType = OS_LOG_TYPE_INFO;
-                break;
-        }
+    if (!logFormat->isDeferred) {
+        LogSubmitMessage(level, tag, format, args, isOutput);
+        va_end(args);
+        return;
+    }
 
-        os_log_with_type(OS_LOG_DEFAULT, logType, "%c/%{public}-14s: %{public}s", levelChar, tag, messageBuffer);
-#elif TARGET_PLATFORM_LINUX
-        // TODO: syslog implementation here
+    LogRecordBuffer buffer;
+    size_t offset = LogStartRecord(&buffer, level, tag);
+
+    LogRecord *record = &buffer.record;
+    record->format = logFormat;
+    record->dataSize = (uint32_t)LogEncodeArguments(logFormat, args, (uint8_t *)record->data + offset, RECORD_SIZE - offsetof(LogRecord, data) - offset);
+
+    va_end(args);
+
+    LogSubmitRecord(record, isOutput);
+}
+
+void LogVA(LogLevel level, const char *tag, const char *format, va_list args) {
+    if (ThreadCapture != NULL) {
+        LogCapture(level, tag, format, args);
+        return;
+    }
+
+    bool isOutput = LogIsTagEnabled(LogFindTag(tag, false), level);
+
+    if (!isOutput && (int)level < atomic_load_explicit(&RecorderLevel, memory_order_relaxed)) {
+        return;
+    }
+
+    LogSubmitMessage(level, tag, format, args, isOutput);
+}
+
+bool LogIsEnabled(LogSite *site, LogLevel level, const char *tag) {
+    LogTag *logTag = (LogTag *)atomic_load_explicit((_Atomic(void *) *)&site->tag, memory_order_acquire);
+
+    // The first message from a site finds its tag, so later checks are a pair of loads
+    if (logTag == NULL) {
+        logTag = LogFindTag(tag, true);
+        atomic_store_explicit((_Atomic(void *) *)&site->tag, (void *)logTag, memory_order_release);
+    }
+
+    return LogIsTagEnabled(logTag, level) || (int)level >= atomic_load_explicit(&RecorderLevel, memory_order_relaxed);
+}
+
+LogCallback LogSetThreadCapture(LogCallback callback) {
+    LogCallback previous = ThreadCapture;
+    ThreadCapture = callback;
+
+    return previous;
+}
+
+const char * LogSetField(LogField field, const char *value) {
+    const char *previous = ThreadFields[field];
+    ThreadFields[field] = value;
+
+    return previous;
+}
+
+bool LogIsAllowed(LogLimit *limit, LogLevel level, const char *tag) {
+    struct timespec now;
+
+#if defined(CLOCK_MONOTONIC_COARSE)
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &now);
 #endif
+
+    uint64_t milliseconds = ((uint64_t)now.tv_sec * 1000ULL) + ((uint64_t)now.tv_nsec / 1000000ULL);
+
+    // A limited site is dropping messages until its next refill
+    if (limit->tokens == 0 && milliseconds < limit->refillTime) {
+        limit->totalSuppressed += 1;
+        return false;
+    }
+
+    if (limit->refillTime == 0) {
+        limit->tokens = LOG_LIMIT_BURST;
+        limit->refillTime = milliseconds + LOG_LIMIT_INTERVAL;
+    } else if (milliseconds >= limit->refillTime) {
+        uint64_t earned = 1 + ((milliseconds - limit->refillTime) / LOG_LIMIT_INTERVAL);
+        uint64_t tokens = limit->tokens + earned;
+
+        limit->tokens = (tokens > LOG_LIMIT_BURST) ? LOG_LIMIT_BURST : (uint32_t)tokens;
+        limit->refillTime += earned * LOG_LIMIT_INTERVAL;
+    }
+
+    limit->tokens -= 1;
+
+    if (limit->totalSuppressed > 0) {
+        uint32_t totalSuppressed = limit->totalSuppressed;
+        limit->totalSuppressed = 0;
+
+        Log(level, tag, "Suppressed %" PRIu32 " repeats of the next message", totalSuppressed);
     }
+
+    return true;
 }
 
 void LogErrno(const char * NONNULL tag, int errorNumber, const char * NONNULL format, ...) {
@@ -138,6 +733,1732 @@ void LogErrno(const char * NONNULL tag, int errorNumber, const char * NONNULL fo
     Log(LogLevelError, tag, "%s: (%i) %s", messageBuffer, errorNumber, errorBuffer);
 }
 
+static void LogCapture(LogLevel level, const char *tag, const char *format, va_list args) {
+    char message[MESSAGE_SIZE];
+    vsnprintf(message, sizeof(message), format, args);
+
+    ThreadCapture(level, tag, message);
+}
+
+static void LogSubmitMessage(LogLevel level, const char *tag, const char *format, va_list args, bool isOutput) {
+    LogRecordBuffer buffer;
+    size_t offset = LogStartRecord(&buffer, level, tag);
+
+    LogRecord *record = &buffer.record;
+    size_t available = RECORD_SIZE - offsetof(LogRecord, data) - offset;
+
+    if (available > MESSAGE_SIZE) {
+        available = MESSAGE_SIZE;
+    }
+
+    int messageSize = vsnprintf(record->data + offset, available, format, args);
+
+    if (messageSize < 0) {
+        messageSize = 0;
+        record->data[offset] = '\0';
+    } else if ((size_t)messageSize >= available) {
+        messageSize = (int)available - 1;
+    }
+
+    record->format = NULL;
+    record->dataSize = (uint32_t)messageSize + 1;
+
+    LogSubmitRecord(record, isOutput);
+}
+
+static size_t LogStartRecord(LogRecordBuffer *buffer, LogLevel level, const char *tag) {
+    LogRecord *record = &buffer->record;
+
+    size_t tagSize = strnlen(tag, UINT8_MAX) + 1;
+    memcpy(record->data, tag, tagSize - 1);
+    record->data[tagSize - 1] = '\0';
+
+    record->level = (uint16_t)level;
+    record->tagSize = (uint16_t)tagSize;
+
+    memcpy(record->fields, ThreadFields, sizeof(record->fields));
+
+#if defined(CLOCK_REALTIME_COARSE)
+    if (atomic_load_explicit(&CoarseClockEnabled, memory_order_relaxed)) {
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME_COARSE, &now);
+
+        record->time.tv_sec = now.tv_sec;
+        record->time.tv_usec = (suseconds_t)(now.tv_nsec / 1000);
+    } else {
+        gettimeofday(&record->time, NULL);
+    }
+#else
+    gettimeofday(&record->time, NULL);
+#endif
+
+    return tagSize;
+}
+
+static void LogSubmitRecord(LogRecord *record, bool isOutput) {
+    record->size = (uint32_t)RING_ALIGN(offsetof(LogRecord, data) + record->tagSize + record->dataSize);
+
+    if ((int)record->level >= atomic_load_explicit(&RecorderLevel, memory_order_relaxed)) {
+        LogRecorderWrite(record);
+    }
+
+    if (!isOutput) {
+        return;
+    }
+
+    // Hand the record to the writer, unless this interrupted a message on the same thread
+    if (atomic_load_explicit(&AsyncOutputEnabled, memory_order_relaxed) && !IsLoggingOnThread) {
+        IsLoggingOnThread = true;
+        bool isQueued = LogEnqueue(record);
+        IsLoggingOnThread = false;
+
+        if (isQueued) {
+            return;
+        }
+    }
+
+    const LogSinks *sinks = LogAcquireSinks();
+    LogProcessRecord(sinks, record, NULL, NULL);
+    LogReleaseSinks();
+}
+
+
+// MARK: - Levels
+
+bool LogCheckTagLevels(const char *levels) {
+    return LogParseTagLevels(levels, false);
+}
+
+bool LogSetTagLevel(const char *tag, LogLevel level) {
+    LogTag *logTag = LogFindTag(tag, true);
+
+    if (logTag == NULL) {
+        return false;
+    }
+
+    atomic_store(&logTag->level, (int)level);
+
+    return true;
+}
+
+bool LogSetTagLevels(const char *levels) {
+    // Nothing changes unless every level is valid
+    if (!LogParseTagLevels(levels, false)) {
+        return false;
+    }
+
+    pthread_mutex_lock(&TagsMutex);
+
+    for (size_t idx = 0; idx < TAG_TABLE_SIZE; idx++) {
+        atomic_store(&Tags[idx].level, TAG_LEVEL_DEFAULT);
+    }
+
+    pthread_mutex_unlock(&TagsMutex);
+
+    return LogParseTagLevels(levels, true);
+}
+
+static LogTag * LogFindTag(const char *name, bool isCreating) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+
+    for (const char *current = name; *current != '\0'; current++) {
+        hash = (hash ^ (uint8_t)*current) * 16777619u;
+    }
+
+    // Tags are added under the lock, but published complete, so finding one needs no lock
+    size_t slot = hash & (TAG_TABLE_SIZE - 1);
+
+    for (size_t idx = 0; idx < TAG_TABLE_SIZE; idx++) {
+        LogTag *tag = Tags + ((slot + idx) & (TAG_TABLE_SIZE - 1));
+        const char *tagName = atomic_load_explicit(&tag->name, memory_order_acquire);
+
+        if (tagName == NULL) {
+            break;
+        } else if (strcmp(tagName, name) == 0) {
+            return tag;
+        }
+    }
+
+    if (!isCreating) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&TagsMutex);
+
+    LogTag *result = NULL;
+
+    for (size_t idx = 0; idx < TAG_TABLE_SIZE && result == NULL; idx++) {
+        LogTag *tag = Tags + ((slot + idx) & (TAG_TABLE_SIZE - 1));
+        const char *tagName = atomic_load_explicit(&tag->name, memory_order_relaxed);
+
+        if (tagName == NULL) {
+            char *copy = strdup(name);
+
+            if (copy != NULL) {
+                atomic_store_explicit(&tag->level, TAG_LEVEL_DEFAULT, memory_order_relaxed);
+                atomic_store_explicit(&tag->name, copy, memory_order_release);
+                result = tag;
+            }
+
+            break;
+        } else if (strcmp(tagName, name) == 0) {
+            result = tag;
+        }
+    }
+
+    pthread_mutex_unlock(&TagsMutex);
+
+    return result;
+}
+
+static bool LogIsTagEnabled(const LogTag *tag, LogLevel level) {
+    int minimumLevel = (tag == NULL) ? TAG_LEVEL_DEFAULT : atomic_load_explicit(&tag->level, memory_order_relaxed);
+
+    if (minimumLevel == TAG_LEVEL_DEFAULT) {
+        minimumLevel = atomic_load_explicit(&GlobalLogLevel, memory_order_relaxed);
+    }
+
+    return (int)level >= minimumLevel;
+}
+
+static bool LogParseLevel(const char *value, size_t valueSize, LogLevel *level) {
+    static const struct {
+        const char *name;
+        LogLevel level;
+    } Levels[] = {
+        { "verbose", LogLevelVerbose },
+        { "debug", LogLevelDebug },
+        { "info", LogLevelInfo },
+        { "warn", LogLevelWarning },
+        { "warning", LogLevelWarning },
+        { "error", LogLevelError },
+    };
+
+    for (size_t idx = 0; idx < sizeof(Levels) / sizeof(Levels[0]); idx++) {
+        if (strlen(Levels[idx].name) == valueSize && strncasecmp(Levels[idx].name, value, valueSize) == 0) {
+            *level = Levels[idx].level;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool LogParseTagLevels(const char *levels, bool isApplying) {
+    const char *current = levels;
+
+    while (*current != '\0') {
+        size_t itemSize = strcspn(current, ",");
+        const char *next = current + itemSize + ((current[itemSize] == ',') ? 1 : 0);
+
+        // Trim the spaces around the item and its parts
+        while (itemSize > 0 && (*current == ' ' || *current == '\t')) {
+            current += 1;
+            itemSize -= 1;
+        }
+
+        while (itemSize > 0 && (current[itemSize - 1] == ' ' || current[itemSize - 1] == '\t')) {
+            itemSize -= 1;
+        }
+
+        if (itemSize == 0) {
+            current = next;
+            continue;
+        }
+
+        const char *separator = memchr(current, '=', itemSize);
+        const char *value = (separator == NULL) ? current : separator + 1;
+        size_t valueSize = itemSize - (size_t)(value - current);
+
+        while (valueSize > 0 && *value == ' ') {
+            value += 1;
+            valueSize -= 1;
+        }
+
+        LogLevel level = LogLevelInfo;
+
+        if (!LogParseLevel(value, valueSize, &level)) {
+            return false;
+        }
+
+        // A level without a tag is the global level
+        if (separator == NULL) {
+            if (isApplying) {
+                LogSetUp(level);
+            }
+        } else {
+            size_t tagSize = (size_t)(separator - current);
+
+            while (tagSize > 0 && current[tagSize - 1] == ' ') {
+                tagSize -= 1;
+            }
+
+            if (tagSize == 0 || tagSize > UINT8_MAX) {
+                return false;
+            }
+
+            if (isApplying) {
+                char tag[UINT8_MAX + 1];
+                memcpy(tag, current, tagSize);
+                tag[tagSize] = '\0';
+
+                if (!LogSetTagLevel(tag, level)) {
+                    return false;
+                }
+            }
+        }
+
+        current = next;
+    }
+
+    return true;
+}
+
+
+// MARK: - Output
+
+static void LogDeliver(const LogSinks *sinks, const LogRecord *record, const char *message, bool isBatched) {
+    LogLevel level = (LogLevel)record->level;
+    const char *tag = record->data;
+
+    if (sinks->callback != NULL) {
+        sinks->callback(level, tag, message);
+    }
+
+    if (sinks->isSystemEnabled) {
+#if TARGET_PLATFORM_APPLE
+        os_log_type_t logType;
+
+        switch (level) {
+            case LogLevelDebug:
+            case LogLevelVerbose:
+                logType = OS_LOG_TYPE_DEBUG;
+                break;
+            case LogLevelError:
+            case LogLevelWarning:
+                logType = OS_LOG_TYPE_ERROR;
+                break;
+            case LogLevelInfo:
+                logType = OS_LOG_TYPE_INFO;
+                break;
+        }
+
+        os_log_with_type(OS_LOG_DEFAULT, logType, "%c/%{public}-14s: %{public}s", LogLevelToChar(level), tag, message);
+#elif TARGET_PLATFORM_LINUX
+        if (sinks->journal != NULL) {
+            // The writer sends its batch of entries together
+            if (isBatched) {
+                LogJournalAppend(sinks->journal, level, tag, message, record->fields);
+            } else {
+                LogJournalWrite(sinks->journal, level, tag, message, record->fields);
+            }
+        } else if (sinks->isSyslogOpen) {
+            int priority;
+
+            switch (level) {
+                case LogLevelDebug:
+                case LogLevelVerbose:
+                    priority = LOG_DEBUG;
+                    break;
+                case LogLevelError:
+                    priority = LOG_ERR;
+                    break;
+                case LogLevelWarning:
+                    priority = LOG_WARNING;
+                    break;
+                case LogLevelInfo:
+                default:
+                    priority = LOG_INFO;
+                    break;
+            }
+
+            syslog(priority, "%c/%-14s: %s", LogLevelToChar(level), tag, message);
+        }
+#endif
+    }
+}
+
+static size_t LogAppend(char *buffer, size_t limit, size_t used, const char *value, size_t valueSize) {
+    if (used + valueSize > limit) {
+        valueSize = limit - used;
+    }
+
+    memcpy(buffer + used, value, valueSize);
+
+    return used + valueSize;
+}
+
+static size_t LogFormatLine(char *buffer, size_t bufferSize, LogLevel level, const char *tag, const char *message, const struct timeval *time) {
+    LogTimeCache *cache = &TimeCache;
+
+    // Only a new second needs the local time, so the rest of the second reuses its text
+    if (!cache->isValid || cache->second != time->tv_sec) {
+        time_t seconds = time->tv_sec;
+        struct tm local;
+
+        localtime_r(&seconds, &local);
+
+        cache->prefixSize = strftime(cache->prefix, sizeof(cache->prefix), "%Y-%m-%d %H:%M:%S.", &local);
+        cache->second = seconds;
+        cache->isValid = true;
+    }
+
+    char fields[16];
+    long microseconds = (long)time->tv_usec;
+
+    for (int idx = 5; idx >= 0; idx--) {
+        fields[idx] = (char)('0' + (microseconds % 10));
+        microseconds /= 10;
+    }
+
+    fields[6] = ' ';
+    fields[7] = LogLevelToChar(level);
+    fields[8] = ' ';
+
+    // Room is kept for the line ending, so a truncated line still has one
+    size_t limit = bufferSize - 2;
+    size_t tagSize = strlen(tag);
+
+    size_t used = LogAppend(buffer, limit, 0, cache->prefix, cache->prefixSize);
+    used = LogAppend(buffer, limit, used, fields, 9);
+    used = LogAppend(buffer, limit, used, tag, tagSize);
+
+    while (tagSize < LINE_TAG_WIDTH && used < limit) {
+        buffer[used++] = ' ';
+        tagSize += 1;
+    }
+
+    used = LogAppend(buffer, limit, used, " ", 1);
+    used = LogAppend(buffer, limit, used, message, strlen(message));
+
+    buffer[used++] = '\n';
+    buffer[used] = '\0';
+
+    return used;
+}
+
+static void LogProcessRecord(const LogSinks *sinks, const LogRecord *record, char *batch, size_t *batchSize) {
+    LogLevel level = (LogLevel)record->level;
+    const char *tag = record->data;
+    const uint8_t *data = (const uint8_t *)record->data + record->tagSize;
+
+    // The writer holds the lock for a whole batch
+    if (atomic_load_explicit(&BinaryOutputEnabled, memory_order_relaxed)) {
+        if (batch == NULL) {
+            pthread_mutex_lock(&BinaryMutex);
+        }
+
+        LogWriteBinaryRecord(record);
+
+        if (batch == NULL) {
+            if (BinaryFile != NULL) {
+                fflush(BinaryFile);
+            }
+
+            pthread_mutex_unlock(&BinaryMutex);
+        }
+    }
+
+    // Only render the message if something reads it
+    if (!sinks->isConsoleEnabled && !sinks->isSystemEnabled && sinks->callback == NULL && sinks->file == NULL) {
+        return;
+    }
+
+    char messageBuffer[MESSAGE_SIZE];
+    const char *message = (const char *)data;
+
+    if (record->format != NULL) {
+        LogRenderMessage(record->format, data, record->dataSize, messageBuffer, sizeof(messageBuffer));
+        message = messageBuffer;
+    }
+
+    LogDeliver(sinks, record, message, batch != NULL);
+
+    if (!sinks->isConsoleEnabled && sinks->file == NULL) {
+        return;
+    }
+
+    // The writer formats the line straight in to its batch, and the file copies it from there
+    char lineBuffer[LINE_SIZE];
+    char *line = lineBuffer;
+
+    if (batch != NULL && sinks->isConsoleEnabled) {
+        if (*batchSize + LINE_SIZE > BATCH_SIZE) {
+            LogWriteBatch(batch, batchSize);
+        }
+
+        line = batch + *batchSize;
+    }
+
+    size_t lineSize = LogFormatLine(line, LINE_SIZE, level, tag, message, &record->time);
+
+    if (sinks->file != NULL) {
+        LogFileWrite(sinks->file, line, lineSize);
+    }
+
+    if (sinks->isConsoleEnabled) {
+        if (batch == NULL) {
+            fwrite(line, 1, lineSize, stdout);
+        } else {
+            *batchSize += lineSize;
+        }
+    }
+}
+
+
+// MARK: - Formats
+
+static bool LogParseFormat(const char *format, LogFormat *result) {
+    result->format = format;
+    result->totalArguments = 0;
+
+    const char *current = format;
+
+    while ((current = strchr(current, '%')) != NULL) {
+        current += 1;
+
+        if (*current == '%') {
+            current += 1;
+            continue;
+        }
+
+        // Flags and a fixed width and precision are kept in the spec. Positional and `*` arguments aren't recorded.
+        const char *specStart = current;
+        current += strspn(current, "-+ #0'");
+        current += strspn(current, "0123456789");
+
+        if (*current == '.') {
+            current += 1;
+            current += strspn(current, "0123456789");
+        }
+
+        if (*current == '$' || *current == '*') {
+            return false;
+        }
+
+        LogArgument argument = LogArgumentInt;
+
+        if (current[0] == 'h') {
+            current += (current[1] == 'h') ? 2 : 1;
+        } else if (current[0] == 'l' && current[1] == 'l') {
+            argument = LogArgumentLongLong;
+            current += 2;
+        } else if (current[0] == 'l') {
+            argument = LogArgumentLong;
+            current += 1;
+        } else if (current[0] == 'z') {
+            argument = LogArgumentSize;
+            current += 1;
+        } else if (current[0] == 't') {
+            argument = LogArgumentPtrDiff;
+            current += 1;
+        } else if (current[0] == 'j') {
+            argument = LogArgumentIntMax;
+            current += 1;
+        }
+
+        // NOTE: The whole spec, from its `%` through its conversion, is copied with a terminator when it is rendered
+        if (current - specStart + 3 > FORMAT_SPEC_SIZE) {
+            return false;
+        }
+
+        bool isLong = (argument == LogArgumentLong);
+        bool hasLength = (current != specStart && strchr("hlztj", current[-1]) != NULL);
+
+        switch (*current) {
+            case 'd':
+            case 'i':
+                break;
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+                argument |= LogArgumentUnsigned;
+                break;
+            case 'c':
+                if (isLong) {
+                    return false;
+                }
+
+                break;
+            case 'e':
+            case 'E':
+            case 'f':
+            case 'F':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                argument = LogArgumentDouble;
+                break;
+            case 'p':
+                argument = LogArgumentPointer;
+                break;
+            case 's':
+                if (hasLength) {
+                    return false;
+                }
+
+                argument = LogArgumentString;
+                break;
+            default:
+                return false;
+        }
+
+        if (result->totalArguments == FORMAT_MAX_ARGUMENTS) {
+            return false;
+        }
+
+        result->arguments[result->totalArguments] = (uint8_t)argument;
+        result->totalArguments += 1;
+
+        current += 1;
+    }
+
+    return true;
+}
+
+static const LogFormat * LogRegisterFormat(LogSite *site, const char *format) {
+    LogFormat *logFormat = (LogFormat *)calloc(1, sizeof(LogFormat));
+    logFormat->isDeferred = LogParseFormat(format, logFormat);
+    logFormat->identifier = (uint32_t)atomic_fetch_add(&NextFormatIdentifier, 1);
+
+    // Another thread may have registered the site first. Its format is kept, so a site never changes identifier.
+    void *existing = NULL;
+
+    if (!atomic_compare_exchange_strong((_Atomic(void *) *)&site->format, &existing, logFormat)) {
+        free(logFormat);
+        return (const LogFormat *)existing;
+    }
+
+    return logFormat;
+}
+
+static size_t LogEncodeArguments(const LogFormat *format, va_list args, uint8_t *buffer, size_t bufferSize) {
+    size_t offset = 0;
+
+    for (uint8_t idx = 0; idx < format->totalArguments; idx++) {
+        uint8_t argument = format->arguments[idx];
+        bool isUnsigned = (argument & LogArgumentUnsigned) != 0;
+
+        // Numbers are written with a fixed size, so a log decodes the same on any machine
+        int64_t value = 0;
+        double doubleValue = 0.0;
+
+        switch ((LogArgument)(argument & ~LogArgumentUnsigned)) {
+            case LogArgumentInt: {
+                int32_t intValue = (int32_t)va_arg(args, int);
+
+                if (offset + sizeof(intValue) <= bufferSize) {
+                    memcpy(buffer + offset, &intValue, sizeof(intValue));
+                }
+
+                offset += sizeof(intValue);
+                continue;
+            }
+            case LogArgumentLong:
+                value = isUnsigned ? (int64_t)va_arg(args, unsigned long) : (int64_t)va_arg(args, long);
+                break;
+            case LogArgumentLongLong:
+                value = (int64_t)va_arg(args, long long);
+                break;
+            case LogArgumentSize:
+                value = isUnsigned ? (int64_t)va_arg(args, size_t) : (int64_t)(ptrdiff_t)va_arg(args, size_t);
+                break;
+            case LogArgumentPtrDiff:
+                value = (int64_t)va_arg(args, ptrdiff_t);
+                break;
+            case LogArgumentIntMax:
+                value = (int64_t)va_arg(args, intmax_t);
+                break;
+            case LogArgumentPointer:
+                value = (int64_t)(uintptr_t)va_arg(args, void *);
+                break;
+            case LogArgumentDouble:
+                doubleValue = va_arg(args, double);
+                memcpy(&value, &doubleValue, sizeof(value));
+                break;
+            case LogArgumentString: {
+                const char *stringValue = va_arg(args, const char *);
+                uint16_t length = STRING_NULL;
+
+                if (offset + sizeof(length) > bufferSize) {
+                    return bufferSize;
+                }
+
+                // Long strings are cut to fit the record, and are still terminated
+                if (stringValue != NULL) {
+                    size_t available = bufferSize - offset - sizeof(length);
+                    size_t stringSize = strnlen(stringValue, MESSAGE_SIZE);
+
+                    if (available == 0) {
+                        return bufferSize;
+                    } else if (stringSize >= available) {
+                        stringSize = available - 1;
+                    }
+
+                    length = (uint16_t)stringSize;
+
+                    memcpy(buffer + offset + sizeof(length), stringValue, stringSize);
+                    buffer[offset + sizeof(length) + stringSize] = '\0';
+                }
+
+                memcpy(buffer + offset, &length, sizeof(length));
+                offset += sizeof(length) + ((length == STRING_NULL) ? 0 : (size_t)length + 1);
+                continue;
+            }
+            case LogArgumentUnsigned:
+                break;
+        }
+
+        if (offset + sizeof(value) <= bufferSize) {
+            memcpy(buffer + offset, &value, sizeof(value));
+        }
+
+        offset += sizeof(value);
+    }
+
+    return (offset > bufferSize) ? bufferSize : offset;
+}
+
+static bool LogRenderMessage(const LogFormat *format, const uint8_t *data, size_t dataSize, char *buffer, size_t bufferSize) {
+    const char *current = format->format;
+    size_t used = 0;
+    size_t offset = 0;
+    uint8_t argumentIdx = 0;
+
+    buffer[0] = '\0';
+
+    while (*current != '\0' && used + 1 < bufferSize) {
+        const char *next = strchr(current, '%');
+        size_t literalSize = (next == NULL) ? strlen(current) : (size_t)(next - current);
+
+        if (literalSize > 0) {
+            if (literalSize > bufferSize - used - 1) {
+                literalSize = bufferSize - used - 1;
+            }
+
+            memcpy(buffer + used, current, literalSize);
+            used += literalSize;
+            buffer[used] = '\0';
+        }
+
+        if (next == NULL) {
+            break;
+        }
+
+        if (next[1] == '%') {
+            current = next + 2;
+
+            if (used + 1 < bufferSize) {
+                buffer[used++] = '%';
+                buffer[used] = '\0';
+            }
+
+            continue;
+        }
+
+        // The spec runs to its conversion, which was checked when the format was parsed
+        size_t specSize = strcspn(next + 1, "diouxXceEfFgGaApsn") + 2;
+
+        if (specSize >= FORMAT_SPEC_SIZE) {
+            return false;
+        }
+
+        char spec[FORMAT_SPEC_SIZE];
+        memcpy(spec, next, specSize);
+        spec[specSize] = '\0';
+
+        current = next + specSize;
+
+        if (argumentIdx == format->totalArguments) {
+            break;
+        }
+
+        uint8_t argument = format->arguments[argumentIdx];
+        argumentIdx += 1;
+
+        char *output = buffer + used;
+        size_t available = bufferSize - used;
+        int outputSize = 0;
+
+        if ((argument & ~LogArgumentUnsigned) == LogArgumentInt) {
+            int32_t intValue = 0;
+
+            if (offset + sizeof(intValue) > dataSize) {
+                break;
+            }
+
+            memcpy(&intValue, data + offset, sizeof(intValue));
+            offset += sizeof(intValue);
+
+            outputSize = snprintf(output, available, spec, (int)intValue);
+        } else if (argument == LogArgumentString) {
+            uint16_t length = 0;
+
+            if (offset + sizeof(length) > dataSize) {
+                break;
+            }
+
+            memcpy(&length, data + offset, sizeof(length));
+            offset += sizeof(length);
+
+            const char *stringValue = NULL;
+
+            if (length != STRING_NULL) {
+                if (offset + length + 1 > dataSize) {
+                    break;
+                }
+
+                // NOTE: A string without its terminator comes from a damaged log, and would be read past its record
+                if (data[offset + length] != '\0') {
+                    return false;
+                }
+
+                stringValue = (const char *)data + offset;
+                offset += (size_t)length + 1;
+            }
+
+            outputSize = snprintf(output, available, spec, (stringValue == NULL) ? "(null)" : stringValue);
+        } else {
+            int64_t value = 0;
+
+            if (offset + sizeof(value) > dataSize) {
+                break;
+            }
+
+            memcpy(&value, data + offset, sizeof(value));
+            offset += sizeof(value);
+
+            switch ((LogArgument)(argument & ~LogArgumentUnsigned)) {
+                case LogArgumentLong:
+                    outputSize = snprintf(output, available, spec, (long)value);
+                    break;
+                case LogArgumentLongLong:
+                    outputSize = snprintf(output, available, spec, (long long)value);
+                    break;
+                case LogArgumentSize:
+                    outputSize = snprintf(output, available, spec, (size_t)value);
+                    break;
+                case LogArgumentPtrDiff:
+                    outputSize = snprintf(output, available, spec, (ptrdiff_t)value);
+                    break;
+                case LogArgumentIntMax:
+                    outputSize = snprintf(output, available, spec, (intmax_t)value);
+                    break;
+                case LogArgumentPointer:
+                    outputSize = snprintf(output, available, spec, (void *)(uintptr_t)value);
+                    break;
+                case LogArgumentDouble: {
+                    double doubleValue = 0.0;
+                    memcpy(&doubleValue, &value, sizeof(doubleValue));
+                    outputSize = snprintf(output, available, spec, doubleValue);
+                    break;
+                }
+                case LogArgumentInt:
+                case LogArgumentString:
+                case LogArgumentUnsigned:
+                    break;
+            }
+        }
+
+        if (outputSize < 0) {
+            break;
+        }
+
+        used += ((size_t)outputSize < available) ? (size_t)outputSize : available - 1;
+    }
+
+    return true;
+}
+
+
+// MARK: - Rings
+
+static LogRing * LogClaimRing(void) {
+    // Take over the ring of a thread that has exited, if there is one
+    for (LogRing *ring = atomic_load(&Rings); ring != NULL; ring = ring->next) {
+        bool isOwned = false;
+
+        if (atomic_compare_exchange_strong(&ring->isOwned, &isOwned, true)) {
+            return ring;
+        }
+    }
+
+    LogRing *ring = (LogRing *)calloc(1, sizeof(LogRing));
+
+    if (ring == NULL) {
+        return NULL;
+    }
+
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->totalDropped, 0);
+    atomic_init(&ring->totalWaits, 0);
+    atomic_init(&ring->isOwned, true);
+
+    // Rings are only ever pushed on the front, so the writer can walk the list without a lock
+    LogRing *head = atomic_load(&Rings);
+
+    do {
+        ring->next = head;
+    } while (!atomic_compare_exchange_weak(&Rings, &head, ring));
+
+    return ring;
+}
+
+static void LogCreateRingKey(void) {
+    pthread_key_create(&RingKey, LogReleaseRing);
+}
+
+static bool LogEnqueue(const LogRecord *record) {
+    LogRing *ring = ThreadRing;
+
+    if (ring == NULL) {
+        ring = LogClaimRing();
+
+        if (ring == NULL) {
+            return false;
+        }
+
+        ThreadRing = ring;
+        pthread_setspecific(RingKey, ring);
+    }
+
+    size_t recordSize = record->size;
+
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t offset = head & (RING_SIZE - 1);
+    size_t padding = (RING_SIZE - offset < recordSize) ? RING_SIZE - offset : 0;
+
+    // Wait or drop while the record and any padding before it do not fit
+    while (head + padding + recordSize - atomic_load_explicit(&ring->tail, memory_order_acquire) > RING_SIZE) {
+        // Once the writer is stopping, nothing makes room, so the message is written directly like every later one
+        if (!atomic_load_explicit(&AsyncOutputEnabled, memory_order_relaxed)) {
+            return false;
+        }
+
+        if (atomic_load_explicit(&OverflowPolicy, memory_order_relaxed) == LogOverflowPolicyDrop) {
+            atomic_fetch_add_explicit(&ring->totalDropped, 1, memory_order_relaxed);
+            return true;
+        }
+
+        atomic_fetch_add_explicit(&ring->totalWaits, 1, memory_order_relaxed);
+        pthread_cond_signal(&WriterCondition);
+
+        struct timespec interval = { 0, WAIT_INTERVAL_NS };
+        nanosleep(&interval, NULL);
+    }
+
+    if (padding > 0) {
+        LogRecord *wrap = (LogRecord *)(ring->buffer + offset);
+        wrap->size = (uint32_t)padding;
+        wrap->level = RECORD_LEVEL_WRAP;
+
+        head += padding;
+        offset = 0;
+    }
+
+    memcpy(ring->buffer + offset, record, offsetof(LogRecord, data) + record->tagSize + record->dataSize);
+
+    atomic_store_explicit(&ring->head, head + recordSize, memory_order_release);
+
+    return true;
+}
+
+static void LogReleaseRing(void *ring) {
+    if (ring != NULL) {
+        atomic_store(&((LogRing *)ring)->isOwned, false);
+    }
+}
+
+
+// MARK: - Recorder
+
+bool LogDumpRecorder(const char *path) {
+    // The formats are marked with the dump that defined them, so only one dump runs at a time
+    if (atomic_flag_test_and_set(&IsDumping)) {
+        return false;
+    }
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (fd == -1) {
+        atomic_flag_clear(&IsDumping);
+        return false;
+    }
+
+    LogDump dump;
+    dump.fd = fd;
+    dump.isFailed = false;
+    dump.used = 0;
+
+    DumpGeneration += 1;
+
+    uint8_t entry[BINARY_MESSAGE_SIZE];
+    LogDumpAppend(&dump, entry, LogEncodeBinaryHeader(entry));
+
+    // Each thread is read up to where it had logged when the dump started
+    LogRecorder *first = atomic_load(&Recorders);
+
+    for (LogRecorder *recorder = first; recorder != NULL; recorder = recorder->next) {
+        recorder->dumpEnd = atomic_load_explicit(&recorder->head, memory_order_acquire);
+        recorder->dumpPosition = atomic_load_explicit(&recorder->tail, memory_order_acquire);
+    }
+
+    LogRecordBuffer buffer;
+    LogRecord *record = &buffer.record;
+
+    while (!dump.isFailed) {
+        // The threads' records are merged, so the dump reads oldest first
+        LogRecorder *oldest = NULL;
+        struct timeval oldestTime = { 0, 0 };
+
+        for (LogRecorder *recorder = first; recorder != NULL; recorder = recorder->next) {
+            struct timeval time;
+
+            if (LogRecorderPeek(recorder, &time) && (oldest == NULL || timercmp(&time, &oldestTime, <))) {
+                oldest = recorder;
+                oldestTime = time;
+            }
+        }
+
+        if (oldest == NULL) {
+            break;
+        }
+
+        size_t offset = oldest->dumpPosition & (LOG_RECORDER_SIZE - 1);
+        size_t recordSize = ((const LogRecord *)(oldest->buffer + offset))->size;
+
+        if (recordSize > RECORD_SIZE || recordSize > LOG_RECORDER_SIZE - offset) {
+            recordSize = (RECORD_SIZE < LOG_RECORDER_SIZE - offset) ? RECORD_SIZE : LOG_RECORDER_SIZE - offset;
+        }
+
+        memcpy(&buffer, oldest->buffer + offset, recordSize);
+
+        // NOTE: A record overwritten while it was copied is skipped, as its thread moved the tail past it first
+        atomic_thread_fence(memory_order_acquire);
+
+        if (atomic_load_explicit(&oldest->tail, memory_order_relaxed) > oldest->dumpPosition) {
+            continue;
+        }
+
+        oldest->dumpPosition += record->size;
+
+        if (record->tagSize == 0 || record->tagSize > UINT8_MAX + 1 || offsetof(LogRecord, data) + record->tagSize + record->dataSize > record->size) {
+            continue;
+        }
+
+        LogFormat *format = (LogFormat *)record->format;
+
+        if (format != NULL && format->dumpGeneration != DumpGeneration) {
+            LogDumpAppend(&dump, entry, LogEncodeBinaryFormat(format, entry));
+            format->dumpGeneration = DumpGeneration;
+        }
+
+        LogDumpAppend(&dump, entry, LogEncodeBinaryMessage(record, entry));
+    }
+
+    LogDumpFlush(&dump);
+
+    bool isWritten = !dump.isFailed;
+
+    if (close(fd) == -1) {
+        isWritten = false;
+    }
+
+    atomic_flag_clear(&IsDumping);
+
+    return isWritten;
+}
+
+static LogRecorder * LogClaimRecorder(void) {
+    // Take over the recorder of a thread that has exited, if there is one
+    for (LogRecorder *recorder = atomic_load(&Recorders); recorder != NULL; recorder = recorder->next) {
+        bool isOwned = false;
+
+        if (atomic_compare_exchange_strong(&recorder->isOwned, &isOwned, true)) {
+            return recorder;
+        }
+    }
+
+    LogRecorder *recorder = (LogRecorder *)calloc(1, sizeof(LogRecorder));
+
+    if (recorder == NULL) {
+        return NULL;
+    }
+
+    atomic_init(&recorder->head, 0);
+    atomic_init(&recorder->tail, 0);
+    atomic_init(&recorder->isOwned, true);
+
+    // Recorders are only ever pushed on the front, so a dump can walk the list without a lock
+    LogRecorder *head = atomic_load(&Recorders);
+
+    do {
+        recorder->next = head;
+    } while (!atomic_compare_exchange_weak(&Recorders, &head, recorder));
+
+    return recorder;
+}
+
+static void LogCreateRecorderKey(void) {
+    pthread_key_create(&RecorderKey, LogReleaseRecorder);
+}
+
+static void LogReleaseRecorder(void *recorder) {
+    if (recorder != NULL) {
+        atomic_store(&((LogRecorder *)recorder)->isOwned, false);
+    }
+}
+
+static void LogRecorderWrite(const LogRecord *record) {
+    LogRecorder *recorder = ThreadRecorder;
+
+    if (recorder == NULL) {
+        recorder = LogClaimRecorder();
+
+        if (recorder == NULL) {
+            return;
+        }
+
+        ThreadRecorder = recorder;
+
+        pthread_once(&RecorderKeyOnce, LogCreateRecorderKey);
+        pthread_setspecific(RecorderKey, recorder);
+    }
+
+    size_t recordSize = record->size;
+
+    size_t head = atomic_load_explicit(&recorder->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&recorder->tail, memory_order_relaxed);
+    size_t offset = head & (LOG_RECORDER_SIZE - 1);
+    size_t padding = (LOG_RECORDER_SIZE - offset < recordSize) ? LOG_RECORDER_SIZE - offset : 0;
+
+    // Forget the oldest records until the record and any padding before it fit
+    if (head + padding + recordSize - tail > LOG_RECORDER_SIZE) {
+        while (head + padding + recordSize - tail > LOG_RECORDER_SIZE) {
+            tail += ((const LogRecord *)(recorder->buffer + (tail & (LOG_RECORDER_SIZE - 1))))->size;
+        }
+
+        // NOTE: The tail is published before the records behind it are overwritten, pairing with the fence in a dump
+        atomic_store_explicit(&recorder->tail, tail, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+    }
+
+    if (padding > 0) {
+        LogRecord *wrap = (LogRecord *)(recorder->buffer + offset);
+        wrap->size = (uint32_t)padding;
+        wrap->level = RECORD_LEVEL_WRAP;
+
+        head += padding;
+        offset = 0;
+    }
+
+    memcpy(recorder->buffer + offset, record, offsetof(LogRecord, data) + record->tagSize + record->dataSize);
+
+    atomic_store_explicit(&recorder->head, head + recordSize, memory_order_release);
+}
+
+static bool LogRecorderPeek(LogRecorder *recorder, struct timeval *time) {
+    while (recorder->dumpPosition < recorder->dumpEnd) {
+        // Records the thread overwrote since the dump started are skipped
+        size_t tail = atomic_load_explicit(&recorder->tail, memory_order_acquire);
+
+        if (recorder->dumpPosition < tail) {
+            recorder->dumpPosition = tail;
+            continue;
+        }
+
+        size_t offset = recorder->dumpPosition & (LOG_RECORDER_SIZE - 1);
+        const LogRecord *record = (const LogRecord *)(recorder->buffer + offset);
+
+        uint32_t size = record->size;
+        uint16_t level = record->level;
+
+        atomic_thread_fence(memory_order_acquire);
+
+        if (atomic_load_explicit(&recorder->tail, memory_order_relaxed) > recorder->dumpPosition) {
+            continue;
+        }
+
+        // NOTE: After a crash, the memory may be damaged, so a thread is abandoned at a record that can't be right
+        if (size == 0 || size % RING_ALIGNMENT != 0 || size > LOG_RECORDER_SIZE - offset || (level != RECORD_LEVEL_WRAP && size > RECORD_SIZE)) {
+            recorder->dumpPosition = recorder->dumpEnd;
+            break;
+        }
+
+        if (level == RECORD_LEVEL_WRAP) {
+            recorder->dumpPosition += size;
+            continue;
+        }
+
+        *time = record->time;
+
+        atomic_thread_fence(memory_order_acquire);
+
+        if (atomic_load_explicit(&recorder->tail, memory_order_relaxed) > recorder->dumpPosition) {
+            continue;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+static void LogDumpAppend(LogDump *dump, const void *data, size_t dataSize) {
+    if (dump->used + dataSize > DUMP_BUFFER_SIZE) {
+        LogDumpFlush(dump);
+    }
+
+    memcpy(dump->buffer + dump->used, data, dataSize);
+    dump->used += dataSize;
+}
+
+static void LogDumpFlush(LogDump *dump) {
+    const uint8_t *current = dump->buffer;
+    size_t remaining = dump->used;
+
+    dump->used = 0;
+
+    // NOTE: Only `write` is used, as it is async-signal-safe
+    while (remaining > 0 && !dump->isFailed) {
+        ssize_t written = write(dump->fd, current, remaining);
+
+        if (written == -1 && errno == EINTR) {
+            continue;
+        } else if (written <= 0) {
+            dump->isFailed = true;
+            break;
+        }
+
+        current += written;
+        remaining -= (size_t)written;
+    }
+}
+
+
+// MARK: - Sinks
+
+static const LogSinks * LogAcquireSinks(void) {
+    // A callback that logs is already reading the sinks
+    if (ThreadReadDepth++ > 0) {
+        return atomic_load(&Sinks);
+    }
+
+    LogReader *reader = ThreadReader;
+
+    if (reader == NULL) {
+        reader = LogClaimReader();
+        ThreadReader = reader;
+
+        pthread_once(&ReaderKeyOnce, LogCreateReaderKey);
+        pthread_setspecific(ReaderKey, reader);
+    }
+
+    // NOTE: The generation is stored before the sinks are loaded, so a publisher that changes them after this waits
+    atomic_store(&reader->generation, atomic_load(&SinksGeneration));
+
+    return atomic_load(&Sinks);
+}
+
+static void LogReleaseSinks(void) {
+    ThreadReadDepth -= 1;
+
+    if (ThreadReadDepth == 0) {
+        atomic_store_explicit(&ThreadReader->generation, 0, memory_order_release);
+
+        // Sinks a callback replaced may have been waiting for this message to finish
+        if (atomic_load_explicit(&RetiredSinks, memory_order_relaxed) != NULL && pthread_mutex_trylock(&SinksMutex) == 0) {
+            LogReleaseRetiredSinks();
+            pthread_mutex_unlock(&SinksMutex);
+        }
+    }
+}
+
+static LogSinks * LogCopySinks(void) {
+    LogSinks *sinks = (LogSinks *)malloc(sizeof(LogSinks));
+    memcpy(sinks, atomic_load(&Sinks), sizeof(LogSinks));
+
+    return sinks;
+}
+
+static void LogPublishSinks(LogSinks *sinks) {
+    LogSinks *previous = atomic_exchange(&Sinks, sinks);
+    uint64_t generation = atomic_fetch_add(&SinksGeneration, 1) + 1;
+
+    LogRetiredSinks *retired = (LogRetiredSinks *)calloc(1, sizeof(LogRetiredSinks));
+    retired->sinks = (previous != &DefaultSinks) ? previous : NULL;
+    retired->file = (previous->file != sinks->file) ? previous->file : NULL;
+#if TARGET_PLATFORM_LINUX
+    retired->journal = (previous->journal != sinks->journal) ? previous->journal : NULL;
+    retired->isSyslogClosed = previous->isSyslogOpen && !sinks->isSyslogOpen;
+#endif
+    retired->generation = generation;
+
+    // A callback that changes the outputs returns to a message still using the previous ones, so they are kept until it finishes
+    if (ThreadReadDepth > 0) {
+        retired->next = atomic_load(&RetiredSinks);
+        atomic_store(&RetiredSinks, retired);
+        return;
+    }
+
+    // Wait for every thread that could have loaded the previous sinks to finish with them
+    for (LogReader *reader = atomic_load(&Readers); reader != NULL; reader = reader->next) {
+        while (true) {
+            uint64_t readerGeneration = atomic_load(&reader->generation);
+
+            if (readerGeneration == 0 || readerGeneration >= generation) {
+                break;
+            }
+
+            struct timespec wait = { 0, WAIT_INTERVAL_NS };
+            nanosleep(&wait, NULL);
+        }
+    }
+
+    LogDestroyRetiredSinks(retired);
+
+    // NOTE: Every older generation has drained as well
+    LogReleaseRetiredSinks();
+}
+
+static void LogDestroyRetiredSinks(LogRetiredSinks *retired) {
+    if (retired->file != NULL) {
+        LogFileDestroy(retired->file);
+    }
+
+#if TARGET_PLATFORM_LINUX
+    if (retired->journal != NULL) {
+        LogJournalDestroy(retired->journal);
+    }
+
+    // A later change may have opened the system log again
+    if (retired->isSyslogClosed && !atomic_load(&Sinks)->isSyslogOpen) {
+        closelog();
+    }
+#endif
+
+    free(retired->sinks);
+    free(retired);
+}
+
+static bool LogIsGenerationRead(uint64_t generation) {
+    for (LogReader *reader = atomic_load(&Readers); reader != NULL; reader = reader->next) {
+        uint64_t readerGeneration = atomic_load(&reader->generation);
+
+        if (readerGeneration != 0 && readerGeneration < generation) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void LogReleaseRetiredSinks(void) {
+    // NOTE: Called with `SinksMutex` held
+    LogRetiredSinks *kept = NULL;
+    LogRetiredSinks *retired = atomic_exchange(&RetiredSinks, NULL);
+
+    while (retired != NULL) {
+        LogRetiredSinks *next = retired->next;
+
+        if (LogIsGenerationRead(retired->generation)) {
+            retired->next = kept;
+            kept = retired;
+        } else {
+            LogDestroyRetiredSinks(retired);
+        }
+
+        retired = next;
+    }
+
+    atomic_store(&RetiredSinks, kept);
+}
+
+static LogReader * LogClaimReader(void) {
+    // Take over the reader of a thread that has exited, if there is one
+    for (LogReader *reader = atomic_load(&Readers); reader != NULL; reader = reader->next) {
+        bool isOwned = false;
+
+        if (atomic_compare_exchange_strong(&reader->isOwned, &isOwned, true)) {
+            return reader;
+        }
+    }
+
+    LogReader *reader = (LogReader *)calloc(1, sizeof(LogReader));
+
+    atomic_init(&reader->generation, 0);
+    atomic_init(&reader->isOwned, true);
+
+    LogReader *head = atomic_load(&Readers);
+
+    do {
+        reader->next = head;
+    } while (!atomic_compare_exchange_weak(&Readers, &head, reader));
+
+    return reader;
+}
+
+static void LogCreateReaderKey(void) {
+    pthread_key_create(&ReaderKey, LogReleaseReader);
+}
+
+static void LogReleaseReader(void *reader) {
+    if (reader != NULL) {
+        atomic_store(&((LogReader *)reader)->isOwned, false);
+    }
+}
+
+
+// MARK: - Writer
+
+static void LogDrainRings(char *batch, size_t *batchSize) {
+    // The outputs are read once for the whole batch, so they are not closed until it is written
+    const LogSinks *sinks = LogAcquireSinks();
+
+    pthread_mutex_lock(&BinaryMutex);
+
+    for (LogRing *ring = atomic_load(&Rings); ring != NULL; ring = ring->next) {
+        size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+        uint64_t totalWritten = 0;
+
+        while (tail != head) {
+            const LogRecord *record = (const LogRecord *)(ring->buffer + (tail & (RING_SIZE - 1)));
+
+            if (record->level != RECORD_LEVEL_WRAP) {
+                LogProcessRecord(sinks, record, batch, batchSize);
+                totalWritten += 1;
+            }
+
+            tail += record->size;
+        }
+
+        atomic_store_explicit(&ring->tail, tail, memory_order_release);
+        atomic_fetch_add(&TotalWritten, totalWritten);
+
+        // Report drops after what was buffered before them
+        uint64_t totalDropped = atomic_load_explicit(&ring->totalDropped, memory_order_relaxed);
+
+        if (totalDropped != ring->reportedDropped) {
+            LogRecordBuffer buffer;
+            size_t offset = LogStartRecord(&buffer, LogLevelWarning, "Log");
+
+            LogRecord *record = &buffer.record;
+            int messageSize = snprintf(record->data + offset, MESSAGE_SIZE, "Dropped %" PRIu64 " messages from a full log buffer", totalDropped - ring->reportedDropped);
+
+            record->format = NULL;
+            record->dataSize = (uint32_t)messageSize + 1;
+
+            LogProcessRecord(sinks, record, batch, batchSize);
+
+            ring->reportedDropped = totalDropped;
+        }
+    }
+
+    if (BinaryFile != NULL) {
+        fflush(BinaryFile);
+    }
+
+    pthread_mutex_unlock(&BinaryMutex);
+
+    LogWriteBatch(batch, batchSize);
+
+#if TARGET_PLATFORM_LINUX
+    if (sinks->journal != NULL) {
+        LogJournalFlush(sinks->journal);
+    }
+#endif
+
+    LogReleaseSinks();
+}
+
+static void LogWriteBatch(const char *batch, size_t *batchSize) {
+    if (*batchSize == 0) {
+        return;
+    }
+
+    fwrite(batch, 1, *batchSize, stdout);
+    fflush(stdout);
+
+    *batchSize = 0;
+}
+
+static void LogSyncFile(void) {
+    const LogSinks *sinks = LogAcquireSinks();
+
+    if (sinks->file != NULL) {
+        LogFileSync(sinks->file);
+    }
+
+    LogReleaseSinks();
+}
+
+static void * LogWriterMain(void *context) {
+    char *batch = (char *)malloc(BATCH_SIZE);
+    size_t batchSize = 0;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    uint64_t syncTime = ((uint64_t)now.tv_sec * 1000ULL) + ((uint64_t)now.tv_nsec / 1000000ULL) + FILE_SYNC_INTERVAL_MS;
+
+    pthread_mutex_lock(&WriterMutex);
+
+    while (true) {
+        bool isRunning = IsWriterRunning;
+
+        if (isRunning && FlushesCompleted == FlushesRequested) {
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+
+            deadline.tv_nsec += WRITER_INTERVAL_MS * 1000000L;
+
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec += 1;
+                deadline.tv_nsec -= 1000000000L;
+            }
+
+            pthread_cond_timedwait(&WriterCondition, &WriterMutex, &deadline);
+            isRunning = IsWriterRunning;
+        }
+
+        uint64_t flush = FlushesRequested;
+
+        pthread_mutex_unlock(&WriterMutex);
+
+        // Everything logged before a flush was requested is in the rings by now
+        LogDrainRings(batch, &batchSize);
+
+        // Syncing waits for the disk, so it is done here rather than on the threads that log
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        uint64_t milliseconds = ((uint64_t)now.tv_sec * 1000ULL) + ((uint64_t)now.tv_nsec / 1000000ULL);
+
+        if (milliseconds >= syncTime || !isRunning) {
+            LogSyncFile();
+            syncTime = milliseconds + FILE_SYNC_INTERVAL_MS;
+        }
+
+        pthread_mutex_lock(&WriterMutex);
+
+        FlushesCompleted = flush;
+        pthread_cond_broadcast(&FlushCondition);
+
+        if (!isRunning) {
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&WriterMutex);
+
+    free(batch);
+
+    return NULL;
+}
+
+
+// MARK: - Binary Output
+
+static size_t LogEncode(uint8_t *buffer, size_t used, const void *value, size_t valueSize) {
+    memcpy(buffer + used, value, valueSize);
+
+    return used + valueSize;
+}
+
+static size_t LogEncodeBinaryHeader(uint8_t *buffer) {
+    uint8_t entry = LogEntryHeader;
+    uint16_t version = BINARY_VERSION;
+
+    size_t used = LogEncode(buffer, 0, &entry, sizeof(entry));
+    used = LogEncode(buffer, used, BINARY_MAGIC + 1, strlen(BINARY_MAGIC) - 1);
+    used = LogEncode(buffer, used, &version, sizeof(version));
+
+    return used;
+}
+
+static size_t LogEncodeBinaryFormat(const LogFormat *format, uint8_t *buffer) {
+    uint8_t entry = LogEntryFormat;
+    uint32_t identifier = format->identifier;
+
+    // NOTE: The decoder reads a format in to a record sized buffer, so a format entry is smaller than a message entry
+    uint16_t formatSize = (uint16_t)strnlen(format->format, RECORD_SIZE - 1);
+
+    size_t used = LogEncode(buffer, 0, &entry, sizeof(entry));
+    used = LogEncode(buffer, used, &identifier, sizeof(identifier));
+    used = LogEncode(buffer, used, &formatSize, sizeof(formatSize));
+    used = LogEncode(buffer, used, format->format, formatSize);
+
+    return used;
+}
+
+static size_t LogEncodeBinaryMessage(const LogRecord *record, uint8_t *buffer) {
+    uint8_t entry = LogEntryMessage;
+    uint32_t identifier = (record->format != NULL) ? record->format->identifier : 0;
+    uint8_t level = (uint8_t)record->level;
+    int64_t seconds = (int64_t)record->time.tv_sec;
+    uint32_t microseconds = (uint32_t)record->time.tv_usec;
+    uint8_t tagSize = (uint8_t)(record->tagSize - 1);
+    uint16_t dataSize = (uint16_t)record->dataSize;
+
+    size_t used = LogEncode(buffer, 0, &entry, sizeof(entry));
+    used = LogEncode(buffer, used, &identifier, sizeof(identifier));
+    used = LogEncode(buffer, used, &level, sizeof(level));
+    used = LogEncode(buffer, used, &seconds, sizeof(seconds));
+    used = LogEncode(buffer, used, &microseconds, sizeof(microseconds));
+    used = LogEncode(buffer, used, &tagSize, sizeof(tagSize));
+    used = LogEncode(buffer, used, record->data, tagSize);
+    used = LogEncode(buffer, used, &dataSize, sizeof(dataSize));
+    used = LogEncode(buffer, used, record->data + record->tagSize, dataSize);
+
+    return used;
+}
+
+static void LogWriteBinaryHeader(FILE *file) {
+    uint8_t header[BINARY_HEADER_SIZE];
+
+    fwrite(header, 1, LogEncodeBinaryHeader(header), file);
+}
+
+static void LogWriteBinaryRecord(const LogRecord *record) {
+    if (BinaryFile == NULL) {
+        return;
+    }
+
+    uint8_t entry[BINARY_MESSAGE_SIZE];
+    LogFormat *format = (LogFormat *)record->format;
+
+    // Each format is defined once per file, before the first message that uses it
+    if (format != NULL && format->generation != BinaryGeneration) {
+        fwrite(entry, 1, LogEncodeBinaryFormat(format, entry), BinaryFile);
+        format->generation = BinaryGeneration;
+    }
+
+    fwrite(entry, 1, LogEncodeBinaryMessage(record, entry), BinaryFile);
+}
+
+bool LogDecode(FILE *input, FILE *output) {
+    ArenaRef arena = ArenaCreate(DECODE_ARENA_SIZE);
+
+    LogFormat **formats = NULL;
+    size_t totalFormats = 0;
+    size_t formatsCapacity = 0;
+
+    bool isValid = true;
+    bool hasHeader = false;
+
+    uint8_t data[RECORD_SIZE];
+    char messageBuffer[MESSAGE_SIZE];
+    char lineBuffer[LINE_SIZE];
+
+    while (isValid) {
+        uint8_t entry = 0;
+
+        if (fread(&entry, sizeof(entry), 1, input) != 1) {
+            break;
+        }
+
+        if (entry == LogEntryHeader) {
+            char magic[sizeof(BINARY_MAGIC) - 2];
+            uint16_t version = 0;
+
+            isValid = fread(magic, sizeof(magic), 1, input) == 1
+                && fread(&version, sizeof(version), 1, input) == 1
+                && memcmp(magic, BINARY_MAGIC + 1, sizeof(magic)) == 0
+                && version == BINARY_VERSION;
+
+            // Identifiers start over with each run
+            for (size_t idx = 0; idx < totalFormats; idx++) {
+                formats[idx] = NULL;
+            }
+
+            hasHeader = true;
+        } else if (!hasHeader) {
+            isValid = false;
+        } else if (entry == LogEntryFormat) {
+            uint32_t identifier = 0;
+            uint16_t formatSize = 0;
+
+            if (fread(&identifier, sizeof(identifier), 1, input) != 1 || fread(&formatSize, sizeof(formatSize), 1, input) != 1 || formatSize >= sizeof(data)) {
+                isValid = false;
+                break;
+            }
+
+            if (fread(data, 1, formatSize, input) != formatSize || identifier == 0 || identifier >= DECODE_MAX_FORMATS) {
+                isValid = false;
+                break;
+            }
+
+            while (totalFormats <= identifier) {
+                formats = (LogFormat **)ArenaAppend(arena, formats, sizeof(LogFormat *), totalFormats, &formatsCapacity);
+                formats[totalFormats] = NULL;
+                totalFormats += 1;
+            }
+
+            LogFormat *format = (LogFormat *)ArenaAllocate(arena, sizeof(LogFormat));
+            format->identifier = identifier;
+            format->isDeferred = LogParseFormat(ArenaIntern(arena, (const char *)data, formatSize), format);
+
+            formats[identifier] = format;
+        } else if (entry == LogEntryMessage) {
+            uint32_t identifier = 0;
+            uint8_t level = 0;
+            int64_t seconds = 0;
+            uint32_t microseconds = 0;
+            uint8_t tagSize = 0;
+            char tag[UINT8_MAX + 1];
+            uint16_t dataSize = 0;
+
+            isValid = fread(&identifier, sizeof(identifier), 1, input) == 1
+                && fread(&level, sizeof(level), 1, input) == 1
+                && fread(&seconds, sizeof(seconds), 1, input) == 1
+                && fread(&microseconds, sizeof(microseconds), 1, input) == 1
+                && fread(&tagSize, sizeof(tagSize), 1, input) == 1
+                && fread(tag, 1, tagSize, input) == tagSize
+                && fread(&dataSize, sizeof(dataSize), 1, input) == 1
+                && dataSize <= sizeof(data)
+                && fread(data, 1, dataSize, input) == dataSize;
+
+            if (!isValid) {
+                break;
+            }
+
+            tag[tagSize] = '\0';
+
+            const char *message = messageBuffer;
+
+            if (identifier == 0) {
+                // A message formatted when it was logged
+                size_t messageSize = (dataSize < sizeof(messageBuffer)) ? dataSize : sizeof(messageBuffer) - 1;
+                memcpy(messageBuffer, data, messageSize);
+                messageBuffer[messageSize] = '\0';
+            } else if (identifier < totalFormats && formats[identifier] != NULL && formats[identifier]->isDeferred) {
+                if (!LogRenderMessage(formats[identifier], data, dataSize, messageBuffer, sizeof(messageBuffer))) {
+                    isValid = false;
+                    break;
+                }
+            } else {
+                isValid = false;
+                break;
+            }
+
+            struct timeval time = { (time_t)seconds, (suseconds_t)microseconds };
+            size_t lineSize = LogFormatLine(lineBuffer, sizeof(lineBuffer), (LogLevel)level, tag, message, &time);
+
+            fwrite(lineBuffer, 1, lineSize, output);
+        } else {
+            isValid = false;
+        }
+    }
+
+    ArenaDestroy(arena);
+
+    return isValid && hasHeader;
+}
+
 
 // MARK: - Utilities
 
@@ -13,12 +13,34 @@
 
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 
 BEGIN_DECLS
 
 
 // MARK: - Constants & Globals
 
+/// The lowest level the helper macros log, as a `LogLevel` value. Lower levels are compiled away.
+#ifndef WOODPECKERS_MIN_LOG_LEVEL
+#define WOODPECKERS_MIN_LOG_LEVEL 0
+#endif
+
+/// The messages a limited call site logs in a burst, before it is limited.
+#define LOG_LIMIT_BURST 5
+
+/// The milliseconds a limited call site waits to log another message once its burst is spent.
+#define LOG_LIMIT_INTERVAL 1000
+
+/// The number of segments file output rotates through, unless another is given.
+#define LOG_FILE_DEFAULT_SEGMENTS 4
+
+/// The size of each file output segment in bytes, unless another is given.
+#define LOG_FILE_DEFAULT_SEGMENT_SIZE (1024 * 1024)
+
+/// The bytes of its latest messages each thread's flight recorder keeps. It must be a power of two.
+#define LOG_RECORDER_SIZE (256 * 1024)
+
 /// The level severity of a log message.
 typedef enum _LogLevel {
     LogLevelVerbose, ///< A highly specific debug log message
@@ -28,6 +50,40 @@ typedef enum _LogLevel {
     LogLevelError,   ///< An error log message
 } LogLevel;
 
+/// What an asynchronous log does when the calling thread's buffer is full.
+typedef enum _LogOverflowPolicy {
+    LogOverflowPolicyDrop = 0, ///< The message is dropped and counted
+    LogOverflowPolicyWait,     ///< The caller waits for the writer to make room
+} LogOverflowPolicy;
+
+/// A structured field that messages from a thread carry, for outputs that keep them.
+typedef enum _LogField {
+    LogFieldShow = 0, ///< The show being run
+    LogFieldBird,     ///< The bird being moved
+    LogFieldOutput,   ///< The output being written
+    LogFieldCount,
+} LogField;
+
+/// Counters for asynchronous logging.
+typedef struct _LogStatistics {
+    uint64_t totalWritten; ///< Messages written by the background writer
+    uint64_t totalDropped; ///< Messages dropped because a buffer was full
+    uint64_t totalWaits;   ///< Times a caller waited for room in a full buffer
+} LogStatistics;
+
+/// A place a message is logged from. The helper macros give each call its own.
+typedef struct _LogSite {
+    void * NULLABLE format; ///< The parsed format, registered by the first message
+    void * NULLABLE tag;    ///< The tag's level, found by the first message
+} LogSite;
+
+/// The rate a call site logs at. The limited helper macros give each call its own.
+typedef struct _LogLimit {
+    uint64_t refillTime;      ///< When the site earns another message, in milliseconds of the monotonic clock, or 0 before its first message
+    uint32_t tokens;          ///< The messages the site may log before it earns another
+    uint32_t totalSuppressed; ///< The messages dropped since the site last logged
+} LogLimit;
+
 
 // MARK: - Callbacks
 
@@ -46,9 +102,25 @@ typedef void (* LogCallback)(LogLevel level, const char * NONNULL tag, const cha
  * Enable or disable callback logging.
  * \param enabled `true` to enable callback logging, otherwise `false`.
  * \param callback The callback function to be called for a log line.
+ * \note Outputs may be changed while other threads log. This returns once no message is still using the previous callback.
  */
 void LogEnableCallbackOutput(bool enabled, LogCallback NULLABLE callback);
 
+/**
+ * Capture the messages logged by the calling thread, instead of writing them to the outputs.
+ * \param callback The callback function to be called for each message, or `NULL` to write messages again.
+ * \return The previous callback, so that it can be restored.
+ * \note Messages are formatted on the calling thread and are not recorded. Whoever captures them decides where, and from which thread, they are logged.
+ */
+LogCallback NULLABLE LogSetThreadCapture(LogCallback NULLABLE callback);
+
+/**
+ * Enable or disable the coarse clock for timestamps.
+ * \param enabled `true` to read a cheaper clock that is only as precise as the scheduler tick, otherwise `false`.
+ * \note Does nothing where there is no coarse clock.
+ */
+void LogEnableCoarseClock(bool enabled);
+
 /**
  * Enable or disable console output.
  * \param enabled `true` to enable logging to the console, otherwise `false`.
@@ -58,16 +130,100 @@ void LogEnableConsoleOutput(bool enabled);
 /**
  * Enable or disable system output.
  * \param enabled `true` to enable logging to system log service, otherwise `false`.
+ * \note On Linux, messages are sent to journald's native socket with their level, tag and fields. If journald is not running, they are sent to syslog instead.
  */
 void LogEnableSystemOutput(bool enabled);
 
+/**
+ * Set the socket system output sends journald entries to.
+ * \param path The path to the socket, or `NULL` for journald's own.
+ * \note This takes effect the next time system output is enabled, and does nothing except on Linux.
+ */
+void LogSetJournalPath(const char * NULLABLE path);
+
+/**
+ * Enable or disable asynchronous output.
+ * \param enabled `true` to hand messages to a background writer, otherwise `false` to write them on the calling thread.
+ * \param policy What to do with a message when the calling thread's buffer is full.
+ * \return `true` if the mode was changed, otherwise `false` if the writer could not be started.
+ * \note Each thread copies its messages in to its own buffer without locking. The writer formats the timestamps and writes in batches, so callbacks and output run on the writer's thread.
+ * \note Disabling waits for every buffered message to be written.
+ */
+bool LogEnableAsyncOutput(bool enabled, LogOverflowPolicy policy);
+
+/**
+ * Enable or disable binary output.
+ * \param path The file to append binary messages to, or `NULL` to stop.
+ * \return `true` if the output was changed, otherwise `false` if the file could not be opened.
+ * \note Messages logged through the helper macros are written as their format's identifier and raw arguments. Each format is written once per file. With asynchronous output, the message text is only formatted if another output needs it.
+ */
+bool LogEnableBinaryOutput(const char * NULLABLE path);
+
+/**
+ * Enable or disable file output.
+ * \param path The base path of the segment files, which are named `PATH.0`, `PATH.1` and so on, or `NULL` to stop.
+ * \param totalSegments The number of segments to rotate through.
+ * \param segmentSize The size of each segment in bytes.
+ * \return `true` if the output was changed, otherwise `false` if the first segment could not be opened.
+ * \note Lines are formatted like the console output and copied in to preallocated, memory mapped segments. A full segment is closed and the oldest is reused, so the log never uses more than `totalSegments * segmentSize` bytes.
+ * \note With asynchronous output, the writer syncs the current segment to the disk every second. Otherwise the system writes it back on its own schedule.
+ */
+bool LogEnableFileOutput(const char * NULLABLE path, size_t totalSegments, size_t segmentSize);
+
+/**
+ * Enable or disable the flight recorder.
+ * \param enabled `true` to keep each thread's latest messages in memory, otherwise `false`.
+ * \param level The lowest level recorded, whatever level the outputs filter to.
+ * \note Each thread copies its messages in to its own ring of `LOG_RECORDER_SIZE` bytes, overwriting its oldest. Messages from the helper macros are recorded as their format and raw arguments, so recording a message the outputs filter out costs a copy rather than formatting it.
+ */
+void LogEnableRecorder(bool enabled, LogLevel level);
+
+/**
+ * Wait for every message logged before the call to be written.
+ * \note Does nothing unless asynchronous output is enabled.
+ */
+void LogFlush(void);
+
+/**
+ * Get the asynchronous logging counters.
+ * \param statistics The counters on return.
+ */
+void LogGetStatistics(LogStatistics * NONNULL statistics);
+
 /**
  * Initialize the logging subsystem.
- * \param level The log level to filter to.
+ * \param level The log level to filter to, for tags without a level of their own.
  */
 void LogSetUp(LogLevel level);
 
 
+// MARK: - Levels
+
+/**
+ * Check a list of tag levels without applying it.
+ * \param levels The levels, as described by `LogSetTagLevels`.
+ * \return `true` if every level is valid, otherwise `false`.
+ */
+bool LogCheckTagLevels(const char * NONNULL levels);
+
+/**
+ * Set the level a tag filters to.
+ * \param tag The section identifier to filter.
+ * \param level The lowest level logged for the tag.
+ * \return `true` if the level was set, otherwise `false` if there are too many tags.
+ */
+bool LogSetTagLevel(const char * NONNULL tag, LogLevel level);
+
+/**
+ * Set the levels of tags from a list, such as `EventLoop=warn,Controller=debug`.
+ * \param levels Comma separated `TAG=LEVEL` items. An item that is only a level sets the global level. The levels are `verbose`, `debug`, `info`, `warn` and `error`.
+ * \return `true` if the levels were set, otherwise `false` if any are invalid, in which case none are set.
+ * \note Tags that are not listed go back to the global level.
+ * \note Remote clients change the levels by sending `log <levels>` lines to the Stage.
+ */
+bool LogSetTagLevels(const char * NONNULL levels);
+
+
 // MARK: - Logging
 
 /**
@@ -88,20 +244,100 @@ void Log(LogLevel level, const char * NONNULL tag, const char * NONNULL format,
  */
 void LogVA(LogLevel level, const char * NONNULL tag, const char * NONNULL format, va_list args);
 
+/**
+ * Log a message from a call site.
+ * \param site The call site, which keeps the parsed format between messages.
+ * \param level The severity of the message.
+ * \param tag A section identifier of the message.
+ * \param format A format string for producing the message. It must outlive the site, as a literal does.
+ * \param ... Arguments to be formatted in the message.
+ * \note The level is checked by the helper macros first. It is only checked again for messages that are only let through for the recorder.
+ * \note With asynchronous or binary output, the arguments are recorded and the message is formatted later. Formats with positional or `*` arguments, `L` or wide conversions are formatted immediately.
+ */
+void LogAt(LogSite * NONNULL site, LogLevel level, const char * NONNULL tag, const char * NONNULL format, ...);
+
+/**
+ * Check if a call site logs at a level.
+ * \param site The call site, which keeps its tag's level after the first check.
+ * \param level The severity of the message.
+ * \param tag A section identifier of the message. It must be the same for every message from the site.
+ * \return `true` if the message should be logged or recorded, otherwise `false`.
+ */
+bool LogIsEnabled(LogSite * NONNULL site, LogLevel level, const char * NONNULL tag);
+
+/// A helper macro to log from a call site of its own. The arguments are only evaluated if the message is logged.
+#define LogAtSite(L, T, ...) \
+    do { \
+        if ((L) >= WOODPECKERS_MIN_LOG_LEVEL) { \
+            static LogSite logSite; \
+            if (LogIsEnabled(&logSite, (L), (T))) { \
+                LogAt(&logSite, (L), (T), __VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
+/**
+ * Check if a call site may log now, and log how many messages it dropped if it may.
+ * \param limit The call site's rate, which earns a message every `LOG_LIMIT_INTERVAL` milliseconds, up to `LOG_LIMIT_BURST`.
+ * \param level The severity of the message.
+ * \param tag A section identifier of the message.
+ * \return `true` if the message should be logged, otherwise `false` if it is counted and dropped.
+ * \note A limit is not locked, so threads that share a call site may let an extra message through.
+ */
+bool LogIsAllowed(LogLimit * NONNULL limit, LogLevel level, const char * NONNULL tag);
+
+/// A helper macro to log from a call site of its own, at a limited rate, for messages that can repeat quickly.
+#define LogLimitedAtSite(L, T, ...) \
+    do { \
+        if ((L) >= WOODPECKERS_MIN_LOG_LEVEL) { \
+            static LogSite logSite; \
+            static LogLimit logLimit; \
+            if (LogIsEnabled(&logSite, (L), (T)) && LogIsAllowed(&logLimit, (L), (T))) { \
+                LogAt(&logSite, (L), (T), __VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
 /// A helper macro to write a debug level log.
-#define LogD(T, ...) Log(LogLevelDebug, (T), __VA_ARGS__)
+#define LogD(T, ...) LogAtSite(LogLevelDebug, (T), __VA_ARGS__)
 
 /// A helper macro to write an error level log.
-#define LogE(T, ...) Log(LogLevelError, (T), __VA_ARGS__)
+#define LogE(T, ...) LogAtSite(LogLevelError, (T), __VA_ARGS__)
 
 /// A helper macro to write an info level log.
-#define LogI(T, ...) Log(LogLevelInfo, (T), __VA_ARGS__)
+#define LogI(T, ...) LogAtSite(LogLevelInfo, (T), __VA_ARGS__)
 
 /// A helper macro to write a verbose level log.
-#define LogV(T, ...) Log(LogLevelVerbose, (T), __VA_ARGS__)
+#define LogV(T, ...) LogAtSite(LogLevelVerbose, (T), __VA_ARGS__)
 
 /// A helper macro to write a warning level log.
-#define LogW(T, ...) Log(LogLevelWarning, (T), __VA_ARGS__)
+#define LogW(T, ...) LogAtSite(LogLevelWarning, (T), __VA_ARGS__)
+
+/// A helper macro to write a debug level log at a limited rate.
+#define LogLimitedD(T, ...) LogLimitedAtSite(LogLevelDebug, (T), __VA_ARGS__)
+
+/// A helper macro to write an error level log at a limited rate.
+#define LogLimitedE(T, ...) LogLimitedAtSite(LogLevelError, (T), __VA_ARGS__)
+
+/// A helper macro to write an info level log at a limited rate.
+#define LogLimitedI(T, ...) LogLimitedAtSite(LogLevelInfo, (T), __VA_ARGS__)
+
+/// A helper macro to write a verbose level log at a limited rate.
+#define LogLimitedV(T, ...) LogLimitedAtSite(LogLevelVerbose, (T), __VA_ARGS__)
+
+/// A helper macro to write a warning level log at a limited rate.
+#define LogLimitedW(T, ...) LogLimitedAtSite(LogLevelWarning, (T), __VA_ARGS__)
+
+
+// MARK: - Fields
+
+/**
+ * Set a field for messages logged by the calling thread.
+ * \param field The field to set.
+ * \param value The value of the field, or `NULL` to clear it. It must outlive asynchronous output, as the object it names does.
+ * \return The previous value of the field, so that it can be restored.
+ */
+const char * NULLABLE LogSetField(LogField field, const char * NULLABLE value);
 
 
 // MARK: - System-specific Logging
@@ -115,6 +351,41 @@ void LogVA(LogLevel level, const char * NONNULL tag, const char * NONNULL format
  */
 void LogErrno(const char * NONNULL tag, int errorNumber, const char * NONNULL format, ...);
 
+/// A helper macro to log an error with a given `errno` at a limited rate. The `errno` is read before anything else.
+#define LogLimitedErrno(T, E, ...) \
+    do { \
+        int logError = (E); \
+        static LogSite logSite; \
+        static LogLimit logLimit; \
+        if (LogIsEnabled(&logSite, LogLevelError, (T)) && LogIsAllowed(&logLimit, LogLevelError, (T))) { \
+            LogErrno((T), logError, __VA_ARGS__); \
+        } \
+    } while (0)
+
+
+// MARK: - Recorder
+
+/**
+ * Write the messages in the flight recorder to a file, as a binary log.
+ * \param path The file to write. It is replaced if it exists.
+ * \return `true` if the messages were written, otherwise `false` if the file could not be written or another dump is being written.
+ * \note Every thread's messages are written together, oldest first. Read the file with `LogDecode`.
+ * \note This is async-signal-safe, so it can be called from a fatal signal handler. Threads keep logging while it runs, and messages they overwrite are skipped.
+ * \note Remote clients dump the recorder by sending `recorder <path>` lines to the Stage.
+ */
+bool LogDumpRecorder(const char * NONNULL path);
+
+
+// MARK: - Decoding
+
+/**
+ * Decode a binary log in to text.
+ * \param input The binary log to read.
+ * \param output The stream to write a line per message to, formatted like the console output.
+ * \return `true` if the whole log was decoded, otherwise `false` if it is not a binary log or is damaged. The messages before the damage are still written.
+ */
+bool LogDecode(FILE * NONNULL input, FILE * NONNULL output);
+
 END_DECLS
 
 #endif /* LOG_H */
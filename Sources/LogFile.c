@@ -0,0 +1,282 @@
+//
+//  LogFile.c
+//  Woodpeckers
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include "config.h"
+
+#include "LogFile.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+// MARK: - Constants & Globals
+
+// NOTE: A segment that fails to open is retried after a wait that doubles with each failure, in milliseconds
+#define RETRY_MIN_WAIT 100
+#define RETRY_MAX_WAIT 10000
+
+typedef struct _LogFile {
+    char *path;
+    size_t totalSegments;
+    size_t segmentSize;
+
+    // NOTE: The lock is only contended when messages are written on several threads without the asynchronous writer
+    pthread_mutex_t mutex;
+
+    size_t currentSegment;
+    char *segment;
+    size_t segmentUsed;
+
+    // NOTE: When the current segment failed to open, and when it is next tried, in milliseconds of the monotonic clock
+    uint64_t retryWait;
+    uint64_t retryTime;
+} LogFile;
+
+
+// MARK: - Prototypes
+
+static bool LogFileCloseSegment(LogFileRef NONNULL file);
+static size_t LogFileFindNewestSegment(LogFileRef NONNULL file);
+static void LogFileMakeSegmentPath(LogFileRef NONNULL file, size_t segmentIdx, char * NONNULL buffer, size_t bufferSize);
+static bool LogFileOpenSegment(LogFileRef NONNULL file, size_t segmentIdx);
+static void LogFileOpenSegmentOrRetry(LogFileRef NONNULL file, size_t segmentIdx);
+static uint64_t LogFileNow(void);
+
+
+// MARK: - Lifecycle Methods
+
+LogFileRef LogFileCreate(const char *path, size_t totalSegments, size_t segmentSize) {
+    if (totalSegments == 0 || segmentSize == 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    LogFileRef self = (LogFileRef)calloc(1, sizeof(LogFile));
+
+    self->path = strdup(path);
+    self->totalSegments = totalSegments;
+    self->segmentSize = segmentSize;
+
+    pthread_mutex_init(&self->mutex, NULL);
+
+    // A restart keeps the segments written before it, and overwrites the oldest
+    size_t newestSegment = LogFileFindNewestSegment(self);
+    size_t firstSegment = (newestSegment == SIZE_MAX) ? 0 : ((newestSegment + 1) % totalSegments);
+
+    if (!LogFileOpenSegment(self, firstSegment)) {
+        int error = errno;
+
+        pthread_mutex_destroy(&self->mutex);
+        SAFE_DESTROY(self->path, free);
+        free(self);
+
+        errno = error;
+        return NULL;
+    }
+
+    return self;
+}
+
+void LogFileDestroy(LogFileRef self) {
+    LogFileCloseSegment(self);
+
+    pthread_mutex_destroy(&self->mutex);
+
+    SAFE_DESTROY(self->path, free);
+
+    free(self);
+}
+
+
+// MARK: - Writing
+
+void LogFileWrite(LogFileRef self, const char *data, size_t size) {
+    if (size > self->segmentSize) {
+        size = self->segmentSize;
+    }
+
+    pthread_mutex_lock(&self->mutex);
+
+    if (self->segment != NULL && self->segmentUsed + size > self->segmentSize) {
+        size_t nextSegment = (self->currentSegment + 1) % self->totalSegments;
+
+        LogFileCloseSegment(self);
+        LogFileOpenSegmentOrRetry(self, nextSegment);
+    } else if (self->segment == NULL && LogFileNow() >= self->retryTime) {
+        LogFileOpenSegmentOrRetry(self, self->currentSegment);
+    }
+
+    // NOTE: Text is lost while a segment can't be opened, until a retry opens it
+    if (self->segment != NULL) {
+        memcpy(self->segment + self->segmentUsed, data, size);
+        self->segmentUsed += size;
+    }
+
+    pthread_mutex_unlock(&self->mutex);
+}
+
+bool LogFileSync(LogFileRef self) {
+    bool isSynced = true;
+
+    pthread_mutex_lock(&self->mutex);
+
+    if (self->segment != NULL && self->segmentUsed > 0) {
+        isSynced = msync(self->segment, self->segmentUsed, MS_SYNC) == 0;
+    }
+
+    pthread_mutex_unlock(&self->mutex);
+
+    return isSynced;
+}
+
+
+// MARK: - Properties
+
+size_t LogFileGetCurrentSegment(const LogFileRef self) {
+    return self->currentSegment;
+}
+
+
+// MARK: - Segments
+
+static bool LogFileCloseSegment(LogFileRef self) {
+    if (self->segment == NULL) {
+        return true;
+    }
+
+    // Flash wears with each write, so the kernel writes the full segment back when it chooses
+    msync(self->segment, self->segmentSize, MS_ASYNC);
+    munmap(self->segment, self->segmentSize);
+
+    self->segment = NULL;
+
+    // The unwritten end of a segment is only zeros, so a closed segment is cut to its text
+    char segmentPath[PATH_MAX];
+    LogFileMakeSegmentPath(self, self->currentSegment, segmentPath, sizeof(segmentPath));
+
+    return truncate(segmentPath, (off_t)self->segmentUsed) == 0;
+}
+
+static size_t LogFileFindNewestSegment(LogFileRef self) {
+    size_t newestSegment = SIZE_MAX;
+    struct timespec newestTime = { 0, 0 };
+
+    for (size_t idx = 0; idx < self->totalSegments; idx++) {
+        char segmentPath[PATH_MAX];
+        LogFileMakeSegmentPath(self, idx, segmentPath, sizeof(segmentPath));
+
+        struct stat status;
+
+        if (stat(segmentPath, &status) == -1) {
+            continue;
+        }
+
+        struct timespec modifiedTime = STAT_MODIFIED_TIME(status);
+
+        if (newestSegment == SIZE_MAX || modifiedTime.tv_sec > newestTime.tv_sec || (modifiedTime.tv_sec == newestTime.tv_sec && modifiedTime.tv_nsec > newestTime.tv_nsec)) {
+            newestSegment = idx;
+            newestTime = modifiedTime;
+        }
+    }
+
+    return newestSegment;
+}
+
+static void LogFileMakeSegmentPath(LogFileRef self, size_t segmentIdx, char *buffer, size_t bufferSize) {
+    snprintf(buffer, bufferSize, "%s.%zu", self->path, segmentIdx);
+}
+
+static bool LogFileOpenSegment(LogFileRef self, size_t segmentIdx) {
+    char segmentPath[PATH_MAX];
+    LogFileMakeSegmentPath(self, segmentIdx, segmentPath, sizeof(segmentPath));
+
+    self->currentSegment = segmentIdx;
+    self->segmentUsed = 0;
+
+    int fd = open(segmentPath, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+    if (fd == -1) {
+        return false;
+    }
+
+    // Emptying the segment first frees its old blocks, so the preallocated space reads as zeros without writing them
+    int result = ftruncate(fd, 0);
+
+    if (result == 0) {
+#if TARGET_PLATFORM_LINUX
+        result = posix_fallocate(fd, 0, (off_t)self->segmentSize);
+
+        if (result != 0) {
+            errno = result;
+            result = -1;
+        }
+#else
+        result = ftruncate(fd, (off_t)self->segmentSize);
+#endif
+    }
+
+    if (result == -1) {
+        int error = errno;
+        close(fd);
+        errno = error;
+
+        return false;
+    }
+
+    void *segment = mmap(NULL, self->segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    // NOTE: The mapping keeps the file open
+    int error = errno;
+    close(fd);
+    errno = error;
+
+    if (segment == MAP_FAILED) {
+        return false;
+    }
+
+    self->segment = (char *)segment;
+
+    return true;
+}
+
+static void LogFileOpenSegmentOrRetry(LogFileRef self, size_t segmentIdx) {
+    if (LogFileOpenSegment(self, segmentIdx)) {
+        self->retryWait = 0;
+        return;
+    }
+
+    // A full disk or a lack of descriptors may pass, so the segment is tried again, less often the longer it fails
+    self->retryWait = (self->retryWait == 0) ? RETRY_MIN_WAIT : self->retryWait * 2;
+
+    if (self->retryWait > RETRY_MAX_WAIT) {
+        self->retryWait = RETRY_MAX_WAIT;
+    }
+
+    self->retryTime = LogFileNow() + self->retryWait;
+}
+
+
+// MARK: - Utilities
+
+static uint64_t LogFileNow() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)now.tv_sec * 1000ULL) + ((uint64_t)now.tv_nsec / 1000000ULL);
+}
@@ -0,0 +1,75 @@
+//
+//  LogFile.h
+//  Woodpeckers
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#ifndef LOGFILE_H
+#define LOGFILE_H
+
+#include "Macros.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+BEGIN_DECLS
+
+
+// MARK: - Constants & Globals
+
+/// The Log File object, which writes text in to a rotating set of memory mapped segment files.
+typedef struct _LogFile * LogFileRef;
+
+
+// MARK: - Lifecycle Methods
+
+/**
+ * Create a Log File, opening the segment after the one written most recently.
+ * \param path The base path of the segments, which are named `PATH.0`, `PATH.1` and so on.
+ * \param totalSegments The number of segments to rotate through.
+ * \param segmentSize The size of each segment in bytes.
+ * \return A new Log File instance, or `NULL` if the first segment could not be opened, with `errno` set.
+ */
+LogFileRef NULLABLE LogFileCreate(const char * NONNULL path, size_t totalSegments, size_t segmentSize);
+
+/**
+ * Destroy a Log File, syncing the current segment and trimming it to what was written.
+ * \param file The instance to destroy.
+ */
+void LogFileDestroy(LogFileRef NONNULL file);
+
+
+// MARK: - Writing
+
+/**
+ * Copy text in to the current segment, rotating to the next segment if it does not fit.
+ * \param file The instance to write to.
+ * \param data The text to write.
+ * \param size The size of the text in bytes. Text larger than a segment is cut to fit.
+ * \note Segments are preallocated, so this is a copy in to mapped memory until a segment is full.
+ * \note Text is dropped while a segment fails to open. The segment is tried again on later writes, waiting longer after each failure, up to 10 seconds.
+ */
+void LogFileWrite(LogFileRef NONNULL file, const char * NONNULL data, size_t size);
+
+/**
+ * Wait for the text written to the current segment to reach the disk.
+ * \param file The instance to sync.
+ * \return `true` if the segment was synced, otherwise `false`.
+ */
+bool LogFileSync(LogFileRef NONNULL file);
+
+
+// MARK: - Properties
+
+/**
+ * Get the index of the segment being written.
+ * \param file The instance to inspect.
+ * \return The index of the current segment.
+ */
+size_t LogFileGetCurrentSegment(const LogFileRef NONNULL file);
+
+END_DECLS
+
+#endif /* LOGFILE_H */
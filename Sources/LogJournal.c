@@ -0,0 +1,237 @@
+//
+//  LogJournal.c
+//  Woodpeckers
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+// NOTE: `sendmmsg` is a GNU extension
+#define _GNU_SOURCE
+
+#include "config.h"
+
+#include "LogJournal.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <syslog.h>
+
+
+// MARK: - Constants & Globals
+
+// NOTE: Large enough for a whole message, its tag and every field
+#define ENTRY_SIZE 2048
+
+// NOTE: The entries queued before they are sent with a single call
+#define BATCH_SIZE 32
+
+// NOTE: journald raises its own buffer, so a burst is not refused while it catches up
+#define SEND_BUFFER_SIZE (1024 * 1024)
+
+static const char * const FieldNames[LogFieldCount] = {
+    "WOODPECKERS_SHOW",
+    "WOODPECKERS_BIRD",
+    "WOODPECKERS_OUTPUT",
+};
+
+typedef struct _LogJournal {
+    int socket;
+
+    char *entries;
+    struct iovec vectors[BATCH_SIZE];
+    struct mmsghdr messages[BATCH_SIZE];
+    unsigned int totalQueued;
+} LogJournal;
+
+
+// MARK: - Prototypes
+
+static size_t LogJournalFormat(char * NONNULL buffer, LogLevel level, const char * NONNULL tag, const char * NONNULL message, const char * NULLABLE const * NONNULL fields);
+static size_t LogJournalFormatField(char * NONNULL buffer, size_t used, const char * NONNULL name, const char * NONNULL value);
+static int LogJournalPriority(LogLevel level);
+
+
+// MARK: - Lifecycle Methods
+
+LogJournalRef LogJournalCreate(const char *path) {
+    struct sockaddr_un address;
+
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        return NULL;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+
+    if (fd == -1) {
+        return NULL;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+
+    // Connecting checks the journal is running, and lets each entry be sent without an address
+    if (connect(fd, (struct sockaddr *)&address, sizeof(address)) == -1) {
+        close(fd);
+        return NULL;
+    }
+
+    int bufferSize = SEND_BUFFER_SIZE;
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize));
+
+    LogJournalRef self = (LogJournalRef)calloc(1, sizeof(LogJournal));
+
+    self->socket = fd;
+    self->entries = (char *)malloc(ENTRY_SIZE * BATCH_SIZE);
+
+    for (size_t idx = 0; idx < BATCH_SIZE; idx++) {
+        self->vectors[idx].iov_base = self->entries + (idx * ENTRY_SIZE);
+        self->messages[idx].msg_hdr.msg_iov = self->vectors + idx;
+        self->messages[idx].msg_hdr.msg_iovlen = 1;
+    }
+
+    return self;
+}
+
+void LogJournalDestroy(LogJournalRef self) {
+    LogJournalFlush(self);
+
+    close(self->socket);
+
+    SAFE_DESTROY(self->entries, free);
+
+    free(self);
+}
+
+
+// MARK: - Writing
+
+bool LogJournalWrite(LogJournalRef self, LogLevel level, const char *tag, const char *message, const char * const *fields) {
+    char buffer[ENTRY_SIZE];
+    size_t bufferSize = LogJournalFormat(buffer, level, tag, message, fields);
+
+    // The calling thread may be the event loop, so a full journal loses the entry instead of blocking
+    ssize_t result;
+
+    do {
+        result = send(self->socket, buffer, bufferSize, MSG_DONTWAIT | MSG_NOSIGNAL);
+    } while (result == -1 && errno == EINTR);
+
+    return result != -1;
+}
+
+void LogJournalAppend(LogJournalRef self, LogLevel level, const char *tag, const char *message, const char * const *fields) {
+    if (self->totalQueued == BATCH_SIZE) {
+        LogJournalFlush(self);
+    }
+
+    unsigned int index = self->totalQueued;
+
+    self->vectors[index].iov_len = LogJournalFormat(self->vectors[index].iov_base, level, tag, message, fields);
+    self->totalQueued += 1;
+}
+
+bool LogJournalFlush(LogJournalRef self) {
+    unsigned int totalSent = 0;
+    bool isComplete = true;
+
+    // Only the background writer queues entries, so it waits for room rather than losing them
+    while (totalSent < self->totalQueued) {
+        int result = sendmmsg(self->socket, self->messages + totalSent, self->totalQueued - totalSent, MSG_NOSIGNAL);
+
+        if (result == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            isComplete = false;
+            break;
+        }
+
+        totalSent += (unsigned int)result;
+    }
+
+    self->totalQueued = 0;
+
+    return isComplete;
+}
+
+
+// MARK: - Formatting
+
+static size_t LogJournalFormat(char *buffer, LogLevel level, const char *tag, const char *message, const char * const *fields) {
+    char priority[2] = { (char)('0' + LogJournalPriority(level)), '\0' };
+
+    size_t used = LogJournalFormatField(buffer, 0, "PRIORITY", priority);
+    used = LogJournalFormatField(buffer, used, "SYSLOG_IDENTIFIER", PROJECT_NAME);
+    used = LogJournalFormatField(buffer, used, "WOODPECKERS_TAG", tag);
+
+    for (size_t idx = 0; idx < LogFieldCount; idx++) {
+        if (fields[idx] != NULL) {
+            used = LogJournalFormatField(buffer, used, FieldNames[idx], fields[idx]);
+        }
+    }
+
+    return LogJournalFormatField(buffer, used, "MESSAGE", message);
+}
+
+static size_t LogJournalFormatField(char *buffer, size_t used, const char *name, const char *value) {
+    size_t nameSize = strlen(name);
+    size_t valueSize = strlen(value);
+
+    // A value with a line break is written with its size in front, as the line break would end it
+    bool hasSize = memchr(value, '\n', valueSize) != NULL;
+    size_t overhead = nameSize + (hasSize ? (1 + sizeof(uint64_t) + 1) : 2);
+
+    if (used + overhead > ENTRY_SIZE) {
+        return used;
+    }
+
+    if (used + overhead + valueSize > ENTRY_SIZE) {
+        valueSize = ENTRY_SIZE - used - overhead;
+    }
+
+    memcpy(buffer + used, name, nameSize);
+    used += nameSize;
+
+    if (hasSize) {
+        buffer[used++] = '\n';
+
+        // NOTE: The size is always little endian
+        for (size_t idx = 0; idx < sizeof(uint64_t); idx++) {
+            buffer[used++] = (char)(((uint64_t)valueSize >> (idx * 8)) & 0xFF);
+        }
+    } else {
+        buffer[used++] = '=';
+    }
+
+    memcpy(buffer + used, value, valueSize);
+    used += valueSize;
+
+    buffer[used++] = '\n';
+
+    return used;
+}
+
+static int LogJournalPriority(LogLevel level) {
+    switch (level) {
+        case LogLevelVerbose:
+        case LogLevelDebug:
+            return LOG_DEBUG;
+        case LogLevelInfo:
+            return LOG_INFO;
+        case LogLevelWarning:
+            return LOG_WARNING;
+        case LogLevelError:
+            return LOG_ERR;
+    }
+
+    return LOG_INFO;
+}
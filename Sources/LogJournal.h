@@ -0,0 +1,80 @@
+//
+//  LogJournal.h
+//  Woodpeckers
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#ifndef LOGJOURNAL_H
+#define LOGJOURNAL_H
+
+#include "Macros.h"
+
+#include <stdbool.h>
+
+#include "Log.h"
+
+BEGIN_DECLS
+
+
+// MARK: - Constants & Globals
+
+/// The path of the journald native socket.
+#define LOG_JOURNAL_DEFAULT_PATH "/run/systemd/journal/socket"
+
+/// The Log Journal object, which sends messages as structured entries to journald's native socket.
+typedef struct _LogJournal * LogJournalRef;
+
+
+// MARK: - Lifecycle Methods
+
+/**
+ * Create a Log Journal connected to a socket.
+ * \param path The path to the journald socket. Any datagram socket may stand in for testing.
+ * \return A new Log Journal instance, or `NULL` if the socket could not be connected.
+ */
+LogJournalRef NULLABLE LogJournalCreate(const char * NONNULL path);
+
+/**
+ * Destroy a Log Journal, sending any queued entries first.
+ * \param journal The instance to destroy.
+ */
+void LogJournalDestroy(LogJournalRef NONNULL journal);
+
+
+// MARK: - Writing
+
+/**
+ * Send a message as an entry immediately.
+ * \param journal The instance to send to.
+ * \param level The severity of the message.
+ * \param tag A section identifier of the message.
+ * \param message The full log message.
+ * \param fields The values of each `LogField`, with `NULL` for those that are not set.
+ * \return `true` if the entry was sent, otherwise `false`.
+ * \note This may be called from any thread.
+ */
+bool LogJournalWrite(LogJournalRef NONNULL journal, LogLevel level, const char * NONNULL tag, const char * NONNULL message, const char * NULLABLE const * NONNULL fields);
+
+/**
+ * Queue a message as an entry, sending the queue if it is full.
+ * \param journal The instance to queue in.
+ * \param level The severity of the message.
+ * \param tag A section identifier of the message.
+ * \param message The full log message.
+ * \param fields The values of each `LogField`, with `NULL` for those that are not set.
+ * \note Only one thread may queue and flush at a time.
+ */
+void LogJournalAppend(LogJournalRef NONNULL journal, LogLevel level, const char * NONNULL tag, const char * NONNULL message, const char * NULLABLE const * NONNULL fields);
+
+/**
+ * Send every queued entry with as few system calls as possible.
+ * \param journal The instance to flush.
+ * \return `true` if every entry was sent, otherwise `false` if any were lost.
+ */
+bool LogJournalFlush(LogJournalRef NONNULL journal);
+
+END_DECLS
+
+#endif /* LOGJOURNAL_H */
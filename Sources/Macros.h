@@ -69,6 +69,14 @@
 #define SWIFT_NEWTYPE(_type)
 #endif
 
+// File Status
+// NOTE: Apple platforms name the modification time of a `struct stat` differently. `config.h` is private to the library, so the compiler's own definition is checked.
+#if defined(__APPLE__)
+#define STAT_MODIFIED_TIME(S) ((S).st_mtimespec)
+#else
+#define STAT_MODIFIED_TIME(S) ((S).st_mtim)
+#endif
+
 // Memory Safety
 #if defined(_WIN32)
 #ifdef __cplusplus
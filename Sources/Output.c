@@ -14,8 +14,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "Log.h"
+#include "Trace.h"
 
 
 // MARK: - Constants & Globals
@@ -31,6 +33,7 @@ typedef enum _OutputType {
 typedef struct _Output {
     OutputType type;
     char *name;
+    OutputSafeState safeState;
 
     union {
         struct {
@@ -39,6 +42,7 @@ typedef struct _Output {
         struct {
             char *path;
             FILE *file;
+            int fd;
         } file;
         struct {
             int pin;
@@ -86,6 +90,7 @@ OutputRef OutputCreateFile(const char *name, const char *path) {
     self->type = OutputTypeFile;
     self->file.path = strdup(path);
     self->file.file = NULL;
+    self->file.fd = -1;
 
     return self;
 }
@@ -127,6 +132,7 @@ void OutputDestroy(OutputRef self) {
 }
 
 static void OutputDestroyFile(OutputRef self) {
+    self->file.fd = -1;
     SAFE_DESTROY(self->file.path, free);
     SAFE_DESTROY(self->file.file, fclose);
 }
@@ -167,6 +173,7 @@ static bool OutputSetUpFile(OutputRef self) {
     }
 
     self->file.file = file;
+    self->file.fd = fileno(file);
 
     return true;
 }
@@ -196,6 +203,7 @@ void OutputTearDown(OutputRef self) {
 }
 
 static void OutputTearDownFile(OutputRef self) {
+    self->file.fd = -1;
     SAFE_DESTROY(self->file.file, fclose);
 }
 
@@ -258,26 +266,37 @@ static bool OutputGetValueMemory(const OutputRef self) {
 }
 
 void OutputSetValue(OutputRef self, bool value) {
+    const char *previousOutput = LogSetField(LogFieldOutput, self->name);
+
     LogI(TAG, "Turning output %s %s", self->name, value ? "on" : "off");
 
     switch (self->type) {
         case OutputTypeFile:
+            TraceBeginString(TAG, "File", "output", self->name);
             OutputSetValueFile(self, value);
+            TraceEnd(TAG, "File");
             break;
         case OutputTypeGPIO:
+            TraceBeginString(TAG, "GPIO", "output", self->name);
             OutputSetValueGPIO(self, value);
+            TraceEnd(TAG, "GPIO");
             break;
         case OutputTypeMemory:
+            TraceBeginString(TAG, "Memory", "output", self->name);
             OutputSetValueMemory(self, value);
+            TraceEnd(TAG, "Memory");
             break;
     }
+
+    LogSetField(LogFieldOutput, previousOutput);
 }
 
 static void OutputSetValueFile(OutputRef self, bool value) {
+    // A missing file fails on every toggle, so the failures are limited
     int result = fseek(self->file.file, 0, SEEK_SET);
 
     if (result == -1) {
-        LogErrno(TAG, errno, "Failed to seek file output %s for writing", self->name);
+        LogLimitedErrno(TAG, errno, "Failed to seek file output %s for writing", self->name);
         return;
     }
 
@@ -285,7 +304,13 @@ static void OutputSetValueFile(OutputRef self, bool value) {
     ssize_t bytesWritten = fwrite(&buffer, sizeof(char), 1, self->file.file);
 
     if (bytesWritten != 1) {
-        LogErrno(TAG, errno, "Failed to write value to file output %s", self->name);
+        LogLimitedErrno(TAG, errno, "Failed to write value to file output %s", self->name);
+        return;
+    }
+
+    // Flush so the file always holds the value, and so the safe state path can write the descriptor directly
+    if (fflush(self->file.file) != 0) {
+        LogLimitedErrno(TAG, errno, "Failed to flush file output %s", self->name);
     }
 }
 
@@ -296,3 +321,47 @@ static void OutputSetValueGPIO(OutputRef self, bool value) {
 static void OutputSetValueMemory(OutputRef self, bool value) {
     self->memory.value = value;
 }
+
+OutputSafeState OutputGetSafeState(const OutputRef self) {
+    return self->safeState;
+}
+
+void OutputSetSafeState(OutputRef self, OutputSafeState state) {
+    self->safeState = state;
+}
+
+
+// MARK: - Safe States
+
+void OutputApplySafeState(OutputRef self) {
+    bool value;
+
+    switch (self->safeState) {
+        case OutputSafeStateOff:
+            value = false;
+            break;
+        case OutputSafeStateOn:
+            value = true;
+            break;
+        case OutputSafeStateHold:
+        default:
+            return;
+    }
+
+    switch (self->type) {
+        case OutputTypeFile:
+            if (self->file.fd != -1) {
+                char buffer = value ? '1' : '0';
+                ssize_t result = pwrite(self->file.fd, &buffer, 1, 0);
+                (void)result;
+            }
+
+            break;
+        case OutputTypeGPIO:
+            // TODO: Implement with the GPIO backend
+            break;
+        case OutputTypeMemory:
+            self->memory.value = value;
+            break;
+    }
+}
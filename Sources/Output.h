@@ -22,6 +22,13 @@ BEGIN_DECLS
 /// The Output object
 typedef struct _Output * OutputRef;
 
+/// The value an output is left at when the process exits or crashes.
+typedef enum _OutputSafeState {
+    OutputSafeStateOff = 0, ///< The output is turned off
+    OutputSafeStateOn,      ///< The output is turned on
+    OutputSafeStateHold,    ///< The output is left at its last value
+} OutputSafeState;
+
 
 // MARK: - Lifecycle Methods
 
@@ -94,6 +101,30 @@ bool OutputGetValue(const OutputRef NONNULL output);
  */
 void OutputSetValue(OutputRef NONNULL output, bool value);
 
+/**
+ * Get the safe state of the output.
+ * \param output The instance to inspect.
+ * \return The safe state of the output.
+ */
+OutputSafeState OutputGetSafeState(const OutputRef NONNULL output);
+
+/**
+ * Set the safe state of the output.
+ * \param output The instance to modify.
+ * \param state The value to leave the output at when the process exits or crashes.
+ */
+void OutputSetSafeState(OutputRef NONNULL output, OutputSafeState state);
+
+
+// MARK: - Safe States
+
+/**
+ * Write the safe state to the output without logging, allocating or locking.
+ * \param output The instance to modify.
+ * \note This is async-signal-safe, so it may be called when the process is crashing.
+ */
+void OutputApplySafeState(OutputRef NONNULL output);
+
 END_DECLS
 
 #endif /* OUTPUT_H */
@@ -0,0 +1,579 @@
+//
+//  OutputTable.c
+//  Woodpeckers
+//
+//  Created by Stephen H. Gerstacker on 2020-12-12.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include "OutputTable.h"
+
+#include <inttypes.h>
+#include <string.h>
+#include <time.h>
+
+#include "Log.h"
+
+
+// MARK: - Constants & Globals
+
+#define TAG "OutputTable"
+
+#define INITIAL_CAPACITY 8
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+// NOTE: An array that fails to grow keeps its contents, and the capacity only moves once every array has grown
+#define GROW_ARRAY(A, C) do { \
+    void *grown = realloc((A), sizeof(*(A)) * (C)); \
+    if (grown == NULL) { \
+        return false; \
+    } \
+    (A) = grown; \
+} while (0)
+
+typedef struct _OutputTable {
+    OutputRef *outputs;
+    size_t totalOutputs;
+    size_t capacity;
+
+    // NOTE: Open addressed by name hash. Slots hold the output index plus one, or 0 when empty.
+    size_t *nameSlots;
+    size_t totalNameSlots;
+
+    // NOTE: Switching limits, packed per output and indexed like `outputs`. Times are in milliseconds.
+    uint32_t *minOns;
+    uint32_t *minOffs;
+    uint32_t *minDwells;
+    uint64_t *lastChanges;
+
+    // NOTE: Changes that would break a limit wait here until their deadline
+    bool *pendingValues;
+    uint64_t *deadlines;
+
+    // NOTE: A min heap of the outputs with a change waiting, ordered by deadline. Positions hold the heap index plus one, or 0 when nothing is waiting.
+    size_t *pendings;
+    size_t totalPendings;
+    size_t *pendingPositions;
+
+    EventLoopRef eventLoop;
+    EventID timerID;
+    uint64_t timerDeadline;
+
+    // NOTE: Preallocated at set up so that applying safe states never allocates
+    OutputRef *safeOutputs;
+    size_t totalSafeOutputs;
+} OutputTable;
+
+
+// MARK: - Prototypes
+
+static bool OutputTableAddOutput(OutputTableRef NONNULL table, OutputRef NONNULL output);
+static bool OutputTableGrow(OutputTableRef NONNULL table);
+static bool OutputTableGrowNameSlots(OutputTableRef NONNULL table);
+static size_t OutputTableHashName(const char * NONNULL name);
+static void OutputTableInsertName(OutputTableRef NONNULL table, size_t idx);
+static void OutputTableInsertPending(OutputTableRef NONNULL table, size_t idx);
+static void OutputTableRemovePending(OutputTableRef NONNULL table, size_t idx);
+static void OutputTableSiftPendingDown(OutputTableRef NONNULL table, size_t position);
+static void OutputTableSiftPendingUp(OutputTableRef NONNULL table, size_t position);
+static void OutputTableSwapPendings(OutputTableRef NONNULL table, size_t position, size_t otherPosition);
+static uint64_t OutputTableGetEarliestChange(const OutputTableRef NONNULL table, size_t idx);
+static uint64_t OutputTableNow(void);
+static void OutputTableScheduleTimer(OutputTableRef NONNULL table);
+static void OutputTableTimerFired(EventLoopRef NONNULL eventLoop, EventID id, void * NULLABLE context);
+
+
+// MARK: - Lifecycle Methods
+
+OutputTableRef OutputTableCreate() {
+    OutputTableRef self = (OutputTableRef)calloc(1, sizeof(OutputTable));
+
+    return self;
+}
+
+void OutputTableDestroy(OutputTableRef self) {
+    for (size_t idx = 0; idx < self->totalOutputs; idx++) {
+        SAFE_DESTROY(self->outputs[idx], OutputDestroy);
+    }
+
+    SAFE_DESTROY(self->outputs, free);
+    SAFE_DESTROY(self->nameSlots, free);
+    SAFE_DESTROY(self->safeOutputs, free);
+
+    SAFE_DESTROY(self->minOns, free);
+    SAFE_DESTROY(self->minOffs, free);
+    SAFE_DESTROY(self->minDwells, free);
+    SAFE_DESTROY(self->lastChanges, free);
+    SAFE_DESTROY(self->pendingValues, free);
+    SAFE_DESTROY(self->deadlines, free);
+    SAFE_DESTROY(self->pendings, free);
+    SAFE_DESTROY(self->pendingPositions, free);
+
+    free(self);
+}
+
+
+// MARK: - Set Up & Tear Down
+
+bool OutputTableSetUp(OutputTableRef self) {
+    for (size_t idx = 0; idx < self->totalOutputs; idx++) {
+        OutputRef output = self->outputs[idx];
+
+        LogI(TAG, "Setting up output %s", OutputGetName(output));
+
+        bool result = OutputSetUp(output);
+
+        if (!result) {
+            return false;
+        }
+    }
+
+    // Gather the outputs that have a safe state to write
+    OutputRef *safeOutputs = (OutputRef *)realloc(self->safeOutputs, sizeof(OutputRef) * (self->totalOutputs + 1));
+
+    if (safeOutputs == NULL) {
+        LogE(TAG, "Failed to allocate the safe outputs");
+        return false;
+    }
+
+    self->safeOutputs = safeOutputs;
+    self->totalSafeOutputs = 0;
+
+    for (size_t idx = 0; idx < self->totalOutputs; idx++) {
+        OutputRef output = self->outputs[idx];
+
+        if (OutputGetSafeState(output) != OutputSafeStateHold) {
+            self->safeOutputs[self->totalSafeOutputs] = output;
+            self->totalSafeOutputs += 1;
+        }
+    }
+
+    return true;
+}
+
+void OutputTableTearDown(OutputTableRef self) {
+    // Deferred changes are abandoned
+    if (self->eventLoop != NULL && self->timerDeadline != 0) {
+        EventLoopRemoveTimer(self->eventLoop, self->timerID);
+    }
+
+    self->timerDeadline = 0;
+    self->totalPendings = 0;
+    memset(self->pendingPositions, 0, sizeof(size_t) * self->totalOutputs);
+
+    for (size_t idx = 0; idx < self->totalOutputs; idx++) {
+        OutputRef output = self->outputs[idx];
+
+        LogI(TAG, "Tearing down output %s", OutputGetName(output));
+
+        OutputTearDown(output);
+    }
+}
+
+
+// MARK: - Safe States
+
+void OutputTableApplySafeStates(OutputTableRef self) {
+    for (size_t idx = 0; idx < self->totalSafeOutputs; idx++) {
+        OutputApplySafeState(self->safeOutputs[idx]);
+    }
+}
+
+void OutputTableSetSafeValue(OutputTableRef self, size_t idx) {
+    if (idx >= self->totalOutputs) {
+        LogE(TAG, "Cannot set safe value for invalid output %zu", idx);
+        return;
+    }
+
+    switch (OutputGetSafeState(self->outputs[idx])) {
+        case OutputSafeStateOff:
+            OutputTableSetValue(self, idx, false);
+            break;
+        case OutputSafeStateOn:
+            OutputTableSetValue(self, idx, true);
+            break;
+        case OutputSafeStateHold:
+            break;
+    }
+}
+
+
+// MARK: - Outputs
+
+bool OutputTableAddFileOutput(OutputTableRef self, const char *name, const char *path) {
+    if (OutputTableFindOutput(self, name) != NULL) {
+        LogE(TAG, "Cannot add file output \"%s\" as another output has that name", name);
+        return false;
+    }
+
+    return OutputTableAddOutput(self, OutputCreateFile(name, path));
+}
+
+bool OutputTableAddGPIOOutput(OutputTableRef self, const char *name, int pin) {
+    if (OutputTableFindOutput(self, name) != NULL) {
+        LogE(TAG, "Cannot add GPIO output \"%s\" as another output has that name", name);
+        return false;
+    }
+
+    return OutputTableAddOutput(self, OutputCreateGPIO(name, pin));
+}
+
+bool OutputTableAddMemoryOutput(OutputTableRef self, const char *name) {
+    if (OutputTableFindOutput(self, name) != NULL) {
+        LogE(TAG, "Cannot add Memory output \"%s\" as another output has that name", name);
+        return false;
+    }
+
+    return OutputTableAddOutput(self, OutputCreateMemory(name));
+}
+
+OutputRef OutputTableFindOutput(const OutputTableRef self, const char *name) {
+    size_t idx = OutputTableFindOutputIndex(self, name);
+
+    if (idx == OUTPUT_TABLE_NOT_FOUND) {
+        return NULL;
+    }
+
+    return self->outputs[idx];
+}
+
+size_t OutputTableFindOutputIndex(const OutputTableRef self, const char *name) {
+    if (self->totalNameSlots == 0) {
+        return OUTPUT_TABLE_NOT_FOUND;
+    }
+
+    size_t mask = self->totalNameSlots - 1;
+
+    for (size_t slot = OutputTableHashName(name) & mask; self->nameSlots[slot] != 0; slot = (slot + 1) & mask) {
+        size_t idx = self->nameSlots[slot] - 1;
+
+        if (strcmp(OutputGetName(self->outputs[idx]), name) == 0) {
+            return idx;
+        }
+    }
+
+    return OUTPUT_TABLE_NOT_FOUND;
+}
+
+OutputRef OutputTableGetOutput(const OutputTableRef self, size_t idx) {
+    if (idx >= self->totalOutputs) {
+        return NULL;
+    }
+
+    return self->outputs[idx];
+}
+
+size_t OutputTableGetTotalOutputs(const OutputTableRef self) {
+    return self->totalOutputs;
+}
+
+
+// MARK: - Switching
+
+void OutputTableSetEventLoop(OutputTableRef self, EventLoopRef eventLoop, EventID timerID) {
+    self->eventLoop = eventLoop;
+    self->timerID = timerID;
+}
+
+bool OutputTableSetLimits(OutputTableRef self, size_t idx, uint32_t minOn, uint32_t minOff, uint32_t minDwell) {
+    if (idx >= self->totalOutputs) {
+        LogE(TAG, "Cannot set limits for invalid output %zu", idx);
+        return false;
+    }
+
+    self->minOns[idx] = minOn;
+    self->minOffs[idx] = minOff;
+    self->minDwells[idx] = minDwell;
+
+    return true;
+}
+
+void OutputTableSetValue(OutputTableRef self, size_t idx, bool value) {
+    if (idx >= self->totalOutputs) {
+        LogE(TAG, "Cannot set value for invalid output %zu", idx);
+        return;
+    }
+
+    OutputRef output = self->outputs[idx];
+
+    // Asking for the current value cancels any change still waiting
+    if (OutputGetValue(output) == value) {
+        OutputTableRemovePending(self, idx);
+        return;
+    }
+
+    // A change already waiting keeps its deadline
+    if (self->pendingPositions[idx] != 0) {
+        self->pendingValues[idx] = value;
+        return;
+    }
+
+    uint64_t now = OutputTableNow();
+    uint64_t earliest = OutputTableGetEarliestChange(self, idx);
+
+    if (now >= earliest) {
+        OutputSetValue(output, value);
+        self->lastChanges[idx] = now;
+        return;
+    }
+
+    LogD(TAG, "Deferring %s for %" PRIu64 " milliseconds", OutputGetName(output), earliest - now);
+
+    self->pendingValues[idx] = value;
+    self->deadlines[idx] = earliest;
+
+    OutputTableInsertPending(self, idx);
+    OutputTableScheduleTimer(self);
+}
+
+void OutputTableApplyDeferred(OutputTableRef self) {
+    uint64_t now = OutputTableNow();
+
+    // Only the changes that are due are visited, earliest first
+    while (self->totalPendings > 0 && self->deadlines[self->pendings[0]] <= now) {
+        size_t idx = self->pendings[0];
+        OutputTableRemovePending(self, idx);
+
+        OutputRef output = self->outputs[idx];
+
+        if (OutputGetValue(output) != self->pendingValues[idx]) {
+            OutputSetValue(output, self->pendingValues[idx]);
+            self->lastChanges[idx] = now;
+        }
+    }
+}
+
+bool OutputTableHasDeferred(const OutputTableRef self, size_t idx) {
+    if (idx >= self->totalOutputs) {
+        return false;
+    }
+
+    return self->pendingPositions[idx] != 0;
+}
+
+static uint64_t OutputTableGetEarliestChange(const OutputTableRef self, size_t idx) {
+    uint64_t lastChange = self->lastChanges[idx];
+
+    // Outputs that have never changed can change right away
+    if (lastChange == 0) {
+        return 0;
+    }
+
+    uint32_t minHold = OutputGetValue(self->outputs[idx]) ? self->minOns[idx] : self->minOffs[idx];
+    uint32_t minWait = (minHold > self->minDwells[idx]) ? minHold : self->minDwells[idx];
+
+    return lastChange + minWait;
+}
+
+static void OutputTableScheduleTimer(OutputTableRef self) {
+    if (self->eventLoop == NULL) {
+        return;
+    }
+
+    uint64_t deadline = (self->totalPendings > 0) ? self->deadlines[self->pendings[0]] : 0;
+
+    if (deadline == self->timerDeadline) {
+        return;
+    }
+
+    // Timers repeat, so replace the timer whenever the earliest deadline moves
+    if (self->timerDeadline != 0) {
+        EventLoopRemoveTimer(self->eventLoop, self->timerID);
+    }
+
+    self->timerDeadline = deadline;
+
+    if (deadline != 0) {
+        uint64_t now = OutputTableNow();
+        uint32_t timeout = (deadline > now) ? (uint32_t)(deadline - now) : 1;
+
+        EventLoopAddTimerWithContext(self->eventLoop, self->timerID, timeout, OutputTableTimerFired, self);
+    }
+}
+
+static void OutputTableTimerFired(EventLoopRef eventLoop, EventID id, void *context) {
+    OutputTableRef self = (OutputTableRef)context;
+
+    OutputTableApplyDeferred(self);
+    OutputTableScheduleTimer(self);
+}
+
+
+// MARK: - Utilities
+
+static bool OutputTableAddOutput(OutputTableRef self, OutputRef output) {
+    // The arrays double as they fill, so building a large stage stays linear
+    if (self->totalOutputs == self->capacity && !OutputTableGrow(self)) {
+        LogE(TAG, "Failed to allocate space for output \"%s\"", OutputGetName(output));
+        OutputDestroy(output);
+        return false;
+    }
+
+    if ((self->totalOutputs + 1) * 2 > self->totalNameSlots && !OutputTableGrowNameSlots(self)) {
+        LogE(TAG, "Failed to allocate the name index for output \"%s\"", OutputGetName(output));
+        OutputDestroy(output);
+        return false;
+    }
+
+    size_t idx = self->totalOutputs;
+
+    self->outputs[idx] = output;
+    self->minOns[idx] = 0;
+    self->minOffs[idx] = 0;
+    self->minDwells[idx] = 0;
+    self->lastChanges[idx] = 0;
+    self->pendingValues[idx] = false;
+    self->deadlines[idx] = 0;
+    self->pendingPositions[idx] = 0;
+
+    self->totalOutputs += 1;
+
+    OutputTableInsertName(self, idx);
+
+    return true;
+}
+
+static bool OutputTableGrow(OutputTableRef self) {
+    size_t capacity = (self->capacity == 0) ? INITIAL_CAPACITY : self->capacity * 2;
+
+    GROW_ARRAY(self->outputs, capacity);
+    GROW_ARRAY(self->minOns, capacity);
+    GROW_ARRAY(self->minOffs, capacity);
+    GROW_ARRAY(self->minDwells, capacity);
+    GROW_ARRAY(self->lastChanges, capacity);
+    GROW_ARRAY(self->pendingValues, capacity);
+    GROW_ARRAY(self->deadlines, capacity);
+    GROW_ARRAY(self->pendings, capacity);
+    GROW_ARRAY(self->pendingPositions, capacity);
+
+    self->capacity = capacity;
+
+    return true;
+}
+
+static bool OutputTableGrowNameSlots(OutputTableRef self) {
+    size_t totalNameSlots = (self->totalNameSlots == 0) ? INITIAL_CAPACITY * 2 : self->totalNameSlots * 2;
+    size_t *nameSlots = (size_t *)calloc(totalNameSlots, sizeof(size_t));
+
+    if (nameSlots == NULL) {
+        return false;
+    }
+
+    SAFE_DESTROY(self->nameSlots, free);
+
+    self->nameSlots = nameSlots;
+    self->totalNameSlots = totalNameSlots;
+
+    for (size_t idx = 0; idx < self->totalOutputs; idx++) {
+        OutputTableInsertName(self, idx);
+    }
+
+    return true;
+}
+
+static size_t OutputTableHashName(const char *name) {
+    uint64_t hash = FNV_OFFSET_BASIS;
+
+    for (const char *current = name; *current != '\0'; current++) {
+        hash ^= (uint8_t)*current;
+        hash *= FNV_PRIME;
+    }
+
+    return (size_t)hash;
+}
+
+static void OutputTableInsertName(OutputTableRef self, size_t idx) {
+    size_t mask = self->totalNameSlots - 1;
+    size_t slot = OutputTableHashName(OutputGetName(self->outputs[idx])) & mask;
+
+    while (self->nameSlots[slot] != 0) {
+        slot = (slot + 1) & mask;
+    }
+
+    self->nameSlots[slot] = idx + 1;
+}
+
+static void OutputTableInsertPending(OutputTableRef self, size_t idx) {
+    size_t position = self->totalPendings;
+
+    self->pendings[position] = idx;
+    self->pendingPositions[idx] = position + 1;
+    self->totalPendings += 1;
+
+    OutputTableSiftPendingUp(self, position);
+}
+
+static void OutputTableRemovePending(OutputTableRef self, size_t idx) {
+    if (self->pendingPositions[idx] == 0) {
+        return;
+    }
+
+    size_t position = self->pendingPositions[idx] - 1;
+    size_t last = self->totalPendings - 1;
+
+    OutputTableSwapPendings(self, position, last);
+
+    self->pendingPositions[idx] = 0;
+    self->totalPendings = last;
+
+    // The output moved into the hole may belong above or below it
+    if (position < last) {
+        OutputTableSiftPendingDown(self, position);
+        OutputTableSiftPendingUp(self, position);
+    }
+}
+
+static void OutputTableSiftPendingDown(OutputTableRef self, size_t position) {
+    while (true) {
+        size_t earliest = position;
+        size_t left = (position * 2) + 1;
+        size_t right = left + 1;
+
+        if (left < self->totalPendings && self->deadlines[self->pendings[left]] < self->deadlines[self->pendings[earliest]]) {
+            earliest = left;
+        }
+
+        if (right < self->totalPendings && self->deadlines[self->pendings[right]] < self->deadlines[self->pendings[earliest]]) {
+            earliest = right;
+        }
+
+        if (earliest == position) {
+            return;
+        }
+
+        OutputTableSwapPendings(self, position, earliest);
+        position = earliest;
+    }
+}
+
+static void OutputTableSiftPendingUp(OutputTableRef self, size_t position) {
+    while (position > 0) {
+        size_t parent = (position - 1) / 2;
+
+        if (self->deadlines[self->pendings[parent]] <= self->deadlines[self->pendings[position]]) {
+            return;
+        }
+
+        OutputTableSwapPendings(self, position, parent);
+        position = parent;
+    }
+}
+
+static void OutputTableSwapPendings(OutputTableRef self, size_t position, size_t otherPosition) {
+    size_t idx = self->pendings[position];
+    size_t otherIdx = self->pendings[otherPosition];
+
+    self->pendings[position] = otherIdx;
+    self->pendings[otherPosition] = idx;
+
+    self->pendingPositions[otherIdx] = position + 1;
+    self->pendingPositions[idx] = otherPosition + 1;
+}
+
+static uint64_t OutputTableNow() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)now.tv_sec * 1000ULL) + ((uint64_t)now.tv_nsec / 1000000ULL);
+}
@@ -0,0 +1,190 @@
+//
+//  OutputTable.h
+//  Woodpeckers
+//
+//  Created by Stephen H. Gerstacker on 2020-12-12.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#ifndef OUTPUT_TABLE_H
+#define OUTPUT_TABLE_H
+
+#include "Macros.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "EventLoop.h"
+#include "Output.h"
+
+
+BEGIN_DECLS
+
+
+// MARK: - Constants & Globals
+
+/// The Output Table object, which owns every Output shared by the shows in a process.
+typedef struct _OutputTable * OutputTableRef;
+
+/// The index returned when an Output cannot be found.
+#define OUTPUT_TABLE_NOT_FOUND SIZE_MAX
+
+
+// MARK: - Lifecycle Methods
+
+/**
+ * Create an empty Output Table.
+ * \return A new Output Table instance.
+ */
+OutputTableRef NONNULL OutputTableCreate(void);
+
+/**
+ * Destroy an Output Table and every Output it owns.
+ * \param table The instance to destroy.
+ */
+void OutputTableDestroy(OutputTableRef NONNULL table);
+
+
+// MARK: - Set Up & Tear Down
+
+/**
+ * Set up every Output in the table.
+ * \param table The instance to set up.
+ * \return `true` if every Output was set up, otherwise `false`.
+ */
+bool OutputTableSetUp(OutputTableRef NONNULL table);
+
+/**
+ * Tear down every Output in the table.
+ * \param table The instance to tear down.
+ */
+void OutputTableTearDown(OutputTableRef NONNULL table);
+
+
+// MARK: - Safe States
+
+/**
+ * Write the safe state of every Output that does not hold its value.
+ * \param table The instance to modify.
+ * \note This does not log, allocate or lock, so it may be called when the process is crashing. The Outputs to write are gathered when the table is set up. Switching limits are ignored.
+ */
+void OutputTableApplySafeStates(OutputTableRef NONNULL table);
+
+/**
+ * Move the Output at the given index to its safe state, within its switching limits.
+ * \param table The instance to modify.
+ * \param idx The index of the Output.
+ * \note Unlike `OutputTableApplySafeStates`, this is for a running process, so the change may be deferred. An Output that holds its value is left alone.
+ */
+void OutputTableSetSafeValue(OutputTableRef NONNULL table, size_t idx);
+
+
+// MARK: - Outputs
+
+/**
+ * Add a file-based Output to the table.
+ * \param table The instance to modify.
+ * \param name The name of the Output.
+ * \param path The path to the file to output to.
+ * \return `true` if the output was added successfully, otherwise `false`.
+ */
+bool OutputTableAddFileOutput(OutputTableRef NONNULL table, const char * NONNULL name, const char * NONNULL path);
+
+/**
+ * Add a GPIO-based Output to the table.
+ * \param table The instance to modify.
+ * \param name The name of the Output.
+ * \param pin The GPIO pin to output to.
+ * \return `true` if the output was added successfully, otherwise `false`.
+ */
+bool OutputTableAddGPIOOutput(OutputTableRef NONNULL table, const char * NONNULL name, int pin);
+
+/**
+ * Add a memory-based Output to the table.
+ * \param table The instance to modify.
+ * \param name The name of the Output.
+ * \return `true` if the output was added successfully, otherwise `false`.
+ */
+bool OutputTableAddMemoryOutput(OutputTableRef NONNULL table, const char * NONNULL name);
+
+/**
+ * Find an Output by name.
+ * \param table The instance to inspect.
+ * \param name The name of the Output.
+ * \return The Output, or `NULL` if no Output has that name.
+ */
+OutputRef NULLABLE OutputTableFindOutput(const OutputTableRef NONNULL table, const char * NONNULL name);
+
+/**
+ * Find the index of an Output by name.
+ * \param table The instance to inspect.
+ * \param name The name of the Output.
+ * \return The index of the Output, or `OUTPUT_TABLE_NOT_FOUND` if no Output has that name.
+ */
+size_t OutputTableFindOutputIndex(const OutputTableRef NONNULL table, const char * NONNULL name);
+
+/**
+ * Get the Output at the given index.
+ * \param table The instance to inspect.
+ * \param idx The index of the Output.
+ * \return The Output, or `NULL` if the index is invalid.
+ */
+OutputRef NULLABLE OutputTableGetOutput(const OutputTableRef NONNULL table, size_t idx);
+
+/**
+ * Get the total number of Outputs in the table.
+ * \param table The instance to inspect.
+ * \return The total number of Outputs.
+ */
+size_t OutputTableGetTotalOutputs(const OutputTableRef NONNULL table);
+
+
+// MARK: - Switching
+
+/**
+ * Set the Event Loop used to apply deferred changes.
+ * \param table The instance to modify.
+ * \param eventLoop The Event Loop to schedule a timer on.
+ * \param timerID The ID of the timer to use.
+ * \note Without an Event Loop, deferred changes are only applied by `OutputTableApplyDeferred`.
+ */
+void OutputTableSetEventLoop(OutputTableRef NONNULL table, EventLoopRef NULLABLE eventLoop, EventID timerID);
+
+/**
+ * Set the switching limits of the Output at the given index.
+ * \param table The instance to modify.
+ * \param idx The index of the Output.
+ * \param minOn The minimum time in milliseconds the Output stays on.
+ * \param minOff The minimum time in milliseconds the Output stays off.
+ * \param minDwell The minimum time in milliseconds between any two changes.
+ * \return `true` if the limits were set, otherwise `false`.
+ */
+bool OutputTableSetLimits(OutputTableRef NONNULL table, size_t idx, uint32_t minOn, uint32_t minOff, uint32_t minDwell);
+
+/**
+ * Set the value of the Output at the given index, within its switching limits.
+ * \param table The instance to modify.
+ * \param idx The index of the Output.
+ * \param value `true` to set the Output, otherwise `false`.
+ * \note A change that would break a limit is deferred to the earliest time it is allowed. Later requests replace the deferred value, and requesting the current value cancels it.
+ */
+void OutputTableSetValue(OutputTableRef NONNULL table, size_t idx, bool value);
+
+/**
+ * Apply every deferred change whose time has come.
+ * \param table The instance to modify.
+ */
+void OutputTableApplyDeferred(OutputTableRef NONNULL table);
+
+/**
+ * Does the Output at the given index have a deferred change?
+ * \param table The instance to inspect.
+ * \param idx The index of the Output.
+ * \return `true` if a change is waiting, otherwise `false`.
+ */
+bool OutputTableHasDeferred(const OutputTableRef NONNULL table, size_t idx);
+
+END_DECLS
+
+#endif /* OUTPUT_TABLE_H */
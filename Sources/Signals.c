@@ -0,0 +1,240 @@
+//
+//  Signals.c
+//  Woodpeckers
+//
+//  Created by Stephen H. Gerstacker on 2020-12-13.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include "Signals.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Log.h"
+
+
+// MARK: - Constants & Globals
+
+#define TAG "Signals"
+
+#define ALTERNATE_STACK_SIZE (64 * 1024)
+#define DUMP_SIGNAL SIGUSR1
+
+typedef struct _SignalsHandlerEntry {
+    SignalsHandler handler;
+    void *context;
+} SignalsHandlerEntry;
+
+static const int FatalSignals[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT };
+
+// NOTE: Termination requests stop the process in an orderly way, so it tears down as it would after running
+static const int StopSignals[] = { SIGTERM, SIGINT };
+
+static SignalsHandlerEntry FatalHandlers[SIGNALS_MAX_HANDLERS];
+static volatile sig_atomic_t TotalFatalHandlers = 0;
+
+static SignalsHandlerEntry DumpHandlers[SIGNALS_MAX_HANDLERS];
+static volatile sig_atomic_t TotalDumpHandlers = 0;
+
+static SignalsHandlerEntry StopHandlers[SIGNALS_MAX_HANDLERS];
+static volatile sig_atomic_t TotalStopHandlers = 0;
+
+static volatile sig_atomic_t IsHandlingFatalSignal = 0;
+
+static void *AlternateStack = NULL;
+
+
+// MARK: - Prototypes
+
+static void SignalsHandleDump(int signal);
+static void SignalsHandleFatal(int signal);
+static void SignalsHandleStop(int signal);
+
+
+// MARK: - Set Up
+
+bool SignalsSetUp() {
+    // Fatal signals may come from a stack overflow, so handle them on their own stack
+    if (AlternateStack == NULL) {
+        AlternateStack = malloc(ALTERNATE_STACK_SIZE);
+
+        stack_t stack;
+        memset(&stack, 0, sizeof(stack));
+
+        stack.ss_sp = AlternateStack;
+        stack.ss_size = ALTERNATE_STACK_SIZE;
+
+        if (sigaltstack(&stack, NULL) == -1) {
+            LogErrno(TAG, errno, "Failed to install the alternate signal stack");
+        }
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+
+    sigemptyset(&action.sa_mask);
+    action.sa_handler = SignalsHandleFatal;
+    action.sa_flags = SA_ONSTACK | SA_RESETHAND;
+
+    for (size_t idx = 0; idx < sizeof(FatalSignals) / sizeof(FatalSignals[0]); idx++) {
+        if (sigaction(FatalSignals[idx], &action, NULL) == -1) {
+            LogErrno(TAG, errno, "Failed to install the handler for signal %i", FatalSignals[idx]);
+            return false;
+        }
+    }
+
+    memset(&action, 0, sizeof(action));
+
+    sigemptyset(&action.sa_mask);
+    action.sa_handler = SignalsHandleDump;
+    action.sa_flags = SA_RESTART;
+
+    if (sigaction(DUMP_SIGNAL, &action, NULL) == -1) {
+        LogErrno(TAG, errno, "Failed to install the dump signal handler");
+        return false;
+    }
+
+    memset(&action, 0, sizeof(action));
+
+    sigemptyset(&action.sa_mask);
+    action.sa_handler = SignalsHandleStop;
+    action.sa_flags = SA_RESTART;
+
+    for (size_t idx = 0; idx < sizeof(StopSignals) / sizeof(StopSignals[0]); idx++) {
+        if (sigaction(StopSignals[idx], &action, NULL) == -1) {
+            LogErrno(TAG, errno, "Failed to install the handler for signal %i", StopSignals[idx]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool SignalsAddFatalHandler(SignalsHandler handler, void *context) {
+    if (TotalFatalHandlers >= SIGNALS_MAX_HANDLERS) {
+        LogE(TAG, "Too many fatal signal handlers");
+        return false;
+    }
+
+    FatalHandlers[TotalFatalHandlers].handler = handler;
+    FatalHandlers[TotalFatalHandlers].context = context;
+    TotalFatalHandlers += 1;
+
+    return true;
+}
+
+bool SignalsAddDumpHandler(SignalsHandler handler, void *context) {
+    if (TotalDumpHandlers >= SIGNALS_MAX_HANDLERS) {
+        LogE(TAG, "Too many dump signal handlers");
+        return false;
+    }
+
+    DumpHandlers[TotalDumpHandlers].handler = handler;
+    DumpHandlers[TotalDumpHandlers].context = context;
+    TotalDumpHandlers += 1;
+
+    return true;
+}
+
+bool SignalsAddStopHandler(SignalsHandler handler, void *context) {
+    if (TotalStopHandlers >= SIGNALS_MAX_HANDLERS) {
+        LogE(TAG, "Too many stop signal handlers");
+        return false;
+    }
+
+    StopHandlers[TotalStopHandlers].handler = handler;
+    StopHandlers[TotalStopHandlers].context = context;
+    TotalStopHandlers += 1;
+
+    return true;
+}
+
+
+// MARK: - Signal Handlers
+
+static void SignalsHandleDump(int signal) {
+    int savedErrno = errno;
+
+    for (sig_atomic_t idx = 0; idx < TotalDumpHandlers; idx++) {
+        DumpHandlers[idx].handler(signal, DumpHandlers[idx].context);
+    }
+
+    errno = savedErrno;
+}
+
+static void SignalsHandleFatal(int signal) {
+    // A fault inside a handler should not run the handlers again
+    if (IsHandlingFatalSignal == 0) {
+        IsHandlingFatalSignal = 1;
+
+        SignalsWriteString(STDERR_FILENO, "Fatal signal ");
+        SignalsWriteUnsigned(STDERR_FILENO, (uint64_t)signal, 0);
+        SignalsWriteString(STDERR_FILENO, " received\n");
+
+        for (sig_atomic_t idx = 0; idx < TotalFatalHandlers; idx++) {
+            FatalHandlers[idx].handler(signal, FatalHandlers[idx].context);
+        }
+    }
+
+    // The handler was reset, so this terminates with the default action
+    raise(signal);
+}
+
+static void SignalsHandleStop(int signal) {
+    int savedErrno = errno;
+
+    for (sig_atomic_t idx = 0; idx < TotalStopHandlers; idx++) {
+        StopHandlers[idx].handler(signal, StopHandlers[idx].context);
+    }
+
+    errno = savedErrno;
+}
+
+
+// MARK: - Async-Signal-Safe Output
+
+void SignalsWriteString(int fd, const char *value) {
+    size_t remaining = strlen(value);
+
+    while (remaining > 0) {
+        ssize_t written = write(fd, value, remaining);
+
+        if (written <= 0) {
+            if (written == -1 && errno == EINTR) {
+                continue;
+            }
+
+            break;
+        }
+
+        value += written;
+        remaining -= (size_t)written;
+    }
+}
+
+void SignalsWriteUnsigned(int fd, uint64_t value, int width) {
+    char buffer[24];
+    size_t position = sizeof(buffer) - 1;
+    int digits = 0;
+
+    buffer[position] = '\0';
+
+    do {
+        position -= 1;
+        buffer[position] = (char)('0' + (value % 10));
+        value /= 10;
+        digits += 1;
+    } while (value > 0 && position > 0);
+
+    while (digits < width && position > 0) {
+        position -= 1;
+        buffer[position] = '0';
+        digits += 1;
+    }
+
+    SignalsWriteString(fd, buffer + position);
+}
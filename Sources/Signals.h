@@ -0,0 +1,92 @@
+//
+//  Signals.h
+//  Woodpeckers
+//
+//  Created by Stephen H. Gerstacker on 2020-12-13.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#ifndef SIGNALS_H
+#define SIGNALS_H
+
+#include "Macros.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+BEGIN_DECLS
+
+
+// MARK: - Constants & Globals
+
+/// The maximum number of handlers that can be registered for each kind of signal.
+#define SIGNALS_MAX_HANDLERS 8
+
+
+// MARK: - Callbacks
+
+/**
+ * Called from a signal handler.
+ * \param signal The signal that was received.
+ * \param context The opaque context the handler was registered with.
+ * \note This is called in a signal context, so only async-signal-safe functions may be used.
+ */
+typedef void (* SignalsHandler)(int signal, void * NULLABLE context);
+
+
+// MARK: - Set Up
+
+/**
+ * Install the signal handlers for fatal signals, stop requests and dump requests.
+ * \return `true` if the handlers were installed, otherwise `false`.
+ * \note Fatal signals are `SIGSEGV`, `SIGBUS`, `SIGILL`, `SIGFPE` and `SIGABRT`. Stops are requested with `SIGTERM` and `SIGINT`, and dumps with `SIGUSR1`.
+ */
+bool SignalsSetUp(void);
+
+/**
+ * Register a handler to be called when a fatal signal is received, before the process terminates.
+ * \param handler The handler to call.
+ * \param context The opaque context passed to the handler.
+ * \return `true` if the handler was registered, otherwise `false`.
+ */
+bool SignalsAddFatalHandler(SignalsHandler NONNULL handler, void * NULLABLE context);
+
+/**
+ * Register a handler to be called when a dump is requested.
+ * \param handler The handler to call.
+ * \param context The opaque context passed to the handler.
+ * \return `true` if the handler was registered, otherwise `false`.
+ */
+bool SignalsAddDumpHandler(SignalsHandler NONNULL handler, void * NULLABLE context);
+
+/**
+ * Register a handler to be called when a stop is requested.
+ * \param handler The handler to call.
+ * \param context The opaque context passed to the handler.
+ * \return `true` if the handler was registered, otherwise `false`.
+ * \note The process keeps running, so the handler should only ask it to stop. It is called again for every request.
+ */
+bool SignalsAddStopHandler(SignalsHandler NONNULL handler, void * NULLABLE context);
+
+
+// MARK: - Async-Signal-Safe Output
+
+/**
+ * Write a string to a file descriptor without allocating or locking.
+ * \param fd The file descriptor to write to.
+ * \param value The string to write.
+ */
+void SignalsWriteString(int fd, const char * NONNULL value);
+
+/**
+ * Write an unsigned number to a file descriptor without allocating or locking.
+ * \param fd The file descriptor to write to.
+ * \param value The number to write.
+ * \param width The minimum number of digits to write, padded with zeros.
+ */
+void SignalsWriteUnsigned(int fd, uint64_t value, int width);
+
+END_DECLS
+
+#endif /* SIGNALS_H */
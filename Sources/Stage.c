@@ -0,0 +1,597 @@
+//
+//  Stage.c
+//  Woodpeckers
+//
+//  Created by Stephen H. Gerstacker on 2020-12-12.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include "Stage.h"
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "Log.h"
+#include "Trace.h"
+#include "Watchdog.h"
+
+
+// MARK: - Constants & Globals
+
+#define TAG "Stage"
+
+#define REMOTE_SERVER_ID 42
+#define REMOTE_SERVER_PORT 5353
+
+// NOTE: Timer namespace 0 is reserved for the Stage. Shows start at 1.
+#define STAGE_TIMER_NAMESPACE 0
+#define FIRST_SHOW_TIMER_NAMESPACE 1
+#define MAX_SHOWS ((UINT16_MAX / CONTROLLER_TIMER_NAMESPACE_SIZE) - FIRST_SHOW_TIMER_NAMESPACE)
+
+#define STAGE_TIMER_ID(T) ((EventID)((STAGE_TIMER_NAMESPACE * CONTROLLER_TIMER_NAMESPACE_SIZE) + (T)))
+#define WATCHDOG_TIMER_ID STAGE_TIMER_ID(0)
+#define OUTPUT_TABLE_TIMER_ID STAGE_TIMER_ID(1)
+#define FIRST_SCHEDULE_TIMER_ID 2
+#define MAX_SCHEDULES (CONTROLLER_TIMER_NAMESPACE_SIZE - FIRST_SCHEDULE_TIMER_ID)
+
+#define TRIGGER_EVENT_ID 0
+
+#define MAX_COMMAND_SIZE 256
+#define MAX_COMMAND_WORD_SIZE 16
+
+typedef void (* StageSettingSetter)(ControllerRef NONNULL controller, uint32_t value);
+
+typedef struct _StageSetting {
+    const char *name;
+    StageSettingSetter setter;
+} StageSetting;
+
+static const StageSetting Settings[] = {
+    { "MinWait", ControllerSetMinWait },
+    { "MaxWait", ControllerSetMaxWait },
+    { "MinPecks", ControllerSetMinPecks },
+    { "MaxPecks", ControllerSetMaxPecks },
+    { "PeckWait", ControllerSetPeckWait },
+};
+
+typedef enum _StageExportKind {
+    StageExportKindConfiguration = 0,
+    StageExportKindTrace,
+    StageExportKindRecorder,
+} StageExportKind;
+
+typedef struct _StageExport {
+    StageExportKind kind;
+
+    // NOTE: `NULL` unless the kind is `StageExportKindConfiguration`
+    ConfigurationSnapshotRef snapshot;
+    ConfigurationSnapshotFormat format;
+    atomic_bool *isExporting;
+    char path[];
+} StageExport;
+
+typedef struct _Stage {
+    EventLoopRef eventLoop;
+    OutputTableRef outputTable;
+
+    ControllerRef *shows;
+    size_t totalShows;
+
+    WatchdogRef watchdog;
+    uint32_t watchdogInterval;
+
+    TriggerBusRef triggerBus;
+    uint32_t schedules[MAX_SCHEDULES];
+    size_t totalSchedules;
+
+    ConfigurationRef configuration;
+    pthread_t exportThread;
+    bool hasExportThread;
+    atomic_bool isExporting;
+} Stage;
+
+
+// MARK: - Prototypes
+
+static void StageDidAcceptClient(EventLoopRef NONNULL eventLoop, EventID serverID, EventID peerID, struct sockaddr * NONNULL address, void * NULLABLE context);
+static void StageDidReceiveData(EventLoopRef NONNULL eventLoop, EventID serverID, EventID peerID, const uint8_t *data, size_t dataSize, void * NULLABLE context);
+static bool StageShouldAcceptClient(EventLoopRef NONNULL eventLoop, EventID id, struct sockaddr * NONNULL address, void * NULLABLE context);
+
+static void StageWatchdogTimerFired(EventLoopRef NONNULL eventLoop, EventID id, void * NULLABLE context);
+
+static void StageHandleCommand(StageRef NONNULL stage, const char * NONNULL command);
+static void StageScheduleTimerFired(EventLoopRef NONNULL eventLoop, EventID id, void * NULLABLE context);
+static void StageTriggerEventFired(EventLoopRef NONNULL eventLoop, EventID id, void * NULLABLE context);
+
+static void * NULLABLE StageExportWorker(void * NONNULL context);
+static void StageJoinExport(StageRef NONNULL stage);
+static bool StageStartExport(StageRef NONNULL stage, StageExportKind kind, const char * NONNULL path, ConfigurationSnapshotRef NULLABLE snapshot, ConfigurationSnapshotFormat format);
+
+
+// MARK: - Lifecycle Methods
+
+StageRef StageCreate() {
+    StageRef self = (StageRef)calloc(1, sizeof(Stage));
+
+    self->eventLoop = EventLoopCreate();
+    EventLoopSetCallbackContext(self->eventLoop, self);
+
+    self->outputTable = OutputTableCreate();
+    OutputTableSetEventLoop(self->outputTable, self->eventLoop, OUTPUT_TABLE_TIMER_ID);
+    self->triggerBus = TriggerBusCreate();
+
+    atomic_init(&self->isExporting, false);
+
+    return self;
+}
+
+void StageDestroy(StageRef self) {
+    StageJoinExport(self);
+
+    for (size_t idx = 0; idx < self->totalShows; idx++) {
+        SAFE_DESTROY(self->shows[idx], ControllerDestroy);
+    }
+
+    SAFE_DESTROY(self->shows, free);
+    SAFE_DESTROY(self->watchdog, WatchdogDestroy);
+    SAFE_DESTROY(self->triggerBus, TriggerBusDestroy);
+    SAFE_DESTROY(self->outputTable, OutputTableDestroy);
+    SAFE_DESTROY(self->eventLoop, EventLoopDestroy);
+    SAFE_DESTROY(self->configuration, ConfigurationDestroy);
+
+    free(self);
+}
+
+
+// MARK: - Running
+
+void StageRun(StageRef self) {
+    for (size_t idx = 0; idx < self->totalShows; idx++) {
+        ControllerStart(self->shows[idx]);
+    }
+
+    EventLoopRun(self->eventLoop);
+}
+
+bool StageSetUp(StageRef self) {
+    srand(time(NULL));
+
+    bool result = OutputTableSetUp(self->outputTable);
+
+    if (!result) {
+        return false;
+    }
+
+    EventLoopServerDescriptor descriptor;
+    memset(&descriptor, 0, sizeof(descriptor));
+
+    descriptor.id = REMOTE_SERVER_ID;
+    descriptor.port = REMOTE_SERVER_PORT;
+    descriptor.shouldAccept = StageShouldAcceptClient;
+    descriptor.didAccept = StageDidAcceptClient;
+    descriptor.didReceiveData = StageDidReceiveData;
+
+    EventLoopAddServer(self->eventLoop, &descriptor);
+
+    // Triggers are dispatched from the Event Loop, after the subscriptions are final
+    TriggerBusCompile(self->triggerBus);
+    EventLoopAddUserEvent(self->eventLoop, TRIGGER_EVENT_ID, StageTriggerEventFired);
+
+    for (size_t idx = 0; idx < self->totalSchedules; idx++) {
+        EventID timerID = STAGE_TIMER_ID(FIRST_SCHEDULE_TIMER_ID + idx);
+        EventLoopAddTimerWithContext(self->eventLoop, timerID, self->schedules[idx], StageScheduleTimerFired, self);
+    }
+
+    if (self->watchdog != NULL) {
+        result = WatchdogOpen(self->watchdog);
+
+        if (!result) {
+            return false;
+        }
+
+        WatchdogPet(self->watchdog);
+        EventLoopAddTimerWithContext(self->eventLoop, WATCHDOG_TIMER_ID, self->watchdogInterval, StageWatchdogTimerFired, self);
+    }
+
+    return true;
+}
+
+void StageTearDown(StageRef self) {
+    StageJoinExport(self);
+
+    for (size_t idx = 0; idx < self->totalSchedules; idx++) {
+        EventLoopRemoveTimer(self->eventLoop, STAGE_TIMER_ID(FIRST_SCHEDULE_TIMER_ID + idx));
+    }
+
+    EventLoopRemoveUserEvent(self->eventLoop, TRIGGER_EVENT_ID);
+
+    for (size_t idx = 0; idx < self->totalShows; idx++) {
+        ControllerStop(self->shows[idx]);
+    }
+
+    LogI(TAG, "Applying safe states");
+    OutputTableApplySafeStates(self->outputTable);
+
+    OutputTableTearDown(self->outputTable);
+
+    if (self->watchdog != NULL) {
+        EventLoopRemoveTimer(self->eventLoop, WATCHDOG_TIMER_ID);
+        WatchdogClose(self->watchdog, true);
+    }
+}
+
+
+// MARK: - Properties
+
+EventLoopRef StageGetEventLoop(const StageRef self) {
+    return self->eventLoop;
+}
+
+OutputTableRef StageGetOutputTable(const StageRef self) {
+    return self->outputTable;
+}
+
+TriggerBusRef StageGetTriggerBus(const StageRef self) {
+    return self->triggerBus;
+}
+
+
+// MARK: - Safety
+
+void StageSetWatchdog(StageRef self, const char *path, uint32_t interval) {
+    SAFE_DESTROY(self->watchdog, WatchdogDestroy);
+
+    self->watchdog = WatchdogCreate(path);
+    self->watchdogInterval = interval;
+}
+
+void StageFailSafe(StageRef self, bool disarmWatchdog) {
+    OutputTableApplySafeStates(self->outputTable);
+
+    if (self->watchdog != NULL) {
+        WatchdogClose(self->watchdog, disarmWatchdog);
+    }
+}
+
+
+// MARK: - Shows
+
+ControllerRef StageAddShow(StageRef self, const char *name) {
+    for (size_t idx = 0; idx < self->totalShows; idx++) {
+        if (strcmp(ControllerGetName(self->shows[idx]), name) == 0) {
+            LogE(TAG, "Cannot add show \"%s\" as another show has that name", name);
+            return NULL;
+        }
+    }
+
+    if (self->totalShows >= MAX_SHOWS) {
+        LogE(TAG, "Cannot add show \"%s\" as there are no timer namespaces left", name);
+        return NULL;
+    }
+
+    EventID timerNamespace = (EventID)(FIRST_SHOW_TIMER_NAMESPACE + self->totalShows);
+    ControllerRef show = ControllerCreate(name, self->eventLoop, self->outputTable, timerNamespace);
+
+    self->shows = (ControllerRef *)realloc(self->shows, sizeof(ControllerRef) * (self->totalShows + 1));
+    self->shows[self->totalShows] = show;
+    self->totalShows += 1;
+
+    return show;
+}
+
+ControllerRef StageGetShow(const StageRef self, size_t idx) {
+    if (idx >= self->totalShows) {
+        return NULL;
+    }
+
+    return self->shows[idx];
+}
+
+size_t StageGetTotalShows(const StageRef self) {
+    return self->totalShows;
+}
+
+
+// MARK: - Triggers
+
+bool StageAddSchedule(StageRef self, uint32_t period) {
+    if (period == 0) {
+        LogE(TAG, "Cannot add a schedule with a period of 0");
+        return false;
+    }
+
+    for (size_t idx = 0; idx < self->totalSchedules; idx++) {
+        if (self->schedules[idx] == period) {
+            return true;
+        }
+    }
+
+    if (self->totalSchedules >= MAX_SCHEDULES) {
+        LogE(TAG, "Cannot add a schedule every %" PRIu32 " milliseconds as there are too many schedules", period);
+        return false;
+    }
+
+    self->schedules[self->totalSchedules] = period;
+    self->totalSchedules += 1;
+
+    return true;
+}
+
+bool StagePublishTrigger(StageRef self, TriggerType type, uint32_t source) {
+    bool result = TriggerBusPublish(self->triggerBus, type, source);
+
+    if (result) {
+        EventLoopTriggerUserEvent(self->eventLoop, TRIGGER_EVENT_ID);
+    }
+
+    return result;
+}
+
+static void StageHandleCommand(StageRef self, const char *command) {
+    unsigned long source = 0;
+    unsigned long value = 0;
+    char word[MAX_COMMAND_WORD_SIZE];
+    char path[MAX_COMMAND_SIZE];
+
+    // NOTE: Commands are shorter than `MAX_COMMAND_SIZE`, so the path always fits
+    if (sscanf(command, "trigger %lu", &source) == 1 && source < TRIGGER_SOURCE_ANY) {
+        LogI(TAG, "Received command trigger %lu", source);
+        StagePublishTrigger(self, TriggerTypeCommand, (uint32_t)source);
+    } else if (sscanf(command, "set %15s %lu", word, &value) == 2 && value <= UINT32_MAX) {
+        LogI(TAG, "Received command set %s %lu", word, value);
+        StageSetSetting(self, word, (uint32_t)value);
+    } else if (sscanf(command, "log %s", path) == 1) {
+        LogI(TAG, "Received command log %s", path);
+
+        if (!LogSetTagLevels(path)) {
+            LogW(TAG, "Invalid log levels: %s", path);
+        }
+    } else if (sscanf(command, "recorder %s", path) == 1) {
+        LogI(TAG, "Received command recorder %s", path);
+        StageStartExport(self, StageExportKindRecorder, path, NULL, ConfigurationSnapshotFormatYAML);
+    } else if (sscanf(command, "trace save %s", path) == 1) {
+        LogI(TAG, "Received command trace save %s", path);
+        StageStartExport(self, StageExportKindTrace, path, NULL, ConfigurationSnapshotFormatYAML);
+    } else if (sscanf(command, "trace %15s", word) == 1) {
+        LogI(TAG, "Received command trace %s", word);
+
+        if (strcmp(word, "start") == 0) {
+            TraceEnable(true);
+        } else if (strcmp(word, "stop") == 0) {
+            TraceEnable(false);
+        } else {
+            LogW(TAG, "Unknown trace command: %s", word);
+        }
+    } else if (sscanf(command, "export %15s %s", word, path) == 2) {
+        LogI(TAG, "Received command export %s %s", word, path);
+
+        if (strcmp(word, "yaml") == 0) {
+            StageExportConfiguration(self, path, ConfigurationSnapshotFormatYAML);
+        } else if (strcmp(word, "image") == 0) {
+            StageExportConfiguration(self, path, ConfigurationSnapshotFormatImage);
+        } else {
+            LogW(TAG, "Unknown export format: %s", word);
+        }
+    } else {
+        LogW(TAG, "Unhandled command: %s", command);
+    }
+}
+
+static void StageScheduleTimerFired(EventLoopRef eventLoop, EventID id, void *context) {
+    StageRef self = (StageRef)context;
+    size_t idx = (size_t)(id - STAGE_TIMER_ID(FIRST_SCHEDULE_TIMER_ID));
+
+    StagePublishTrigger(self, TriggerTypeSchedule, self->schedules[idx]);
+}
+
+static void StageTriggerEventFired(EventLoopRef eventLoop, EventID id, void *context) {
+    StageRef self = (StageRef)context;
+
+    TriggerBusDispatch(self->triggerBus);
+}
+
+
+// MARK: - Configuration
+
+void StageSetConfiguration(StageRef self, ConfigurationRef configuration) {
+    StageJoinExport(self);
+
+    SAFE_DESTROY(self->configuration, ConfigurationDestroy);
+    self->configuration = configuration;
+}
+
+bool StageSetSetting(StageRef self, const char *name, uint32_t value) {
+    for (size_t settingIdx = 0; settingIdx < (sizeof(Settings) / sizeof(Settings[0])); settingIdx++) {
+        if (strcmp(Settings[settingIdx].name, name) != 0) {
+            continue;
+        }
+
+        for (size_t idx = 0; idx < self->totalShows; idx++) {
+            Settings[settingIdx].setter(self->shows[idx], value);
+        }
+
+        return true;
+    }
+
+    LogW(TAG, "Cannot set unknown setting \"%s\"", name);
+    return false;
+}
+
+bool StageExportConfiguration(StageRef self, const char *path, ConfigurationSnapshotFormat format) {
+    if (self->configuration == NULL) {
+        LogE(TAG, "Cannot export without the configuration the stage was built from");
+        return false;
+    }
+
+    // Every show shares the same settings, as they are only ever changed together
+    ConfigurationSettings settings;
+    ConfigurationSettings *liveSettings = NULL;
+
+    if (self->totalShows > 0) {
+        ControllerRef controller = self->shows[0];
+
+        settings.minWait = ControllerGetMinWait(controller);
+        settings.maxWait = ControllerGetMaxWait(controller);
+        settings.minPecks = ControllerGetMinPecks(controller);
+        settings.maxPecks = ControllerGetMaxPecks(controller);
+        settings.peckWait = ControllerGetPeckWait(controller);
+
+        liveSettings = &settings;
+    }
+
+    ConfigurationSnapshotRef snapshot = ConfigurationSnapshotCreate(self->configuration, liveSettings);
+
+    return StageStartExport(self, StageExportKindConfiguration, path, snapshot, format);
+}
+
+static bool StageStartExport(StageRef self, StageExportKind kind, const char *path, ConfigurationSnapshotRef snapshot, ConfigurationSnapshotFormat format) {
+    if (atomic_load(&self->isExporting)) {
+        LogW(TAG, "Cannot export to %s while another export is running", path);
+        SAFE_DESTROY(snapshot, ConfigurationSnapshotDestroy);
+
+        return false;
+    }
+
+    // The last worker has finished, so this returns immediately
+    StageJoinExport(self);
+
+    size_t pathSize = strlen(path) + 1;
+    StageExport *job = (StageExport *)malloc(sizeof(StageExport) + pathSize);
+
+    job->kind = kind;
+    job->snapshot = snapshot;
+    job->format = format;
+    job->isExporting = &self->isExporting;
+    memcpy(job->path, path, pathSize);
+
+    atomic_store(&self->isExporting, true);
+
+    int result = pthread_create(&self->exportThread, NULL, StageExportWorker, job);
+
+    if (result != 0) {
+        LogErrno(TAG, result, "Failed to start the export worker");
+
+        atomic_store(&self->isExporting, false);
+        SAFE_DESTROY(job->snapshot, ConfigurationSnapshotDestroy);
+        free(job);
+
+        return false;
+    }
+
+    self->hasExportThread = true;
+
+    return true;
+}
+
+static void *StageExportWorker(void *context) {
+    StageExport *job = (StageExport *)context;
+
+    switch (job->kind) {
+        case StageExportKindConfiguration:
+            if (ConfigurationSnapshotWriteFile(job->snapshot, job->path, job->format)) {
+                LogI(TAG, "Exported the running configuration to %s", job->path);
+            } else {
+                LogE(TAG, "Failed to export the running configuration to %s", job->path);
+            }
+
+            break;
+        case StageExportKindTrace:
+            if (TraceExport(job->path)) {
+                LogI(TAG, "Exported the trace to %s", job->path);
+            } else {
+                LogW(TAG, "Failed to export the trace to %s", job->path);
+            }
+
+            break;
+        case StageExportKindRecorder:
+            if (LogDumpRecorder(job->path)) {
+                LogI(TAG, "Dumped the log recorder to %s", job->path);
+            } else {
+                LogW(TAG, "Failed to dump the log recorder to %s", job->path);
+            }
+
+            break;
+    }
+
+    atomic_bool *isExporting = job->isExporting;
+
+    SAFE_DESTROY(job->snapshot, ConfigurationSnapshotDestroy);
+    free(job);
+
+    atomic_store(isExporting, false);
+
+    return NULL;
+}
+
+static void StageJoinExport(StageRef self) {
+    if (!self->hasExportThread) {
+        return;
+    }
+
+    pthread_join(self->exportThread, NULL);
+    self->hasExportThread = false;
+}
+
+
+// MARK: - Diagnostics
+
+void StageDumpTransitions(const StageRef self, int fd) {
+    for (size_t idx = 0; idx < self->totalShows; idx++) {
+        ControllerDumpTransitions(self->shows[idx], fd);
+    }
+}
+
+
+// MARK: - Remote Server
+
+static void StageDidAcceptClient(EventLoopRef eventLoop, EventID serverID, EventID peerID, struct sockaddr *address, void *context) {
+    LogI(TAG, "New client connection %" PRIu16 " on %" PRIu16, peerID, serverID);
+}
+
+static void StageDidReceiveData(EventLoopRef eventLoop, EventID serverID, EventID peerID, const uint8_t *data, size_t dataSize, void * NULLABLE context) {
+    StageRef self = (StageRef)context;
+
+    LogI(TAG, "Client %" PRIu16 "/%" PRIu16 " received %zu bytes", serverID, peerID, dataSize);
+
+    // Each line is a command. Lines split across reads are not reassembled.
+    char command[MAX_COMMAND_SIZE];
+    size_t commandSize = 0;
+
+    for (size_t idx = 0; idx < dataSize; idx++) {
+        char value = (char)data[idx];
+
+        if (value == '\n' || value == '\r') {
+            if (commandSize > 0) {
+                command[commandSize] = '\0';
+                StageHandleCommand(self, command);
+            }
+
+            commandSize = 0;
+        } else if (commandSize < (MAX_COMMAND_SIZE - 1)) {
+            command[commandSize] = value;
+            commandSize += 1;
+        }
+    }
+
+    if (commandSize > 0) {
+        command[commandSize] = '\0';
+        StageHandleCommand(self, command);
+    }
+}
+
+static bool StageShouldAcceptClient(EventLoopRef eventLoop, EventID id, struct sockaddr *address, void *context) {
+    return true;
+}
+
+
+// MARK: - Watchdog
+
+static void StageWatchdogTimerFired(EventLoopRef eventLoop, EventID id, void *context) {
+    StageRef self = (StageRef)context;
+
+    WatchdogPet(self->watchdog);
+}
@@ -0,0 +1,207 @@
+//
+//  Stage.h
+//  Woodpeckers
+//
+//  Created by Stephen H. Gerstacker on 2020-12-12.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#ifndef STAGE_H
+#define STAGE_H
+
+#include "Macros.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "Configuration.h"
+#include "ConfigurationSnapshot.h"
+#include "Controller.h"
+#include "EventLoop.h"
+#include "OutputTable.h"
+#include "TriggerBus.h"
+
+
+BEGIN_DECLS
+
+
+// MARK: - Constants & Globals
+
+/// The Stage object, which runs every show in a process on one shared Event Loop and Output Table.
+typedef struct _Stage * StageRef;
+
+
+// MARK: - Lifecycle Methods
+
+/**
+ * Create a Stage with an empty Output Table and no shows.
+ * \return A new Stage instance.
+ */
+StageRef NONNULL StageCreate(void);
+
+/**
+ * Destroy a Stage, its shows, its outputs, its Event Loop and its Configuration.
+ * \param stage The instance to destroy.
+ */
+void StageDestroy(StageRef NONNULL stage);
+
+
+// MARK: - Running
+
+/**
+ * Run every show on the Stage.
+ * \param stage The instance to run.
+ * \note This will block until the Event Loop is stopped.
+ */
+void StageRun(StageRef NONNULL stage);
+
+/**
+ * Perform any set up tasks for the Stage before running.
+ * \param stage The instance to set up.
+ * \return `true` if the set up succeeded, otherwise `false`.
+ */
+bool StageSetUp(StageRef NONNULL stage);
+
+/**
+ * Perform any tear down tasks for the Stage after running.
+ * \param stage The instance to tear down.
+ */
+void StageTearDown(StageRef NONNULL stage);
+
+
+// MARK: - Properties
+
+/**
+ * Get the Event Loop shared by every show.
+ * \param stage The instance to inspect.
+ * \return The shared Event Loop.
+ */
+EventLoopRef NONNULL StageGetEventLoop(const StageRef NONNULL stage);
+
+/**
+ * Get the Output Table shared by every show.
+ * \param stage The instance to inspect.
+ * \return The shared Output Table.
+ */
+OutputTableRef NONNULL StageGetOutputTable(const StageRef NONNULL stage);
+
+/**
+ * Get the Trigger Bus shared by every show.
+ * \param stage The instance to inspect.
+ * \return The shared Trigger Bus.
+ */
+TriggerBusRef NONNULL StageGetTriggerBus(const StageRef NONNULL stage);
+
+
+// MARK: - Safety
+
+/**
+ * Pet a hardware watchdog from the Event Loop while the Stage runs.
+ * \param stage The instance to modify.
+ * \param path The path to the watchdog device, such as `/dev/watchdog`.
+ * \param interval The time, in milliseconds, between each pet. This must be shorter than the watchdog timeout.
+ * \note The watchdog is opened when the Stage is set up and disarmed when it is torn down. A stalled Event Loop stops petting it, so the board is reset.
+ */
+void StageSetWatchdog(StageRef NONNULL stage, const char * NONNULL path, uint32_t interval);
+
+/**
+ * Write the safe state of every Output and close the watchdog.
+ * \param stage The instance to modify.
+ * \param disarmWatchdog `true` to disarm the watchdog as it is closed, or `false` to leave it armed so the board is reset.
+ * \note This is async-signal-safe, so it may be called when the process is crashing.
+ */
+void StageFailSafe(StageRef NONNULL stage, bool disarmWatchdog);
+
+
+// MARK: - Shows
+
+/**
+ * Add a show to the Stage.
+ * \param stage The instance to modify.
+ * \param name The name of the show.
+ * \return The Controller running the show, owned by the Stage, or `NULL` if the show could not be added.
+ */
+ControllerRef NULLABLE StageAddShow(StageRef NONNULL stage, const char * NONNULL name);
+
+/**
+ * Get the Controller for the show at the given index.
+ * \param stage The instance to inspect.
+ * \param idx The index of the show.
+ * \return The Controller, or `NULL` if the index is invalid.
+ */
+ControllerRef NULLABLE StageGetShow(const StageRef NONNULL stage, size_t idx);
+
+/**
+ * Get the total number of shows on the Stage.
+ * \param stage The instance to inspect.
+ * \return The number of shows.
+ */
+size_t StageGetTotalShows(const StageRef NONNULL stage);
+
+
+// MARK: - Triggers
+
+/**
+ * Publish a schedule trigger periodically while the Stage runs.
+ * \param stage The instance to modify.
+ * \param period The time, in milliseconds, between triggers. This is also the source of the trigger.
+ * \return `true` if the schedule was added or already exists, otherwise `false`.
+ */
+bool StageAddSchedule(StageRef NONNULL stage, uint32_t period);
+
+/**
+ * Publish a trigger and wake the Event Loop to dispatch it.
+ * \param stage The instance to modify.
+ * \param type The type of the trigger.
+ * \param source The source of the trigger.
+ * \return `true` if the trigger was queued, otherwise `false`.
+ * \note Remote clients publish command triggers by sending `trigger <source>` lines.
+ */
+bool StagePublishTrigger(StageRef NONNULL stage, TriggerType type, uint32_t source);
+
+
+// MARK: - Configuration
+
+/**
+ * Keep the Configuration the Stage was built from, so the running model can be exported.
+ * \param stage The instance to modify.
+ * \param configuration The resolved Configuration. The Stage takes ownership of it.
+ * \note The Configuration is never changed once it is kept, so export workers can read it while the Event Loop runs.
+ */
+void StageSetConfiguration(StageRef NONNULL stage, ConfigurationRef NONNULL configuration);
+
+/**
+ * Change a setting of every show while running.
+ * \param stage The instance to modify.
+ * \param name The name of the setting, as it is written in the configuration, such as `MinWait`.
+ * \param value The new value of the setting.
+ * \return `true` if the setting was changed, otherwise `false`.
+ * \note Remote clients change settings by sending `set <name> <value>` lines.
+ */
+bool StageSetSetting(StageRef NONNULL stage, const char * NONNULL name, uint32_t value);
+
+/**
+ * Export the running model to a file without blocking the Event Loop.
+ * \param stage The instance to export.
+ * \param path The path to write to.
+ * \param format The format to write.
+ * \return `true` if the export was started, otherwise `false`.
+ * \note A snapshot is taken immediately and written on a worker thread. Only one export runs at a time, and `trace save` and `recorder` commands share the same worker. Remote clients export by sending `export yaml <path>` or `export image <path>` lines.
+ */
+bool StageExportConfiguration(StageRef NONNULL stage, const char * NONNULL path, ConfigurationSnapshotFormat format);
+
+
+// MARK: - Diagnostics
+
+/**
+ * Write the recent state transitions of every show to a file descriptor.
+ * \param stage The instance to inspect.
+ * \param fd The file descriptor to write to.
+ * \note This is async-signal-safe, so it may be called when the process is crashing.
+ */
+void StageDumpTransitions(const StageRef NONNULL stage, int fd);
+
+END_DECLS
+
+#endif /* STAGE_H */
@@ -0,0 +1,293 @@
+//
+//  Trace.c
+//  Woodpeckers
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include "config.h"
+
+#include "Trace.h"
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+
+// MARK: - Constants & Globals
+
+// NOTE: String arguments are copied, as the names of outputs and shows are freed when the configuration is reloaded
+#define STRING_SIZE 32
+
+typedef struct _TraceEvent {
+    uint64_t timestamp;
+
+    const char *category;
+    const char *name;
+    const char *argumentName;
+    int64_t argument;
+
+    uint8_t phase;
+    bool isString;
+    char string[STRING_SIZE];
+} TraceEvent;
+
+typedef struct _TraceBuffer {
+    // NOTE: Free running event counts, only moved by the owning thread. `tail` moves before the event behind it is overwritten.
+    atomic_size_t head;
+    atomic_size_t tail;
+
+    // NOTE: A buffer is never freed. When its thread exits, the next new thread takes it over, and its track with it.
+    atomic_bool isOwned;
+    struct _TraceBuffer *next;
+
+    uint32_t identifier;
+
+    TraceEvent events[TRACE_BUFFER_EVENTS];
+} TraceBuffer;
+
+static atomic_bool IsEnabled = false;
+
+static _Atomic(TraceBuffer *) Buffers = NULL;
+static atomic_uint TotalBuffers = 0;
+static _Thread_local TraceBuffer *ThreadBuffer = NULL;
+
+static pthread_once_t BufferKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t BufferKey;
+
+
+// MARK: - Prototypes
+
+static TraceBuffer * NULLABLE TraceClaimBuffer(void);
+static void TraceCreateBufferKey(void);
+static void TraceReleaseBuffer(void * NULLABLE buffer);
+static void TraceWrite(TracePhase phase, const char * NONNULL category, const char * NONNULL name, const char * NULLABLE argumentName, const char * NULLABLE string, int64_t argument);
+
+static void TraceWriteEvent(FILE * NONNULL file, const TraceEvent * NONNULL event, int processIdentifier, uint32_t threadIdentifier, bool isFirst);
+static void TraceWriteString(FILE * NONNULL file, const char * NONNULL string);
+
+
+// MARK: - Recording
+
+void TraceEnable(bool enabled) {
+    atomic_store(&IsEnabled, enabled);
+}
+
+void TraceRecord(TracePhase phase, const char *category, const char *name, const char *argumentName, int64_t argument) {
+    TraceWrite(phase, category, name, argumentName, NULL, argument);
+}
+
+void TraceRecordString(TracePhase phase, const char *category, const char *name, const char *argumentName, const char *argument) {
+    TraceWrite(phase, category, name, argumentName, argument, 0);
+}
+
+static TraceBuffer * TraceClaimBuffer(void) {
+    // Take over the buffer of a thread that has exited, if there is one
+    for (TraceBuffer *buffer = atomic_load(&Buffers); buffer != NULL; buffer = buffer->next) {
+        bool isOwned = false;
+
+        if (atomic_compare_exchange_strong(&buffer->isOwned, &isOwned, true)) {
+            return buffer;
+        }
+    }
+
+    TraceBuffer *buffer = (TraceBuffer *)calloc(1, sizeof(TraceBuffer));
+
+    if (buffer == NULL) {
+        return NULL;
+    }
+
+    atomic_init(&buffer->head, 0);
+    atomic_init(&buffer->tail, 0);
+    atomic_init(&buffer->isOwned, true);
+
+    buffer->identifier = atomic_fetch_add(&TotalBuffers, 1) + 1;
+
+    // Buffers are only ever pushed on the front, so an export can walk the list without a lock
+    TraceBuffer *head = atomic_load(&Buffers);
+
+    do {
+        buffer->next = head;
+    } while (!atomic_compare_exchange_weak(&Buffers, &head, buffer));
+
+    return buffer;
+}
+
+static void TraceCreateBufferKey(void) {
+    pthread_key_create(&BufferKey, TraceReleaseBuffer);
+}
+
+static void TraceReleaseBuffer(void *buffer) {
+    if (buffer != NULL) {
+        atomic_store(&((TraceBuffer *)buffer)->isOwned, false);
+    }
+}
+
+static void TraceWrite(TracePhase phase, const char *category, const char *name, const char *argumentName, const char *string, int64_t argument) {
+    if (!atomic_load_explicit(&IsEnabled, memory_order_relaxed)) {
+        return;
+    }
+
+    TraceBuffer *buffer = ThreadBuffer;
+
+    if (buffer == NULL) {
+        buffer = TraceClaimBuffer();
+
+        if (buffer == NULL) {
+            return;
+        }
+
+        ThreadBuffer = buffer;
+
+        pthread_once(&BufferKeyOnce, TraceCreateBufferKey);
+        pthread_setspecific(BufferKey, buffer);
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    size_t head = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+
+    // NOTE: The tail is published before the oldest event is overwritten, pairing with the fence in an export
+    if (head >= TRACE_BUFFER_EVENTS) {
+        atomic_store_explicit(&buffer->tail, head - TRACE_BUFFER_EVENTS + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+    }
+
+    TraceEvent *event = &buffer->events[head & (TRACE_BUFFER_EVENTS - 1)];
+    event->timestamp = (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+    event->category = category;
+    event->name = name;
+    event->argumentName = argumentName;
+    event->argument = argument;
+    event->phase = (uint8_t)phase;
+    event->isString = string != NULL;
+
+    if (string != NULL) {
+        strncpy(event->string, string, STRING_SIZE - 1);
+        event->string[STRING_SIZE - 1] = '\0';
+    }
+
+    atomic_store_explicit(&buffer->head, head + 1, memory_order_release);
+}
+
+
+// MARK: - Exporting
+
+bool TraceExport(const char *path) {
+    FILE *file = fopen(path, "w");
+
+    if (file == NULL) {
+        return false;
+    }
+
+    int processIdentifier = (int)getpid();
+    bool isFirst = true;
+
+    fputs("{\"traceEvents\":[\n", file);
+
+    for (TraceBuffer *buffer = atomic_load(&Buffers); buffer != NULL; buffer = buffer->next) {
+        // Each thread is read up to where it had traced when its buffer is reached
+        size_t end = atomic_load_explicit(&buffer->head, memory_order_acquire);
+        size_t position = atomic_load_explicit(&buffer->tail, memory_order_acquire);
+
+        // NOTE: A span whose start was overwritten has no start to end, so its end is dropped
+        size_t depth = 0;
+
+        for (; position < end; position++) {
+            TraceEvent event = buffer->events[position & (TRACE_BUFFER_EVENTS - 1)];
+            event.string[STRING_SIZE - 1] = '\0';
+
+            // NOTE: An event overwritten while it was copied is skipped, as its thread moved the tail past it first
+            atomic_thread_fence(memory_order_acquire);
+
+            if (atomic_load_explicit(&buffer->tail, memory_order_relaxed) > position) {
+                depth = 0;
+                continue;
+            }
+
+            if (event.phase == TracePhaseBegin) {
+                depth += 1;
+            } else if (event.phase == TracePhaseEnd) {
+                if (depth == 0) {
+                    continue;
+                }
+
+                depth -= 1;
+            }
+
+            TraceWriteEvent(file, &event, processIdentifier, buffer->identifier, isFirst);
+            isFirst = false;
+        }
+    }
+
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", file);
+
+    bool isWritten = !ferror(file);
+
+    if (fclose(file) != 0) {
+        isWritten = false;
+    }
+
+    return isWritten;
+}
+
+static void TraceWriteEvent(FILE *file, const TraceEvent *event, int processIdentifier, uint32_t threadIdentifier, bool isFirst) {
+    static const char *Phases[] = { "B", "E", "i" };
+
+    if (!isFirst) {
+        fputs(",\n", file);
+    }
+
+    // Timestamps are in microseconds, keeping the nanoseconds as a fraction
+    fprintf(file, "{\"ph\":\"%s\",\"ts\":%" PRIu64 ".%03u,\"pid\":%i,\"tid\":%" PRIu32 ",\"cat\":", Phases[event->phase], event->timestamp / 1000, (unsigned int)(event->timestamp % 1000), processIdentifier, threadIdentifier);
+    TraceWriteString(file, event->category);
+
+    fputs(",\"name\":", file);
+    TraceWriteString(file, event->name);
+
+    if (event->phase == TracePhaseInstant) {
+        fputs(",\"s\":\"t\"", file);
+    }
+
+    if (event->argumentName != NULL) {
+        fputs(",\"args\":{", file);
+        TraceWriteString(file, event->argumentName);
+        fputc(':', file);
+
+        if (event->isString) {
+            TraceWriteString(file, event->string);
+        } else {
+            fprintf(file, "%" PRId64, event->argument);
+        }
+
+        fputc('}', file);
+    }
+
+    fputc('}', file);
+}
+
+static void TraceWriteString(FILE *file, const char *string) {
+    fputc('"', file);
+
+    for (const char *current = string; *current != '\0'; current++) {
+        unsigned char character = (unsigned char)*current;
+
+        if (character == '"' || character == '\\') {
+            fputc('\\', file);
+            fputc(character, file);
+        } else if (character < 0x20) {
+            fprintf(file, "\\u%04x", character);
+        } else {
+            fputc(character, file);
+        }
+    }
+
+    fputc('"', file);
+}
@@ -0,0 +1,120 @@
+//
+//  Trace.h
+//  Woodpeckers
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "Macros.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+BEGIN_DECLS
+
+
+// MARK: - Constants & Globals
+
+/// Whether the helper macros record trace events. When `0`, they are compiled away.
+#ifndef WOODPECKERS_TRACE
+#define WOODPECKERS_TRACE 1
+#endif
+
+/// The latest events each thread's trace buffer keeps. It must be a power of two.
+#define TRACE_BUFFER_EVENTS 8192
+
+/// The kind of a trace event.
+typedef enum _TracePhase {
+    TracePhaseBegin = 0, ///< A span starts on the calling thread
+    TracePhaseEnd,       ///< The latest span started on the calling thread ends
+    TracePhaseInstant,   ///< Something happened at a single moment
+} TracePhase;
+
+
+// MARK: - Recording
+
+/**
+ * Enable or disable recording trace events.
+ * \param enabled `true` to record events from the helper macros, otherwise `false`.
+ * \note Does nothing to the helper macros when they are compiled away.
+ */
+void TraceEnable(bool enabled);
+
+/**
+ * Record a trace event with a number.
+ * \param phase The kind of event.
+ * \param category The part of the program the event comes from.
+ * \param name The name of the event.
+ * \param argumentName The name of the number, or `NULL` for an event without one.
+ * \param argument The number.
+ * \note The strings are kept, not copied, so they must outlive the export, as literals do.
+ * \note Each thread copies its events in to its own buffer without locking, overwriting its oldest. Does nothing unless tracing is enabled.
+ */
+void TraceRecord(TracePhase phase, const char * NONNULL category, const char * NONNULL name, const char * NULLABLE argumentName, int64_t argument);
+
+/**
+ * Record a trace event with a string.
+ * \param phase The kind of event.
+ * \param category The part of the program the event comes from.
+ * \param name The name of the event.
+ * \param argumentName The name of the string.
+ * \param argument The string.
+ * \note The argument is copied, cut to 31 bytes. The other strings are kept, so they must outlive the export, as literals do.
+ */
+void TraceRecordString(TracePhase phase, const char * NONNULL category, const char * NONNULL name, const char * NONNULL argumentName, const char * NONNULL argument);
+
+#if WOODPECKERS_TRACE
+
+/// A helper macro to start a span.
+#define TraceBegin(C, N) TraceRecord(TracePhaseBegin, (C), (N), NULL, 0)
+
+/// A helper macro to start a span with a number.
+#define TraceBeginValue(C, N, A, V) TraceRecord(TracePhaseBegin, (C), (N), (A), (int64_t)(V))
+
+/// A helper macro to start a span with a string.
+#define TraceBeginString(C, N, A, S) TraceRecordString(TracePhaseBegin, (C), (N), (A), (S))
+
+/// A helper macro to end the latest span.
+#define TraceEnd(C, N) TraceRecord(TracePhaseEnd, (C), (N), NULL, 0)
+
+/// A helper macro to mark a moment.
+#define TraceInstant(C, N) TraceRecord(TracePhaseInstant, (C), (N), NULL, 0)
+
+/// A helper macro to mark a moment with a number.
+#define TraceInstantValue(C, N, A, V) TraceRecord(TracePhaseInstant, (C), (N), (A), (int64_t)(V))
+
+/// A helper macro to mark a moment with a string.
+#define TraceInstantString(C, N, A, S) TraceRecordString(TracePhaseInstant, (C), (N), (A), (S))
+
+#else
+
+#define TraceBegin(C, N) do { } while (0)
+#define TraceBeginValue(C, N, A, V) do { } while (0)
+#define TraceBeginString(C, N, A, S) do { } while (0)
+#define TraceEnd(C, N) do { } while (0)
+#define TraceInstant(C, N) do { } while (0)
+#define TraceInstantValue(C, N, A, V) do { } while (0)
+#define TraceInstantString(C, N, A, S) do { } while (0)
+
+#endif
+
+
+// MARK: - Exporting
+
+/**
+ * Write the recorded events to a file in the Chrome trace event format.
+ * \param path The file to write. It is replaced if it exists.
+ * \return `true` if the events were written, otherwise `false`.
+ * \note The file opens in `chrome://tracing` and the Perfetto UI. Each thread is its own track, with its spans nested.
+ * \note Threads keep tracing while it runs, and events they overwrite are skipped.
+ * \note Remote clients control tracing by sending `trace start`, `trace stop` and `trace save <path>` lines to the Stage.
+ */
+bool TraceExport(const char * NONNULL path);
+
+END_DECLS
+
+#endif /* TRACE_H */
@@ -0,0 +1,217 @@
+//
+//  TriggerBus.c
+//  Woodpeckers
+//
+//  Created by Stephen H. Gerstacker on 2020-12-14.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include "TriggerBus.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+#include "Log.h"
+
+
+// MARK: - Constants & Globals
+
+#define TAG "TriggerBus"
+
+typedef struct _TriggerBusSubscription {
+    TriggerType type;
+    uint32_t source;
+    TriggerBusHandler handler;
+    void *context;
+} TriggerBusSubscription;
+
+typedef struct _TriggerBus {
+    // NOTE: Collected before compiling, then sorted by type in to `compiled`
+    TriggerBusSubscription *subscriptions;
+    size_t totalSubscriptions;
+
+    // NOTE: The subscriptions for a type are `compiled[offsets[type]]` up to `compiled[offsets[type + 1]]`
+    TriggerBusSubscription *compiled;
+    size_t offsets[TriggerTypeCount + 1];
+    bool isCompiled;
+
+    Trigger queue[TRIGGER_BUS_CAPACITY];
+    size_t queueHead;
+    size_t totalPending;
+    uint64_t totalDropped;
+} TriggerBus;
+
+
+// MARK: - Lifecycle Methods
+
+TriggerBusRef TriggerBusCreate() {
+    TriggerBusRef self = (TriggerBusRef)calloc(1, sizeof(TriggerBus));
+
+    return self;
+}
+
+void TriggerBusDestroy(TriggerBusRef self) {
+    SAFE_DESTROY(self->subscriptions, free);
+    SAFE_DESTROY(self->compiled, free);
+
+    free(self);
+}
+
+
+// MARK: - Subscriptions
+
+bool TriggerBusSubscribe(TriggerBusRef self, TriggerType type, uint32_t source, TriggerBusHandler handler, void *context) {
+    if (self->isCompiled) {
+        LogE(TAG, "Cannot subscribe to %s triggers after the bus is compiled", TriggerTypeToString(type));
+        return false;
+    }
+
+    if (type >= TriggerTypeCount) {
+        LogE(TAG, "Cannot subscribe to invalid trigger type %i", type);
+        return false;
+    }
+
+    self->subscriptions = (TriggerBusSubscription *)realloc(self->subscriptions, sizeof(TriggerBusSubscription) * (self->totalSubscriptions + 1));
+
+    TriggerBusSubscription *subscription = self->subscriptions + self->totalSubscriptions;
+    subscription->type = type;
+    subscription->source = source;
+    subscription->handler = handler;
+    subscription->context = context;
+
+    self->totalSubscriptions += 1;
+
+    return true;
+}
+
+void TriggerBusCompile(TriggerBusRef self) {
+    if (self->isCompiled) {
+        return;
+    }
+
+    // Count the subscriptions of each type, then turn the counts in to offsets
+    size_t counts[TriggerTypeCount];
+    memset(counts, 0, sizeof(counts));
+
+    for (size_t idx = 0; idx < self->totalSubscriptions; idx++) {
+        counts[self->subscriptions[idx].type] += 1;
+    }
+
+    self->offsets[0] = 0;
+
+    for (size_t type = 0; type < TriggerTypeCount; type++) {
+        self->offsets[type + 1] = self->offsets[type] + counts[type];
+    }
+
+    // Place each subscription in its type's list, keeping the subscription order
+    size_t positions[TriggerTypeCount];
+    memcpy(positions, self->offsets, sizeof(positions));
+
+    self->compiled = (TriggerBusSubscription *)calloc(self->totalSubscriptions + 1, sizeof(TriggerBusSubscription));
+
+    for (size_t idx = 0; idx < self->totalSubscriptions; idx++) {
+        TriggerType type = self->subscriptions[idx].type;
+
+        self->compiled[positions[type]] = self->subscriptions[idx];
+        positions[type] += 1;
+    }
+
+    SAFE_DESTROY(self->subscriptions, free);
+    self->isCompiled = true;
+
+    LogI(TAG, "Compiled %zu trigger subscriptions", self->totalSubscriptions);
+}
+
+size_t TriggerBusGetTotalSubscriptions(const TriggerBusRef self, TriggerType type) {
+    if (!self->isCompiled || type >= TriggerTypeCount) {
+        return 0;
+    }
+
+    return self->offsets[type + 1] - self->offsets[type];
+}
+
+
+// MARK: - Publishing
+
+bool TriggerBusPublish(TriggerBusRef self, TriggerType type, uint32_t source) {
+    if (type >= TriggerTypeCount) {
+        LogE(TAG, "Cannot publish invalid trigger type %i", type);
+        return false;
+    }
+
+    if (self->totalPending >= TRIGGER_BUS_CAPACITY) {
+        self->totalDropped += 1;
+        LogW(TAG, "Dropped %s trigger from %" PRIu32 ", the queue is full", TriggerTypeToString(type), source);
+        return false;
+    }
+
+    Trigger *trigger = self->queue + ((self->queueHead + self->totalPending) % TRIGGER_BUS_CAPACITY);
+    trigger->type = type;
+    trigger->source = source;
+
+    self->totalPending += 1;
+
+    return true;
+}
+
+size_t TriggerBusDispatch(TriggerBusRef self) {
+    size_t totalDispatched = 0;
+
+    if (!self->isCompiled) {
+        LogW(TAG, "Cannot dispatch triggers before the bus is compiled");
+        return totalDispatched;
+    }
+
+    while (self->totalPending > 0) {
+        // Copy the trigger out so handlers may publish in to its slot
+        Trigger trigger = self->queue[self->queueHead];
+
+        self->queueHead = (self->queueHead + 1) % TRIGGER_BUS_CAPACITY;
+        self->totalPending -= 1;
+
+        const TriggerBusSubscription *subscription = self->compiled + self->offsets[trigger.type];
+        const TriggerBusSubscription *end = self->compiled + self->offsets[trigger.type + 1];
+
+        for (; subscription < end; subscription++) {
+            if (subscription->source == TRIGGER_SOURCE_ANY || subscription->source == trigger.source) {
+                subscription->handler(&trigger, subscription->context);
+            }
+        }
+
+        totalDispatched += 1;
+    }
+
+    return totalDispatched;
+}
+
+size_t TriggerBusGetTotalPending(const TriggerBusRef self) {
+    return self->totalPending;
+}
+
+uint64_t TriggerBusGetTotalDropped(const TriggerBusRef self) {
+    return self->totalDropped;
+}
+
+
+// MARK: - Utilities
+
+const char * TriggerTypeToString(TriggerType type) {
+    switch (type) {
+        case TriggerTypeInput:
+            return "Input";
+            break;
+        case TriggerTypeCommand:
+            return "Command";
+            break;
+        case TriggerTypeSchedule:
+            return "Schedule";
+            break;
+        case TriggerTypeCue:
+            return "Cue";
+            break;
+        case TriggerTypeCount:
+            break;
+    }
+
+    return "ERROR";
+}
@@ -0,0 +1,149 @@
+//
+//  TriggerBus.h
+//  Woodpeckers
+//
+//  Created by Stephen H. Gerstacker on 2020-12-14.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#ifndef TRIGGER_BUS_H
+#define TRIGGER_BUS_H
+
+#include "Macros.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+
+BEGIN_DECLS
+
+
+// MARK: - Constants & Globals
+
+/// The maximum number of triggers that can wait to be dispatched.
+#define TRIGGER_BUS_CAPACITY 64
+
+/// The source value that subscribes to every source of a trigger type.
+#define TRIGGER_SOURCE_ANY UINT32_MAX
+
+/// The Trigger Bus object, which delivers triggers from their sources to the behaviors that subscribe to them.
+typedef struct _TriggerBus * TriggerBusRef;
+
+/// The kind of source that published a trigger
+typedef enum _TriggerType {
+    TriggerTypeInput = 0, ///< An input changed
+    TriggerTypeCommand,   ///< A remote command was received
+    TriggerTypeSchedule,  ///< A schedule boundary was reached
+    TriggerTypeCue,       ///< A cue was reached
+    TriggerTypeCount,
+} TriggerType;
+
+/// A trigger published on the bus
+typedef struct _Trigger {
+    TriggerType type;
+    uint32_t source;
+} Trigger;
+
+
+// MARK: - Callbacks
+
+/**
+ * Called when a subscribed trigger is dispatched.
+ * \param trigger The trigger that was dispatched.
+ * \param context The opaque context the subscription was made with.
+ */
+typedef void (* TriggerBusHandler)(const Trigger * NONNULL trigger, void * NULLABLE context);
+
+
+// MARK: - Lifecycle Methods
+
+/**
+ * Create an empty Trigger Bus.
+ * \return A new Trigger Bus instance.
+ */
+TriggerBusRef NONNULL TriggerBusCreate(void);
+
+/**
+ * Destroy a Trigger Bus.
+ * \param bus The instance to destroy.
+ */
+void TriggerBusDestroy(TriggerBusRef NONNULL bus);
+
+
+// MARK: - Subscriptions
+
+/**
+ * Subscribe a handler to triggers of a type from a source.
+ * \param bus The instance to modify.
+ * \param type The type of trigger to subscribe to.
+ * \param source The source to subscribe to, or `TRIGGER_SOURCE_ANY` for every source.
+ * \param handler The handler to call when a matching trigger is dispatched.
+ * \param context The opaque context passed to the handler.
+ * \return `true` if the subscription was added, otherwise `false`.
+ * \note Subscriptions can only be added before the bus is compiled.
+ */
+bool TriggerBusSubscribe(TriggerBusRef NONNULL bus, TriggerType type, uint32_t source, TriggerBusHandler NONNULL handler, void * NULLABLE context);
+
+/**
+ * Compile the subscriptions in to per-type lists so dispatching is a few array reads.
+ * \param bus The instance to modify.
+ */
+void TriggerBusCompile(TriggerBusRef NONNULL bus);
+
+/**
+ * Get the number of subscriptions to a trigger type.
+ * \param bus The instance to inspect.
+ * \param type The type of trigger.
+ * \return The number of subscriptions, or `0` if the bus has not been compiled.
+ */
+size_t TriggerBusGetTotalSubscriptions(const TriggerBusRef NONNULL bus, TriggerType type);
+
+
+// MARK: - Publishing
+
+/**
+ * Publish a trigger to be dispatched later.
+ * \param bus The instance to modify.
+ * \param type The type of the trigger.
+ * \param source The source of the trigger.
+ * \return `true` if the trigger was queued, otherwise `false` if the queue was full.
+ * \note This does not allocate. Triggers are published and dispatched on the Event Loop thread.
+ */
+bool TriggerBusPublish(TriggerBusRef NONNULL bus, TriggerType type, uint32_t source);
+
+/**
+ * Dispatch every queued trigger to its subscribers.
+ * \param bus The instance to modify.
+ * \return The number of triggers dispatched.
+ * \note Triggers published by a handler are dispatched in the same call.
+ */
+size_t TriggerBusDispatch(TriggerBusRef NONNULL bus);
+
+/**
+ * Get the number of triggers waiting to be dispatched.
+ * \param bus The instance to inspect.
+ * \return The number of queued triggers.
+ */
+size_t TriggerBusGetTotalPending(const TriggerBusRef NONNULL bus);
+
+/**
+ * Get the number of triggers dropped because the queue was full.
+ * \param bus The instance to inspect.
+ * \return The number of dropped triggers.
+ */
+uint64_t TriggerBusGetTotalDropped(const TriggerBusRef NONNULL bus);
+
+
+// MARK: - Utilities
+
+/**
+ * Get the name of a trigger type.
+ * \param type The type of trigger.
+ * \return The name of the trigger type.
+ */
+const char * NONNULL TriggerTypeToString(TriggerType type);
+
+END_DECLS
+
+#endif /* TRIGGER_BUS_H */
@@ -0,0 +1,112 @@
+//
+//  Watchdog.c
+//  Woodpeckers
+//
+//  Created by Stephen H. Gerstacker on 2020-12-13.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include "Watchdog.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Log.h"
+
+
+// MARK: - Constants & Globals
+
+#define TAG "Watchdog"
+
+#define MAGIC_CLOSE_CHARACTER 'V'
+#define PET_CHARACTER '\n'
+
+typedef struct _Watchdog {
+    char *path;
+    int fd;
+} Watchdog;
+
+
+// MARK: - Lifecycle Methods
+
+WatchdogRef WatchdogCreate(const char *path) {
+    WatchdogRef self = (WatchdogRef)calloc(1, sizeof(Watchdog));
+
+    self->path = strdup(path);
+    self->fd = -1;
+
+    return self;
+}
+
+void WatchdogDestroy(WatchdogRef self) {
+    WatchdogClose(self, false);
+
+    SAFE_DESTROY(self->path, free);
+
+    free(self);
+}
+
+
+// MARK: - Running
+
+bool WatchdogOpen(WatchdogRef self) {
+    if (self->fd != -1) {
+        return true;
+    }
+
+    int fd = open(self->path, O_WRONLY | O_CLOEXEC);
+
+    if (fd == -1) {
+        LogErrno(TAG, errno, "Failed to open watchdog at %s", self->path);
+        return false;
+    }
+
+    self->fd = fd;
+
+    LogI(TAG, "Opened watchdog at %s", self->path);
+
+    return true;
+}
+
+bool WatchdogPet(WatchdogRef self) {
+    if (self->fd == -1) {
+        return false;
+    }
+
+    char buffer = PET_CHARACTER;
+    ssize_t bytesWritten = write(self->fd, &buffer, 1);
+
+    if (bytesWritten != 1) {
+        LogErrno(TAG, errno, "Failed to pet watchdog at %s", self->path);
+        return false;
+    }
+
+    return true;
+}
+
+void WatchdogClose(WatchdogRef self, bool disarm) {
+    int fd = self->fd;
+    self->fd = -1;
+
+    if (fd == -1) {
+        return;
+    }
+
+    if (disarm) {
+        char buffer = MAGIC_CLOSE_CHARACTER;
+        ssize_t result = write(fd, &buffer, 1);
+        (void)result;
+    }
+
+    close(fd);
+}
+
+
+// MARK: - Properties
+
+bool WatchdogIsOpen(const WatchdogRef self) {
+    return self->fd != -1;
+}
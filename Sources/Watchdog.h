@@ -0,0 +1,78 @@
+//
+//  Watchdog.h
+//  Woodpeckers
+//
+//  Created by Stephen H. Gerstacker on 2020-12-13.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include "Macros.h"
+
+#include <stdbool.h>
+
+
+BEGIN_DECLS
+
+
+// MARK: - Constants & Globals
+
+/// The Watchdog object, which pets a hardware watchdog device such as `/dev/watchdog`.
+typedef struct _Watchdog * WatchdogRef;
+
+
+// MARK: - Lifecycle Methods
+
+/**
+ * Create a Watchdog for the device at the given path.
+ * \param path The path to the watchdog device. Any writable file may stand in for testing.
+ * \return A new Watchdog instance.
+ */
+WatchdogRef NONNULL WatchdogCreate(const char * NONNULL path);
+
+/**
+ * Destroy a Watchdog, closing the device without disarming it.
+ * \param watchdog The instance to destroy.
+ */
+void WatchdogDestroy(WatchdogRef NONNULL watchdog);
+
+
+// MARK: - Running
+
+/**
+ * Open the watchdog device, which arms it.
+ * \param watchdog The instance to open.
+ * \return `true` if the device was opened, otherwise `false`.
+ */
+bool WatchdogOpen(WatchdogRef NONNULL watchdog);
+
+/**
+ * Pet the watchdog so that it does not reset the board.
+ * \param watchdog The instance to pet.
+ * \return `true` if the watchdog was pet, otherwise `false`.
+ */
+bool WatchdogPet(WatchdogRef NONNULL watchdog);
+
+/**
+ * Close the watchdog device.
+ * \param watchdog The instance to close.
+ * \param disarm `true` to write the magic close character so the board is not reset, otherwise `false`.
+ * \note This is async-signal-safe, so it may be called when the process is terminating.
+ */
+void WatchdogClose(WatchdogRef NONNULL watchdog, bool disarm);
+
+
+// MARK: - Properties
+
+/**
+ * Is the watchdog device open?
+ * \param watchdog The instance to inspect.
+ * \return `true` if the device is open, otherwise `false`.
+ */
+bool WatchdogIsOpen(const WatchdogRef NONNULL watchdog);
+
+END_DECLS
+
+#endif /* WATCHDOG_H */
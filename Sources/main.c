@@ -10,20 +10,30 @@
 
 #include "Macros.h"
 
+#include <errno.h>
 #include <getopt.h>
 #include <inttypes.h>
+#include <signal.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "Configuration.h"
+#include "ConfigurationLoader.h"
+#include "ConfigurationValidator.h"
 #include "Controller.h"
 #include "Log.h"
+#include "Signals.h"
+#include "Stage.h"
+#include "Trace.h"
 
 
 // MARK: - Constants & Globals
 
-#define MAX_OUTPUTS 16
+#define DEFAULT_RECORDER_PATH "/var/tmp/Woodpeckers.recorder"
+#define DEFAULT_SHOW_NAME "Default"
+#define IMAGE_EXTENSION ".bin"
 #define TAG "Main"
 
 static struct option Options[] = {
@@ -31,12 +41,33 @@ static struct option Options[] = {
     { "help",    no_argument,       NULL, 'h' },
     { "config",  required_argument, NULL, 'c' },
     { "debug",   no_argument,       NULL, 'd' },
+    { "compile-config", no_argument, NULL, 'C' },
+    { "check",   no_argument,       NULL, 't' },
+    { "log",     required_argument, NULL, 'l' },
+    { "decode-log", required_argument, NULL, 'D' },
+    { "coarse-log-clock", no_argument, NULL, 'k' },
+    { "log-file", required_argument, NULL, 'f' },
+    { "log-segments", required_argument, NULL, 'n' },
+    { "log-segment-size", required_argument, NULL, 's' },
+    { "recorder", required_argument, NULL, 'r' },
+    { "trace",   no_argument,       NULL, 'T' },
     { NULL,      0,                 NULL, 0   }
 };
 
 
 // MARK: - Prototypes
 
+static bool AddBird(ControllerRef NONNULL controller, ConfigurationRef NONNULL configuration, size_t birdIdx, size_t showBirdIdx);
+static bool AddShow(StageRef NONNULL stage, ConfigurationRef NONNULL configuration, size_t showIdx);
+static bool AddTrigger(StageRef NONNULL stage, ConfigurationRef NONNULL configuration, size_t triggerIdx);
+static size_t FindShowBird(ConfigurationRef NONNULL configuration, size_t showIdx, uint32_t birdIdx);
+static bool CheckConfiguration(const char * NONNULL configPath);
+static bool DecodeLog(const char * NONNULL logPath);
+static void DumpRecorder(int signal, void * NULLABLE context);
+static void DumpTransitions(int signal, void * NULLABLE context);
+static void FailSafe(int signal, void * NULLABLE context);
+static void RequestStop(int signal, void * NULLABLE context);
+static ConfigurationRef NULLABLE LoadConfiguration(const char * NONNULL configPath, bool compileOnly);
 static void PrintUsage(void);
 static void PrintVersion(void);
 
@@ -46,10 +77,19 @@ static void PrintVersion(void);
 int main(int argc, char **argv) {
     // Parse options
     bool debugMode = false;
+    bool compileConfig = false;
+    bool checkConfig = false;
     char *configPath = NULL;
+    char *logPath = NULL;
+    bool coarseLogClock = false;
+    char *logFilePath = NULL;
+    size_t logSegments = LOG_FILE_DEFAULT_SEGMENTS;
+    size_t logSegmentSize = LOG_FILE_DEFAULT_SEGMENT_SIZE;
+    char *recorderPath = strdup(DEFAULT_RECORDER_PATH);
+    bool trace = false;
 
     while (true) {
-        int result = getopt_long(argc, argv, "vhc:d", Options, NULL);
+        int result = getopt_long(argc, argv, "vhc:dCtl:D:kf:n:s:r:T", Options, NULL);
 
         if (result == -1) {
             break;
@@ -71,6 +111,39 @@ int main(int argc, char **argv) {
             case 'd':
                 debugMode = true;
                 break;
+            case 'C':
+                compileConfig = true;
+                break;
+            case 't':
+                checkConfig = true;
+                break;
+            case 'l':
+                SAFE_DESTROY(logPath, free);
+                logPath = strdup(optarg);
+                break;
+            case 'D':
+                return DecodeLog(optarg) ? EXIT_SUCCESS : EXIT_FAILURE;
+                break;
+            case 'k':
+                coarseLogClock = true;
+                break;
+            case 'f':
+                SAFE_DESTROY(logFilePath, free);
+                logFilePath = strdup(optarg);
+                break;
+            case 'n':
+                logSegments = strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                logSegmentSize = strtoul(optarg, NULL, 10);
+                break;
+            case 'r':
+                SAFE_DESTROY(recorderPath, free);
+                recorderPath = strdup(optarg);
+                break;
+            case 'T':
+                trace = true;
+                break;
 
         }
     }
@@ -81,8 +154,21 @@ int main(int argc, char **argv) {
         return EXIT_FAILURE;
     }
 
+    if (logSegments == 0 || logSegmentSize == 0) {
+        fprintf(stderr, "The log file needs at least one segment of at least one byte\n");
+        return EXIT_FAILURE;
+    }
+
+    // Report every problem in the configuration, without loading it
+    if (checkConfig) {
+        bool isValid = CheckConfiguration(configPath);
+        SAFE_DESTROY(configPath, free);
+
+        return isValid ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
     // Set up logging
-    if (debugMode) {
+    if (debugMode || compileConfig) {
         LogEnableConsoleOutput(true);
         LogEnableSystemOutput(false);
     } else {
@@ -91,27 +177,50 @@ int main(int argc, char **argv) {
     }
 
     LogSetUp(LogLevelVerbose);
+    LogEnableCoarseClock(coarseLogClock);
+
+    // Keep the latest debug messages in memory, whatever the configured levels, for a dump after a problem
+    LogEnableRecorder(true, LogLevelDebug);
+
+    // Tracing can also be started and saved later with Stage commands
+    TraceEnable(trace);
+
+    if (logPath != NULL) {
+        LogEnableBinaryOutput(logPath);
+        SAFE_DESTROY(logPath, free);
+    }
+
+    if (logFilePath != NULL) {
+        LogEnableFileOutput(logFilePath, logSegments, logSegmentSize);
+        SAFE_DESTROY(logFilePath, free);
+    }
 
     LogI(TAG, "Woodpeckers %s", PROJECT_VERSION);
 
     // Load the configuration file
-    ConfigurationRef configuration = ConfigurationCreateFromFile(configPath);
+    ConfigurationRef configuration = LoadConfiguration(configPath, compileConfig);
 
     if (configuration == NULL) {
         LogE(TAG, "Failed to load configuration from %s", configPath);
         return EXIT_FAILURE;
     }
 
-    LogI(TAG, "Loaded configuration from %s", configPath);
+    // Filter the log to the configured levels from here on
+    const char *logLevels = ConfigurationGetLogLevels(configuration);
 
-    // Build the controller
-    ControllerRef controller = ControllerCreate();
+    if (logLevels != NULL) {
+        LogSetTagLevels(logLevels);
+    }
 
-    ControllerSetMinWait(controller, ConfigurationGetMinWait(configuration));
-    ControllerSetMaxWait(controller, ConfigurationGetMaxWait(configuration));
-    ControllerSetMinPecks(controller, ConfigurationGetMinPecks(configuration));
-    ControllerSetMaxPecks(controller, ConfigurationGetMaxPecks(configuration));
-    ControllerSetPeckWait(controller, ConfigurationGetPeckWait(configuration));
+    if (compileConfig) {
+        SAFE_DESTROY(configuration, ConfigurationDestroy);
+        SAFE_DESTROY(configPath, free);
+        return EXIT_SUCCESS;
+    }
+
+    // Build the stage
+    StageRef stage = StageCreate();
+    OutputTableRef outputTable = StageGetOutputTable(stage);
 
     size_t totalOutputs = ConfigurationGetTotalOutputs(configuration);
 
@@ -127,14 +236,14 @@ int main(int argc, char **argv) {
         switch (type) {
             case ConfigurationOutputTypeFile:
                 path = ConfigurationGetOutputPath(configuration, idx);
-                success = ControllerAddFileOutput(controller, name, path);
+                success = OutputTableAddFileOutput(outputTable, name, path);
                 break;
             case ConfigurationOutputTypeGPIO:
                 pin = ConfigurationGetOutputPin(configuration, idx);
-                success = ControllerAddGPIOOutput(controller, name, pin);
+                success = OutputTableAddGPIOOutput(outputTable, name, pin);
                 break;
             case ConfigurationOutputTypeMemory:
-                success = ControllerAddMemoryOutput(controller, name);
+                success = OutputTableAddMemoryOutput(outputTable, name);
                 break;
             default:
                 LogE(TAG, "Unhandled configuration output type: %i", type);
@@ -145,71 +254,403 @@ int main(int argc, char **argv) {
             LogE(TAG, "Failed to add output \"%s\". Aborting.", name);
             return EXIT_FAILURE;
         }
+
+        // Outputs are added in order, so the table's indices are the configuration's
+        size_t outputIdx = idx;
+        OutputRef output = OutputTableGetOutput(outputTable, outputIdx);
+
+        uint32_t minOn = ConfigurationGetOutputMinOn(configuration, idx);
+        uint32_t minOff = ConfigurationGetOutputMinOff(configuration, idx);
+        uint32_t minDwell = ConfigurationGetOutputMinDwell(configuration, idx);
+
+        OutputTableSetLimits(outputTable, outputIdx, minOn, minOff, minDwell);
+
+        switch (ConfigurationGetOutputSafeState(configuration, idx)) {
+            case ConfigurationSafeStateOff:
+                OutputSetSafeState(output, OutputSafeStateOff);
+                break;
+            case ConfigurationSafeStateOn:
+                OutputSetSafeState(output, OutputSafeStateOn);
+                break;
+            case ConfigurationSafeStateHold:
+                OutputSetSafeState(output, OutputSafeStateHold);
+                break;
+        }
     }
 
-    size_t totalBirds = ConfigurationGetTotalBirds(configuration);
+    const char *watchdogPath = ConfigurationGetWatchdogPath(configuration);
 
-    for (size_t birdIdx = 0; birdIdx < totalBirds; birdIdx++) {
-        const char *name = ConfigurationGetBirdName(configuration, birdIdx);
+    if (watchdogPath != NULL) {
+        StageSetWatchdog(stage, watchdogPath, ConfigurationGetWatchdogInterval(configuration));
+    }
 
-        size_t totalStatics = ConfigurationGetBirdTotalStatics(configuration, birdIdx);
-        size_t totalBacks = ConfigurationGetBirdTotalBacks(configuration, birdIdx);
-        size_t totalForwards = ConfigurationGetBirdTotalForwards(configuration, birdIdx);
+    // Build the shows. Without any shows, every bird runs in a single show.
+    size_t totalShows = ConfigurationGetTotalShows(configuration);
 
-        const char *statics[MAX_OUTPUTS];
-        const char *backs[MAX_OUTPUTS];
-        const char *forwards[MAX_OUTPUTS];
+    if (totalShows == 0) {
+        ControllerRef controller = StageAddShow(stage, DEFAULT_SHOW_NAME);
 
-        for (size_t idx = 0; idx < totalStatics; idx++) {
-            statics[idx] = ConfigurationGetBirdStatic(configuration, birdIdx, idx);
-        }
+        ControllerSetMinWait(controller, ConfigurationGetMinWait(configuration));
+        ControllerSetMaxWait(controller, ConfigurationGetMaxWait(configuration));
+        ControllerSetMinPecks(controller, ConfigurationGetMinPecks(configuration));
+        ControllerSetMaxPecks(controller, ConfigurationGetMaxPecks(configuration));
+        ControllerSetPeckWait(controller, ConfigurationGetPeckWait(configuration));
 
-        for (size_t idx = 0; idx < totalBacks; idx++) {
-            backs[idx] = ConfigurationGetBirdBack(configuration, birdIdx, idx);
-        }
+        size_t totalBirds = ConfigurationGetTotalBirds(configuration);
 
-        for (size_t idx = 0; idx < totalForwards; idx++) {
-            forwards[idx] = ConfigurationGetBirdForward(configuration, birdIdx, idx);
+        for (size_t birdIdx = 0; birdIdx < totalBirds; birdIdx++) {
+            if (!AddBird(controller, configuration, birdIdx, birdIdx)) {
+                return EXIT_FAILURE;
+            }
         }
+    } else {
+        for (size_t showIdx = 0; showIdx < totalShows; showIdx++) {
+            if (!AddShow(stage, configuration, showIdx)) {
+                return EXIT_FAILURE;
+            }
+        }
+    }
 
-        bool success = ControllerAddBird(controller, name, statics, totalStatics, backs, totalBacks, forwards, totalForwards);
+    // Connect the triggers to the shows
+    size_t totalTriggers = ConfigurationGetTotalTriggers(configuration);
 
-        if (!success) {
-            LogE(TAG, "Failed to add bird \"%s\". Aborting.", name);
+    for (size_t triggerIdx = 0; triggerIdx < totalTriggers; triggerIdx++) {
+        if (!AddTrigger(stage, configuration, triggerIdx)) {
             return EXIT_FAILURE;
         }
     }
 
-    SAFE_DESTROY(configuration, ConfigurationDestroy);
+    // The stage keeps the configuration, so the running model can be exported
+    StageSetConfiguration(stage, configuration);
+    configuration = NULL;
 
     // Set Up
-    bool success = ControllerSetUp(controller);
+    bool success = StageSetUp(stage);
 
     if (!success) {
-        LogE(TAG, "Failed to set up controller. Aborting.");
+        LogE(TAG, "Failed to set up stage. Aborting.");
         return EXIT_FAILURE;
     }
 
+    // Put the outputs in their safe states and dump the show histories and log recorder on a crash or on request
+    SignalsSetUp();
+    SignalsAddStopHandler(RequestStop, stage);
+    SignalsAddFatalHandler(FailSafe, stage);
+    SignalsAddFatalHandler(DumpTransitions, stage);
+    SignalsAddFatalHandler(DumpRecorder, recorderPath);
+    SignalsAddDumpHandler(DumpTransitions, stage);
+    SignalsAddDumpHandler(DumpRecorder, recorderPath);
+
+    // Keep logging off the event loop while running, dropping messages rather than stalling a show
+    LogEnableAsyncOutput(true, LogOverflowPolicyDrop);
+
     // Run forever
-    ControllerRun(controller);
+    StageRun(stage);
 
-    // Tear Down
+    // Write what is still buffered before tearing down
+    LogEnableAsyncOutput(false, LogOverflowPolicyDrop);
+    LogEnableBinaryOutput(NULL);
+    LogEnableFileOutput(NULL, 0, 0);
+
+    // Tear Down, which puts the outputs in their safe states and disarms the watchdog
     // Clean up
-    ControllerTearDown(controller);
-    ControllerDestroy(controller);
+    StageTearDown(stage);
+    StageDestroy(stage);
+
+    SAFE_DESTROY(recorderPath, free);
 
     return EXIT_SUCCESS;
 }
 
 
+// MARK: - Set Up
+
+static bool AddBird(ControllerRef controller, ConfigurationRef configuration, size_t birdIdx, size_t showBirdIdx) {
+    const char *name = ConfigurationGetBirdName(configuration, birdIdx);
+
+    const uint32_t *statics = ConfigurationGetBirdStaticIndices(configuration, birdIdx);
+    const uint32_t *backs = ConfigurationGetBirdBackIndices(configuration, birdIdx);
+    const uint32_t *forwards = ConfigurationGetBirdForwardIndices(configuration, birdIdx);
+
+    size_t totalStatics = ConfigurationGetBirdTotalStatics(configuration, birdIdx);
+    size_t totalBacks = ConfigurationGetBirdTotalBacks(configuration, birdIdx);
+    size_t totalForwards = ConfigurationGetBirdTotalForwards(configuration, birdIdx);
+
+    bool success = ControllerAddBird(controller, name, statics, totalStatics, backs, totalBacks, forwards, totalForwards);
+
+    if (!success) {
+        LogE(TAG, "Failed to add bird \"%s\". Aborting.", name);
+        return false;
+    }
+
+    // Only birds that override something need their own timing
+    const ConfigurationTiming *configurationTiming = ConfigurationGetBirdTiming(configuration, birdIdx);
+
+    if (configurationTiming == NULL || configurationTiming->overrides == 0) {
+        return true;
+    }
+
+    ControllerTiming timing;
+    memset(&timing, 0, sizeof(ControllerTiming));
+
+    timing.minWait = configurationTiming->minWait;
+    timing.maxWait = configurationTiming->maxWait;
+    timing.minPecks = configurationTiming->minPecks;
+    timing.maxPecks = configurationTiming->maxPecks;
+    timing.peckWait = configurationTiming->peckWait;
+
+    timing.overrides |= (configurationTiming->overrides & ConfigurationTimingOverrideMinWait) ? ControllerTimingOverrideMinWait : 0;
+    timing.overrides |= (configurationTiming->overrides & ConfigurationTimingOverrideMaxWait) ? ControllerTimingOverrideMaxWait : 0;
+    timing.overrides |= (configurationTiming->overrides & ConfigurationTimingOverrideMinPecks) ? ControllerTimingOverrideMinPecks : 0;
+    timing.overrides |= (configurationTiming->overrides & ConfigurationTimingOverrideMaxPecks) ? ControllerTimingOverrideMaxPecks : 0;
+    timing.overrides |= (configurationTiming->overrides & ConfigurationTimingOverridePeckWait) ? ControllerTimingOverridePeckWait : 0;
+
+    return ControllerSetBirdTiming(controller, showBirdIdx, &timing);
+}
+
+static bool AddShow(StageRef stage, ConfigurationRef configuration, size_t showIdx) {
+    const char *name = ConfigurationGetShowName(configuration, showIdx);
+    ControllerRef controller = StageAddShow(stage, name);
+
+    if (controller == NULL) {
+        LogE(TAG, "Failed to add show \"%s\". Aborting.", name);
+        return false;
+    }
+
+    ControllerSetMinWait(controller, ConfigurationGetMinWait(configuration));
+    ControllerSetMaxWait(controller, ConfigurationGetMaxWait(configuration));
+    ControllerSetMinPecks(controller, ConfigurationGetMinPecks(configuration));
+    ControllerSetMaxPecks(controller, ConfigurationGetMaxPecks(configuration));
+    ControllerSetPeckWait(controller, ConfigurationGetPeckWait(configuration));
+
+    const uint32_t *birds = ConfigurationGetShowBirdIndices(configuration, showIdx);
+    size_t totalBirds = ConfigurationGetShowTotalBirds(configuration, showIdx);
+
+    for (size_t idx = 0; idx < totalBirds; idx++) {
+        if (!AddBird(controller, configuration, birds[idx], idx)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+static bool AddTrigger(StageRef stage, ConfigurationRef configuration, size_t triggerIdx) {
+    const char *name = ConfigurationGetTriggerName(configuration, triggerIdx);
+    uint32_t showIdx = ConfigurationGetTriggerShowIndex(configuration, triggerIdx);
+    uint32_t birdIdx = ConfigurationGetTriggerBirdIndex(configuration, triggerIdx);
+    uint32_t source = ConfigurationGetTriggerSource(configuration, triggerIdx);
+
+    TriggerType type = TriggerTypeCount;
+
+    switch (ConfigurationGetTriggerType(configuration, triggerIdx)) {
+        case ConfigurationTriggerTypeInput:
+            type = TriggerTypeInput;
+            break;
+        case ConfigurationTriggerTypeCommand:
+            type = TriggerTypeCommand;
+            break;
+        case ConfigurationTriggerTypeSchedule:
+            type = TriggerTypeSchedule;
+            break;
+        case ConfigurationTriggerTypeCue:
+            type = TriggerTypeCue;
+            break;
+        case ConfigurationTriggerTypeUnknown:
+            LogE(TAG, "Trigger \"%s\" has an unknown type. Aborting.", name);
+            return false;
+    }
+
+    ControllerTriggerAction action = ControllerTriggerActionPeck;
+
+    switch (ConfigurationGetTriggerAction(configuration, triggerIdx)) {
+        case ConfigurationTriggerActionPeck:
+            action = ControllerTriggerActionPeck;
+            break;
+        case ConfigurationTriggerActionStart:
+            action = ControllerTriggerActionStart;
+            break;
+        case ConfigurationTriggerActionStop:
+            action = ControllerTriggerActionStop;
+            break;
+    }
+
+    if (type == TriggerTypeSchedule && !StageAddSchedule(stage, source)) {
+        LogE(TAG, "Failed to add the schedule for trigger \"%s\". Aborting.", name);
+        return false;
+    }
+
+    // Shows were added in order, so the stage's indices are the configuration's. Without a show, the trigger acts on every show.
+    size_t totalShows = StageGetTotalShows(stage);
+
+    for (size_t stageShowIdx = 0; stageShowIdx < totalShows; stageShowIdx++) {
+        if (showIdx != CONFIGURATION_INDEX_NONE && showIdx != stageShowIdx) {
+            continue;
+        }
+
+        size_t showBirdIdx = CONTROLLER_NEXT_BIRD;
+
+        if (birdIdx != CONFIGURATION_INDEX_NONE) {
+            showBirdIdx = (ConfigurationGetTotalShows(configuration) == 0) ? birdIdx : FindShowBird(configuration, stageShowIdx, birdIdx);
+        }
+
+        ControllerRef controller = StageGetShow(stage, stageShowIdx);
+
+        if (!ControllerSubscribe(controller, StageGetTriggerBus(stage), type, source, action, showBirdIdx)) {
+            LogE(TAG, "Failed to add trigger \"%s\". Aborting.", name);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static size_t FindShowBird(ConfigurationRef configuration, size_t showIdx, uint32_t birdIdx) {
+    const uint32_t *birds = ConfigurationGetShowBirdIndices(configuration, showIdx);
+    size_t totalBirds = ConfigurationGetShowTotalBirds(configuration, showIdx);
+
+    // A show numbers its birds in the order it lists them
+    for (size_t idx = 0; idx < totalBirds; idx++) {
+        if (birds[idx] == birdIdx) {
+            return idx;
+        }
+    }
+
+    return CONTROLLER_NEXT_BIRD;
+}
+
+
+// MARK: - Signals
+
+static void DumpRecorder(int signal, void *context) {
+    const char *path = (const char *)context;
+
+    if (LogDumpRecorder(path)) {
+        SignalsWriteString(STDERR_FILENO, "Log recorder dumped to ");
+    } else {
+        SignalsWriteString(STDERR_FILENO, "Failed to dump the log recorder to ");
+    }
+
+    SignalsWriteString(STDERR_FILENO, path);
+    SignalsWriteString(STDERR_FILENO, "\n");
+}
+
+static void DumpTransitions(int signal, void *context) {
+    StageRef stage = (StageRef)context;
+    StageDumpTransitions(stage, STDERR_FILENO);
+}
+
+static void FailSafe(int signal, void *context) {
+    StageRef stage = (StageRef)context;
+
+    // Only an orderly stop disarms the watchdog. After a crash, the board should be reset.
+    StageFailSafe(stage, false);
+}
+
+static void RequestStop(int signal, void *context) {
+    StageRef stage = (StageRef)context;
+
+    // The run returns and the process tears down as usual
+    EventLoopStop(StageGetEventLoop(stage));
+}
+
+
 // MARK: - Utilities
 
+static bool DecodeLog(const char *logPath) {
+    FILE *input = fopen(logPath, "rb");
+
+    if (input == NULL) {
+        fprintf(stderr, "Failed to open %s: %s\n", logPath, strerror(errno));
+        return false;
+    }
+
+    bool isDecoded = LogDecode(input, stdout);
+    fclose(input);
+
+    if (!isDecoded) {
+        fprintf(stderr, "%s is not a binary log, or is damaged\n", logPath);
+    }
+
+    return isDecoded;
+}
+
+static bool CheckConfiguration(const char *configPath) {
+    ConfigurationValidatorRef validator = ConfigurationValidatorCreate();
+
+    bool isValid = ConfigurationValidatorCheckFile(validator, configPath);
+    ConfigurationValidatorDumpDiagnostics(validator, STDERR_FILENO);
+
+    if (isValid) {
+        fprintf(stderr, "%s is valid\n", configPath);
+    } else {
+        fprintf(stderr, "%s has %zu problem(s)\n", configPath, ConfigurationValidatorGetTotalDiagnostics(validator));
+    }
+
+    ConfigurationValidatorDestroy(validator);
+
+    return isValid;
+}
+
+static ConfigurationRef LoadConfiguration(const char *configPath, bool compileOnly) {
+    size_t imagePathSize = strlen(configPath) + strlen(IMAGE_EXTENSION) + 1;
+    char imagePath[imagePathSize];
+    snprintf(imagePath, imagePathSize, "%s%s", configPath, IMAGE_EXTENSION);
+
+    uint64_t sourceHash = 0;
+
+    if (!ConfigurationHashFile(configPath, &sourceHash)) {
+        return NULL;
+    }
+
+    // Prefer the compiled image when it was compiled from these exact files
+    if (!compileOnly && access(imagePath, R_OK) == 0) {
+        ConfigurationRef configuration = ConfigurationCreateFromImage(imagePath, sourceHash);
+
+        if (configuration != NULL) {
+            LogI(TAG, "Loaded configuration from %s", imagePath);
+            return configuration;
+        }
+
+        LogW(TAG, "Ignoring configuration image %s", imagePath);
+    }
+
+    ConfigurationLoaderRef loader = ConfigurationLoaderCreate(configPath);
+    ConfigurationRef configuration = ConfigurationLoaderLoad(loader);
+    ConfigurationLoaderDestroy(loader);
+
+    if (configuration == NULL) {
+        return NULL;
+    }
+
+    LogI(TAG, "Loaded configuration from %s", configPath);
+
+    // The root file is the first source. Its hash is the one it had when it was parsed.
+    if (compileOnly && !ConfigurationWriteImage(configuration, imagePath, ConfigurationGetSourceHash(configuration, 0))) {
+        SAFE_DESTROY(configuration, ConfigurationDestroy);
+        return NULL;
+    }
+
+    return configuration;
+}
+
 static void PrintUsage() {
     printf("Usage: Woodpeckers [options]\n");
     printf("    -v, --version             Print the version number\n");
     printf("    -h, --help                Print this help message\n");
     printf("    -c, --config=CONFIG       Path to the required config file\n");
     printf("    -d, --debug               Run in debug mode\n");
+    printf("    -C, --compile-config      Compile the config file to CONFIG.bin and exit\n");
+    printf("    -t, --check               Report every problem in the config file and its includes, then exit\n");
+    printf("    -l, --log=LOG             Append a binary log to LOG\n");
+    printf("    -D, --decode-log=LOG      Print a binary log as text and exit\n");
+    printf("    -k, --coarse-log-clock    Timestamp the log with a cheaper, less precise clock\n");
+    printf("    -f, --log-file=PATH       Write the text log to rotating segments named PATH.0, PATH.1 and so on\n");
+    printf("    -n, --log-segments=COUNT  The number of log file segments (default %d)\n", LOG_FILE_DEFAULT_SEGMENTS);
+    printf("    -s, --log-segment-size=N  The size of each log file segment in bytes (default %d)\n", LOG_FILE_DEFAULT_SEGMENT_SIZE);
+    printf("    -r, --recorder=PATH       Dump the latest debug messages to PATH on a crash or SIGUSR1 (default %s)\n", DEFAULT_RECORDER_PATH);
+    printf("    -T, --trace               Trace the loop, outputs and shows from the start, saved with \"trace save PATH\"\n");
 }
 
 static void PrintVersion() {
@@ -0,0 +1,86 @@
+//
+//  ArenaTest.cpp
+//  Woodpeckers Tests
+//
+//  Created by Stephen H. Gerstacker on 2020-12-15.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+#include <Arena.h>
+
+class ArenaTest : public ::testing::Test {
+
+    protected:
+
+    void SetUp() override {
+        arena = ArenaCreate(64);
+    }
+
+    void TearDown() override {
+        SAFE_DESTROY(arena, ArenaDestroy);
+    }
+
+    ArenaRef arena;
+
+};
+
+TEST_F(ArenaTest, AllocatesAlignedZeroedMemory) {
+    uint8_t *first = (uint8_t *)ArenaAllocate(arena, 3);
+    uint8_t *second = (uint8_t *)ArenaAllocate(arena, 5);
+
+    ASSERT_EQ((uintptr_t)first % ARENA_ALIGNMENT, 0);
+    ASSERT_EQ((uintptr_t)second % ARENA_ALIGNMENT, 0);
+    ASSERT_GE(second, first + 3);
+
+    for (size_t idx = 0; idx < 5; idx++) {
+        ASSERT_EQ(second[idx], 0);
+    }
+
+    ASSERT_EQ(ArenaGetTotalAllocations(arena), 1);
+}
+
+TEST_F(ArenaTest, GrowsGeometrically) {
+    for (size_t idx = 0; idx < 1024; idx++) {
+        ArenaAllocate(arena, 64);
+    }
+
+    ASSERT_EQ(ArenaGetUsedSize(arena), 1024 * 64);
+
+    // 64 KB from a 64 byte start takes a handful of doubling blocks, not one per allocation
+    ASSERT_LE(ArenaGetTotalAllocations(arena), 12);
+}
+
+TEST_F(ArenaTest, InternsStrings) {
+    const char *first = ArenaIntern(arena, "Left Static 1 and more", 13);
+    const char *second = ArenaIntern(arena, "Left Static 1", 13);
+    const char *third = ArenaIntern(arena, "Left Static", 11);
+
+    ASSERT_STREQ(first, "Left Static 1");
+    ASSERT_EQ(first, second);
+    ASSERT_NE(first, third);
+    ASSERT_STREQ(third, "Left Static");
+
+    ArenaReleaseInterning(arena);
+
+    ASSERT_STREQ(first, "Left Static 1");
+}
+
+TEST_F(ArenaTest, AppendsToArrays) {
+    size_t capacity = 0;
+    uint32_t *values = nullptr;
+
+    for (uint32_t idx = 0; idx < 1000; idx++) {
+        values = (uint32_t *)ArenaAppend(arena, values, sizeof(uint32_t), idx, &capacity);
+        values[idx] = idx;
+    }
+
+    ASSERT_GE(capacity, 1000);
+
+    for (uint32_t idx = 0; idx < 1000; idx++) {
+        ASSERT_EQ(values[idx], idx);
+    }
+}
@@ -0,0 +1,335 @@
+//
+//  ConfigurationLoaderTest.cpp
+//  Woodpeckers Tests
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <ConfigurationLoader.h>
+#include <Log.h>
+
+class ConfigurationLoaderTest : public ::testing::Test {
+
+    protected:
+
+    static void LogMessage(LogLevel level, const char *tag, const char *message) {
+        std::cerr << "[          ] [" << tag << "/" << message << std::endl;
+
+        LoggedMessages.push_back({ std::this_thread::get_id(), message });
+    }
+
+    void SetUp() override {
+        configuration = nullptr;
+        loader = nullptr;
+
+        char path[] = "/tmp/ConfigurationLoaderTest.XXXXXX";
+        ASSERT_NE(mkdtemp(path), nullptr);
+        directory = path;
+
+        LoggedMessages.clear();
+
+        LogEnableCallbackOutput(true, LogMessage);
+        LogEnableConsoleOutput(false);
+        LogEnableSystemOutput(false);
+    }
+
+    void TearDown() override {
+        SAFE_DESTROY(configuration, ConfigurationDestroy);
+        SAFE_DESTROY(loader, ConfigurationLoaderDestroy);
+
+        for (const std::string &name : files) {
+            unlink((directory + "/" + name).c_str());
+        }
+
+        rmdir(directory.c_str());
+    }
+
+    // Write a file with a given modification time, so changes are seen even within the same clock tick
+    void WriteFile(const std::string &name, const std::string &contents, time_t modifiedTime) {
+        std::string path = directory + "/" + name;
+
+        std::ofstream stream(path);
+        stream << contents;
+        stream.close();
+
+        struct timespec times[2] = { { modifiedTime, 0 }, { modifiedTime, 0 } };
+        utimensat(AT_FDCWD, path.c_str(), times, 0);
+
+        files.push_back(name);
+    }
+
+    std::string RootPath() {
+        return directory + "/root.yml";
+    }
+
+    ConfigurationRef configuration;
+    ConfigurationLoaderRef loader;
+
+    std::string directory;
+    std::vector<std::string> files;
+
+    static std::vector<std::pair<std::thread::id, std::string>> LoggedMessages;
+
+};
+
+std::vector<std::pair<std::thread::id, std::string>> ConfigurationLoaderTest::LoggedMessages;
+
+static const char *RootSource =
+    "%YAML 1.1\n"
+    "---\n"
+    "\n"
+    "Include:\n"
+    "  - outputs.yml\n"
+    "  - birds.yml\n"
+    "\n"
+    "Settings:\n"
+    "  MinWait: 2000\n";
+
+static const char *OutputsSource =
+    "%YAML 1.1\n"
+    "---\n"
+    "\n"
+    "Outputs:\n"
+    "  - Static:\n"
+    "    Type: Memory\n"
+    "  - Back:\n"
+    "    Type: Memory\n";
+
+static const char *BirdsSource =
+    "%YAML 1.1\n"
+    "---\n"
+    "\n"
+    "Settings:\n"
+    "  MaxWait: 8000\n"
+    "\n"
+    "Birds:\n"
+    "  - Left:\n"
+    "    Static:\n"
+    "      - Static\n"
+    "    Back:\n"
+    "      - Back\n";
+
+TEST_F(ConfigurationLoaderTest, MergesIncludes) {
+    WriteFile("root.yml", RootSource, 1000);
+    WriteFile("outputs.yml", OutputsSource, 1000);
+    WriteFile("birds.yml", BirdsSource, 1000);
+
+    loader = ConfigurationLoaderCreate(RootPath().c_str());
+    configuration = ConfigurationLoaderLoad(loader);
+    ASSERT_NE(configuration, nullptr);
+
+    ASSERT_EQ(ConfigurationGetMinWait(configuration), 2000);
+    ASSERT_EQ(ConfigurationGetMaxWait(configuration), 8000);
+
+    ASSERT_EQ(ConfigurationGetTotalOutputs(configuration), 2);
+    ASSERT_STREQ(ConfigurationGetOutputName(configuration, 0), "Static");
+    ASSERT_EQ(ConfigurationGetTotalBirds(configuration), 1);
+    ASSERT_STREQ(ConfigurationGetBirdBack(configuration, 0, 0), "Back");
+
+    ASSERT_EQ(ConfigurationGetTotalIncludes(configuration), 0);
+    ASSERT_EQ(ConfigurationGetTotalSources(configuration), 3);
+    ASSERT_NE(strstr(ConfigurationGetSourcePath(configuration, 0), "root.yml"), nullptr);
+    ASSERT_NE(strstr(ConfigurationGetSourcePath(configuration, 1), "outputs.yml"), nullptr);
+    ASSERT_NE(strstr(ConfigurationGetSourcePath(configuration, 2), "birds.yml"), nullptr);
+    ASSERT_EQ(ConfigurationGetSourceHash(configuration, 1), ConfigurationHashBytes(OutputsSource, strlen(OutputsSource)));
+
+    ASSERT_EQ(ConfigurationLoaderGetTotalParsed(loader), 3);
+}
+
+TEST_F(ConfigurationLoaderTest, ReparsesOnlyChangedFiles) {
+    WriteFile("root.yml", RootSource, 1000);
+    WriteFile("outputs.yml", OutputsSource, 1000);
+    WriteFile("birds.yml", BirdsSource, 1000);
+
+    loader = ConfigurationLoaderCreate(RootPath().c_str());
+    configuration = ConfigurationLoaderLoad(loader);
+    ASSERT_NE(configuration, nullptr);
+    SAFE_DESTROY(configuration, ConfigurationDestroy);
+
+    // Nothing changed
+    configuration = ConfigurationLoaderLoad(loader);
+    ASSERT_NE(configuration, nullptr);
+    ASSERT_EQ(ConfigurationLoaderGetTotalParsed(loader), 0);
+    SAFE_DESTROY(configuration, ConfigurationDestroy);
+
+    // Touched, but the same contents
+    WriteFile("birds.yml", BirdsSource, 2000);
+
+    configuration = ConfigurationLoaderLoad(loader);
+    ASSERT_NE(configuration, nullptr);
+    ASSERT_EQ(ConfigurationLoaderGetTotalParsed(loader), 0);
+    SAFE_DESTROY(configuration, ConfigurationDestroy);
+
+    // One file changed
+    std::string outputs = std::string(OutputsSource) + "  - Forward:\n    Type: Memory\n";
+    WriteFile("outputs.yml", outputs, 3000);
+
+    configuration = ConfigurationLoaderLoad(loader);
+    ASSERT_NE(configuration, nullptr);
+    ASSERT_EQ(ConfigurationLoaderGetTotalParsed(loader), 1);
+    ASSERT_EQ(ConfigurationGetTotalOutputs(configuration), 3);
+    ASSERT_STREQ(ConfigurationGetOutputName(configuration, 2), "Forward");
+    ASSERT_EQ(ConfigurationGetTotalBirds(configuration), 1);
+}
+
+TEST_F(ConfigurationLoaderTest, FailsOnIncludeCycle) {
+    WriteFile("root.yml", "Include: other.yml\n", 1000);
+    WriteFile("other.yml", "Include: root.yml\n", 1000);
+
+    loader = ConfigurationLoaderCreate(RootPath().c_str());
+    configuration = ConfigurationLoaderLoad(loader);
+    ASSERT_EQ(configuration, nullptr);
+}
+
+TEST_F(ConfigurationLoaderTest, FailsOnMissingInclude) {
+    WriteFile("root.yml", "Include: missing.yml\n", 1000);
+
+    loader = ConfigurationLoaderCreate(RootPath().c_str());
+    configuration = ConfigurationLoaderLoad(loader);
+    ASSERT_EQ(configuration, nullptr);
+}
+
+TEST_F(ConfigurationLoaderTest, FailsOnSettingInTwoFiles) {
+    WriteFile("root.yml", "Include: other.yml\nSettings:\n  MinWait: 10\n", 1000);
+    WriteFile("other.yml", "Settings:\n  MinWait: 20\n", 1000);
+
+    loader = ConfigurationLoaderCreate(RootPath().c_str());
+    configuration = ConfigurationLoaderLoad(loader);
+    ASSERT_EQ(configuration, nullptr);
+}
+
+TEST_F(ConfigurationLoaderTest, FailsOnOutputInTwoFiles) {
+    WriteFile("root.yml", "Include: other.yml\nOutputs:\n  - Static:\n    Type: Memory\n", 1000);
+    WriteFile("other.yml", "Outputs:\n  - Static:\n    Type: Memory\n", 1000);
+
+    loader = ConfigurationLoaderCreate(RootPath().c_str());
+    configuration = ConfigurationLoaderLoad(loader);
+    ASSERT_EQ(configuration, nullptr);
+}
+
+TEST_F(ConfigurationLoaderTest, ParallelLoadMatchesSerialLoad) {
+    // Large enough that each file is split in to several chunks
+    std::string outputs = "Outputs:\n";
+    std::string birds = "Birds:\n";
+
+    for (int idx = 0; idx < 4000; idx++) {
+        outputs += "  - Output " + std::to_string(idx) + ":\n    Type: Memory\n";
+    }
+
+    for (int idx = 0; idx < 2000; idx++) {
+        birds += "  - Bird " + std::to_string(idx) + ":\n    Static:\n      - Output " + std::to_string(idx * 2) + "\n";
+    }
+
+    ASSERT_GT(outputs.size(), CONFIGURATION_LOADER_CHUNK_SIZE);
+
+    WriteFile("root.yml", "Include:\n  - outputs.yml\n  - birds.yml\n", 1000);
+    WriteFile("outputs.yml", outputs, 1000);
+    WriteFile("birds.yml", birds, 1000);
+
+    loader = ConfigurationLoaderCreate(RootPath().c_str());
+    ConfigurationLoaderSetTotalThreads(loader, 1);
+    ASSERT_EQ(ConfigurationLoaderGetTotalThreads(loader), 1);
+
+    ConfigurationRef serial = ConfigurationLoaderLoad(loader);
+    ASSERT_NE(serial, nullptr);
+    SAFE_DESTROY(loader, ConfigurationLoaderDestroy);
+
+    loader = ConfigurationLoaderCreate(RootPath().c_str());
+    ConfigurationLoaderSetTotalThreads(loader, 4);
+    ASSERT_EQ(ConfigurationLoaderGetTotalThreads(loader), 4);
+
+    configuration = ConfigurationLoaderLoad(loader);
+    ASSERT_NE(configuration, nullptr);
+
+    ASSERT_EQ(ConfigurationGetTotalOutputs(configuration), 4000);
+    ASSERT_EQ(ConfigurationGetTotalOutputs(configuration), ConfigurationGetTotalOutputs(serial));
+    ASSERT_EQ(ConfigurationGetTotalBirds(configuration), 2000);
+    ASSERT_EQ(ConfigurationGetTotalBirds(configuration), ConfigurationGetTotalBirds(serial));
+
+    for (size_t idx = 0; idx < ConfigurationGetTotalOutputs(serial); idx++) {
+        ASSERT_STREQ(ConfigurationGetOutputName(configuration, idx), ConfigurationGetOutputName(serial, idx));
+    }
+
+    for (size_t idx = 0; idx < ConfigurationGetTotalBirds(serial); idx++) {
+        ASSERT_STREQ(ConfigurationGetBirdName(configuration, idx), ConfigurationGetBirdName(serial, idx));
+    }
+
+    ASSERT_EQ(ConfigurationGetSourceHash(configuration, 1), ConfigurationGetSourceHash(serial, 1));
+
+    ConfigurationDestroy(serial);
+}
+
+TEST_F(ConfigurationLoaderTest, LogsParseErrorsFromTheLoadingThread) {
+    // Several chunks have a bad output, so several workers fail
+    std::string outputs = "Outputs:\n";
+
+    for (int idx = 0; idx < 20000; idx++) {
+        const char *type = (idx % 1000 == 999) ? "Bogus" : "Memory";
+        outputs += "  - Output " + std::to_string(idx) + ":\n    Type: " + type + "\n";
+    }
+
+    ASSERT_GT(outputs.size(), CONFIGURATION_LOADER_CHUNK_SIZE);
+
+    WriteFile("root.yml", outputs, 1000);
+
+    loader = ConfigurationLoaderCreate(RootPath().c_str());
+    ConfigurationLoaderSetTotalThreads(loader, 4);
+
+    configuration = ConfigurationLoaderLoad(loader);
+    ASSERT_EQ(configuration, nullptr);
+
+    size_t totalTypeErrors = 0;
+
+    for (const auto &logged : LoggedMessages) {
+        ASSERT_EQ(logged.first, std::this_thread::get_id()) << logged.second;
+
+        if (logged.second == "Unhandled output type: Bogus") {
+            totalTypeErrors += 1;
+        }
+    }
+
+    ASSERT_GT(totalTypeErrors, 1u);
+}
+
+TEST_F(ConfigurationLoaderTest, CompiledImageTracksIncludes) {
+    WriteFile("root.yml", RootSource, 1000);
+    WriteFile("outputs.yml", OutputsSource, 1000);
+    WriteFile("birds.yml", BirdsSource, 1000);
+    files.push_back("root.yml.bin");
+
+    std::string imagePath = RootPath() + ".bin";
+
+    loader = ConfigurationLoaderCreate(RootPath().c_str());
+    configuration = ConfigurationLoaderLoad(loader);
+    ASSERT_NE(configuration, nullptr);
+
+    uint64_t rootHash = ConfigurationGetSourceHash(configuration, 0);
+    ASSERT_TRUE(ConfigurationWriteImage(configuration, imagePath.c_str(), rootHash));
+    SAFE_DESTROY(configuration, ConfigurationDestroy);
+
+    configuration = ConfigurationCreateFromImage(imagePath.c_str(), rootHash);
+    ASSERT_NE(configuration, nullptr);
+    ASSERT_EQ(ConfigurationGetTotalSources(configuration), 3);
+    ASSERT_EQ(ConfigurationGetTotalBirds(configuration), 1);
+    SAFE_DESTROY(configuration, ConfigurationDestroy);
+
+    // Changing an included file makes the image stale, even though the root is the same
+    WriteFile("birds.yml", std::string(BirdsSource) + "  - Right:\n    Static:\n      - Static\n", 2000);
+
+    configuration = ConfigurationCreateFromImage(imagePath.c_str(), rootHash);
+    ASSERT_EQ(configuration, nullptr);
+}
@@ -0,0 +1,199 @@
+//
+//  ConfigurationSnapshotTest.cpp
+//  Woodpeckers Tests
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+
+#include <unistd.h>
+
+#include <Configuration.h>
+#include <ConfigurationSnapshot.h>
+
+static const char *ConfigurationString =
+    "Settings:\n"
+    "  MinWait: 100\n"
+    "  MaxWait: 200\n"
+    "  Watchdog: /dev/watchdog\n"
+    "  WatchdogInterval: 250\n"
+    "  LogLevels: EventLoop=warn\n"
+    "\n"
+    "Outputs:\n"
+    "  - \"Static: #1\":\n"
+    "    Type: File\n"
+    "    Path: /tmp/static\n"
+    "    SafeState: Hold\n"
+    "  - Wing $:\n"
+    "    Type: GPIO\n"
+    "    Range: 0..2\n"
+    "    Pin: 4\n"
+    "    PinStep: 2\n"
+    "    MinOn: 50\n"
+    "\n"
+    "Birds:\n"
+    "  - Bird $:\n"
+    "    Range: 0..2\n"
+    "    Static:\n"
+    "      - \"Static: #1\"\n"
+    "    Back:\n"
+    "      - Wing $\n"
+    "    PeckWait: 80\n"
+    "\n"
+    "Groups:\n"
+    "  - Front:\n"
+    "    Birds:\n"
+    "      - Bird 0\n"
+    "    MaxPecks: 7\n"
+    "\n"
+    "Shows:\n"
+    "  - Porch:\n"
+    "    Birds:\n"
+    "      - Bird 2\n"
+    "      - Bird 0\n"
+    "\n"
+    "Triggers:\n"
+    "  - Doorbell:\n"
+    "    Type: Command\n"
+    "    Source: 7\n"
+    "    Show: Porch\n"
+    "    Bird: Bird 0\n"
+    "  - Nightly:\n"
+    "    Type: Schedule\n"
+    "    Source: 60000\n"
+    "    Action: Stop\n";
+
+class ConfigurationSnapshotTest : public ::testing::Test {
+
+    protected:
+
+    void SetUp() override {
+        configuration = ConfigurationCreateFromString(ConfigurationString);
+        ASSERT_NE(configuration, nullptr);
+        ASSERT_TRUE(ConfigurationResolve(configuration));
+
+        char path[] = "/tmp/ConfigurationSnapshotTest.XXXXXX";
+        int fd = mkstemp(path);
+        ASSERT_NE(fd, -1);
+        close(fd);
+
+        yamlPath = path;
+        imagePath = yamlPath + ".bin";
+    }
+
+    void TearDown() override {
+        SAFE_DESTROY(snapshot, ConfigurationSnapshotDestroy);
+        SAFE_DESTROY(configuration, ConfigurationDestroy);
+
+        unlink(yamlPath.c_str());
+        unlink(imagePath.c_str());
+    }
+
+    // Check that a configuration describes the same model as the one the snapshot was taken from
+    void ExpectSameModel(ConfigurationRef copy) {
+        ASSERT_TRUE(ConfigurationIsResolved(copy));
+
+        ASSERT_EQ(ConfigurationGetTotalOutputs(copy), 4);
+        ASSERT_STREQ(ConfigurationGetOutputName(copy, 0), "Static: #1");
+        ASSERT_EQ(ConfigurationGetOutputType(copy, 0), ConfigurationOutputTypeFile);
+        ASSERT_STREQ(ConfigurationGetOutputPath(copy, 0), "/tmp/static");
+        ASSERT_EQ(ConfigurationGetOutputSafeState(copy, 0), ConfigurationSafeStateHold);
+        ASSERT_STREQ(ConfigurationGetOutputName(copy, 3), "Wing 2");
+        ASSERT_EQ(ConfigurationGetOutputPin(copy, 3), 8);
+        ASSERT_EQ(ConfigurationGetOutputMinOn(copy, 3), 50);
+
+        ASSERT_EQ(ConfigurationGetTotalBirds(copy), 3);
+        ASSERT_STREQ(ConfigurationGetBirdName(copy, 1), "Bird 1");
+        ASSERT_EQ(ConfigurationGetBirdTotalStatics(copy, 1), 1);
+        ASSERT_EQ(ConfigurationGetBirdStaticIndices(copy, 1)[0], 0);
+        ASSERT_EQ(ConfigurationGetBirdTotalBacks(copy, 1), 1);
+        ASSERT_EQ(ConfigurationGetBirdBackIndices(copy, 1)[0], 2);
+        ASSERT_EQ(ConfigurationGetBirdTotalForwards(copy, 1), 0);
+
+        // Groups are written as each bird's own overrides
+        ASSERT_EQ(ConfigurationGetBirdTiming(copy, 0)->maxPecks, 7);
+        ASSERT_EQ(ConfigurationGetBirdTiming(copy, 0)->overrides, ConfigurationTimingOverrideMaxPecks | ConfigurationTimingOverridePeckWait);
+        ASSERT_EQ(ConfigurationGetBirdTiming(copy, 1)->peckWait, 80);
+        ASSERT_EQ(ConfigurationGetBirdTiming(copy, 1)->overrides, ConfigurationTimingOverridePeckWait);
+
+        ASSERT_EQ(ConfigurationGetTotalShows(copy), 1);
+        ASSERT_EQ(ConfigurationGetShowTotalBirds(copy, 0), 2);
+        ASSERT_EQ(ConfigurationGetShowBirdIndices(copy, 0)[0], 2);
+        ASSERT_EQ(ConfigurationGetShowBirdIndices(copy, 0)[1], 0);
+
+        ASSERT_EQ(ConfigurationGetTotalTriggers(copy), 2);
+        ASSERT_EQ(ConfigurationGetTriggerSource(copy, 0), 7);
+        ASSERT_EQ(ConfigurationGetTriggerShowIndex(copy, 0), 0);
+        ASSERT_EQ(ConfigurationGetTriggerBirdIndex(copy, 0), 0);
+        ASSERT_EQ(ConfigurationGetTriggerType(copy, 1), ConfigurationTriggerTypeSchedule);
+        ASSERT_EQ(ConfigurationGetTriggerAction(copy, 1), ConfigurationTriggerActionStop);
+        ASSERT_EQ(ConfigurationGetTriggerShowIndex(copy, 1), CONFIGURATION_INDEX_NONE);
+
+        ASSERT_STREQ(ConfigurationGetWatchdogPath(copy), "/dev/watchdog");
+        ASSERT_EQ(ConfigurationGetWatchdogInterval(copy), 250);
+        ASSERT_STREQ(ConfigurationGetLogLevels(copy), "EventLoop=warn");
+    }
+
+    ConfigurationRef configuration = nullptr;
+    ConfigurationSnapshotRef snapshot = nullptr;
+
+    std::string yamlPath;
+    std::string imagePath;
+
+};
+
+TEST_F(ConfigurationSnapshotTest, WritesLiveSettingsAsYAML) {
+    ConfigurationSettings settings = { 300, 400, 1, 9, 75 };
+    snapshot = ConfigurationSnapshotCreate(configuration, &settings);
+
+    ASSERT_TRUE(ConfigurationSnapshotWriteFile(snapshot, yamlPath.c_str(), ConfigurationSnapshotFormatYAML));
+
+    ConfigurationRef copy = ConfigurationCreateFromFile(yamlPath.c_str());
+    ASSERT_NE(copy, nullptr);
+    ASSERT_TRUE(ConfigurationResolve(copy));
+
+    ExpectSameModel(copy);
+
+    // The settings come from the running model, not the file
+    ASSERT_EQ(ConfigurationGetMinWait(copy), 300);
+    ASSERT_EQ(ConfigurationGetMaxWait(copy), 400);
+    ASSERT_EQ(ConfigurationGetMinPecks(copy), 1);
+    ASSERT_EQ(ConfigurationGetMaxPecks(copy), 9);
+    ASSERT_EQ(ConfigurationGetPeckWait(copy), 75);
+
+    ConfigurationDestroy(copy);
+}
+
+TEST_F(ConfigurationSnapshotTest, WritesImagesThatMatchTheirYAML) {
+    snapshot = ConfigurationSnapshotCreate(configuration, nullptr);
+
+    ASSERT_TRUE(ConfigurationSnapshotWriteFile(snapshot, yamlPath.c_str(), ConfigurationSnapshotFormatYAML));
+    ASSERT_TRUE(ConfigurationSnapshotWriteFile(snapshot, imagePath.c_str(), ConfigurationSnapshotFormatImage));
+
+    uint64_t sourceHash = 0;
+    ASSERT_TRUE(ConfigurationHashFile(yamlPath.c_str(), &sourceHash));
+
+    ConfigurationRef copy = ConfigurationCreateFromImage(imagePath.c_str(), sourceHash);
+    ASSERT_NE(copy, nullptr);
+
+    ExpectSameModel(copy);
+
+    // Without live settings, the configuration's own are written
+    ASSERT_EQ(ConfigurationGetMinWait(copy), 100);
+    ASSERT_EQ(ConfigurationGetMaxWait(copy), 200);
+    ASSERT_EQ(ConfigurationGetMinPecks(copy), ConfigurationGetMinPecks(configuration));
+
+    ConfigurationDestroy(copy);
+}
+
+TEST_F(ConfigurationSnapshotTest, FailsWithoutWritingPartialFiles) {
+    snapshot = ConfigurationSnapshotCreate(configuration, nullptr);
+
+    ASSERT_FALSE(ConfigurationSnapshotWriteFile(snapshot, "/nonexistent/snapshot.yml", ConfigurationSnapshotFormatYAML));
+    ASSERT_NE(access("/nonexistent/snapshot.yml.tmp", F_OK), 0);
+}
@@ -8,7 +8,12 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <sstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
 
 #include <Configuration.h>
 #include <Log.h>
@@ -490,3 +495,864 @@ TEST_F(ConfigurationTest, ParseEverything) {
     ASSERT_NE(name, nullptr);
     ASSERT_STREQ(name, "Right Forward 1");
 }
+
+TEST_F(ConfigurationTest, ParsesShows) {
+    const char *stringValue =
+        "%YAML 1.1\n"
+        "---\n"
+        "\n"
+        "Birds:\n"
+        "  - Left:\n"
+        "    Static:\n"
+        "      - One\n"
+        "  - Right:\n"
+        "    Static:\n"
+        "      - Two\n"
+        "  - Middle:\n"
+        "    Static:\n"
+        "      - Three\n"
+        "\n"
+        "Shows:\n"
+        "  - Porch:\n"
+        "    Birds:\n"
+        "      - Left\n"
+        "      - Middle\n"
+        "  - Roofline:\n"
+        "    Birds:\n"
+        "      - Right\n";
+
+    configuration = ConfigurationCreateFromString(stringValue);
+    ASSERT_NE(configuration, nullptr);
+
+    size_t total = ConfigurationGetTotalBirds(configuration);
+    ASSERT_EQ(total, 3);
+
+    total = ConfigurationGetTotalShows(configuration);
+    ASSERT_EQ(total, 2);
+
+    const char *name = ConfigurationGetShowName(configuration, 0);
+    ASSERT_STREQ(name, "Porch");
+
+    total = ConfigurationGetShowTotalBirds(configuration, 0);
+    ASSERT_EQ(total, 2);
+
+    name = ConfigurationGetShowBird(configuration, 0, 0);
+    ASSERT_STREQ(name, "Left");
+
+    name = ConfigurationGetShowBird(configuration, 0, 1);
+    ASSERT_STREQ(name, "Middle");
+
+    name = ConfigurationGetShowName(configuration, 1);
+    ASSERT_STREQ(name, "Roofline");
+
+    total = ConfigurationGetShowTotalBirds(configuration, 1);
+    ASSERT_EQ(total, 1);
+
+    name = ConfigurationGetShowBird(configuration, 1, 0);
+    ASSERT_STREQ(name, "Right");
+}
+
+TEST_F(ConfigurationTest, FailsToParseDuplicateShows) {
+    const char *stringValue =
+        "%YAML 1.1\n"
+        "---\n"
+        "\n"
+        "Shows:\n"
+        "  - Porch:\n"
+        "    Birds:\n"
+        "      - Left\n"
+        "  - Porch:\n"
+        "    Birds:\n"
+        "      - Right\n";
+
+    configuration = ConfigurationCreateFromString(stringValue);
+    ASSERT_EQ(configuration, nullptr);
+}
+
+TEST_F(ConfigurationTest, ParsesOutputSafeStates) {
+    const char *stringValue =
+        "%YAML 1.1\n"
+        "---\n"
+        "\n"
+        "Outputs:\n"
+        "  - Default Output:\n"
+        "    Type: Memory\n"
+        "  - On Output:\n"
+        "    Type: Memory\n"
+        "    SafeState: On\n"
+        "  - Hold Output:\n"
+        "    Type: GPIO\n"
+        "    Pin: 4\n"
+        "    SafeState: Hold\n";
+
+    configuration = ConfigurationCreateFromString(stringValue);
+    ASSERT_NE(configuration, nullptr);
+
+    ASSERT_EQ(ConfigurationGetOutputSafeState(configuration, 0), ConfigurationSafeStateOff);
+    ASSERT_EQ(ConfigurationGetOutputSafeState(configuration, 1), ConfigurationSafeStateOn);
+    ASSERT_EQ(ConfigurationGetOutputSafeState(configuration, 2), ConfigurationSafeStateHold);
+}
+
+TEST_F(ConfigurationTest, ParsesOutputLimits) {
+    const char *stringValue =
+        "%YAML 1.1\n"
+        "---\n"
+        "\n"
+        "Outputs:\n"
+        "  - Free Output:\n"
+        "    Type: Memory\n"
+        "  - Relay Output:\n"
+        "    Type: Memory\n"
+        "    MinOn: 100\n"
+        "    MinOff: 200\n"
+        "    MinDwell: 50\n";
+
+    configuration = ConfigurationCreateFromString(stringValue);
+    ASSERT_NE(configuration, nullptr);
+
+    ASSERT_EQ(ConfigurationGetOutputMinOn(configuration, 0), 0);
+    ASSERT_EQ(ConfigurationGetOutputMinOff(configuration, 0), 0);
+    ASSERT_EQ(ConfigurationGetOutputMinDwell(configuration, 0), 0);
+
+    ASSERT_EQ(ConfigurationGetOutputMinOn(configuration, 1), 100);
+    ASSERT_EQ(ConfigurationGetOutputMinOff(configuration, 1), 200);
+    ASSERT_EQ(ConfigurationGetOutputMinDwell(configuration, 1), 50);
+}
+
+TEST_F(ConfigurationTest, FailsToParseOutputUnknownSafeState) {
+    const char *stringValue =
+        "%YAML 1.1\n"
+        "---\n"
+        "\n"
+        "Outputs:\n"
+        "  - Memory Output:\n"
+        "    Type: Memory\n"
+        "    SafeState: Sideways\n";
+
+    configuration = ConfigurationCreateFromString(stringValue);
+    ASSERT_EQ(configuration, nullptr);
+}
+
+TEST_F(ConfigurationTest, ParsesWatchdog) {
+    configuration = ConfigurationCreate();
+    ASSERT_EQ(ConfigurationGetWatchdogPath(configuration), nullptr);
+
+    SAFE_DESTROY(configuration, ConfigurationDestroy);
+
+    const char *stringValue =
+        "%YAML 1.1\n"
+        "---\n"
+        "\n"
+        "Settings:\n"
+        "  Watchdog: /dev/watchdog\n"
+        "  WatchdogInterval: 250\n";
+
+    configuration = ConfigurationCreateFromString(stringValue);
+    ASSERT_NE(configuration, nullptr);
+
+    ASSERT_STREQ(ConfigurationGetWatchdogPath(configuration), "/dev/watchdog");
+    ASSERT_EQ(ConfigurationGetWatchdogInterval(configuration), 250);
+}
+
+TEST_F(ConfigurationTest, ParsesLogLevels) {
+    configuration = ConfigurationCreate();
+    ASSERT_EQ(ConfigurationGetLogLevels(configuration), nullptr);
+
+    SAFE_DESTROY(configuration, ConfigurationDestroy);
+
+    const char *stringValue =
+        "Settings:\n"
+        "  LogLevels: info, EventLoop=warn, Controller=debug\n";
+
+    configuration = ConfigurationCreateFromString(stringValue);
+    ASSERT_NE(configuration, nullptr);
+
+    ASSERT_STREQ(ConfigurationGetLogLevels(configuration), "info, EventLoop=warn, Controller=debug");
+}
+
+TEST_F(ConfigurationTest, FailsToParseInvalidLogLevels) {
+    const char *stringValue =
+        "Settings:\n"
+        "  LogLevels: EventLoop=loud\n";
+
+    configuration = ConfigurationCreateFromString(stringValue);
+    ASSERT_EQ(configuration, nullptr);
+}
+
+TEST_F(ConfigurationTest, ParsesTriggers) {
+    const char *stringValue =
+        "%YAML 1.1\n"
+        "---\n"
+        "\n"
+        "Triggers:\n"
+        "  - Doorbell:\n"
+        "    Type: Command\n"
+        "    Source: 1\n"
+        "    Show: Porch\n"
+        "    Bird: Left\n"
+        "  - Hourly:\n"
+        "    Type: Schedule\n"
+        "    Source: 3600000\n"
+        "    Action: Start\n";
+
+    configuration = ConfigurationCreateFromString(stringValue);
+    ASSERT_NE(configuration, nullptr);
+
+    ASSERT_EQ(ConfigurationGetTotalTriggers(configuration), 2);
+
+    ASSERT_STREQ(ConfigurationGetTriggerName(configuration, 0), "Doorbell");
+    ASSERT_EQ(ConfigurationGetTriggerType(configuration, 0), ConfigurationTriggerTypeCommand);
+    ASSERT_EQ(ConfigurationGetTriggerSource(configuration, 0), 1);
+    ASSERT_STREQ(ConfigurationGetTriggerShow(configuration, 0), "Porch");
+    ASSERT_EQ(ConfigurationGetTriggerAction(configuration, 0), ConfigurationTriggerActionPeck);
+    ASSERT_STREQ(ConfigurationGetTriggerBird(configuration, 0), "Left");
+
+    ASSERT_STREQ(ConfigurationGetTriggerName(configuration, 1), "Hourly");
+    ASSERT_EQ(ConfigurationGetTriggerType(configuration, 1), ConfigurationTriggerTypeSchedule);
+    ASSERT_EQ(ConfigurationGetTriggerSource(configuration, 1), 3600000);
+    ASSERT_EQ(ConfigurationGetTriggerShow(configuration, 1), nullptr);
+    ASSERT_EQ(ConfigurationGetTriggerAction(configuration, 1), ConfigurationTriggerActionStart);
+    ASSERT_EQ(ConfigurationGetTriggerBird(configuration, 1), nullptr);
+}
+
+TEST_F(ConfigurationTest, FailsToParseTriggerWithoutSource) {
+    const char *stringValue =
+        "%YAML 1.1\n"
+        "---\n"
+        "\n"
+        "Triggers:\n"
+        "  - Doorbell:\n"
+        "    Type: Command\n";
+
+    configuration = ConfigurationCreateFromString(stringValue);
+    ASSERT_EQ(configuration, nullptr);
+}
+
+static const char *ImageSource =
+    "%YAML 1.1\n"
+    "---\n"
+    "\n"
+    "Settings:\n"
+    "  MinWait: 2000\n"
+    "  Watchdog: /dev/watchdog\n"
+    "  LogLevels: Stage=debug\n"
+    "\n"
+    "Outputs:\n"
+    "  - Static:\n"
+    "    Type: File\n"
+    "    Path: /tmp/static\n"
+    "    MinOn: 100\n"
+    "  - Back:\n"
+    "    Type: GPIO\n"
+    "    Pin: 4\n"
+    "    SafeState: On\n"
+    "  - Forward:\n"
+    "    Type: Memory\n"
+    "\n"
+    "Birds:\n"
+    "  - Left:\n"
+    "    Static:\n"
+    "      - Static\n"
+    "    Back:\n"
+    "      - Back\n"
+    "    Forward:\n"
+    "      - Forward\n"
+    "    PeckWait: 250\n"
+    "\n"
+    "Shows:\n"
+    "  - Porch:\n"
+    "    Birds:\n"
+    "      - Left\n"
+    "\n"
+    "Groups:\n"
+    "  - Flock:\n"
+    "    Birds:\n"
+    "      - Left\n"
+    "    MaxPecks: 6\n"
+    "\n"
+    "Triggers:\n"
+    "  - Doorbell:\n"
+    "    Type: Command\n"
+    "    Source: 1\n"
+    "    Bird: Left\n";
+
+TEST_F(ConfigurationTest, RoundTripsCompiledImage) {
+    char path[] = "/tmp/ConfigurationTest.XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_NE(fd, -1);
+    close(fd);
+
+    ConfigurationRef source = ConfigurationCreateFromString(ImageSource);
+    ASSERT_NE(source, nullptr);
+    ASSERT_TRUE(ConfigurationResolve(source));
+
+    bool success = ConfigurationWriteImage(source, path, 42);
+    SAFE_DESTROY(source, ConfigurationDestroy);
+    ASSERT_TRUE(success);
+
+    configuration = ConfigurationCreateFromImage(path, 42);
+    unlink(path);
+    ASSERT_NE(configuration, nullptr);
+
+    ASSERT_EQ(ConfigurationGetMinWait(configuration), 2000);
+    ASSERT_EQ(ConfigurationGetMaxWait(configuration), 4000);
+    ASSERT_STREQ(ConfigurationGetWatchdogPath(configuration), "/dev/watchdog");
+    ASSERT_STREQ(ConfigurationGetLogLevels(configuration), "Stage=debug");
+
+    ASSERT_EQ(ConfigurationGetTotalOutputs(configuration), 3);
+    ASSERT_STREQ(ConfigurationGetOutputName(configuration, 0), "Static");
+    ASSERT_EQ(ConfigurationGetOutputType(configuration, 0), ConfigurationOutputTypeFile);
+    ASSERT_STREQ(ConfigurationGetOutputPath(configuration, 0), "/tmp/static");
+    ASSERT_EQ(ConfigurationGetOutputMinOn(configuration, 0), 100);
+    ASSERT_EQ(ConfigurationGetOutputType(configuration, 1), ConfigurationOutputTypeGPIO);
+    ASSERT_EQ(ConfigurationGetOutputPin(configuration, 1), 4);
+    ASSERT_EQ(ConfigurationGetOutputSafeState(configuration, 1), ConfigurationSafeStateOn);
+
+    ASSERT_EQ(ConfigurationGetTotalBirds(configuration), 1);
+    ASSERT_STREQ(ConfigurationGetBirdName(configuration, 0), "Left");
+    ASSERT_STREQ(ConfigurationGetBirdStatic(configuration, 0, 0), "Static");
+    ASSERT_STREQ(ConfigurationGetBirdBack(configuration, 0, 0), "Back");
+    ASSERT_STREQ(ConfigurationGetBirdForward(configuration, 0, 0), "Forward");
+
+    ASSERT_EQ(ConfigurationGetTotalShows(configuration), 1);
+    ASSERT_STREQ(ConfigurationGetShowName(configuration, 0), "Porch");
+    ASSERT_STREQ(ConfigurationGetShowBird(configuration, 0, 0), "Left");
+
+    ASSERT_EQ(ConfigurationGetTotalTriggers(configuration), 1);
+    ASSERT_EQ(ConfigurationGetTriggerType(configuration, 0), ConfigurationTriggerTypeCommand);
+    ASSERT_EQ(ConfigurationGetTriggerShow(configuration, 0), nullptr);
+    ASSERT_STREQ(ConfigurationGetTriggerBird(configuration, 0), "Left");
+
+    // The image holds the resolved indices
+    ASSERT_TRUE(ConfigurationIsResolved(configuration));
+    ASSERT_EQ(ConfigurationGetBirdStaticIndices(configuration, 0)[0], 0);
+    ASSERT_EQ(ConfigurationGetBirdBackIndices(configuration, 0)[0], 1);
+    ASSERT_EQ(ConfigurationGetBirdForwardIndices(configuration, 0)[0], 2);
+    ASSERT_EQ(ConfigurationGetShowBirdIndices(configuration, 0)[0], 0);
+    ASSERT_EQ(ConfigurationGetTriggerShowIndex(configuration, 0), CONFIGURATION_INDEX_NONE);
+    ASSERT_EQ(ConfigurationGetTriggerBirdIndex(configuration, 0), 0);
+
+    // The image holds the resolved timings, with the group already applied
+    const ConfigurationTiming *timing = ConfigurationGetBirdTiming(configuration, 0);
+    ASSERT_NE(timing, nullptr);
+    ASSERT_EQ(timing->minWait, 2000);
+    ASSERT_EQ(timing->maxPecks, 6);
+    ASSERT_EQ(timing->peckWait, 250);
+    ASSERT_EQ(timing->overrides, ConfigurationTimingOverrideMaxPecks | ConfigurationTimingOverridePeckWait);
+    ASSERT_EQ(ConfigurationGetBirdTiming(configuration, 1), nullptr);
+}
+
+TEST_F(ConfigurationTest, IgnoresStaleCompiledImage) {
+    char path[] = "/tmp/ConfigurationTest.XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_NE(fd, -1);
+    close(fd);
+
+    ConfigurationRef source = ConfigurationCreateFromString(ImageSource);
+    ASSERT_NE(source, nullptr);
+    ASSERT_TRUE(ConfigurationResolve(source));
+
+    bool success = ConfigurationWriteImage(source, path, 42);
+    SAFE_DESTROY(source, ConfigurationDestroy);
+    ASSERT_TRUE(success);
+
+    configuration = ConfigurationCreateFromImage(path, 43);
+    unlink(path);
+    ASSERT_EQ(configuration, nullptr);
+}
+
+TEST_F(ConfigurationTest, RejectsCorruptCompiledImage) {
+    char path[] = "/tmp/ConfigurationTest.XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_NE(fd, -1);
+    close(fd);
+
+    ConfigurationRef source = ConfigurationCreateFromString(ImageSource);
+    ASSERT_NE(source, nullptr);
+    ASSERT_TRUE(ConfigurationResolve(source));
+
+    bool success = ConfigurationWriteImage(source, path, 42);
+    SAFE_DESTROY(source, ConfigurationDestroy);
+    ASSERT_TRUE(success);
+
+    // Flip a byte in the last record
+    fd = open(path, O_RDWR);
+    ASSERT_NE(fd, -1);
+
+    off_t size = lseek(fd, 0, SEEK_END);
+    char value = 0;
+    ASSERT_EQ(pread(fd, &value, 1, size - 1), 1);
+    value ^= 0x5A;
+    ASSERT_EQ(pwrite(fd, &value, 1, size - 1), 1);
+    close(fd);
+
+    configuration = ConfigurationCreateFromImage(path, 42);
+    unlink(path);
+    ASSERT_EQ(configuration, nullptr);
+}
+
+TEST_F(ConfigurationTest, FailsToCompileUnknownOutput) {
+    const char *stringValue =
+        "%YAML 1.1\n"
+        "---\n"
+        "\n"
+        "Birds:\n"
+        "  - Left:\n"
+        "    Static:\n"
+        "      - Missing\n";
+
+    ConfigurationRef source = ConfigurationCreateFromString(stringValue);
+    ASSERT_NE(source, nullptr);
+
+    ASSERT_FALSE(ConfigurationResolve(source));
+    ASSERT_FALSE(ConfigurationWriteImage(source, "/tmp/ConfigurationTest.unused", 0));
+    SAFE_DESTROY(source, ConfigurationDestroy);
+
+    ASSERT_NE(access("/tmp/ConfigurationTest.unused", F_OK), 0);
+}
+
+TEST_F(ConfigurationTest, BuildsInAHandfulOfAllocations) {
+    std::stringstream stream;
+    stream << "%YAML 1.1\n---\n\nOutputs:\n";
+
+    for (int idx = 0; idx < 1000; idx++) {
+        stream << "  - Output " << idx << ":\n    Type: Memory\n";
+    }
+
+    stream << "\nBirds:\n";
+
+    for (int idx = 0; idx < 1000; idx += 2) {
+        stream << "  - Bird " << idx << ":\n    Static:\n      - Output " << idx << "\n    Back:\n      - Output " << (idx + 1) << "\n";
+    }
+
+    configuration = ConfigurationCreateFromString(stream.str().c_str());
+    ASSERT_NE(configuration, nullptr);
+
+    ASSERT_EQ(ConfigurationGetTotalOutputs(configuration), 1000);
+    ASSERT_EQ(ConfigurationGetTotalBirds(configuration), 500);
+    ASSERT_STREQ(ConfigurationGetBirdBack(configuration, 499, 0), "Output 999");
+
+    ASSERT_LT(ConfigurationGetTotalAllocations(configuration), 40);
+}
+
+TEST_F(ConfigurationTest, ExpandsTemplates) {
+    const char *stringValue =
+        "%YAML 1.1\n"
+        "---\n"
+        "\n"
+        "Outputs:\n"
+        "  - Static $:\n"
+        "    Type: GPIO\n"
+        "    Range: 1..3\n"
+        "    Pin: 10\n"
+        "    PinStep: 2\n"
+        "  - Back $:\n"
+        "    Type: File\n"
+        "    Range: 1..3\n"
+        "    Path: /tmp/back-$\n"
+        "\n"
+        "Birds:\n"
+        "  - Bird $:\n"
+        "    Range: 1..3\n"
+        "    Static:\n"
+        "      - Static $\n"
+        "    Back:\n"
+        "      - Back $\n"
+        "\n"
+        "Shows:\n"
+        "  - Porch:\n"
+        "    Range: 2..3\n"
+        "    Birds:\n"
+        "      - Bird 1\n"
+        "      - Bird $\n";
+
+    configuration = ConfigurationCreateFromString(stringValue);
+    ASSERT_NE(configuration, nullptr);
+
+    ASSERT_EQ(ConfigurationGetTotalOutputs(configuration), 6);
+    ASSERT_STREQ(ConfigurationGetOutputName(configuration, 0), "Static 1");
+    ASSERT_EQ(ConfigurationGetOutputPin(configuration, 0), 10);
+    ASSERT_STREQ(ConfigurationGetOutputName(configuration, 2), "Static 3");
+    ASSERT_EQ(ConfigurationGetOutputPin(configuration, 2), 14);
+    ASSERT_STREQ(ConfigurationGetOutputName(configuration, 4), "Back 2");
+    ASSERT_STREQ(ConfigurationGetOutputPath(configuration, 4), "/tmp/back-2");
+
+    ASSERT_EQ(ConfigurationGetTotalBirds(configuration), 3);
+    ASSERT_STREQ(ConfigurationGetBirdName(configuration, 1), "Bird 2");
+    ASSERT_STREQ(ConfigurationGetBirdStatic(configuration, 1, 0), "Static 2");
+    ASSERT_STREQ(ConfigurationGetBirdBack(configuration, 1, 0), "Back 2");
+
+    ASSERT_EQ(ConfigurationGetTotalShows(configuration), 1);
+    ASSERT_EQ(ConfigurationGetShowTotalBirds(configuration, 0), 3);
+    ASSERT_STREQ(ConfigurationGetShowBird(configuration, 0, 0), "Bird 1");
+    ASSERT_STREQ(ConfigurationGetShowBird(configuration, 0, 1), "Bird 2");
+    ASSERT_STREQ(ConfigurationGetShowBird(configuration, 0, 2), "Bird 3");
+}
+
+TEST_F(ConfigurationTest, FailsToParseInvalidRange) {
+    const char *stringValue =
+        "%YAML 1.1\n"
+        "---\n"
+        "\n"
+        "Outputs:\n"
+        "  - Static $:\n"
+        "    Type: Memory\n"
+        "    Range: 5..1\n";
+
+    configuration = ConfigurationCreateFromString(stringValue);
+    ASSERT_EQ(configuration, nullptr);
+}
+
+TEST_F(ConfigurationTest, ParsesRangeEndingAtTheLastIndex) {
+    const char *stringValue =
+        "%YAML 1.1\n"
+        "---\n"
+        "\n"
+        "Outputs:\n"
+        "  - Static $:\n"
+        "    Type: Memory\n"
+        "    Range: 4294967294..4294967295\n";
+
+    configuration = ConfigurationCreateFromString(stringValue);
+    ASSERT_NE(configuration, nullptr);
+
+    ASSERT_EQ(ConfigurationGetTotalOutputs(configuration), 2);
+    ASSERT_STREQ(ConfigurationGetOutputName(configuration, 0), "Static 4294967294");
+    ASSERT_STREQ(ConfigurationGetOutputName(configuration, 1), "Static 4294967295");
+}
+
+TEST_F(ConfigurationTest, FailsToParseRangesOutsideOf32Bits) {
+    const char *ranges[] = { "4294967295..4294967296", "4294967296..4294967297", "-1..2", "1..+2" };
+
+    for (const char *range : ranges) {
+        std::string stringValue = std::string("Outputs:\n  - Static $:\n    Type: Memory\n    Range: ") + range + "\n";
+
+        configuration = ConfigurationCreateFromString(stringValue.c_str());
+        ASSERT_EQ(configuration, nullptr) << range;
+    }
+
+    uint32_t first = 0;
+    uint32_t last = 0;
+
+    ASSERT_STREQ(ConfigurationParseRange("4294967296..4294967297", &first, &last), "expected FIRST..LAST");
+    ASSERT_STREQ(ConfigurationParseRange("0..100000", &first, &last), "more than 100000 instances");
+    ASSERT_EQ(ConfigurationParseRange("7..9", &first, &last), nullptr);
+    ASSERT_EQ(first, 7u);
+    ASSERT_EQ(last, 9u);
+}
+
+TEST_F(ConfigurationTest, FailsToParseOutputRangeWithoutPlaceholder) {
+    const char *stringValue =
+        "%YAML 1.1\n"
+        "---\n"
+        "\n"
+        "Outputs:\n"
+        "  - Static:\n"
+        "    Type: Memory\n"
+        "    Range: 1..5\n";
+
+    configuration = ConfigurationCreateFromString(stringValue);
+    ASSERT_EQ(configuration, nullptr);
+}
+
+TEST_F(ConfigurationTest, ParsesIncludes) {
+    const char *stringValue =
+        "%YAML 1.1\n"
+        "---\n"
+        "\n"
+        "Include:\n"
+        "  - outputs.yml\n"
+        "  - /etc/woodpeckers/birds.yml\n"
+        "\n"
+        "Settings:\n"
+        "  MinWait: 2000\n";
+
+    configuration = ConfigurationCreateFromString(stringValue);
+    ASSERT_NE(configuration, nullptr);
+
+    ASSERT_EQ(ConfigurationGetTotalIncludes(configuration), 2);
+    ASSERT_STREQ(ConfigurationGetInclude(configuration, 0), "outputs.yml");
+    ASSERT_STREQ(ConfigurationGetInclude(configuration, 1), "/etc/woodpeckers/birds.yml");
+    ASSERT_EQ(ConfigurationGetInclude(configuration, 2), nullptr);
+    ASSERT_EQ(ConfigurationGetMinWait(configuration), 2000);
+
+    SAFE_DESTROY(configuration, ConfigurationDestroy);
+
+    configuration = ConfigurationCreateFromString("Include: outputs.yml\nSettings:\n  MaxWait: 10\n");
+    ASSERT_NE(configuration, nullptr);
+
+    ASSERT_EQ(ConfigurationGetTotalIncludes(configuration), 1);
+    ASSERT_EQ(ConfigurationGetMaxWait(configuration), 10);
+    ASSERT_EQ(ConfigurationGetTotalSources(configuration), 0);
+}
+
+TEST_F(ConfigurationTest, SplitsIntoChunksThatMergeToTheWhole) {
+    std::ostringstream stream;
+    stream << "%YAML 1.1\n---\n\nSettings:\n  MinWait: 2000\n\nOutputs:\n";
+
+    for (int idx = 0; idx < 64; idx++) {
+        stream << "  - Output " << idx << ":\n    Type: Memory\n";
+    }
+
+    stream << "\n# Birds follow\nBirds:\n";
+
+    for (int idx = 0; idx < 32; idx++) {
+        stream << "  - Bird " << idx << ":\n    Static:\n      - Output " << (idx * 2) << "\n    Back:\n      - Output " << (idx * 2 + 1) << "\n";
+    }
+
+    std::string yaml = stream.str();
+
+    char **chunks = nullptr;
+    size_t totalChunks = ConfigurationSplitString(yaml.c_str(), 256, &chunks);
+    ASSERT_GT(totalChunks, 4);
+
+    // NOTE: Every chunk is parsed and freed before anything is asserted, so a failure leaks nothing
+    std::vector<ConfigurationRef> parsed(totalChunks, nullptr);
+    bool isParsed = true;
+
+    for (size_t idx = 0; idx < totalChunks; idx++) {
+        parsed[idx] = ConfigurationCreateFromString(chunks[idx]);
+        EXPECT_NE(parsed[idx], nullptr) << chunks[idx];
+        isParsed = isParsed && (parsed[idx] != nullptr);
+        free(chunks[idx]);
+    }
+
+    free(chunks);
+
+    if (isParsed) {
+        configuration = ConfigurationCreateMerged(parsed.data(), totalChunks, nullptr, nullptr, 0);
+    }
+
+    for (ConfigurationRef chunk : parsed) {
+        SAFE_DESTROY(chunk, ConfigurationDestroy);
+    }
+
+    ASSERT_TRUE(isParsed);
+    ASSERT_NE(configuration, nullptr);
+
+    ConfigurationRef whole = ConfigurationCreateFromString(yaml.c_str());
+    ASSERT_NE(whole, nullptr);
+
+    EXPECT_EQ(ConfigurationGetMinWait(configuration), 2000);
+    EXPECT_EQ(ConfigurationGetTotalOutputs(configuration), ConfigurationGetTotalOutputs(whole));
+    EXPECT_EQ(ConfigurationGetTotalBirds(configuration), ConfigurationGetTotalBirds(whole));
+
+    for (size_t idx = 0; idx < std::min(ConfigurationGetTotalOutputs(configuration), ConfigurationGetTotalOutputs(whole)); idx++) {
+        EXPECT_STREQ(ConfigurationGetOutputName(configuration, idx), ConfigurationGetOutputName(whole, idx));
+    }
+
+    for (size_t idx = 0; idx < std::min(ConfigurationGetTotalBirds(configuration), ConfigurationGetTotalBirds(whole)); idx++) {
+        EXPECT_STREQ(ConfigurationGetBirdName(configuration, idx), ConfigurationGetBirdName(whole, idx));
+        EXPECT_STREQ(ConfigurationGetBirdBack(configuration, idx, 0), ConfigurationGetBirdBack(whole, idx, 0));
+    }
+
+    ConfigurationDestroy(whole);
+
+    // Anything the splitter does not understand is left whole
+    totalChunks = ConfigurationSplitString("Outputs: [ { A: { Type: Memory } } ]\n", 4, &chunks);
+    ASSERT_EQ(totalChunks, 1);
+    ASSERT_STREQ(chunks[0], "Outputs: [ { A: { Type: Memory } } ]\n");
+    free(chunks[0]);
+    free(chunks);
+}
+
+TEST_F(ConfigurationTest, FailsToMergeDuplicateNames) {
+    ConfigurationRef first = ConfigurationCreateFromString("Outputs:\n  - Static:\n    Type: Memory\n");
+    ConfigurationRef second = ConfigurationCreateFromString("Outputs:\n  - Static:\n    Type: Memory\n");
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+
+    ConfigurationRef fragments[] = { first, second };
+    configuration = ConfigurationCreateMerged(fragments, 2, nullptr, nullptr, 0);
+    ASSERT_EQ(configuration, nullptr);
+
+    ConfigurationDestroy(first);
+    ConfigurationDestroy(second);
+}
+
+TEST_F(ConfigurationTest, ResolvesReferencesToIndices) {
+    const char *stringValue =
+        "Outputs:\n"
+        "  - A:\n"
+        "    Type: Memory\n"
+        "  - B:\n"
+        "    Type: Memory\n"
+        "  - C:\n"
+        "    Type: Memory\n"
+        "\n"
+        "Birds:\n"
+        "  - Left:\n"
+        "    Static:\n"
+        "      - C\n"
+        "    Back:\n"
+        "      - A\n"
+        "      - B\n"
+        "  - Right:\n"
+        "    Forward:\n"
+        "      - B\n"
+        "\n"
+        "Shows:\n"
+        "  - Porch:\n"
+        "    Birds:\n"
+        "      - Right\n"
+        "      - Left\n"
+        "  - Yard:\n"
+        "    Birds:\n"
+        "      - Left\n"
+        "\n"
+        "Triggers:\n"
+        "  - Doorbell:\n"
+        "    Type: Command\n"
+        "    Source: 1\n"
+        "    Show: Porch\n"
+        "    Bird: Right\n"
+        "  - Button:\n"
+        "    Type: Input\n"
+        "    Source: 17\n"
+        "    Bird: Left\n";
+
+    configuration = ConfigurationCreateFromString(stringValue);
+    ASSERT_NE(configuration, nullptr);
+
+    ASSERT_FALSE(ConfigurationIsResolved(configuration));
+    ASSERT_EQ(ConfigurationGetBirdBackIndices(configuration, 0), nullptr);
+    ASSERT_EQ(ConfigurationGetTriggerBirdIndex(configuration, 0), CONFIGURATION_INDEX_NONE);
+
+    ASSERT_TRUE(ConfigurationResolve(configuration));
+    ASSERT_TRUE(ConfigurationIsResolved(configuration));
+    ASSERT_TRUE(ConfigurationResolve(configuration));
+
+    ASSERT_EQ(ConfigurationGetBirdStaticIndices(configuration, 0)[0], 2);
+    ASSERT_EQ(ConfigurationGetBirdBackIndices(configuration, 0)[0], 0);
+    ASSERT_EQ(ConfigurationGetBirdBackIndices(configuration, 0)[1], 1);
+    ASSERT_EQ(ConfigurationGetBirdForwardIndices(configuration, 0), nullptr);
+    ASSERT_EQ(ConfigurationGetBirdForwardIndices(configuration, 1)[0], 1);
+
+    ASSERT_EQ(ConfigurationGetShowBirdIndices(configuration, 0)[0], 1);
+    ASSERT_EQ(ConfigurationGetShowBirdIndices(configuration, 0)[1], 0);
+    ASSERT_EQ(ConfigurationGetShowBirdIndices(configuration, 1)[0], 0);
+
+    ASSERT_EQ(ConfigurationGetTriggerShowIndex(configuration, 0), 0);
+    ASSERT_EQ(ConfigurationGetTriggerBirdIndex(configuration, 0), 1);
+    ASSERT_EQ(ConfigurationGetTriggerShowIndex(configuration, 1), CONFIGURATION_INDEX_NONE);
+    ASSERT_EQ(ConfigurationGetTriggerBirdIndex(configuration, 1), 0);
+}
+
+TEST_F(ConfigurationTest, FailsToResolveDanglingReferences) {
+    const char *prefix =
+        "Outputs:\n"
+        "  - A:\n"
+        "    Type: Memory\n"
+        "\n"
+        "Birds:\n"
+        "  - Left:\n"
+        "    Static:\n"
+        "      - A\n"
+        "  - Right:\n"
+        "    Static:\n"
+        "      - A\n"
+        "\n";
+
+    const char *suffixes[] = {
+        // A show with an unknown bird
+        "Shows:\n  - Porch:\n    Birds:\n      - Missing\n",
+        // A show with a bird twice
+        "Shows:\n  - Porch:\n    Birds:\n      - Left\n      - Left\n",
+        // A trigger with an unknown show
+        "Triggers:\n  - Doorbell:\n    Type: Command\n    Source: 1\n    Show: Missing\n",
+        // A trigger with an unknown bird
+        "Triggers:\n  - Doorbell:\n    Type: Command\n    Source: 1\n    Bird: Missing\n",
+        // A trigger for a bird outside its show
+        "Shows:\n  - Porch:\n    Birds:\n      - Left\n\nTriggers:\n  - Doorbell:\n    Type: Command\n    Source: 1\n    Show: Porch\n    Bird: Right\n",
+        // A trigger for every show, with a bird missing from one
+        "Shows:\n  - Porch:\n    Birds:\n      - Left\n  - Yard:\n    Birds:\n      - Right\n\nTriggers:\n  - Doorbell:\n    Type: Command\n    Source: 1\n    Bird: Left\n",
+        // A group with an unknown bird
+        "Groups:\n  - Flock:\n    Birds:\n      - Missing\n",
+        // A group with a bird twice
+        "Groups:\n  - Flock:\n    Birds:\n      - Left\n      - Left\n",
+        // A bird in two groups
+        "Groups:\n  - Flock:\n    Birds:\n      - Left\n  - Pair:\n    Birds:\n      - Right\n      - Left\n",
+    };
+
+    for (const char *suffix : suffixes) {
+        std::string stringValue = std::string(prefix) + suffix;
+
+        configuration = ConfigurationCreateFromString(stringValue.c_str());
+        ASSERT_NE(configuration, nullptr) << suffix;
+        ASSERT_FALSE(ConfigurationResolve(configuration)) << suffix;
+        ASSERT_FALSE(ConfigurationIsResolved(configuration));
+
+        SAFE_DESTROY(configuration, ConfigurationDestroy);
+    }
+}
+
+TEST_F(ConfigurationTest, ResolvesTimingOverrides) {
+    const char *stringValue =
+        "Settings:\n"
+        "  MinWait: 100\n"
+        "\n"
+        "Outputs:\n"
+        "  - A:\n"
+        "    Type: Memory\n"
+        "\n"
+        "Birds:\n"
+        "  - Bird $:\n"
+        "    Range: 0..1\n"
+        "    Static:\n"
+        "      - A\n"
+        "    PeckWait: 250\n"
+        "  - Loner:\n"
+        "    Static:\n"
+        "      - A\n"
+        "    MaxWait: 50\n"
+        "  - Plain:\n"
+        "    Static:\n"
+        "      - A\n"
+        "\n"
+        "Groups:\n"
+        "  - Flock:\n"
+        "    Range: 0..1\n"
+        "    Birds:\n"
+        "      - Bird $\n"
+        "    MaxWait: 900\n"
+        "    MinPecks: 2\n"
+        "  - Solo:\n"
+        "    Birds:\n"
+        "      - Loner\n"
+        "    MaxWait: 700\n"
+        "    PeckWait: 125\n";
+
+    configuration = ConfigurationCreateFromString(stringValue);
+    ASSERT_NE(configuration, nullptr);
+
+    // Timings are only known once resolved
+    ASSERT_EQ(ConfigurationGetBirdTiming(configuration, 0), nullptr);
+    ASSERT_TRUE(ConfigurationResolve(configuration));
+
+    // A template's instances share its settings, and its group's
+    for (size_t idx = 0; idx < 2; idx++) {
+        const ConfigurationTiming *timing = ConfigurationGetBirdTiming(configuration, idx);
+        ASSERT_NE(timing, nullptr);
+        ASSERT_EQ(timing->minWait, 100);
+        ASSERT_EQ(timing->maxWait, 900);
+        ASSERT_EQ(timing->minPecks, 2);
+        ASSERT_EQ(timing->maxPecks, 3);
+        ASSERT_EQ(timing->peckWait, 250);
+        ASSERT_EQ(timing->overrides, ConfigurationTimingOverrideMaxWait | ConfigurationTimingOverrideMinPecks | ConfigurationTimingOverridePeckWait);
+    }
+
+    // A bird's own settings win over its group's
+    const ConfigurationTiming *timing = ConfigurationGetBirdTiming(configuration, 2);
+    ASSERT_NE(timing, nullptr);
+    ASSERT_EQ(timing->maxWait, 50);
+    ASSERT_EQ(timing->peckWait, 125);
+    ASSERT_EQ(timing->overrides, ConfigurationTimingOverrideMaxWait | ConfigurationTimingOverridePeckWait);
+
+    // Everything else follows the global settings
+    timing = ConfigurationGetBirdTiming(configuration, 3);
+    ASSERT_NE(timing, nullptr);
+    ASSERT_EQ(timing->minWait, 100);
+    ASSERT_EQ(timing->maxWait, 4000);
+    ASSERT_EQ(timing->peckWait, 500);
+    ASSERT_EQ(timing->overrides, 0);
+}
@@ -0,0 +1,363 @@
+//
+//  ConfigurationValidatorTest.cpp
+//  Woodpeckers Tests
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <ConfigurationValidator.h>
+
+class ConfigurationValidatorTest : public ::testing::Test {
+
+    protected:
+
+    void SetUp() override {
+        validator = ConfigurationValidatorCreate();
+
+        char path[] = "/tmp/ConfigurationValidatorTest.XXXXXX";
+        ASSERT_NE(mkdtemp(path), nullptr);
+        directory = path;
+    }
+
+    void TearDown() override {
+        SAFE_DESTROY(validator, ConfigurationValidatorDestroy);
+
+        for (const std::string &name : files) {
+            unlink((directory + "/" + name).c_str());
+        }
+
+        rmdir(directory.c_str());
+    }
+
+    void WriteFile(const std::string &name, const std::string &contents) {
+        std::ofstream stream(directory + "/" + name);
+        stream << contents;
+
+        files.push_back(name);
+    }
+
+    // Find the first diagnostic whose message contains the given text
+    const ConfigurationDiagnostic *FindDiagnostic(const char *text) {
+        size_t total = ConfigurationValidatorGetTotalDiagnostics(validator);
+
+        for (size_t idx = 0; idx < total; idx++) {
+            const ConfigurationDiagnostic *diagnostic = ConfigurationValidatorGetDiagnostic(validator, idx);
+
+            if (strstr(diagnostic->message, text) != nullptr) {
+                return diagnostic;
+            }
+        }
+
+        return nullptr;
+    }
+
+    ConfigurationValidatorRef validator;
+
+    std::string directory;
+    std::vector<std::string> files;
+
+};
+
+TEST_F(ConfigurationValidatorTest, AcceptsValidConfiguration) {
+    const char *stringValue =
+        "%YAML 1.1\n"
+        "---\n"
+        "\n"
+        "Settings:\n"
+        "  MinWait: 100\n"
+        "  Watchdog: /dev/watchdog\n"
+        "  LogLevels: EventLoop=warn,Controller=debug\n"
+        "\n"
+        "Outputs:\n"
+        "  - Static:\n"
+        "    Type: File\n"
+        "    Path: /tmp/static\n"
+        "    SafeState: Hold\n"
+        "  - Wing $:\n"
+        "    Type: GPIO\n"
+        "    Range: 0..3\n"
+        "    Pin: 4\n"
+        "    PinStep: 2\n"
+        "\n"
+        "Birds:\n"
+        "  - Bird $:\n"
+        "    Range: 0..3\n"
+        "    Static: Static\n"
+        "    Back:\n"
+        "      - Wing $\n"
+        "    MinPecks: 2\n"
+        "\n"
+        "Groups:\n"
+        "  - Fast:\n"
+        "    Birds:\n"
+        "      - Bird 0\n"
+        "      - Bird 1\n"
+        "    MaxWait: 500\n"
+        "\n"
+        "Shows:\n"
+        "  - Porch:\n"
+        "    Range: 0..3\n"
+        "    Birds:\n"
+        "      - Bird $\n"
+        "\n"
+        "Triggers:\n"
+        "  - Doorbell:\n"
+        "    Type: Command\n"
+        "    Source: 1\n"
+        "    Show: Porch\n"
+        "    Bird: Bird 2\n";
+
+    ASSERT_TRUE(ConfigurationValidatorCheckString(validator, stringValue));
+    ASSERT_EQ(ConfigurationValidatorGetTotalDiagnostics(validator), 0);
+    ASSERT_EQ(ConfigurationValidatorGetDiagnostic(validator, 0), nullptr);
+}
+
+TEST_F(ConfigurationValidatorTest, CollectsEveryProblem) {
+    const char *stringValue =
+        "Settings:\n"
+        "  MinWait: soon\n"
+        "  Colour: Red\n"
+        "\n"
+        "Outputs:\n"
+        "  - Lamp:\n"
+        "    Type: Relay\n"
+        "  - Door:\n"
+        "    Type: File\n"
+        "  - Lamp:\n"
+        "    Type: Memory\n"
+        "\n"
+        "Triggers:\n"
+        "  - Doorbell:\n"
+        "    Type: Command\n"
+        "\n"
+        "Extras:\n"
+        "  - Nothing\n";
+
+    ASSERT_FALSE(ConfigurationValidatorCheckString(validator, stringValue));
+    ASSERT_EQ(ConfigurationValidatorGetTotalDiagnostics(validator), 7);
+
+    const ConfigurationDiagnostic *diagnostic = FindDiagnostic("Expected a number for MinWait");
+    ASSERT_NE(diagnostic, nullptr);
+    ASSERT_STREQ(diagnostic->path, "<string>");
+    ASSERT_EQ(diagnostic->line, 2);
+    ASSERT_EQ(diagnostic->column, 12);
+
+    diagnostic = FindDiagnostic("Unknown setting \"Colour\"");
+    ASSERT_NE(diagnostic, nullptr);
+    ASSERT_EQ(diagnostic->line, 3);
+    ASSERT_EQ(diagnostic->column, 3);
+
+    diagnostic = FindDiagnostic("Invalid Type \"Relay\"");
+    ASSERT_NE(diagnostic, nullptr);
+    ASSERT_EQ(diagnostic->line, 7);
+
+    diagnostic = FindDiagnostic("File output \"Door\" is missing a path");
+    ASSERT_NE(diagnostic, nullptr);
+    ASSERT_EQ(diagnostic->line, 8);
+
+    diagnostic = FindDiagnostic("Duplicate output name \"Lamp\"");
+    ASSERT_NE(diagnostic, nullptr);
+    ASSERT_EQ(diagnostic->line, 10);
+
+    diagnostic = FindDiagnostic("Trigger \"Doorbell\" is missing a source");
+    ASSERT_NE(diagnostic, nullptr);
+    ASSERT_EQ(diagnostic->line, 14);
+
+    diagnostic = FindDiagnostic("Unknown section \"Extras\"");
+    ASSERT_NE(diagnostic, nullptr);
+    ASSERT_EQ(diagnostic->line, 17);
+    ASSERT_EQ(diagnostic->column, 1);
+}
+
+TEST_F(ConfigurationValidatorTest, ReportsDanglingReferences) {
+    const char *stringValue =
+        "Birds:\n"
+        "  - Left:\n"
+        "    Back:\n"
+        "      - Wing\n"
+        "  - Right:\n"
+        "    Forward:\n"
+        "      - Wing $\n"
+        "    Range: 1..2\n"
+        "\n"
+        "Shows:\n"
+        "  - Porch:\n"
+        "    Birds:\n"
+        "      - Left\n"
+        "      - Left\n"
+        "\n"
+        "Triggers:\n"
+        "  - Doorbell:\n"
+        "    Type: Command\n"
+        "    Source: 1\n"
+        "    Bird: Right\n"
+        "\n"
+        "Outputs:\n"
+        "  - Wing:\n"
+        "    Type: Memory\n"
+        "  - Wing 1:\n"
+        "    Type: Memory\n";
+
+    ASSERT_FALSE(ConfigurationValidatorCheckString(validator, stringValue));
+    ASSERT_EQ(ConfigurationValidatorGetTotalDiagnostics(validator), 3);
+
+    // Outputs defined after the birds that use them are found
+    const ConfigurationDiagnostic *diagnostic = FindDiagnostic("\"Right\" references unknown output \"Wing 2\"");
+    ASSERT_NE(diagnostic, nullptr);
+    ASSERT_EQ(diagnostic->line, 7);
+    ASSERT_EQ(diagnostic->column, 9);
+
+    diagnostic = FindDiagnostic("\"Porch\" lists bird \"Left\" more than once");
+    ASSERT_NE(diagnostic, nullptr);
+    ASSERT_EQ(diagnostic->line, 14);
+
+    diagnostic = FindDiagnostic("\"Doorbell\" pecks bird \"Right\", which is not in show \"Porch\"");
+    ASSERT_NE(diagnostic, nullptr);
+    ASSERT_EQ(diagnostic->line, 20);
+}
+
+TEST_F(ConfigurationValidatorTest, ChecksRangesAtTheEdgeOf32Bits) {
+    const char *stringValue =
+        "Outputs:\n"
+        "  - Wing $:\n"
+        "    Type: Memory\n"
+        "    Range: 4294967294..4294967295\n"
+        "  - Tail $:\n"
+        "    Type: Memory\n"
+        "    Range: 4294967296..4294967297\n";
+
+    ASSERT_FALSE(ConfigurationValidatorCheckString(validator, stringValue));
+    ASSERT_EQ(ConfigurationValidatorGetTotalDiagnostics(validator), 1);
+
+    const ConfigurationDiagnostic *diagnostic = FindDiagnostic("Invalid range \"4294967296..4294967297\", expected FIRST..LAST");
+    ASSERT_NE(diagnostic, nullptr);
+    ASSERT_EQ(diagnostic->line, 7);
+}
+
+TEST_F(ConfigurationValidatorTest, ReportsBirdsInTwoGroups) {
+    const char *stringValue =
+        "Birds:\n"
+        "  - Bird $:\n"
+        "    Range: 0..2\n"
+        "\n"
+        "Groups:\n"
+        "  - Fast:\n"
+        "    Birds:\n"
+        "      - Bird 0\n"
+        "      - Bird 1\n"
+        "    MaxWait: soon\n"
+        "  - Slow:\n"
+        "    Birds:\n"
+        "      - Bird 1\n"
+        "      - Bird 2\n"
+        "      - Bird 2\n";
+
+    ASSERT_FALSE(ConfigurationValidatorCheckString(validator, stringValue));
+    ASSERT_EQ(ConfigurationValidatorGetTotalDiagnostics(validator), 3);
+
+    const ConfigurationDiagnostic *diagnostic = FindDiagnostic("Expected a number for MaxWait");
+    ASSERT_NE(diagnostic, nullptr);
+    ASSERT_EQ(diagnostic->line, 10);
+
+    diagnostic = FindDiagnostic("\"Bird 1\" is in group \"Fast\" and group \"Slow\"");
+    ASSERT_NE(diagnostic, nullptr);
+    ASSERT_EQ(diagnostic->line, 13);
+
+    diagnostic = FindDiagnostic("\"Slow\" lists bird \"Bird 2\" more than once");
+    ASSERT_NE(diagnostic, nullptr);
+    ASSERT_EQ(diagnostic->line, 15);
+}
+
+TEST_F(ConfigurationValidatorTest, ReportsInvalidLogLevels) {
+    const char *stringValue =
+        "Settings:\n"
+        "  LogLevels: EventLoop=warn,Controller=loud\n";
+
+    ASSERT_FALSE(ConfigurationValidatorCheckString(validator, stringValue));
+    ASSERT_EQ(ConfigurationValidatorGetTotalDiagnostics(validator), 1);
+
+    const ConfigurationDiagnostic *diagnostic = FindDiagnostic("Invalid LogLevels \"EventLoop=warn,Controller=loud\"");
+    ASSERT_NE(diagnostic, nullptr);
+    ASSERT_EQ(diagnostic->line, 2);
+}
+
+TEST_F(ConfigurationValidatorTest, StopsAtSyntaxErrors) {
+    const char *stringValue =
+        "Outputs:\n"
+        "  - Lamp:\n"
+        "    Type: Memory\n"
+        "   - Door: [\n";
+
+    ASSERT_FALSE(ConfigurationValidatorCheckString(validator, stringValue));
+    ASSERT_EQ(ConfigurationValidatorGetTotalDiagnostics(validator), 1);
+
+    const ConfigurationDiagnostic *diagnostic = ConfigurationValidatorGetDiagnostic(validator, 0);
+    ASSERT_NE(strstr(diagnostic->message, "Invalid YAML"), nullptr);
+    ASSERT_EQ(diagnostic->line, 4);
+}
+
+TEST_F(ConfigurationValidatorTest, FollowsIncludes) {
+    WriteFile("root.yml",
+        "Include:\n"
+        "  - outputs.yml\n"
+        "  - missing.yml\n"
+        "\n"
+        "Birds:\n"
+        "  - Left:\n"
+        "    Back:\n"
+        "      - Lamp\n"
+        "      - Door\n");
+
+    WriteFile("outputs.yml",
+        "Include: root.yml\n"
+        "\n"
+        "Outputs:\n"
+        "  - Lamp:\n"
+        "    Type: Memory\n"
+        "    MinOn: -5\n");
+
+    std::string rootPath = directory + "/root.yml";
+    std::string outputsPath = directory + "/outputs.yml";
+
+    ASSERT_FALSE(ConfigurationValidatorCheckFile(validator, rootPath.c_str()));
+    ASSERT_EQ(ConfigurationValidatorGetTotalDiagnostics(validator), 4);
+
+    const ConfigurationDiagnostic *diagnostic = FindDiagnostic("Expected a number for MinOn");
+    ASSERT_NE(diagnostic, nullptr);
+    ASSERT_EQ(outputsPath, diagnostic->path);
+    ASSERT_EQ(diagnostic->line, 6);
+
+    diagnostic = FindDiagnostic("includes itself");
+    ASSERT_NE(diagnostic, nullptr);
+    ASSERT_EQ(outputsPath, diagnostic->path);
+    ASSERT_EQ(diagnostic->line, 1);
+
+    diagnostic = FindDiagnostic("missing.yml");
+    ASSERT_NE(diagnostic, nullptr);
+    ASSERT_EQ(rootPath, diagnostic->path);
+    ASSERT_EQ(diagnostic->line, 3);
+
+    // Only the output that is in neither file is unknown
+    diagnostic = FindDiagnostic("references unknown output");
+    ASSERT_NE(diagnostic, nullptr);
+    ASSERT_NE(strstr(diagnostic->message, "\"Door\""), nullptr);
+
+    // A new check starts over
+    WriteFile("valid.yml",
+        "Outputs:\n"
+        "  - Lamp:\n"
+        "    Type: Memory\n");
+
+    ASSERT_TRUE(ConfigurationValidatorCheckFile(validator, (directory + "/valid.yml").c_str()));
+    ASSERT_EQ(ConfigurationValidatorGetTotalDiagnostics(validator), 0);
+}
@@ -0,0 +1,164 @@
+//
+//  ControllerTest.cpp
+//  Woodpeckers Tests
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <time.h>
+
+#include <Controller.h>
+#include <EventLoop.h>
+#include <Log.h>
+#include <OutputTable.h>
+#include <TriggerBus.h>
+
+#define STOP_SOURCE 1
+
+class ControllerTest : public ::testing::Test {
+
+    protected:
+
+    void SetUp() override {
+        LogEnableConsoleOutput(false);
+        LogEnableSystemOutput(false);
+
+        eventLoop = EventLoopCreate();
+        table = OutputTableCreate();
+        bus = TriggerBusCreate();
+
+        ASSERT_TRUE(OutputTableAddMemoryOutput(table, "Static"));
+        ASSERT_TRUE(OutputTableAddMemoryOutput(table, "Back"));
+        ASSERT_TRUE(OutputTableAddMemoryOutput(table, "Forward"));
+
+        show = ControllerCreate("Porch", eventLoop, table, 1);
+
+        // A long sequence of quick pecks, so the show is soon pecking and stays there
+        ControllerSetMinWait(show, 10);
+        ControllerSetMaxWait(show, 10);
+        ControllerSetMinPecks(show, 1000);
+        ControllerSetMaxPecks(show, 1000);
+        ControllerSetPeckWait(show, 20);
+
+        uint32_t statics[] = { 0 };
+        uint32_t backs[] = { 1 };
+        uint32_t forwards[] = { 2 };
+        ASSERT_TRUE(ControllerAddBird(show, "Left", statics, 1, backs, 1, forwards, 1));
+
+        ASSERT_TRUE(ControllerSubscribe(show, bus, TriggerTypeCommand, STOP_SOURCE, ControllerTriggerActionStop, CONTROLLER_NEXT_BIRD));
+        TriggerBusCompile(bus);
+    }
+
+    void TearDown() override {
+        OutputTableTearDown(table);
+
+        SAFE_DESTROY(show, ControllerDestroy);
+        SAFE_DESTROY(bus, TriggerBusDestroy);
+        SAFE_DESTROY(table, OutputTableDestroy);
+        SAFE_DESTROY(eventLoop, EventLoopDestroy);
+
+        LogEnableConsoleOutput(true);
+    }
+
+    bool GetValue(size_t idx) {
+        return OutputGetValue(OutputTableGetOutput(table, idx));
+    }
+
+    static int64_t Now() {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        return ((int64_t)now.tv_sec * 1000) + (now.tv_nsec / 1000000);
+    }
+
+    void RunFor(int64_t milliseconds) {
+        int64_t deadline = Now() + milliseconds;
+
+        while (Now() < deadline) {
+            EventLoopRunOnce(eventLoop, 10);
+        }
+    }
+
+    // The start up sequence turns on one output at a time, so the static and forward outputs are only on together mid-peck
+    bool RunUntilPecking() {
+        int64_t deadline = Now() + 10000;
+
+        while (Now() < deadline) {
+            EventLoopRunOnce(eventLoop, 10);
+
+            if (GetValue(0) && GetValue(2)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void Stop() {
+        ASSERT_TRUE(TriggerBusPublish(bus, TriggerTypeCommand, STOP_SOURCE));
+        ASSERT_EQ(TriggerBusDispatch(bus), 1);
+    }
+
+    EventLoopRef eventLoop = nullptr;
+    OutputTableRef table = nullptr;
+    TriggerBusRef bus = nullptr;
+    ControllerRef show = nullptr;
+
+};
+
+TEST_F(ControllerTest, StopTriggerTurnsOffOutputsMidPeck) {
+    ASSERT_TRUE(OutputTableSetUp(table));
+
+    ControllerStart(show);
+    ASSERT_TRUE(RunUntilPecking());
+
+    Stop();
+
+    ASSERT_FALSE(GetValue(0));
+    ASSERT_FALSE(GetValue(1));
+    ASSERT_FALSE(GetValue(2));
+
+    // The pecks do not carry on after the stop
+    RunFor(100);
+
+    ASSERT_FALSE(GetValue(0));
+    ASSERT_FALSE(GetValue(1));
+    ASSERT_FALSE(GetValue(2));
+}
+
+TEST_F(ControllerTest, StopTriggerMovesOutputsToTheirSafeStates) {
+    OutputSetSafeState(OutputTableGetOutput(table, 0), OutputSafeStateHold);
+    OutputSetSafeState(OutputTableGetOutput(table, 1), OutputSafeStateOn);
+    ASSERT_TRUE(OutputTableSetUp(table));
+
+    ControllerStart(show);
+    ASSERT_TRUE(RunUntilPecking());
+
+    Stop();
+
+    ASSERT_TRUE(GetValue(0));
+    ASSERT_TRUE(GetValue(1));
+    ASSERT_FALSE(GetValue(2));
+}
+
+TEST_F(ControllerTest, RejectsDuplicateBirdsAmongMany) {
+    uint32_t statics[] = { 0 };
+    uint32_t backs[] = { 1 };
+    uint32_t forwards[] = { 2 };
+
+    for (int idx = 0; idx < 1000; idx++) {
+        ASSERT_TRUE(ControllerAddBird(show, ("Bird " + std::to_string(idx)).c_str(), statics, 1, backs, 1, forwards, 1));
+    }
+
+    ASSERT_NE(ControllerGetBirdTiming(show, 1000), nullptr);
+    ASSERT_EQ(ControllerGetBirdTiming(show, 1001), nullptr);
+
+    ASSERT_FALSE(ControllerAddBird(show, "Bird 500", statics, 1, backs, 1, forwards, 1));
+    ASSERT_FALSE(ControllerAddBird(show, "Left", statics, 1, backs, 1, forwards, 1));
+    ASSERT_EQ(ControllerGetBirdTiming(show, 1001), nullptr);
+}
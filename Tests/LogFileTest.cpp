@@ -0,0 +1,209 @@
+//
+//  LogFileTest.cpp
+//  Woodpeckers Tests
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <errno.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <Log.h>
+#include <LogFile.h>
+
+#define SEGMENT_SIZE 4096
+
+class LogFileTest : public ::testing::Test {
+
+    protected:
+
+    void SetUp() override {
+        char pathTemplate[] = "/tmp/LogFileTest.XXXXXX";
+        ASSERT_NE(mkdtemp(pathTemplate), nullptr);
+
+        directory = pathTemplate;
+        path = directory + "/woodpeckers.log";
+    }
+
+    void TearDown() override {
+        SAFE_DESTROY(file, LogFileDestroy);
+
+        LogEnableAsyncOutput(false, LogOverflowPolicyDrop);
+        LogEnableFileOutput(NULL, 0, 0);
+        LogEnableCallbackOutput(false, nullptr);
+        LogEnableConsoleOutput(true);
+
+        for (int idx = 0; idx < 4; idx++) {
+            unlink(SegmentPath(idx).c_str());
+        }
+
+        rmdir(directory.c_str());
+    }
+
+    std::string SegmentPath(int segmentIdx) {
+        return path + "." + std::to_string(segmentIdx);
+    }
+
+    std::string ReadSegment(int segmentIdx) {
+        std::ifstream stream(SegmentPath(segmentIdx));
+        std::stringstream contents;
+        contents << stream.rdbuf();
+
+        return contents.str();
+    }
+
+    // A line of 1000 bytes, so four fit in a segment
+    std::string MakeLine(int lineIdx) {
+        return std::string(999, (char)('a' + lineIdx)) + "\n";
+    }
+
+    std::string directory;
+    std::string path;
+    LogFileRef file = nullptr;
+
+};
+
+TEST_F(LogFileTest, FailsWithoutADirectory) {
+    ASSERT_EQ(LogFileCreate("/nonexistent/woodpeckers.log", 2, SEGMENT_SIZE), nullptr);
+    ASSERT_EQ(errno, ENOENT);
+}
+
+TEST_F(LogFileTest, WritesInToTheFirstSegment) {
+    file = LogFileCreate(path.c_str(), 3, SEGMENT_SIZE);
+    ASSERT_NE(file, nullptr);
+    ASSERT_EQ(LogFileGetCurrentSegment(file), 0);
+
+    LogFileWrite(file, "Hello\n", 6);
+    LogFileWrite(file, "World\n", 6);
+
+    // The segment is preallocated while it is written
+    ASSERT_TRUE(LogFileSync(file));
+    ASSERT_EQ(ReadSegment(0).size(), SEGMENT_SIZE);
+    ASSERT_EQ(ReadSegment(0).substr(0, 13), std::string("Hello\nWorld\n\0", 13));
+
+    // Closing cuts it to its text
+    SAFE_DESTROY(file, LogFileDestroy);
+
+    ASSERT_EQ(ReadSegment(0), "Hello\nWorld\n");
+    ASSERT_NE(access(SegmentPath(1).c_str(), F_OK), 0);
+}
+
+TEST_F(LogFileTest, RotatesWhenASegmentIsFull) {
+    file = LogFileCreate(path.c_str(), 3, SEGMENT_SIZE);
+    ASSERT_NE(file, nullptr);
+
+    for (int idx = 0; idx < 10; idx++) {
+        std::string line = MakeLine(idx);
+        LogFileWrite(file, line.c_str(), line.size());
+    }
+
+    ASSERT_EQ(LogFileGetCurrentSegment(file), 2);
+
+    // The oldest segment is reused once every segment is full
+    for (int idx = 10; idx < 14; idx++) {
+        std::string line = MakeLine(idx);
+        LogFileWrite(file, line.c_str(), line.size());
+    }
+
+    ASSERT_EQ(LogFileGetCurrentSegment(file), 0);
+
+    SAFE_DESTROY(file, LogFileDestroy);
+
+    ASSERT_EQ(ReadSegment(0), MakeLine(12) + MakeLine(13));
+    ASSERT_EQ(ReadSegment(1), MakeLine(4) + MakeLine(5) + MakeLine(6) + MakeLine(7));
+    ASSERT_EQ(ReadSegment(2), MakeLine(8) + MakeLine(9) + MakeLine(10) + MakeLine(11));
+}
+
+TEST_F(LogFileTest, ContinuesAfterTheNewestSegment) {
+    file = LogFileCreate(path.c_str(), 3, SEGMENT_SIZE);
+    ASSERT_NE(file, nullptr);
+
+    LogFileWrite(file, "First\n", 6);
+    SAFE_DESTROY(file, LogFileDestroy);
+
+    file = LogFileCreate(path.c_str(), 3, SEGMENT_SIZE);
+    ASSERT_NE(file, nullptr);
+    ASSERT_EQ(LogFileGetCurrentSegment(file), 1);
+
+    LogFileWrite(file, "Second\n", 7);
+    SAFE_DESTROY(file, LogFileDestroy);
+
+    ASSERT_EQ(ReadSegment(0), "First\n");
+    ASSERT_EQ(ReadSegment(1), "Second\n");
+}
+
+TEST_F(LogFileTest, WritesLogMessages) {
+    LogEnableConsoleOutput(false);
+    ASSERT_TRUE(LogEnableFileOutput(path.c_str(), 2, SEGMENT_SIZE));
+
+    Log(LogLevelInfo, "Test", "Direct %i", 1);
+
+    // The writer copies the lines it formats for the console
+    ASSERT_TRUE(LogEnableAsyncOutput(true, LogOverflowPolicyWait));
+    LogI("Test", "Written %i", 2);
+    ASSERT_TRUE(LogEnableAsyncOutput(false, LogOverflowPolicyWait));
+
+    ASSERT_TRUE(LogEnableFileOutput(NULL, 0, 0));
+
+    std::string contents = ReadSegment(0);
+    std::string lastLine = " I Test           Written 2\n";
+
+    ASSERT_NE(contents.find(" I Test           Direct 1\n"), std::string::npos);
+    ASSERT_EQ(contents.substr(contents.size() - lastLine.size()), lastLine);
+}
+
+static void DisableFileOutput(LogLevel level, const char *tag, const char *message) {
+    LogEnableFileOutput(NULL, 0, 0);
+}
+
+TEST_F(LogFileTest, ClosesAFileReplacedFromACallback) {
+    LogEnableConsoleOutput(false);
+    ASSERT_TRUE(LogEnableFileOutput(path.c_str(), 2, SEGMENT_SIZE));
+    LogEnableCallbackOutput(true, DisableFileOutput);
+
+    LogI("Test", "Replaced");
+
+    // Closing the file trims its segment to what was written
+    struct stat status;
+    ASSERT_EQ(stat(SegmentPath(0).c_str(), &status), 0);
+    ASSERT_LT(status.st_size, SEGMENT_SIZE);
+
+    ASSERT_NE(ReadSegment(0).find(" I Test           Replaced\n"), std::string::npos);
+}
+
+TEST_F(LogFileTest, RetriesASegmentThatFailedToOpen) {
+    file = LogFileCreate(path.c_str(), 2, SEGMENT_SIZE);
+    ASSERT_NE(file, nullptr);
+
+    // A directory in the way of the next segment makes it fail to open
+    ASSERT_EQ(mkdir(SegmentPath(1).c_str(), 0755), 0);
+
+    for (int idx = 0; idx < 5; idx++) {
+        LogFileWrite(file, MakeLine(idx).c_str(), 1000);
+    }
+
+    ASSERT_EQ(LogFileGetCurrentSegment(file), 1);
+
+    // The retry waits, so a write straight after the failure is still lost
+    LogFileWrite(file, MakeLine(5).c_str(), 1000);
+
+    ASSERT_EQ(rmdir(SegmentPath(1).c_str()), 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+    LogFileWrite(file, MakeLine(6).c_str(), 1000);
+
+    SAFE_DESTROY(file, LogFileDestroy);
+
+    ASSERT_EQ(ReadSegment(1), MakeLine(6));
+}
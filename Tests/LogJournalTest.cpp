@@ -0,0 +1,186 @@
+//
+//  LogJournalTest.cpp
+//  Woodpeckers Tests
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include <Log.h>
+#include <LogJournal.h>
+
+class LogJournalTest : public ::testing::Test {
+
+    protected:
+
+    void SetUp() override {
+        // A datagram socket stands in for journald
+        char pathTemplate[] = "/tmp/LogJournalTest.XXXXXX";
+        int fd = mkstemp(pathTemplate);
+        ASSERT_NE(fd, -1);
+        close(fd);
+        unlink(pathTemplate);
+
+        path = pathTemplate;
+
+        server = socket(AF_UNIX, SOCK_DGRAM, 0);
+        ASSERT_NE(server, -1);
+
+        struct sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        strcpy(address.sun_path, path.c_str());
+
+        ASSERT_EQ(bind(server, (struct sockaddr *)&address, sizeof(address)), 0);
+
+        struct timeval timeout = { 1, 0 };
+        setsockopt(server, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+
+    void TearDown() override {
+        SAFE_DESTROY(journal, LogJournalDestroy);
+
+        LogEnableAsyncOutput(false, LogOverflowPolicyDrop);
+        LogEnableSystemOutput(false);
+        LogEnableConsoleOutput(true);
+        LogSetJournalPath(NULL);
+
+        LogSetField(LogFieldShow, NULL);
+        LogSetField(LogFieldBird, NULL);
+        LogSetField(LogFieldOutput, NULL);
+
+        close(server);
+        unlink(path.c_str());
+    }
+
+    std::string Receive() {
+        char buffer[4096];
+        ssize_t bytesRead = recv(server, buffer, sizeof(buffer), 0);
+
+        if (bytesRead <= 0) {
+            return "";
+        }
+
+        return std::string(buffer, (size_t)bytesRead);
+    }
+
+    std::string path;
+    int server = -1;
+    LogJournalRef journal = nullptr;
+
+};
+
+TEST_F(LogJournalTest, FailsWithoutAJournal) {
+    ASSERT_EQ(LogJournalCreate("/nonexistent/socket"), nullptr);
+}
+
+TEST_F(LogJournalTest, WritesStructuredEntries) {
+    journal = LogJournalCreate(path.c_str());
+    ASSERT_NE(journal, nullptr);
+
+    const char *fields[LogFieldCount] = { "Porch", nullptr, "Wing 1" };
+    ASSERT_TRUE(LogJournalWrite(journal, LogLevelWarning, "Output", "Failed to write", fields));
+
+    ASSERT_EQ(Receive(),
+        "PRIORITY=4\n"
+        "SYSLOG_IDENTIFIER=Woodpeckers\n"
+        "WOODPECKERS_TAG=Output\n"
+        "WOODPECKERS_SHOW=Porch\n"
+        "WOODPECKERS_OUTPUT=Wing 1\n"
+        "MESSAGE=Failed to write\n");
+}
+
+TEST_F(LogJournalTest, SizesMessagesWithLineBreaks) {
+    journal = LogJournalCreate(path.c_str());
+    ASSERT_NE(journal, nullptr);
+
+    const char *fields[LogFieldCount] = { nullptr, nullptr, nullptr };
+    ASSERT_TRUE(LogJournalWrite(journal, LogLevelError, "Test", "One\nTwo", fields));
+
+    std::string expected =
+        "PRIORITY=3\n"
+        "SYSLOG_IDENTIFIER=Woodpeckers\n"
+        "WOODPECKERS_TAG=Test\n"
+        "MESSAGE\n";
+
+    expected.append("\x07\x00\x00\x00\x00\x00\x00\x00", 8);
+    expected.append("One\nTwo\n");
+
+    ASSERT_EQ(Receive(), expected);
+}
+
+TEST_F(LogJournalTest, SendsQueuedEntriesInOrder) {
+    journal = LogJournalCreate(path.c_str());
+    ASSERT_NE(journal, nullptr);
+
+    // The socket only holds a few entries, so they are read while they are sent
+    std::vector<std::string> entries;
+    std::thread reader([this, &entries]() {
+        for (int idx = 0; idx < 40; idx++) {
+            entries.push_back(Receive());
+        }
+    });
+
+    const char *fields[LogFieldCount] = { nullptr, "Bird 0", nullptr };
+
+    // More than one batch is queued, so a full batch is sent along the way
+    for (int idx = 0; idx < 40; idx++) {
+        LogJournalAppend(journal, LogLevelInfo, "Test", std::to_string(idx).c_str(), fields);
+    }
+
+    bool isFlushed = LogJournalFlush(journal);
+    reader.join();
+
+    ASSERT_TRUE(isFlushed);
+
+    for (int idx = 0; idx < 40; idx++) {
+        ASSERT_NE(entries[idx].find("WOODPECKERS_BIRD=Bird 0\n"), std::string::npos);
+        ASSERT_NE(entries[idx].find("MESSAGE=" + std::to_string(idx) + "\n"), std::string::npos);
+    }
+}
+
+TEST_F(LogJournalTest, ReceivesSystemOutput) {
+    LogSetJournalPath(path.c_str());
+    LogEnableConsoleOutput(false);
+    LogEnableSystemOutput(true);
+
+    LogSetField(LogFieldBird, "Bird 2");
+    Log(LogLevelInfo, "Test", "Pecked %i times", 3);
+
+    std::string entry = Receive();
+    ASSERT_NE(entry.find("PRIORITY=6\n"), std::string::npos);
+    ASSERT_NE(entry.find("WOODPECKERS_BIRD=Bird 2\n"), std::string::npos);
+    ASSERT_NE(entry.find("MESSAGE=Pecked 3 times\n"), std::string::npos);
+
+    // The writer sends the fields the messages were logged with
+    ASSERT_TRUE(LogEnableAsyncOutput(true, LogOverflowPolicyWait));
+
+    LogSetField(LogFieldBird, "Bird 3");
+    Log(LogLevelWarning, "Test", "First");
+    LogSetField(LogFieldBird, NULL);
+    Log(LogLevelWarning, "Test", "Second");
+
+    LogFlush();
+
+    entry = Receive();
+    ASSERT_NE(entry.find("WOODPECKERS_BIRD=Bird 3\n"), std::string::npos);
+    ASSERT_NE(entry.find("MESSAGE=First\n"), std::string::npos);
+
+    entry = Receive();
+    ASSERT_EQ(entry.find("WOODPECKERS_BIRD="), std::string::npos);
+    ASSERT_NE(entry.find("MESSAGE=Second\n"), std::string::npos);
+}
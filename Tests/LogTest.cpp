@@ -0,0 +1,776 @@
+//
+//  LogTest.cpp
+//  Woodpeckers Tests
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <Log.h>
+
+static std::mutex MessagesMutex;
+static std::vector<std::string> Messages;
+static std::vector<std::thread::id> MessageThreads;
+
+static void CollectMessage(LogLevel level, const char *tag, const char *message) {
+    std::lock_guard<std::mutex> lock(MessagesMutex);
+
+    Messages.push_back(std::string(tag) + ": " + message);
+    MessageThreads.push_back(std::this_thread::get_id());
+}
+
+class LogTest : public ::testing::Test {
+
+    protected:
+
+    void SetUp() override {
+        Messages.clear();
+        MessageThreads.clear();
+
+        LogEnableConsoleOutput(false);
+        LogEnableSystemOutput(false);
+        LogEnableCallbackOutput(true, CollectMessage);
+        LogSetUp(LogLevelVerbose);
+    }
+
+    void TearDown() override {
+        LogEnableAsyncOutput(false, LogOverflowPolicyDrop);
+        LogEnableBinaryOutput(nullptr);
+        LogEnableCallbackOutput(false, nullptr);
+        LogEnableConsoleOutput(true);
+        LogEnableRecorder(false, LogLevelDebug);
+        LogSetTagLevels("");
+    }
+
+};
+
+static bool DumpRecorder(std::string *decoded) {
+    char path[] = "/tmp/LogTest.XXXXXX";
+    int fd = mkstemp(path);
+
+    if (fd == -1) {
+        return false;
+    }
+
+    close(fd);
+
+    bool isDumped = LogDumpRecorder(path);
+    FILE *input = fopen(path, "rb");
+
+    char *text = nullptr;
+    size_t textSize = 0;
+    FILE *output = open_memstream(&text, &textSize);
+
+    bool isDecoded = (input != nullptr) && LogDecode(input, output);
+
+    fclose(output);
+
+    if (input != nullptr) {
+        fclose(input);
+    }
+
+    unlink(path);
+
+    decoded->assign(text, textSize);
+    free(text);
+
+    return isDumped && isDecoded;
+}
+
+TEST_F(LogTest, WritesOnTheCallingThreadByDefault) {
+    LogI("Test", "Message %i", 1);
+
+    ASSERT_EQ(Messages.size(), 1);
+    ASSERT_EQ(Messages[0], "Test: Message 1");
+    ASSERT_EQ(MessageThreads[0], std::this_thread::get_id());
+}
+
+TEST_F(LogTest, WritesAsynchronouslyInOrder) {
+    ASSERT_TRUE(LogEnableAsyncOutput(true, LogOverflowPolicyWait));
+
+    for (int idx = 0; idx < 5000; idx++) {
+        LogI("Test", "Message %i", idx);
+    }
+
+    LogFlush();
+
+    std::lock_guard<std::mutex> lock(MessagesMutex);
+
+    ASSERT_EQ(Messages.size(), 5000);
+
+    for (int idx = 0; idx < 5000; idx++) {
+        ASSERT_EQ(Messages[idx], "Test: Message " + std::to_string(idx));
+        ASSERT_NE(MessageThreads[idx], std::this_thread::get_id());
+    }
+}
+
+TEST_F(LogTest, KeepsEachThreadInOrder) {
+    ASSERT_TRUE(LogEnableAsyncOutput(true, LogOverflowPolicyWait));
+
+    std::vector<std::thread> threads;
+
+    for (int threadIdx = 0; threadIdx < 4; threadIdx++) {
+        threads.emplace_back([threadIdx]() {
+            for (int idx = 0; idx < 2000; idx++) {
+                LogI("Test", "%i %i", threadIdx, idx);
+            }
+        });
+    }
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    // Disabling writes everything that is still buffered
+    ASSERT_TRUE(LogEnableAsyncOutput(false, LogOverflowPolicyWait));
+
+    ASSERT_EQ(Messages.size(), 8000);
+
+    int next[4] = { 0, 0, 0, 0 };
+
+    for (const std::string &message : Messages) {
+        int threadIdx = 0;
+        int idx = 0;
+        ASSERT_EQ(sscanf(message.c_str(), "Test: %i %i", &threadIdx, &idx), 2);
+
+        ASSERT_EQ(idx, next[threadIdx]);
+        next[threadIdx] += 1;
+    }
+}
+
+TEST_F(LogTest, CountsDroppedMessages) {
+    LogStatistics before;
+    LogGetStatistics(&before);
+
+    ASSERT_TRUE(LogEnableAsyncOutput(true, LogOverflowPolicyDrop));
+
+    // Far more than fits in a buffer before the writer wakes up
+    std::string padding(900, 'x');
+
+    for (int idx = 0; idx < 2000; idx++) {
+        LogI("Test", "%i %s", idx, padding.c_str());
+    }
+
+    LogFlush();
+
+    LogStatistics after;
+    LogGetStatistics(&after);
+
+    uint64_t written = after.totalWritten - before.totalWritten;
+    uint64_t dropped = after.totalDropped - before.totalDropped;
+
+    ASSERT_GT(dropped, 0);
+    ASSERT_EQ(written + dropped, 2000);
+
+    // The drops are reported after the messages that were kept
+    std::lock_guard<std::mutex> lock(MessagesMutex);
+
+    ASSERT_EQ(Messages.size(), written + 1);
+    ASSERT_NE(Messages.back().find("Dropped"), std::string::npos);
+}
+
+static std::atomic<bool> IsWriterBlocked(false);
+
+static void BlockingCallback(LogLevel level, const char *tag, const char *message) {
+    if (strcmp(message, "Block") == 0) {
+        while (IsWriterBlocked) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    CollectMessage(level, tag, message);
+}
+
+TEST_F(LogTest, WritesDirectlyWhenStoppedWhileWaiting) {
+    LogStatistics before;
+    LogGetStatistics(&before);
+
+    IsWriterBlocked = true;
+
+    LogEnableCallbackOutput(true, BlockingCallback);
+    ASSERT_TRUE(LogEnableAsyncOutput(true, LogOverflowPolicyWait));
+
+    // The writer is held on the first message, so the rest fill the buffer
+    std::string padding(900, 'x');
+
+    std::thread producer([&padding]() {
+        LogI("Test", "Block");
+
+        for (int idx = 0; idx < 200; idx++) {
+            LogI("Test", "%i %s", idx, padding.c_str());
+        }
+    });
+
+    LogStatistics waiting;
+
+    do {
+        std::this_thread::yield();
+        LogGetStatistics(&waiting);
+    } while (waiting.totalWaits == before.totalWaits);
+
+    // Stopping waits for the writer, which is still held
+    std::thread stopper([]() {
+        ASSERT_TRUE(LogEnableAsyncOutput(false, LogOverflowPolicyWait));
+    });
+
+    producer.join();
+
+    IsWriterBlocked = false;
+    stopper.join();
+
+    LogStatistics after;
+    LogGetStatistics(&after);
+
+    ASSERT_EQ(after.totalDropped, before.totalDropped);
+
+    std::lock_guard<std::mutex> lock(MessagesMutex);
+
+    ASSERT_EQ(Messages.size(), 201);
+}
+
+TEST_F(LogTest, FormatsRecordedArgumentsLikePrintf) {
+    ASSERT_TRUE(LogEnableAsyncOutput(true, LogOverflowPolicyWait));
+
+    const char *missing = nullptr;
+    void *pointer = &Messages;
+
+    LogI("Test", "%d|%-5s|%5.2f|%zu|%lu|%lld|%x|%c|%p|%s|%hhd|%%|%3$.1f", -42, "ab", 3.14159, (size_t)7, (unsigned long)-1, -5LL, 255u, 'z', pointer, missing, 300, 0.0);
+    LogI("Test", "%s and %s", "first", "second");
+    LogI("Test", "Width %*d", 4, 9);
+    LogI("Test", "No arguments");
+
+    LogFlush();
+
+    char expected[256];
+    snprintf(expected, sizeof(expected), "Test: %d|%-5s|%5.2f|%zu|%lu|%lld|%x|%c|%p|%s|%hhd|%%|", -42, "ab", 3.14159, (size_t)7, (unsigned long)-1, -5LL, 255u, 'z', pointer, "(null)", 300);
+
+    std::lock_guard<std::mutex> lock(MessagesMutex);
+
+    ASSERT_EQ(Messages.size(), 4);
+
+    // Positional arguments are formatted when logged
+    ASSERT_EQ(Messages[0], std::string(expected) + "3.1");
+    ASSERT_EQ(Messages[1], "Test: first and second");
+    ASSERT_EQ(Messages[2], "Test: Width    9");
+    ASSERT_EQ(Messages[3], "Test: No arguments");
+}
+
+TEST_F(LogTest, DecodesBinaryOutput) {
+    char path[] = "/tmp/LogTest.XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_NE(fd, -1);
+    close(fd);
+
+    LogEnableCallbackOutput(false, nullptr);
+
+    // Two runs append to the same log, each numbering its formats from the start
+    ASSERT_TRUE(LogEnableBinaryOutput(path));
+    ASSERT_TRUE(LogEnableAsyncOutput(true, LogOverflowPolicyWait));
+
+    for (int idx = 0; idx < 3; idx++) {
+        LogW("Bird", "Pecked %i times in %.1f ms", idx, idx * 1.5);
+    }
+
+    Log(LogLevelError, "Direct", "Formatted %s", "first");
+
+    ASSERT_TRUE(LogEnableAsyncOutput(false, LogOverflowPolicyWait));
+    ASSERT_TRUE(LogEnableBinaryOutput(path));
+
+    LogI("Stage", "Show \"%s\" started", "Porch");
+
+    ASSERT_TRUE(LogEnableBinaryOutput(nullptr));
+
+    FILE *input = fopen(path, "rb");
+    ASSERT_NE(input, nullptr);
+
+    char *text = nullptr;
+    size_t textSize = 0;
+    FILE *output = open_memstream(&text, &textSize);
+
+    bool isDecoded = LogDecode(input, output);
+
+    fclose(output);
+    fclose(input);
+    unlink(path);
+
+    std::string decoded(text, textSize);
+    free(text);
+
+    ASSERT_TRUE(isDecoded);
+
+    ASSERT_NE(decoded.find(" W Bird           Pecked 0 times in 0.0 ms\n"), std::string::npos);
+    ASSERT_NE(decoded.find(" W Bird           Pecked 2 times in 3.0 ms\n"), std::string::npos);
+    ASSERT_NE(decoded.find(" E Direct         Formatted first\n"), std::string::npos);
+    ASSERT_NE(decoded.find(" I Stage          Show \"Porch\" started\n"), std::string::npos);
+    ASSERT_EQ(std::count(decoded.begin(), decoded.end(), '\n'), 5);
+}
+
+TEST_F(LogTest, RejectsOtherFiles) {
+    char text[] = "Not a log";
+    FILE *input = fmemopen(text, sizeof(text) - 1, "rb");
+    FILE *output = fopen("/dev/null", "w");
+
+    ASSERT_FALSE(LogDecode(input, output));
+
+    fclose(output);
+    fclose(input);
+}
+
+// Builds a binary log by hand, for logs the program would never write
+class BinaryLog {
+
+    public:
+
+    BinaryLog() {
+        bytes += "WPLG";
+        Append<uint16_t>(1);
+    }
+
+    void AddFormat(uint32_t identifier, const std::string &format) {
+        bytes += 'F';
+        Append(identifier);
+        Append<uint16_t>((uint16_t)format.size());
+        bytes += format;
+    }
+
+    void AddMessage(uint32_t identifier, const std::string &data) {
+        bytes += 'M';
+        Append(identifier);
+        Append<uint8_t>(LogLevelInfo);
+        Append<int64_t>(0);
+        Append<uint32_t>(0);
+        Append<uint8_t>(4);
+        bytes += "Test";
+        Append<uint16_t>((uint16_t)data.size());
+        bytes += data;
+    }
+
+    bool Decode(std::string *decoded) {
+        FILE *input = fmemopen(&bytes[0], bytes.size(), "rb");
+
+        char *text = nullptr;
+        size_t textSize = 0;
+        FILE *output = open_memstream(&text, &textSize);
+
+        bool isDecoded = LogDecode(input, output);
+
+        fclose(output);
+        fclose(input);
+
+        decoded->assign(text, textSize);
+        free(text);
+
+        return isDecoded;
+    }
+
+    template <typename T> void Append(T value) {
+        bytes.append((const char *)&value, sizeof(value));
+    }
+
+    std::string bytes;
+
+};
+
+static std::string EncodeString(const std::string &value, bool isTerminated) {
+    uint16_t length = (uint16_t)value.size();
+
+    std::string data((const char *)&length, sizeof(length));
+    data += value;
+    data += isTerminated ? '\0' : 'x';
+
+    return data;
+}
+
+TEST_F(LogTest, DecodesHandBuiltLogs) {
+    BinaryLog log;
+    log.AddFormat(1, "Show %s started");
+    log.AddMessage(1, EncodeString("Porch", true));
+
+    std::string decoded;
+    ASSERT_TRUE(log.Decode(&decoded));
+    ASSERT_NE(decoded.find(" I Test           Show Porch started\n"), std::string::npos);
+}
+
+TEST_F(LogTest, RejectsOverlongFormatSpecs) {
+    int64_t value = 7;
+
+    BinaryLog log;
+    log.AddFormat(1, "%" + std::string(29, '0') + "lld");
+    log.AddMessage(1, std::string((const char *)&value, sizeof(value)));
+
+    std::string decoded;
+    ASSERT_FALSE(log.Decode(&decoded));
+    ASSERT_TRUE(decoded.empty());
+}
+
+TEST_F(LogTest, RejectsUnterminatedStrings) {
+    BinaryLog log;
+    log.AddFormat(1, "Show %s started");
+    log.AddMessage(1, EncodeString("Porch", false));
+
+    std::string decoded;
+    ASSERT_FALSE(log.Decode(&decoded));
+    ASSERT_TRUE(decoded.empty());
+}
+
+TEST_F(LogTest, RejectsFormatIdentifiersOutOfRange) {
+    BinaryLog log;
+    log.AddFormat(0xFFFFFFF0, "Show %s started");
+
+    std::string decoded;
+    ASSERT_FALSE(log.Decode(&decoded));
+}
+
+TEST_F(LogTest, FiltersByLevelAndTag) {
+    int evaluations = 0;
+
+    LogSetUp(LogLevelInfo);
+
+    // Filtered messages don't evaluate their arguments
+    LogD("Test", "Debug %i", ++evaluations);
+    LogI("Test", "Info %i", ++evaluations);
+
+    ASSERT_EQ(evaluations, 1);
+
+    ASSERT_TRUE(LogSetTagLevels("Quiet=error, Chatty=verbose"));
+
+    LogW("Quiet", "Warning");
+    LogE("Quiet", "Error");
+    LogV("Chatty", "Verbose");
+    LogD("Test", "Debug");
+
+    // Messages logged directly are filtered by their tag too
+    Log(LogLevelWarning, "Quiet", "Direct warning");
+    Log(LogLevelError, "Quiet", "Direct error");
+
+    // Levels that are not listed again go back to the global level
+    ASSERT_TRUE(LogSetTagLevels("verbose"));
+
+    LogW("Quiet", "Warning again");
+    LogV("Test", "Verbose");
+
+    ASSERT_EQ(Messages.size(), 6);
+    ASSERT_EQ(Messages[0], "Test: Info 1");
+    ASSERT_EQ(Messages[1], "Quiet: Error");
+    ASSERT_EQ(Messages[2], "Chatty: Verbose");
+    ASSERT_EQ(Messages[3], "Quiet: Direct error");
+    ASSERT_EQ(Messages[4], "Quiet: Warning again");
+    ASSERT_EQ(Messages[5], "Test: Verbose");
+}
+
+TEST_F(LogTest, RejectsInvalidTagLevels) {
+    ASSERT_TRUE(LogCheckTagLevels("EventLoop=warn,Controller=DEBUG"));
+    ASSERT_FALSE(LogCheckTagLevels("EventLoop=loud"));
+    ASSERT_FALSE(LogCheckTagLevels("=warn"));
+
+    ASSERT_TRUE(LogSetTagLevels("Test=error"));
+    ASSERT_FALSE(LogSetTagLevels("Test=info,Other=loud"));
+
+    // The invalid list changed nothing
+    LogW("Test", "Warning");
+    ASSERT_EQ(Messages.size(), 0);
+}
+
+TEST_F(LogTest, FormatsTimestampsAcrossSeconds) {
+    // A binary log of text messages, in the format the writer uses
+    std::string log("WPLG\x01\x00", 6);
+
+    auto addMessage = [&log](int64_t seconds, uint32_t microseconds, const std::string &tag, const std::string &message) {
+        uint32_t identifier = 0;
+        uint8_t level = LogLevelInfo;
+        uint8_t tagSize = (uint8_t)tag.size();
+        uint16_t dataSize = (uint16_t)(message.size() + 1);
+
+        log.push_back('M');
+        log.append((const char *)&identifier, sizeof(identifier));
+        log.append((const char *)&level, sizeof(level));
+        log.append((const char *)&seconds, sizeof(seconds));
+        log.append((const char *)&microseconds, sizeof(microseconds));
+        log.append((const char *)&tagSize, sizeof(tagSize));
+        log.append(tag);
+        log.append((const char *)&dataSize, sizeof(dataSize));
+        log.append(message.c_str(), dataSize);
+    };
+
+    addMessage(1608107400, 5, "Test", "First");
+    addMessage(1608107400, 999999, "Test", "Second");
+    addMessage(1608107401, 120000, "AVeryLongTagName", "Third");
+
+    FILE *input = fmemopen(&log[0], log.size(), "rb");
+
+    char *text = nullptr;
+    size_t textSize = 0;
+    FILE *output = open_memstream(&text, &textSize);
+
+    ASSERT_TRUE(LogDecode(input, output));
+
+    fclose(output);
+    fclose(input);
+
+    std::string decoded(text, textSize);
+    free(text);
+
+    auto expectedTime = [](time_t seconds) {
+        struct tm local;
+        localtime_r(&seconds, &local);
+
+        char buffer[32];
+        strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &local);
+
+        return std::string(buffer);
+    };
+
+    std::string expected =
+        expectedTime(1608107400) + ".000005 I Test           First\n" +
+        expectedTime(1608107400) + ".999999 I Test           Second\n" +
+        expectedTime(1608107401) + ".120000 I AVeryLongTagName Third\n";
+
+    ASSERT_EQ(decoded, expected);
+}
+
+static std::atomic<bool> IsSlowCallbackRunning(false);
+static std::atomic<bool> IsSlowCallbackFinished(false);
+
+static void SlowCallback(LogLevel level, const char *tag, const char *message) {
+    IsSlowCallbackRunning = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    IsSlowCallbackFinished = true;
+}
+
+TEST_F(LogTest, WaitsForCallbacksBeforeReplacingThem) {
+    IsSlowCallbackRunning = false;
+    IsSlowCallbackFinished = false;
+
+    LogEnableCallbackOutput(true, SlowCallback);
+
+    std::thread thread([]() {
+        LogI("Test", "Slow");
+    });
+
+    while (!IsSlowCallbackRunning) {
+        std::this_thread::yield();
+    }
+
+    // The previous callback may still be running until the change returns
+    LogEnableCallbackOutput(true, CollectMessage);
+    ASSERT_TRUE(IsSlowCallbackFinished);
+
+    thread.join();
+}
+
+TEST_F(LogTest, ChangesOutputsWhileThreadsLog) {
+    std::atomic<bool> isRunning(true);
+    std::vector<std::thread> threads;
+
+    for (int threadIdx = 0; threadIdx < 4; threadIdx++) {
+        threads.emplace_back([&isRunning, threadIdx]() {
+            for (int idx = 0; isRunning; idx++) {
+                LogI("Test", "%i %i", threadIdx, idx);
+            }
+        });
+    }
+
+    // Setting an output to what it already is still replaces the outputs
+    for (int idx = 0; idx < 200; idx++) {
+        LogEnableCallbackOutput(idx % 2 == 0, CollectMessage);
+        LogEnableConsoleOutput(false);
+    }
+
+    isRunning = false;
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    // Every message that was delivered is whole
+    std::lock_guard<std::mutex> lock(MessagesMutex);
+
+    for (const std::string &message : Messages) {
+        int threadIdx = -1;
+        int messageIdx = -1;
+
+        ASSERT_EQ(sscanf(message.c_str(), "Test: %i %i", &threadIdx, &messageIdx), 2);
+        ASSERT_GE(threadIdx, 0);
+        ASSERT_LT(threadIdx, 4);
+    }
+}
+
+static void LogFailure(int idx) {
+    LogLimitedW("Test", "Failed %i", idx);
+}
+
+TEST_F(LogTest, LimitsRepeatedMessages) {
+    for (int idx = 0; idx < 20; idx++) {
+        LogFailure(idx);
+    }
+
+    // A burst is logged, then the rest are counted
+    ASSERT_EQ(Messages.size(), LOG_LIMIT_BURST);
+    ASSERT_EQ(Messages[LOG_LIMIT_BURST - 1], "Test: Failed " + std::to_string(LOG_LIMIT_BURST - 1));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(LOG_LIMIT_INTERVAL + 100));
+
+    for (int idx = 20; idx < 25; idx++) {
+        LogFailure(idx);
+    }
+
+    // One message was earned, which reports what was dropped first
+    ASSERT_EQ(Messages.size(), LOG_LIMIT_BURST + 2);
+    ASSERT_EQ(Messages[LOG_LIMIT_BURST], "Test: Suppressed " + std::to_string(20 - LOG_LIMIT_BURST) + " repeats of the next message");
+    ASSERT_EQ(Messages[LOG_LIMIT_BURST + 1], "Test: Failed 20");
+}
+
+TEST_F(LogTest, LimitsEachCallSite) {
+    for (int idx = 0; idx < 10; idx++) {
+        LogLimitedE("Test", "First %i", idx);
+        LogLimitedErrno("Test", ENOENT, "Second %i", idx);
+    }
+
+    ASSERT_EQ(Messages.size(), LOG_LIMIT_BURST * 2);
+    ASSERT_EQ(Messages[1], "Test: Second 0: (2) No such file or directory");
+}
+
+TEST_F(LogTest, RecordsFilteredMessages) {
+    LogSetUp(LogLevelInfo);
+    LogEnableRecorder(true, LogLevelDebug);
+
+    LogD("Recorded", "Debug %i of %s", 1, "Porch");
+    LogV("Recorded", "Verbose %i", 2);
+    Log(LogLevelDebug, "Direct", "Formatted %s", "debug");
+    LogI("Recorded", "Info %i", 3);
+
+    // Only the info message reached the outputs
+    ASSERT_EQ(Messages.size(), 1);
+    ASSERT_EQ(Messages[0], "Recorded: Info 3");
+
+    std::string decoded;
+    ASSERT_TRUE(DumpRecorder(&decoded));
+
+    size_t debugPosition = decoded.find(" D Recorded       Debug 1 of Porch\n");
+    size_t directPosition = decoded.find(" D Direct         Formatted debug\n");
+    size_t infoPosition = decoded.find(" I Recorded       Info 3\n");
+
+    ASSERT_NE(debugPosition, std::string::npos);
+    ASSERT_NE(directPosition, std::string::npos);
+    ASSERT_NE(infoPosition, std::string::npos);
+    ASSERT_LT(debugPosition, directPosition);
+    ASSERT_LT(directPosition, infoPosition);
+    ASSERT_EQ(decoded.find("Verbose 2"), std::string::npos);
+}
+
+TEST_F(LogTest, MergesThreadsOldestFirst) {
+    LogEnableCallbackOutput(false, nullptr);
+    LogEnableRecorder(true, LogLevelDebug);
+
+    for (int idx = 0; idx < 3; idx++) {
+        std::thread thread([idx]() {
+            LogD("Merged", "Thread %i", idx);
+        });
+
+        thread.join();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        LogD("Merged", "Main %i", idx);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::string decoded;
+    ASSERT_TRUE(DumpRecorder(&decoded));
+
+    size_t previousPosition = 0;
+
+    for (int idx = 0; idx < 3; idx++) {
+        size_t threadPosition = decoded.find("Merged         Thread " + std::to_string(idx) + "\n");
+        size_t mainPosition = decoded.find("Merged         Main " + std::to_string(idx) + "\n");
+
+        ASSERT_NE(threadPosition, std::string::npos);
+        ASSERT_NE(mainPosition, std::string::npos);
+        ASSERT_GT(threadPosition, previousPosition);
+        ASSERT_GT(mainPosition, threadPosition);
+
+        previousPosition = mainPosition;
+    }
+}
+
+TEST_F(LogTest, OverwritesTheOldestRecords) {
+    LogEnableCallbackOutput(false, nullptr);
+    LogEnableRecorder(true, LogLevelDebug);
+
+    // Many more records than a recorder holds
+    int totalMessages = (LOG_RECORDER_SIZE / 64) * 2;
+
+    for (int idx = 0; idx < totalMessages; idx++) {
+        LogD("Overwritten", "Message %i.", idx);
+    }
+
+    std::string decoded;
+    ASSERT_TRUE(DumpRecorder(&decoded));
+
+    ASSERT_EQ(decoded.find("Message 0.\n"), std::string::npos);
+    ASSERT_NE(decoded.find("Message " + std::to_string(totalMessages - 1) + ".\n"), std::string::npos);
+
+    // What is kept runs up to the latest record without a gap
+    size_t firstPosition = decoded.find("Overwritten    Message ");
+    ASSERT_NE(firstPosition, std::string::npos);
+
+    int firstIdx = atoi(decoded.c_str() + firstPosition + strlen("Overwritten    Message "));
+    int totalKept = (int)std::count(decoded.begin() + (std::string::difference_type)firstPosition, decoded.end(), '\n');
+
+    ASSERT_GT(firstIdx, 0);
+    ASSERT_EQ(firstIdx + totalKept, totalMessages);
+}
+
+TEST_F(LogTest, DumpsWhileThreadsLog) {
+    LogEnableCallbackOutput(false, nullptr);
+    LogEnableRecorder(true, LogLevelDebug);
+
+    std::atomic<bool> isRunning(true);
+    std::atomic<int> totalStarted(0);
+    std::vector<std::thread> threads;
+
+    for (int threadIdx = 0; threadIdx < 4; threadIdx++) {
+        threads.emplace_back([&isRunning, &totalStarted, threadIdx]() {
+            for (int idx = 0; isRunning; idx++) {
+                LogD("Busy", "%i %i %s", threadIdx, idx, (idx % 2 == 0) ? "even" : "odd");
+
+                if (idx == 0) {
+                    totalStarted += 1;
+                }
+            }
+        });
+    }
+
+    while (totalStarted < 4) {
+        std::this_thread::yield();
+    }
+
+    // Records overwritten while they are read are skipped, so every dump decodes
+    for (int idx = 0; idx < 20; idx++) {
+        std::string decoded;
+        ASSERT_TRUE(DumpRecorder(&decoded));
+        ASSERT_NE(decoded.find("Busy"), std::string::npos);
+    }
+
+    isRunning = false;
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
@@ -0,0 +1,180 @@
+//
+//  OutputTableTest.cpp
+//  Woodpeckers Tests
+//
+//  Created by Stephen H. Gerstacker on 2020-12-15.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+#include <unistd.h>
+
+#include <Log.h>
+#include <OutputTable.h>
+
+class OutputTableTest : public ::testing::Test {
+
+    protected:
+
+    static void LogMessage(LogLevel level, const char *tag, const char *message) {
+        std::cerr << "[          ] [" << tag << "/" << message << std::endl;
+    }
+
+    void SetUp() override {
+        LogEnableCallbackOutput(true, LogMessage);
+        LogEnableConsoleOutput(false);
+        LogEnableSystemOutput(false);
+
+        table = OutputTableCreate();
+
+        ASSERT_TRUE(OutputTableAddMemoryOutput(table, "Relay"));
+        ASSERT_TRUE(OutputTableSetUp(table));
+
+        output = OutputTableGetOutput(table, 0);
+    }
+
+    void TearDown() override {
+        OutputTableTearDown(table);
+        SAFE_DESTROY(table, OutputTableDestroy);
+    }
+
+    OutputTableRef table;
+    OutputRef output;
+
+};
+
+TEST_F(OutputTableTest, FindsOutputIndices) {
+    ASSERT_EQ(OutputTableFindOutputIndex(table, "Relay"), 0);
+    ASSERT_EQ(OutputTableFindOutputIndex(table, "Missing"), OUTPUT_TABLE_NOT_FOUND);
+}
+
+TEST_F(OutputTableTest, FindsOutputsAmongMany) {
+    for (int idx = 0; idx < 1000; idx++) {
+        ASSERT_TRUE(OutputTableAddMemoryOutput(table, ("Output " + std::to_string(idx)).c_str()));
+    }
+
+    ASSERT_EQ(OutputTableGetTotalOutputs(table), 1001);
+
+    for (int idx = 0; idx < 1000; idx++) {
+        ASSERT_EQ(OutputTableFindOutputIndex(table, ("Output " + std::to_string(idx)).c_str()), (size_t)idx + 1);
+    }
+
+    ASSERT_FALSE(OutputTableAddMemoryOutput(table, "Output 500"));
+    ASSERT_FALSE(OutputTableAddMemoryOutput(table, "Relay"));
+    ASSERT_EQ(OutputTableGetTotalOutputs(table), 1001);
+}
+
+TEST_F(OutputTableTest, SwitchesFreelyWithoutLimits) {
+    OutputTableSetValue(table, 0, true);
+    ASSERT_TRUE(OutputGetValue(output));
+
+    OutputTableSetValue(table, 0, false);
+    ASSERT_FALSE(OutputGetValue(output));
+    ASSERT_FALSE(OutputTableHasDeferred(table, 0));
+}
+
+TEST_F(OutputTableTest, DefersChangesWithinMinimumOnTime) {
+    ASSERT_TRUE(OutputTableSetLimits(table, 0, 100, 0, 0));
+
+    OutputTableSetValue(table, 0, true);
+    ASSERT_TRUE(OutputGetValue(output));
+
+    // Turning off too soon waits
+    OutputTableSetValue(table, 0, false);
+    ASSERT_TRUE(OutputGetValue(output));
+    ASSERT_TRUE(OutputTableHasDeferred(table, 0));
+
+    OutputTableApplyDeferred(table);
+    ASSERT_TRUE(OutputGetValue(output));
+
+    usleep(150 * 1000);
+
+    OutputTableApplyDeferred(table);
+    ASSERT_FALSE(OutputGetValue(output));
+    ASSERT_FALSE(OutputTableHasDeferred(table, 0));
+}
+
+TEST_F(OutputTableTest, CancelsDeferredChangeForCurrentValue) {
+    ASSERT_TRUE(OutputTableSetLimits(table, 0, 0, 0, 100));
+
+    OutputTableSetValue(table, 0, true);
+    OutputTableSetValue(table, 0, false);
+    ASSERT_TRUE(OutputTableHasDeferred(table, 0));
+
+    OutputTableSetValue(table, 0, true);
+    ASSERT_FALSE(OutputTableHasDeferred(table, 0));
+
+    usleep(150 * 1000);
+
+    OutputTableApplyDeferred(table);
+    ASSERT_TRUE(OutputGetValue(output));
+}
+
+TEST_F(OutputTableTest, MovesToSafeValueWithinLimits) {
+    ASSERT_TRUE(OutputTableSetLimits(table, 0, 100, 0, 0));
+
+    OutputTableSetValue(table, 0, true);
+
+    // The safe state of a running output waits for its limits
+    OutputTableSetSafeValue(table, 0);
+    ASSERT_TRUE(OutputGetValue(output));
+    ASSERT_TRUE(OutputTableHasDeferred(table, 0));
+
+    usleep(150 * 1000);
+
+    OutputTableApplyDeferred(table);
+    ASSERT_FALSE(OutputGetValue(output));
+
+    OutputSetSafeState(output, OutputSafeStateOn);
+    OutputTableSetSafeValue(table, 0);
+    ASSERT_TRUE(OutputGetValue(output));
+
+    usleep(150 * 1000);
+
+    OutputSetSafeState(output, OutputSafeStateHold);
+    OutputTableSetSafeValue(table, 0);
+    ASSERT_TRUE(OutputGetValue(output));
+    ASSERT_FALSE(OutputTableHasDeferred(table, 0));
+}
+
+TEST_F(OutputTableTest, AppliesDeferredChangesAsTheyFallDue) {
+    for (int idx = 1; idx <= 16; idx++) {
+        ASSERT_TRUE(OutputTableAddMemoryOutput(table, ("Output " + std::to_string(idx)).c_str()));
+        ASSERT_TRUE(OutputTableSetLimits(table, idx, (idx % 2 == 0) ? 50 : 300, 0, 0));
+
+        OutputTableSetValue(table, idx, true);
+        OutputTableSetValue(table, idx, false);
+        ASSERT_TRUE(OutputTableHasDeferred(table, idx));
+    }
+
+    // Cancelling changes in the middle of the queue leaves the rest waiting
+    OutputTableSetValue(table, 5, true);
+    OutputTableSetValue(table, 10, true);
+
+    usleep(150 * 1000);
+    OutputTableApplyDeferred(table);
+
+    for (int idx = 1; idx <= 16; idx++) {
+        OutputRef current = OutputTableGetOutput(table, idx);
+        bool isCancelled = (idx == 5 || idx == 10);
+
+        ASSERT_EQ(OutputGetValue(current), isCancelled || (idx % 2 != 0)) << idx;
+        ASSERT_EQ(OutputTableHasDeferred(table, idx), !isCancelled && (idx % 2 != 0)) << idx;
+    }
+
+    usleep(200 * 1000);
+    OutputTableApplyDeferred(table);
+
+    for (int idx = 1; idx <= 16; idx++) {
+        ASSERT_EQ(OutputGetValue(OutputTableGetOutput(table, idx)), idx == 5 || idx == 10) << idx;
+        ASSERT_FALSE(OutputTableHasDeferred(table, idx)) << idx;
+    }
+}
+
+TEST_F(OutputTableTest, FailsToSetLimitsForInvalidOutput) {
+    ASSERT_FALSE(OutputTableSetLimits(table, 1, 100, 100, 100));
+}
@@ -0,0 +1,176 @@
+//
+//  TraceTest.cpp
+//  Woodpeckers Tests
+//
+//  Created by Stephen H. Gerstacker on 2020-12-16.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <Trace.h>
+
+class TraceTest : public ::testing::Test {
+
+    protected:
+
+    void SetUp() override {
+        char pathTemplate[] = "/tmp/TraceTest.XXXXXX";
+        int fd = mkstemp(pathTemplate);
+        ASSERT_NE(fd, -1);
+        close(fd);
+
+        path = pathTemplate;
+    }
+
+    void TearDown() override {
+        TraceEnable(false);
+
+        unlink(path.c_str());
+    }
+
+    // Each event is written on its own line, so the lines naming an event are found without parsing the JSON
+    std::vector<std::string> Export(const std::string &name) {
+        std::vector<std::string> lines;
+
+        if (!TraceExport(path.c_str())) {
+            ADD_FAILURE() << "Failed to export to " << path;
+            return lines;
+        }
+
+        std::ifstream stream(path);
+        std::string line;
+
+        while (std::getline(stream, line)) {
+            if (line.find("\"name\":\"" + name + "\"") != std::string::npos) {
+                lines.push_back(line);
+            }
+        }
+
+        return lines;
+    }
+
+    std::string ReadAll() {
+        std::ifstream stream(path);
+        std::stringstream contents;
+        contents << stream.rdbuf();
+
+        return contents.str();
+    }
+
+    std::string path;
+
+};
+
+TEST_F(TraceTest, RecordsNothingWhileDisabled) {
+    TraceRecord(TracePhaseInstant, "Test", "Disabled", NULL, 0);
+
+    ASSERT_TRUE(Export("Disabled").empty());
+
+    std::string contents = ReadAll();
+    ASSERT_EQ(contents.rfind("{\"traceEvents\":[\n", 0), 0u);
+    ASSERT_EQ(contents.substr(contents.size() - 2), "}\n");
+}
+
+TEST_F(TraceTest, RecordsSpansAndInstants) {
+    TraceEnable(true);
+
+    TraceRecord(TracePhaseBegin, "Test", "Span", "id", 7);
+    TraceRecordString(TracePhaseInstant, "Test", "Span", "output", "Wing 1");
+    TraceRecord(TracePhaseEnd, "Test", "Span", NULL, 0);
+
+    std::vector<std::string> lines = Export("Span");
+    ASSERT_EQ(lines.size(), 3u);
+
+    ASSERT_EQ(lines[0].rfind("{\"ph\":\"B\",\"ts\":", 0), 0u);
+    ASSERT_NE(lines[0].find("\"cat\":\"Test\""), std::string::npos);
+    ASSERT_NE(lines[0].find("\"pid\":" + std::to_string(getpid()) + ","), std::string::npos);
+    ASSERT_NE(lines[0].find("\"args\":{\"id\":7}"), std::string::npos);
+
+    ASSERT_EQ(lines[1].rfind("{\"ph\":\"i\",", 0), 0u);
+    ASSERT_NE(lines[1].find("\"s\":\"t\""), std::string::npos);
+    ASSERT_NE(lines[1].find("\"args\":{\"output\":\"Wing 1\"}"), std::string::npos);
+
+    ASSERT_EQ(lines[2].rfind("{\"ph\":\"E\",", 0), 0u);
+    ASSERT_EQ(lines[2].find("\"args\""), std::string::npos);
+}
+
+TEST_F(TraceTest, EscapesAndCopiesStrings) {
+    TraceEnable(true);
+
+    std::string argument = "A \"quoted\"\\name\n";
+    TraceRecordString(TracePhaseInstant, "Test", "Escaped", "show", argument.c_str());
+
+    // The argument may be freed once it is traced
+    argument.assign(argument.size(), 'x');
+
+    std::vector<std::string> lines = Export("Escaped");
+    ASSERT_EQ(lines.size(), 1u);
+    ASSERT_NE(lines[0].find("\"args\":{\"show\":\"A \\\"quoted\\\"\\\\name\\u000a\"}"), std::string::npos);
+}
+
+TEST_F(TraceTest, KeepsEachThreadOnItsOwnTrack) {
+    TraceEnable(true);
+
+    // Both threads run at once, so neither takes over the other's buffer
+    std::thread first([]() {
+        TraceRecord(TracePhaseInstant, "Test", "Thread", "index", 0);
+        usleep(100000);
+    });
+
+    std::thread second([]() {
+        TraceRecord(TracePhaseInstant, "Test", "Thread", "index", 1);
+        usleep(100000);
+    });
+
+    first.join();
+    second.join();
+
+    std::vector<std::string> lines = Export("Thread");
+    ASSERT_EQ(lines.size(), 2u);
+
+    std::string tids[2];
+
+    for (int idx = 0; idx < 2; idx++) {
+        size_t start = lines[idx].find("\"tid\":");
+        ASSERT_NE(start, std::string::npos);
+
+        tids[idx] = lines[idx].substr(start, lines[idx].find(',', start) - start);
+    }
+
+    ASSERT_NE(tids[0], tids[1]);
+}
+
+TEST_F(TraceTest, DropsTheEndsOfOverwrittenSpans) {
+    TraceEnable(true);
+
+    std::thread thread([]() {
+        TraceRecord(TracePhaseBegin, "Test", "Overwritten", NULL, 0);
+        TraceRecord(TracePhaseBegin, "Test", "Inner", NULL, 0);
+
+        for (int idx = 0; idx < TRACE_BUFFER_EVENTS; idx++) {
+            TraceRecord(TracePhaseInstant, "Test", "Filler", "index", idx);
+        }
+
+        TraceRecord(TracePhaseEnd, "Test", "Inner", NULL, 0);
+        TraceRecord(TracePhaseEnd, "Test", "Overwritten", NULL, 0);
+    });
+
+    thread.join();
+
+    ASSERT_TRUE(Export("Overwritten").empty());
+    ASSERT_TRUE(Export("Inner").empty());
+
+    std::vector<std::string> fillers = Export("Filler");
+    ASSERT_EQ(fillers.size(), (size_t)TRACE_BUFFER_EVENTS - 2);
+    ASSERT_NE(fillers.back().find("\"index\":" + std::to_string(TRACE_BUFFER_EVENTS - 1) + "}"), std::string::npos);
+}
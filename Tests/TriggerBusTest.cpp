@@ -0,0 +1,111 @@
+//
+//  TriggerBusTest.cpp
+//  Woodpeckers Tests
+//
+//  Created by Stephen H. Gerstacker on 2020-12-14.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <vector>
+
+#include <Log.h>
+#include <TriggerBus.h>
+
+class TriggerBusTest : public ::testing::Test {
+
+    protected:
+
+    static void LogMessage(LogLevel level, const char *tag, const char *message) {
+        std::cerr << "[          ] [" << tag << "/" << message << std::endl;
+    }
+
+    static void RecordTrigger(const Trigger *trigger, void *context) {
+        auto triggers = static_cast<std::vector<Trigger> *>(context);
+        triggers->push_back(*trigger);
+    }
+
+    void SetUp() override {
+        LogEnableCallbackOutput(true, LogMessage);
+        LogEnableConsoleOutput(false);
+        LogEnableSystemOutput(false);
+
+        bus = TriggerBusCreate();
+    }
+
+    void TearDown() override {
+        SAFE_DESTROY(bus, TriggerBusDestroy);
+    }
+
+    TriggerBusRef bus;
+
+};
+
+TEST_F(TriggerBusTest, DispatchesToMatchingSubscribers) {
+    std::vector<Trigger> anyCommands;
+    std::vector<Trigger> commandTwo;
+    std::vector<Trigger> schedules;
+
+    ASSERT_TRUE(TriggerBusSubscribe(bus, TriggerTypeCommand, TRIGGER_SOURCE_ANY, RecordTrigger, &anyCommands));
+    ASSERT_TRUE(TriggerBusSubscribe(bus, TriggerTypeCommand, 2, RecordTrigger, &commandTwo));
+    ASSERT_TRUE(TriggerBusSubscribe(bus, TriggerTypeSchedule, 1000, RecordTrigger, &schedules));
+
+    TriggerBusCompile(bus);
+
+    ASSERT_EQ(TriggerBusGetTotalSubscriptions(bus, TriggerTypeCommand), 2);
+    ASSERT_EQ(TriggerBusGetTotalSubscriptions(bus, TriggerTypeSchedule), 1);
+    ASSERT_EQ(TriggerBusGetTotalSubscriptions(bus, TriggerTypeInput), 0);
+
+    ASSERT_TRUE(TriggerBusPublish(bus, TriggerTypeCommand, 1));
+    ASSERT_TRUE(TriggerBusPublish(bus, TriggerTypeCommand, 2));
+    ASSERT_TRUE(TriggerBusPublish(bus, TriggerTypeSchedule, 1000));
+    ASSERT_TRUE(TriggerBusPublish(bus, TriggerTypeInput, 17));
+
+    ASSERT_EQ(TriggerBusGetTotalPending(bus), 4);
+    ASSERT_EQ(TriggerBusDispatch(bus), 4);
+    ASSERT_EQ(TriggerBusGetTotalPending(bus), 0);
+
+    ASSERT_EQ(anyCommands.size(), 2);
+    ASSERT_EQ(anyCommands[0].source, 1);
+    ASSERT_EQ(anyCommands[1].source, 2);
+
+    ASSERT_EQ(commandTwo.size(), 1);
+    ASSERT_EQ(commandTwo[0].type, TriggerTypeCommand);
+    ASSERT_EQ(commandTwo[0].source, 2);
+
+    ASSERT_EQ(schedules.size(), 1);
+    ASSERT_EQ(schedules[0].type, TriggerTypeSchedule);
+}
+
+TEST_F(TriggerBusTest, FailsToSubscribeAfterCompiling) {
+    std::vector<Trigger> triggers;
+
+    TriggerBusCompile(bus);
+
+    ASSERT_FALSE(TriggerBusSubscribe(bus, TriggerTypeCue, 1, RecordTrigger, &triggers));
+}
+
+TEST_F(TriggerBusTest, DropsTriggersWhenFull) {
+    std::vector<Trigger> triggers;
+
+    ASSERT_TRUE(TriggerBusSubscribe(bus, TriggerTypeCue, TRIGGER_SOURCE_ANY, RecordTrigger, &triggers));
+    TriggerBusCompile(bus);
+
+    for (uint32_t idx = 0; idx < TRIGGER_BUS_CAPACITY; idx++) {
+        ASSERT_TRUE(TriggerBusPublish(bus, TriggerTypeCue, idx));
+    }
+
+    ASSERT_FALSE(TriggerBusPublish(bus, TriggerTypeCue, TRIGGER_BUS_CAPACITY));
+    ASSERT_EQ(TriggerBusGetTotalDropped(bus), 1);
+
+    ASSERT_EQ(TriggerBusDispatch(bus), TRIGGER_BUS_CAPACITY);
+    ASSERT_EQ(triggers.size(), TRIGGER_BUS_CAPACITY);
+    ASSERT_EQ(triggers.back().source, TRIGGER_BUS_CAPACITY - 1);
+
+    // The queue wraps around once it has drained
+    ASSERT_TRUE(TriggerBusPublish(bus, TriggerTypeCue, 99));
+    ASSERT_EQ(TriggerBusDispatch(bus), 1);
+    ASSERT_EQ(triggers.back().source, 99);
+}
@@ -0,0 +1,103 @@
+//
+//  WatchdogTest.cpp
+//  Woodpeckers Tests
+//
+//  Created by Stephen H. Gerstacker on 2020-12-13.
+//  Copyright © 2020 Stephen H. Gerstacker. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <Log.h>
+#include <Watchdog.h>
+
+class WatchdogTest : public ::testing::Test {
+
+    protected:
+
+    static void LogMessage(LogLevel level, const char *tag, const char *message) {
+        std::cerr << "[          ] [" << tag << "/" << message << std::endl;
+    }
+
+    void SetUp() override {
+        LogEnableCallbackOutput(true, LogMessage);
+        LogEnableConsoleOutput(false);
+        LogEnableSystemOutput(false);
+
+        // A plain file stands in for the watchdog device
+        char pathTemplate[] = "/tmp/WatchdogTest.XXXXXX";
+        int fd = mkstemp(pathTemplate);
+        ASSERT_NE(fd, -1);
+        close(fd);
+
+        path = pathTemplate;
+        watchdog = WatchdogCreate(path.c_str());
+    }
+
+    void TearDown() override {
+        SAFE_DESTROY(watchdog, WatchdogDestroy);
+        unlink(path.c_str());
+    }
+
+    std::string ReadDevice() {
+        std::ifstream stream(path);
+        std::stringstream contents;
+        contents << stream.rdbuf();
+
+        return contents.str();
+    }
+
+    std::string path;
+    WatchdogRef watchdog;
+
+};
+
+TEST_F(WatchdogTest, DoesNotPetWhenClosed) {
+    ASSERT_FALSE(WatchdogIsOpen(watchdog));
+    ASSERT_FALSE(WatchdogPet(watchdog));
+    ASSERT_EQ(ReadDevice(), "");
+}
+
+TEST_F(WatchdogTest, PetsWhenOpen) {
+    ASSERT_TRUE(WatchdogOpen(watchdog));
+    ASSERT_TRUE(WatchdogIsOpen(watchdog));
+
+    ASSERT_TRUE(WatchdogPet(watchdog));
+    ASSERT_TRUE(WatchdogPet(watchdog));
+
+    ASSERT_EQ(ReadDevice(), "\n\n");
+}
+
+TEST_F(WatchdogTest, DisarmsOnClose) {
+    ASSERT_TRUE(WatchdogOpen(watchdog));
+    ASSERT_TRUE(WatchdogPet(watchdog));
+
+    WatchdogClose(watchdog, true);
+
+    ASSERT_FALSE(WatchdogIsOpen(watchdog));
+    ASSERT_EQ(ReadDevice(), "\nV");
+}
+
+TEST_F(WatchdogTest, StaysArmedOnClose) {
+    ASSERT_TRUE(WatchdogOpen(watchdog));
+    ASSERT_TRUE(WatchdogPet(watchdog));
+
+    WatchdogClose(watchdog, false);
+
+    ASSERT_FALSE(WatchdogIsOpen(watchdog));
+    ASSERT_EQ(ReadDevice(), "\n");
+}
+
+TEST_F(WatchdogTest, FailsToOpenMissingDevice) {
+    SAFE_DESTROY(watchdog, WatchdogDestroy);
+    watchdog = WatchdogCreate("/tmp/WatchdogTest.missing/watchdog");
+
+    ASSERT_FALSE(WatchdogOpen(watchdog));
+    ASSERT_FALSE(WatchdogIsOpen(watchdog));
+}